@@ -1,14 +1,20 @@
 #version 320 es
 
 precision mediump float;
+precision mediump sampler2DArrayShadow;
 
-in vec4 vPositionLightSpace;
+in highp vec3 vPosition;
 
 uniform vec3 normal;
 
-uniform sampler2D shadowMap;
+uniform sampler2DArrayShadow shadowMap;
 uniform vec3 lightDirection;
 
+layout (std140) uniform LightSpaceUB {
+    highp mat4 lightSpace[4];
+    int numCascades;
+};
+
 const float minShadowBias = 0.0005;
 const float maxShadowBias = 0.001;
 
@@ -21,28 +27,40 @@ void main() {
 }
 
 float calculateShadow() {
-    vec3 projectedCoordinates = vPositionLightSpace.xyz / vPositionLightSpace.w;
-    projectedCoordinates = projectedCoordinates * 0.5 + 0.5;
-
-    // Keep objects outside of the light's depth range in the light
-    if (projectedCoordinates.z > 1.0) return 0.0;
-
     // Remove shadow acne
     float bias = max(maxShadowBias * (1.0 - dot(normal, -lightDirection)), minShadowBias);
 
-    float closestDepth = texture(shadowMap, projectedCoordinates.xy).r;
-    float currentDepth = projectedCoordinates.z;
+    // Use the first cascade, which has the smallest texels, that the fragment falls into
+    // with enough of a margin for the samples around it
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    vec2 minCoordinates = 2.0 * texelSize;
+    vec2 maxCoordinates = 1.0 - 2.0 * texelSize;
+
+    for (int cascade = 0; cascade < numCascades; ++cascade) {
+        highp vec4 positionLightSpace = lightSpace[cascade] * vec4(vPosition, 1.0);
+        highp vec3 projectedCoordinates = positionLightSpace.xyz / positionLightSpace.w;
+        projectedCoordinates = projectedCoordinates * 0.5 + 0.5;
 
-    // Sample surrounding texels to create softer shadows
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
-    for(int x = -1; x <= 1; ++x) {
-        for(int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap, projectedCoordinates.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+        if (any(lessThan(projectedCoordinates.xy, minCoordinates)) ||
+            any(greaterThan(projectedCoordinates.xy, maxCoordinates)) ||
+            projectedCoordinates.z > 1.0) {
+            continue;
         }
+
+        highp float currentDepth = projectedCoordinates.z - bias;
+
+        // Sample surrounding texels to create softer shadows. Each sample is the fraction of
+        // the 4 nearest texels in the light, filtered by the hardware depth comparison.
+        float shadow = 0.0;
+        for(int x = -1; x <= 1; ++x) {
+            for(int y = -1; y <= 1; ++y) {
+                vec2 sampleCoordinates = projectedCoordinates.xy + vec2(x, y) * texelSize;
+                shadow += 1.0 - texture(shadowMap, vec4(sampleCoordinates, float(cascade), currentDepth));
+            }
+        }
+        return shadow / 9.0;
     }
-    shadow /= 9.0;
 
-    return shadow;
-}
\ No newline at end of file
+    // Keep objects outside of all cascades in the light
+    return 0.0;
+}
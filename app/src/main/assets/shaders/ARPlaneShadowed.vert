@@ -4,21 +4,17 @@ in vec3 aPosition;
 in vec2 aTextureCoordinate;
 in float aOpacity;
 
-out vec4 vPositionLightSpace;
+out vec3 vPosition;
 
 layout (std140) uniform ProjectionViewUB {
     mat4 projection_view;
 };
 
-layout (std140) uniform LightSpaceUB {
-    mat4 lightSpace;
-};
-
 uniform mat4 model;
 
 void main() {
     vec4 worldPosition = model * vec4(aPosition, 1.0);
 
     gl_Position = projection_view * worldPosition;
-    vPositionLightSpace = lightSpace * worldPosition;
+    vPosition = vec3(worldPosition);
 }
@@ -1,7 +1,7 @@
 #version 320 es
 
 precision mediump float;
-precision mediump sampler2DShadow;
+precision mediump sampler2DArrayShadow;
 
 struct Lighting {
     vec3 ambient;
@@ -15,21 +15,30 @@ struct DirectionalLight {
 };
 
 struct Material {
-    float specularExponent;
     sampler2D diffuseTexture0;
     sampler2D specularTexture0;
 };
 
-in vec3 vPosition;
+in highp vec3 vPosition;
 in vec3 vNormal;
 in vec2 vTextureCoordinate;
-in vec4 vPositionLightSpace;
+in vec3 vColor;
 
 uniform vec3 viewPosition;
 uniform Material material;
 
+layout (std140) uniform DrawUB {
+    float specularExponent;
+};
+
 uniform DirectionalLight directionalLight;
-uniform sampler2D shadowMap;
+
+layout (std140) uniform LightSpaceUB {
+    highp mat4 lightSpace[4];
+    int numCascades;
+};
+
+uniform sampler2DArrayShadow shadowMap;
 
 const float minShadowBias = 0.0005;
 const float maxShadowBias = 0.001;
@@ -51,7 +60,7 @@ Lighting calculateBaseLight(vec3 lightDirection, Lighting lighting) {
     Lighting result;
 
     // Sets ambient color the same as the diffuse color
-    vec3 materialDiffuse = texture(material.diffuseTexture0, vTextureCoordinate).rgb;
+    vec3 materialDiffuse = texture(material.diffuseTexture0, vTextureCoordinate).rgb * vColor;
     result.ambient = lighting.ambient * materialDiffuse;
 
     // Fragment is brighter the closer it is aligned to the light ray direction
@@ -66,35 +75,47 @@ Lighting calculateBaseLight(vec3 lightDirection, Lighting lighting) {
     float specularAngle = dot(halfwayDirection, vNormal);
 
     result.specular = lighting.specular *
-            pow(max(specularAngle, 0.0), material.specularExponent) *
+            pow(max(specularAngle, 0.0), specularExponent) *
             texture(material.specularTexture0, vTextureCoordinate).rgb;
 
     return result;
 }
 
 float calculateShadow(vec3 lightDirection) {
-    vec3 projectedCoordinates = vPositionLightSpace.xyz / vPositionLightSpace.w;
-    projectedCoordinates = projectedCoordinates * 0.5 + 0.5;
-
-    // Keep objects outside of the light's depth range in the light
-    if (projectedCoordinates.z > 1.0) return 0.0;
-
     // Remove shadow acne
     float bias = max(maxShadowBias * (1.0 - dot(vNormal, -lightDirection)), minShadowBias);
 
-    float closestDepth = texture(shadowMap, projectedCoordinates.xy).r;
-    float currentDepth = projectedCoordinates.z;
+    // Use the first cascade, which has the smallest texels, that the fragment falls into
+    // with enough of a margin for the samples around it
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    vec2 minCoordinates = 2.0 * texelSize;
+    vec2 maxCoordinates = 1.0 - 2.0 * texelSize;
+
+    for (int cascade = 0; cascade < numCascades; ++cascade) {
+        highp vec4 positionLightSpace = lightSpace[cascade] * vec4(vPosition, 1.0);
+        highp vec3 projectedCoordinates = positionLightSpace.xyz / positionLightSpace.w;
+        projectedCoordinates = projectedCoordinates * 0.5 + 0.5;
+
+        if (any(lessThan(projectedCoordinates.xy, minCoordinates)) ||
+            any(greaterThan(projectedCoordinates.xy, maxCoordinates)) ||
+            projectedCoordinates.z > 1.0) {
+            continue;
+        }
+
+        highp float currentDepth = projectedCoordinates.z - bias;
 
-    // Sample surrounding texels to create softer shadows
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
-    for(int x = -1; x <= 1; ++x) {
-        for(int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap, projectedCoordinates.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+        // Sample surrounding texels to create softer shadows. Each sample is the fraction of
+        // the 4 nearest texels in the light, filtered by the hardware depth comparison.
+        float shadow = 0.0;
+        for(int x = -1; x <= 1; ++x) {
+            for(int y = -1; y <= 1; ++y) {
+                vec2 sampleCoordinates = projectedCoordinates.xy + vec2(x, y) * texelSize;
+                shadow += 1.0 - texture(shadowMap, vec4(sampleCoordinates, float(cascade), currentDepth));
+            }
         }
+        return shadow / 9.0;
     }
-    shadow /= 9.0;
 
-    return shadow;
-}
\ No newline at end of file
+    // Keep objects outside of all cascades in the light
+    return 0.0;
+}
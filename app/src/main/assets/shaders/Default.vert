@@ -1,30 +1,28 @@
 #version 320 es
 
-in vec3 aPosition;
-in vec3 aNormal;
-in vec2 aTextureCoordinate;
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTextureCoordinate;
+
+// Per-instance attributes
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
+layout (location = 10) in vec3 aColor;
 
 out vec3 vPosition;
 out vec3 vNormal;
 out vec2 vTextureCoordinate;
-out vec4 vPositionLightSpace;
+out vec3 vColor;
 
 layout (std140) uniform ProjectionViewUB {
    mat4 projection_view;
 };
 
-layout (std140) uniform LightSpaceUB {
-   mat4 lightSpace;
-};
-
-uniform mat4 model;
-uniform mat3 normal;
-
 void main() {
-   vec4 worldPosition = model * vec4(aPosition, 1.0);
+   vec4 worldPosition = aModel * vec4(aPosition, 1.0);
    gl_Position = projection_view * worldPosition;
    vPosition = vec3(worldPosition);
-   vNormal = normalize(vec3(normal * aNormal));
+   vNormal = normalize(vec3(aNormalMatrix * aNormal));
    vTextureCoordinate = aTextureCoordinate;
-   vPositionLightSpace = lightSpace * worldPosition;
+   vColor = aColor;
 }
\ No newline at end of file
@@ -2,10 +2,10 @@
 
 precision mediump float;
 
-uniform vec3 color;
+in vec3 vColor;
 
 out vec4 gl_FragColor;
 
 void main() {
-    gl_FragColor = vec4(color, 1.0);
+    gl_FragColor = vec4(vColor, 1.0);
 }
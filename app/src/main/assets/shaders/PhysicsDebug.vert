@@ -1,14 +1,15 @@
 #version 320 es
 
-in vec3 aPosition;
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aColor;
 
 layout (std140) uniform ProjectionViewUB {
     mat4 projection_view;
 };
 
-uniform vec3 origin;
-uniform vec3 basis;
+out vec3 vColor;
 
 void main() {
-    gl_Position = projection_view * vec4(basis * aPosition + origin, 1.0);
-}
\ No newline at end of file
+    vColor = aColor;
+    gl_Position = projection_view * vec4(aPosition, 1.0);
+}
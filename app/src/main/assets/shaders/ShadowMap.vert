@@ -1,13 +1,17 @@
 #version 320 es
 
-in vec3 aPosition;
+layout (location = 0) in vec3 aPosition;
+
+// Per-instance attributes
+layout (location = 3) in mat4 aModel;
 
 layout (std140) uniform LightSpaceUB {
-    mat4 lightSpace;
+    mat4 lightSpace[4];
+    int numCascades;
 };
 
-uniform mat4 model;
+uniform int cascade;
 
 void main() {
-    gl_Position = lightSpace * model * vec4(aPosition, 1.0);
+    gl_Position = lightSpace[cascade] * aModel * vec4(aPosition, 1.0);
 }
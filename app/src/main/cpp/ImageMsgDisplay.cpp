@@ -6,6 +6,7 @@
 #include <glm/vec2.hpp>
 #include <sensor_msgs/Image_generated.h>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/ShaderProgram.h>
 
 #include <android_game_engine/Log.h>
@@ -39,10 +40,10 @@ ImageMsgDisplay::ImageMsgDisplay() {
 
     // Store vertex data
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
 
     glBufferData(GL_ARRAY_BUFFER,
             positionsSize_bytes + textureCoordinatesSize_bytes,
@@ -61,12 +62,12 @@ ImageMsgDisplay::ImageMsgDisplay() {
                           reinterpret_cast<GLvoid*>(positionsSize_bytes));
     glEnableVertexAttribArray(1u);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 
     // Generate texture
     glGenTextures(1, &this->texture);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    GLState::bindTexture(GL_TEXTURE_2D, this->texture);
 
     const float borderColor[] = {1.0f, 1.0f, 0.0f, 1.0f};
     glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
@@ -75,13 +76,13 @@ ImageMsgDisplay::ImageMsgDisplay() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 ImageMsgDisplay::~ImageMsgDisplay() {
-    glDeleteTextures(1, &this->texture);
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
+    GLState::deleteTextures(1, &this->texture);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
 }
 
 void ImageMsgDisplay::bufferImage(ntwk::Image *img) {
@@ -116,32 +117,32 @@ void ImageMsgDisplay::bufferImage(ntwk::Image *img) {
         };
 
         // Update texture coordinates
-        glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
         glBufferSubData(GL_ARRAY_BUFFER,
                 positionsSize_bytes, textureCoordinatesSize_bytes,
                 textureCoordinates.data());
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
         // Update texture size
-        glBindTexture(GL_TEXTURE_2D, this->texture);
+        GLState::bindTexture(GL_TEXTURE_2D, this->texture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, this->width, this->height, 0,
                 format, GL_UNSIGNED_BYTE, nullptr);
     }
 
     // Update texture
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    GLState::bindTexture(GL_TEXTURE_2D, this->texture);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->width, this->height,
             format, GL_UNSIGNED_BYTE, img->data.get());
 }
 
 void ImageMsgDisplay::render(ShaderProgram *shader) {
     // Bind texture
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     shader->setUniform("cameraImageTexture", 0);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    GLState::bindTexture(GL_TEXTURE_2D, this->texture);
 
     // Draw
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
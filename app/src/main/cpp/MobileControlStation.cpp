@@ -17,15 +17,18 @@ JNI_METHOD_DEFINITION(void, onSurfaceCreatedJNI)
 }
 
 JNI_METHOD_DEFINITION(void, onLeftJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y) {
-    reinterpret_cast<MobileControlStation*>(GameEngineJNI::getGame())->onLeftJoystickInput(x, y);
+    auto game = reinterpret_cast<MobileControlStation*>(GameEngineJNI::getGame());
+    game->postEvent([game, x, y](){ game->onLeftJoystickInput(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onRightJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y) {
-    reinterpret_cast<MobileControlStation*>(GameEngineJNI::getGame())->onRightJoystickInput(x, y);
+    auto game = reinterpret_cast<MobileControlStation*>(GameEngineJNI::getGame());
+    game->postEvent([game, x, y](){ game->onRightJoystickInput(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onResetJNI)(JNIEnv *env, jobject gameActivity) {
-    reinterpret_cast<MobileControlStation*>(GameEngineJNI::getGame())->onReset();
+    auto game = reinterpret_cast<MobileControlStation*>(GameEngineJNI::getGame());
+    game->postEvent([game](){ game->onReset(); });
 }
 
 MobileControlStation::MobileControlStation(JNIEnv *env, jobject javaApplicationContext, jobject javaActivityObject) :
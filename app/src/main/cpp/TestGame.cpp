@@ -5,6 +5,7 @@
 #include <android_game_engine/Box.h>
 #include <android_game_engine/LightDirectional.h>
 #include <android_game_engine/Texture2D.h>
+#include <android_game_engine/Trace.h>
 
 namespace age {
 
@@ -16,15 +17,18 @@ JNI_METHOD_DEFINITION(void, onSurfaceCreatedJNI)
 }
 
 JNI_METHOD_DEFINITION(void, onLeftJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y) {
-    reinterpret_cast<TestGame*>(GameEngineJNI::getGame())->onLeftJoystickInput(x, y);
+    auto game = reinterpret_cast<TestGame*>(GameEngineJNI::getGame());
+    game->postEvent([game, x, y](){ game->onLeftJoystickInput(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onRightJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y) {
-    reinterpret_cast<TestGame*>(GameEngineJNI::getGame())->onRightJoystickInput(x, y);
+    auto game = reinterpret_cast<TestGame*>(GameEngineJNI::getGame());
+    game->postEvent([game, x, y](){ game->onRightJoystickInput(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onResetJNI)(JNIEnv *env, jobject gameActivity) {
-    reinterpret_cast<TestGame*>(GameEngineJNI::getGame())->onReset();
+    auto game = reinterpret_cast<TestGame*>(GameEngineJNI::getGame());
+    game->postEvent([game](){ game->onReset(); });
 }
 
 TestGame::TestGame(JNIEnv *env, jobject javaApplicationContext, jobject javaActivityObject)
@@ -36,6 +40,9 @@ void TestGame::onCreate() {
     Game::onCreate();
 
 //    this->enablePhysicsDebugDrawer(true);
+//    this->enableSimulationThread(true);
+//    Trace::setEnabled(true);
+    this->setFixedTimestep(std::chrono::duration<float>(1.0f / 60.0f));
     this->getDirectionalLight()->setLookAtDirection({1.0f, 1.0f, -3.0f});
 
     this->getCam()->setPosition({-3.0f, 0.0f, 1.5f});
@@ -43,7 +50,7 @@ void TestGame::onCreate() {
 
     // Create floor
     const auto scale = 50.0f;
-    std::shared_ptr<Box> floor(new Box({Texture2D("images/wood.png")},
+    std::shared_ptr<Box> floor(new Box({Texture2D("images/wood.png", LoadMode::ASYNCHRONOUS)},
                                        {Texture2D(glm::vec3(1.0f))},
                                        glm::vec2(scale)));
 
@@ -54,15 +61,17 @@ void TestGame::onCreate() {
     floor->setFriction(1.0f);
     this->addToWorldList(floor);
 
-    // Create boxes
+    // Create boxes. All boxes share the same textures and are tinted individually
+    // so that they can be drawn in a single instanced draw call.
     std::mt19937 rand;
     std::uniform_real_distribution<float> color(0.0f, 1.0f);
+    const Texture2D white(glm::vec3(1.0f));
 
     constexpr auto numBoxes = 100u;
     this->boxes.reserve(numBoxes);
     for (auto i = 0u; i < numBoxes; ++i) {
-        this->boxes.push_back(std::shared_ptr<Box>(new Box({Texture2D(glm::vec3(color(rand), color(rand), color(rand)))},
-                                                           {Texture2D(glm::vec3(1.0f))})));
+        this->boxes.push_back(std::shared_ptr<Box>(new Box({white}, {white})));
+        this->boxes.back()->setColor({color(rand), color(rand), color(rand)});
         this->boxes.back()->setScale(glm::vec3(0.2f));
         this->boxes.back()->setMass(1.0f);
         this->addToWorldList(this->boxes.back());
@@ -13,11 +13,13 @@ JNI_METHOD_DEFINITION(void, onSurfaceCreatedJNI)
 }
 
 JNI_METHOD_DEFINITION(void, onJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y) {
-    reinterpret_cast<TestGameAR*>(GameEngineJNI::getGame())->onJoystickInput(x, y);
+    auto game = reinterpret_cast<TestGameAR*>(GameEngineJNI::getGame());
+    game->postEvent([game, x, y](){ game->onJoystickInput(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onResetJNI)(JNIEnv *env, jobject gameActivity) {
-    reinterpret_cast<TestGameAR*>(GameEngineJNI::getGame())->onReset();
+    auto game = reinterpret_cast<TestGameAR*>(GameEngineJNI::getGame());
+    game->postEvent([game](){ game->onReset(); });
 }
 
 TestGameAR::TestGameAR(JNIEnv *env, jobject javaApplicationContext, jobject javaActivityObject)
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+
+namespace ntwk {
+
+///
+/// \brief Tracks absolute deadlines for a fixed period.
+///
+/// Deadlines are advanced from the previous deadline rather than from the time the caller woke
+/// up, so oversleeping does not accumulate into drift. If a caller wakes up after one or more
+/// whole periods have already elapsed, those periods are counted as missed and skipped rather
+/// than being run back to back.
+///
+class DeadlineScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Statistics {
+        unsigned long long numCycles = 0;
+        unsigned long long numMissedDeadlines = 0;
+        std::chrono::nanoseconds meanJitter {0}; ///< Mean lateness of wakeups past their deadline
+        std::chrono::nanoseconds maxJitter {0};  ///< Worst lateness of a wakeup past its deadline
+    };
+
+    explicit DeadlineScheduler(Clock::duration period, Clock::time_point start = Clock::now());
+
+    Clock::duration getPeriod() const;
+    Clock::time_point getNextDeadline() const;
+
+    ///
+    /// \brief Records a wakeup against the current deadline and advances to the next one.
+    /// \param wakeupTime Time at which the periodic work started.
+    /// \return The new deadline.
+    ///
+    Clock::time_point advance(Clock::time_point wakeupTime);
+
+    ///
+    /// \brief Restarts the schedule one period after start and clears the statistics.
+    ///
+    void reset(Clock::time_point start = Clock::now());
+
+    Statistics getStatistics() const;
+
+private:
+    Clock::duration period;
+    Clock::time_point nextDeadline;
+
+    Statistics statistics;
+    std::chrono::nanoseconds totalJitter {0};
+};
+
+inline DeadlineScheduler::Clock::duration DeadlineScheduler::getPeriod() const {return this->period;}
+inline DeadlineScheduler::Clock::time_point DeadlineScheduler::getNextDeadline() const {return this->nextDeadline;}
+inline DeadlineScheduler::Statistics DeadlineScheduler::getStatistics() const {return this->statistics;}
+
+} // namespace ntwk
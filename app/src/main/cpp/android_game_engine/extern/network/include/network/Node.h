@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -9,6 +10,7 @@
 
 #include "Compression.h"
 #include "Image.h"
+#include "PeriodicTimer.h"
 #include "TcpPublisher.h"
 #include "TcpSubscriber.h"
 
@@ -33,6 +35,13 @@ public:
     std::shared_ptr<TcpSubscriber<Image, DecompressionPolicy>> subscribeImage(const std::string &host, unsigned short port,
                                                                               std::function<void(std::unique_ptr<Image>)> imgMsgReceivedHandler);
 
+    ///
+    /// \brief Calls the callback at a fixed rate from the thread calling Node::run() or
+    ///        Node::runOnce(). Timers created on the same node share that thread.
+    ///
+    std::shared_ptr<PeriodicTimer> createTimer(std::chrono::steady_clock::duration period,
+                                               PeriodicTimer::Callback callback);
+
     void run();
     void runOnce();
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+
+#include "DeadlineScheduler.h"
+
+namespace ntwk {
+
+///
+/// \brief Invokes a callback at a fixed rate on an io_context.
+///
+/// Several timers can share the thread running the io_context. Deadlines are tracked with a
+/// DeadlineScheduler so callbacks do not drift when the io_context is busy.
+///
+class PeriodicTimer : public std::enable_shared_from_this<PeriodicTimer> {
+public:
+    using Callback = std::function<void()>;
+
+    static std::shared_ptr<PeriodicTimer> create(asio::io_context &context,
+                                                 std::chrono::steady_clock::duration period,
+                                                 Callback callback);
+
+    ///
+    /// \brief Stops any further callbacks. The pending wait is aborted on the thread running
+    ///        the io_context, so this can be called from any thread.
+    ///
+    void cancel();
+
+    ///
+    /// \brief Returns the deadline statistics. This should be called from the thread running
+    ///        the io_context.
+    ///
+    DeadlineScheduler::Statistics getStatistics() const;
+
+private:
+    PeriodicTimer(asio::io_context &context, std::chrono::steady_clock::duration period,
+                  Callback callback);
+
+    static void wait(std::shared_ptr<PeriodicTimer> timer);
+
+    asio::steady_timer timer;
+    DeadlineScheduler scheduler;
+    Callback callback;
+    std::atomic<bool> cancelled;
+};
+
+inline DeadlineScheduler::Statistics PeriodicTimer::getStatistics() const {return this->scheduler.getStatistics();}
+
+} // namespace ntwk
@@ -2,16 +2,48 @@
 
 #include <chrono>
 
+#include "DeadlineScheduler.h"
+
 namespace ntwk {
 
+///
+/// \brief Keeps a loop running at a fixed rate by sleeping until absolute deadlines.
+///
 class Rate {
 public:
-    explicit Rate(unsigned int fps);
+    enum class SleepMode {
+        SLEEP,           ///< Sleep until the deadline
+        SLEEP_THEN_SPIN  ///< Sleep until shortly before the deadline and spin for the remainder
+    };
+
+    ///
+    /// \param fps Target loop rate (Hz).
+    /// \param sleepMode Strategy used to wait for each deadline.
+    /// \param spinDuration Time spent spinning before each deadline in SleepMode::SLEEP_THEN_SPIN.
+    ///                     This should cover the OS wakeup latency.
+    ///
+    explicit Rate(unsigned int fps, SleepMode sleepMode = SleepMode::SLEEP,
+                  std::chrono::microseconds spinDuration = std::chrono::milliseconds(1));
+
+    ///
+    /// \brief Blocks until the next deadline. Returns immediately if the deadline has already passed.
+    ///
     void sleep();
 
+    ///
+    /// \brief Restarts the deadlines from the current time and clears the statistics.
+    ///
+    void reset();
+
+    DeadlineScheduler::Statistics getStatistics() const;
+
 private:
-    std::chrono::duration<float> period;
-    std::chrono::steady_clock::time_point lastUpdateTime;
+    DeadlineScheduler scheduler;
+
+    SleepMode sleepMode;
+    std::chrono::microseconds spinDuration;
 };
 
+inline DeadlineScheduler::Statistics Rate::getStatistics() const {return this->scheduler.getStatistics();}
+
 } // namespace ntwk
@@ -5,6 +5,8 @@
 #include <asio/read.hpp>
 #include <asio/write.hpp>
 
+#include "Trace.h"
+
 namespace {
 
 constexpr auto SOCKET_RECONNECT_WAIT_DURATION = std::chrono::milliseconds(30);
@@ -141,7 +143,11 @@ template<typename T, typename DecompressionPolicy>
 void TcpSubscriber<T, DecompressionPolicy>::processMsg(std::shared_ptr<TcpSubscriber<T, DecompressionPolicy>> subscriber,
                                                        std::unique_ptr<uint8_t[]> msgBuffer) {
     // Decompress msg if necessary
-    auto msg = DecompressionPolicy::decompressMsg(std::move(msgBuffer));
+    std::unique_ptr<T> msg;
+    {
+        NTWK_TRACE_SCOPE("TcpSubscriber::decode");
+        msg = DecompressionPolicy::decompressMsg(std::move(msgBuffer));
+    }
     if (msg == nullptr) {
         {
             std::lock_guard<std::mutex> guard(subscriber->socketMutex);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+
+namespace ntwk {
+namespace Trace {
+
+using Clock = std::chrono::steady_clock;
+
+///
+/// \brief Receives every traced scope once it ended, on the thread that ran it.
+///
+using Recorder = void (*)(const char *name, Clock::time_point begin, Clock::time_point end);
+
+///
+/// \brief setRecorder Sets the function traced scopes are handed to, e.g. the trace buffer
+///                    of an application. Scopes aren't timed while it's nullptr, the default.
+///
+void setRecorder(Recorder recorder);
+Recorder getRecorder();
+
+///
+/// \brief Times the enclosing scope if a recorder is set when it's entered.
+///
+class Scope {
+public:
+    explicit Scope(const char *name);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope& operator=(const Scope &) = delete;
+
+private:
+    const char *name;
+    Recorder recorder;
+    Clock::time_point begin;
+};
+
+inline Scope::Scope(const char *name) : name(name), recorder(getRecorder()) {
+    if (this->recorder != nullptr) this->begin = Clock::now();
+}
+
+inline Scope::~Scope() {
+    if (this->recorder != nullptr) this->recorder(this->name, this->begin, Clock::now());
+}
+
+} // namespace Trace
+} // namespace ntwk
+
+#define NTWK_TRACE_CONCAT_IMPL(a, b) a##b
+#define NTWK_TRACE_CONCAT(a, b) NTWK_TRACE_CONCAT_IMPL(a, b)
+
+// Compiled out unless the library is built with NETWORK_TRACE
+#ifdef NETWORK_TRACE
+#define NTWK_TRACE_SCOPE(name) ::ntwk::Trace::Scope NTWK_TRACE_CONCAT(ntwkTraceScope, __LINE__)(name)
+#else
+#define NTWK_TRACE_SCOPE(name) ((void)0)
+#endif
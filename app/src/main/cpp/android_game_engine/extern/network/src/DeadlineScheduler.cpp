@@ -0,0 +1,34 @@
+#include <network/DeadlineScheduler.h>
+
+#include <algorithm>
+
+namespace ntwk {
+
+DeadlineScheduler::DeadlineScheduler(Clock::duration period, Clock::time_point start) :
+    period(period), nextDeadline(start + period) { }
+
+DeadlineScheduler::Clock::time_point DeadlineScheduler::advance(Clock::time_point wakeupTime) {
+    const auto lateness = std::max(Clock::duration::zero(), wakeupTime - this->nextDeadline);
+
+    // Whole periods that passed before waking up are skipped instead of run back to back
+    const auto numMissedDeadlines = lateness / this->period;
+    this->nextDeadline += (numMissedDeadlines + 1) * this->period;
+
+    const auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(lateness);
+    this->totalJitter += jitter;
+
+    ++this->statistics.numCycles;
+    this->statistics.numMissedDeadlines += numMissedDeadlines;
+    this->statistics.meanJitter = this->totalJitter / this->statistics.numCycles;
+    this->statistics.maxJitter = std::max(this->statistics.maxJitter, jitter);
+
+    return this->nextDeadline;
+}
+
+void DeadlineScheduler::reset(Clock::time_point start) {
+    this->nextDeadline = start + this->period;
+    this->statistics = Statistics();
+    this->totalJitter = std::chrono::nanoseconds::zero();
+}
+
+} // namespace ntwk
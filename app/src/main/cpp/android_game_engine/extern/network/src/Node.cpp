@@ -1,5 +1,7 @@
 #include <network/Node.h>
 
+#include <network/Trace.h>
+
 namespace ntwk {
 
 Node::Node() : mainContext(), tasksContext(),
@@ -15,12 +17,18 @@ Node::~Node() {
     this->tasksThread.join();
 }
 
+std::shared_ptr<PeriodicTimer> Node::createTimer(std::chrono::steady_clock::duration period,
+                                                PeriodicTimer::Callback callback) {
+    return PeriodicTimer::create(this->mainContext, period, std::move(callback));
+}
+
 void Node::run() {
     auto work = asio::make_work_guard(this->mainContext);
     this->mainContext.run();
 }
 
 void Node::runOnce() {
+    NTWK_TRACE_SCOPE("Node::runOnce");
     this->mainContext.poll_one();
     this->mainContext.restart();
 }
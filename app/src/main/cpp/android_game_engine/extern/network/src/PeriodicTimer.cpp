@@ -0,0 +1,45 @@
+#include <network/PeriodicTimer.h>
+
+#include <asio/post.hpp>
+
+namespace ntwk {
+
+std::shared_ptr<PeriodicTimer> PeriodicTimer::create(asio::io_context &context,
+                                                     std::chrono::steady_clock::duration period,
+                                                     Callback callback) {
+    std::shared_ptr<PeriodicTimer> timer(new PeriodicTimer(context, period, std::move(callback)));
+    wait(timer);
+    return timer;
+}
+
+PeriodicTimer::PeriodicTimer(asio::io_context &context, std::chrono::steady_clock::duration period,
+                             Callback callback) :
+    timer(context), scheduler(period), callback(std::move(callback)), cancelled(false) { }
+
+void PeriodicTimer::cancel() {
+    this->cancelled = true;
+
+    // The steady_timer isn't thread safe, so the wait is aborted on the timer's executor
+    asio::post(this->timer.get_executor(), [timer=this->shared_from_this()](){
+        timer->timer.cancel();
+    });
+}
+
+void PeriodicTimer::wait(std::shared_ptr<PeriodicTimer> timer) {
+    auto pTimer = timer.get();
+    pTimer->timer.expires_at(pTimer->scheduler.getNextDeadline());
+    pTimer->timer.async_wait([timer=std::move(timer)](const auto &error) mutable {
+        if (error || timer->cancelled) {
+            return;
+        }
+
+        timer->scheduler.advance(DeadlineScheduler::Clock::now());
+        timer->callback();
+
+        if (!timer->cancelled) {
+            wait(std::move(timer));
+        }
+    });
+}
+
+} // namespace ntwk
@@ -4,16 +4,33 @@
 
 namespace ntwk {
 
-Rate::Rate(unsigned int fps) : period(1.0f / static_cast<float>(fps)),
-    lastUpdateTime(std::chrono::steady_clock::now()) {  }
+Rate::Rate(unsigned int fps, SleepMode sleepMode, std::chrono::microseconds spinDuration) :
+    scheduler(std::chrono::duration_cast<DeadlineScheduler::Clock::duration>(
+            std::chrono::duration<double>(1.0 / static_cast<double>(fps)))),
+    sleepMode(sleepMode), spinDuration(spinDuration) {  }
 
 void Rate::sleep() {
-    const auto currentTime = std::chrono::steady_clock::now();
-    const auto timeElapsed = currentTime - this->lastUpdateTime;
-    if (timeElapsed < this->period) {
-        std::this_thread::sleep_for(this->period - timeElapsed);
+    using Clock = DeadlineScheduler::Clock;
+    const auto deadline = this->scheduler.getNextDeadline();
+
+    switch (this->sleepMode) {
+        case SleepMode::SLEEP:
+            std::this_thread::sleep_until(deadline);
+            break;
+
+        case SleepMode::SLEEP_THEN_SPIN:
+            std::this_thread::sleep_until(deadline - this->spinDuration);
+            while (Clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            break;
     }
-    this->lastUpdateTime = currentTime;
+
+    this->scheduler.advance(Clock::now());
+}
+
+void Rate::reset() {
+    this->scheduler.reset();
 }
 
 } // namespace ntwk
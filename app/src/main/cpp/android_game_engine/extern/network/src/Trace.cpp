@@ -0,0 +1,23 @@
+#include <network/Trace.h>
+
+#include <atomic>
+
+namespace {
+
+std::atomic<ntwk::Trace::Recorder> activeRecorder {nullptr};
+
+} // namespace
+
+namespace ntwk {
+namespace Trace {
+
+void setRecorder(Recorder recorder) {
+    activeRecorder.store(recorder, std::memory_order_release);
+}
+
+Recorder getRecorder() {
+    return activeRecorder.load(std::memory_order_acquire);
+}
+
+} // namespace Trace
+} // namespace ntwk
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace age {
+
+///
+/// \brief Axis aligned bounding box.
+///
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    bool contains(const AABB &other) const;
+    bool overlaps(const AABB &other) const;
+
+    float getSurfaceArea() const;
+
+    static AABB merge(const AABB &a, const AABB &b);
+};
+
+///
+/// \brief Dynamic bounding volume hierarchy for spatial queries over moving objects.
+///
+/// Leaves store enlarged boxes so that objects moving by less than the margin don't
+/// change the tree. Leaves are inserted next to the sibling minimizing the surface area
+/// of the tree and the tree is kept balanced with rotations as leaves are inserted
+/// and removed.
+///
+class AABBTree {
+public:
+    ///
+    /// \brief Called for every proxy overlapping a query. Return false to stop the query.
+    ///
+    using QueryCallback = std::function<bool(int proxyId)>;
+
+    static constexpr int nullProxy = -1;
+
+    ///
+    /// \brief AABBTree
+    /// \param margin Distance leaf boxes are enlarged by on every side.
+    ///
+    explicit AABBTree(float margin=0.1f);
+
+    ///
+    /// \brief createProxy Inserts a bounding box into the tree.
+    /// \param aabb Bounding box of the object.
+    /// \param userData Data returned by AABBTree::getUserData.
+    /// \return ID of the inserted proxy.
+    ///
+    int createProxy(const AABB &aabb, void *userData);
+
+    void destroyProxy(int proxyId);
+
+    ///
+    /// \brief moveProxy Updates the bounding box of a proxy. The tree is only changed
+    ///                  if the new box is no longer contained in the enlarged leaf box.
+    /// \return Whether the proxy was reinserted.
+    ///
+    bool moveProxy(int proxyId, const AABB &aabb);
+
+    void* getUserData(int proxyId) const;
+    const AABB& getFatAABB(int proxyId) const;
+
+    size_t getNumProxies() const;
+
+    ///
+    /// \brief getBounds Returns the box enclosing the enlarged boxes of all proxies, or an
+    ///                  empty box at the origin if the tree is empty.
+    ///
+    AABB getBounds() const;
+
+    ///
+    /// \brief getHeight Returns the height of the tree with a single leaf having height 0.
+    ///
+    int getHeight() const;
+
+    /// \name Queries
+    ///
+    /// Reports every proxy whose enlarged box intersects the query volume. Proxies may
+    /// be reported even though the tight bounding box of the object doesn't intersect.
+    ///@{
+    void queryFrustum(const glm::mat4 &projectionView, const QueryCallback &callback) const;
+    void querySphere(const glm::vec3 &center, float radius, const QueryCallback &callback) const;
+    void queryBox(const AABB &aabb, const QueryCallback &callback) const;
+    void queryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                  const QueryCallback &callback) const;
+    ///@}
+
+private:
+    struct Node {
+        AABB aabb;
+        void *userData = nullptr;
+
+        // Next free node while the node is in the free list
+        int parent = nullProxy;
+
+        int child1 = nullProxy;
+        int child2 = nullProxy;
+
+        // Leaf = 0, free node = -1
+        int height = -1;
+
+        bool isLeaf() const;
+    };
+
+    int allocateNode();
+    void freeNode(int node);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+
+    ///
+    /// \brief balance Rotates the subtree rooted at a node if it's imbalanced.
+    /// \return The new root of the subtree.
+    ///
+    int balance(int node);
+
+    void refit(int node);
+
+    template<typename Overlaps, typename Contained>
+    void query(const Overlaps &overlaps, const Contained &contained,
+               const QueryCallback &callback) const;
+
+    float margin;
+
+    std::vector<Node> nodes;
+    int root = nullProxy;
+    int freeList = nullProxy;
+    size_t numProxies = 0;
+};
+
+inline bool AABB::contains(const AABB &other) const {
+    return this->min.x <= other.min.x && this->min.y <= other.min.y && this->min.z <= other.min.z &&
+           other.max.x <= this->max.x && other.max.y <= this->max.y && other.max.z <= this->max.z;
+}
+
+inline bool AABB::overlaps(const AABB &other) const {
+    return this->min.x <= other.max.x && other.min.x <= this->max.x &&
+           this->min.y <= other.max.y && other.min.y <= this->max.y &&
+           this->min.z <= other.max.z && other.min.z <= this->max.z;
+}
+
+inline float AABB::getSurfaceArea() const {
+    const auto d = this->max - this->min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+inline bool AABBTree::Node::isLeaf() const {return this->child1 == nullProxy;}
+inline void* AABBTree::getUserData(int proxyId) const {return this->nodes[proxyId].userData;}
+inline const AABB& AABBTree::getFatAABB(int proxyId) const {return this->nodes[proxyId].aabb;}
+inline size_t AABBTree::getNumProxies() const {return this->numProxies;}
+inline AABB AABBTree::getBounds() const {return this->root == nullProxy ? AABB{glm::vec3(0.0f), glm::vec3(0.0f)} : this->nodes[this->root].aabb;}
+inline int AABBTree::getHeight() const {return this->root == nullProxy ? 0 : this->nodes[this->root].height;}
+
+} // namespace age
@@ -2,10 +2,12 @@
 
 #include "GameObject.h"
 
+#include <memory>
 #include <vector>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include "OcclusionCuller.h"
 #include "Texture2D.h"
 
 namespace age {
@@ -18,11 +20,17 @@ public:
     ARPlane(ARPlane &&) = default;
     ARPlane& operator=(ARPlane &&) = default;
 
-    void render(ShaderProgram *shader) override;
+    void render(ShaderProgram *shader, const MaterialUniforms *uniforms) override;
+    bool isInstanceable() const override;
 
     void setDimensions(const glm::vec2 &dimensions);
     void setCollisionDiameter(float diameter);
 
+    ///
+    /// \brief getOccluderMesh Returns the triangles of the plane, to register it as an occluder.
+    ///
+    std::shared_ptr<const OccluderMesh> getOccluderMesh() const;
+
 private:
     std::vector<glm::vec2> generateTextureCoordinates(float scale);
 
@@ -36,7 +44,12 @@ private:
 
     unsigned int textureCoordinatesOffset;
 
+    std::shared_ptr<const OccluderMesh> occluderMesh;
+
     bool visible = true;
 };
 
+inline bool ARPlane::isInstanceable() const {return false;}
+inline std::shared_ptr<const OccluderMesh> ARPlane::getOccluderMesh() const {return this->occluderMesh;}
+
 } // namespace age
\ No newline at end of file
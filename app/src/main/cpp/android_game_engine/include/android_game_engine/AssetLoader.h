@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * Singleton service that loads assets in the background. File I/O and decoding run on
+ * worker threads while the resulting OpenGL uploads are queued for the GL thread, which
+ * drains them under a per-frame time and byte budget so that loading doesn't hitch the
+ * frame loop.
+ *
+ * Initialize AssetLoader after ManagerAssets.
+ * Shutdown AssetLoader before ManagerAssets.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace age {
+
+///
+/// \brief How assets are loaded by the classes that support loading in the background.
+///
+enum class LoadMode {
+    SYNCHRONOUS, ///< Load, decode and upload before returning
+    ASYNCHRONOUS ///< Use a placeholder until the asset was decoded by a worker and uploaded
+};
+
+namespace AssetLoader {
+
+struct Statistics {
+    unsigned int numPendingLoads = 0;   ///< Loads queued or running on worker threads
+    unsigned int numPendingUploads = 0; ///< Uploads queued for the GL thread
+    unsigned int numLoads = 0;          ///< Loads completed since initialization
+    unsigned int numUploads = 0;        ///< Uploads completed since initialization
+
+    std::chrono::duration<float> maxLoadDuration {0.0f}; ///< Longest load on a worker thread
+
+    std::chrono::duration<float> frameUploadDuration {0.0f}; ///< GL thread time spent uploading in the last frame
+    size_t frameUploadBytes = 0;                             ///< Bytes uploaded in the last frame
+
+    ///
+    /// Longest GL thread time spent uploading in a single frame, the worst hitch
+    /// caused by asset loading.
+    ///
+    std::chrono::duration<float> maxFrameUploadDuration {0.0f};
+};
+
+///
+/// \brief init Starts the worker threads.
+/// \param numThreads Number of worker threads. Loads run on the calling thread when 0.
+///
+void init(unsigned int numThreads=2);
+
+///
+/// \brief shutdown Waits for the running loads to finish, stops the worker threads and
+///                 discards the loads and uploads that are still queued.
+///
+void shutdown();
+
+///
+/// \brief enqueueLoad Queues a load to run on a worker thread.
+///
+/// Loads typically read and decode an asset and then call AssetLoader::enqueueUpload
+/// with the decoded data. Exceptions thrown by a load are logged.
+///
+/// \param load Load to run. Must not call OpenGL.
+///
+void enqueueLoad(std::function<void()> load);
+
+///
+/// \brief loadAsync Runs a function on a worker thread.
+/// \param load Function to run. Must not call OpenGL.
+/// \return Future holding the result of load or the exception it threw.
+///
+template<typename T>
+std::shared_future<T> loadAsync(std::function<T()> load);
+
+///
+/// \brief enqueueUpload Queues an upload to run on the GL thread. Can be called from any thread.
+/// \param upload Upload to run.
+/// \param numBytes Number of bytes the upload transfers to the GPU, counted against the
+///                 byte budget of AssetLoader::processUploads.
+///
+void enqueueUpload(std::function<void()> upload, size_t numBytes);
+
+///
+/// \brief processUploads Runs queued uploads in the order they were queued until one of
+///                       the budgets is used up. At least one upload is run per call so
+///                       that uploads larger than the budgets still complete.
+///
+/// This must be called on the GL thread once per frame.
+///
+/// \param timeBudget Time that can be spent uploading.
+/// \param byteBudget Number of bytes that can be uploaded.
+///
+void processUploads(std::chrono::duration<float> timeBudget, size_t byteBudget);
+
+///
+/// \brief getStatistics Returns the loading and upload statistics.
+///
+Statistics getStatistics();
+
+template<typename T>
+std::shared_future<T> loadAsync(std::function<T()> load) {
+    auto task = std::make_shared<std::packaged_task<T()>>(std::move(load));
+    std::shared_future<T> result = task->get_future().share();
+    enqueueLoad([task](){ (*task)(); });
+    return result;
+}
+
+} // namespace AssetLoader
+} // namespace age
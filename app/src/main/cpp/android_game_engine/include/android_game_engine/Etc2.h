@@ -0,0 +1,80 @@
+#pragma once
+
+/**
+ * ETC2 texture compression. Encodes 8-bit RGB and RGBA images into the
+ * GL_COMPRESSED_RGB8_ETC2 and GL_COMPRESSED_RGBA8_ETC2_EAC formats that every
+ * OpenGL ES 3.0 device supports. Only depends on the standard library so that
+ * textures can be transcoded offline on the host.
+ *
+ * Images are arrays of 4 bytes per pixel RGBA, row by row. Blocks are 4x4 pixels
+ * with pixels outside of the image replicated from the nearest edge.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace age {
+namespace Etc2 {
+
+constexpr uint32_t rgb8InternalFormat = 0x9274; ///< GL_COMPRESSED_RGB8_ETC2
+constexpr uint32_t rgba8InternalFormat = 0x9278; ///< GL_COMPRESSED_RGBA8_ETC2_EAC
+
+constexpr size_t rgbBlockSize = 8;
+constexpr size_t rgbaBlockSize = 16;
+
+///
+/// \brief encodeRgbBlock Encodes the RGB channels of a 4x4 block of pixels with the
+///                       individual, differential or planar mode giving the lowest error.
+/// \param pixels 16 RGBA pixels, row by row.
+/// \param block 8 byte output block.
+///
+void encodeRgbBlock(const uint8_t *pixels, uint8_t *block);
+
+///
+/// \brief decodeRgbBlock Decodes a block written by encodeRgbBlock. Alpha is set to 255.
+///
+/// The T and H modes, which encodeRgbBlock never selects, are not supported.
+///
+/// \param block 8 byte input block.
+/// \param pixels 16 RGBA output pixels, row by row.
+///
+void decodeRgbBlock(const uint8_t *block, uint8_t *pixels);
+
+///
+/// \brief encodeAlphaBlock Encodes the alpha channel of a 4x4 block of pixels as an EAC block.
+/// \param pixels 16 RGBA pixels, row by row.
+/// \param block 8 byte output block.
+///
+void encodeAlphaBlock(const uint8_t *pixels, uint8_t *block);
+
+///
+/// \brief decodeAlphaBlock Decodes an EAC block into the alpha channel of 4x4 pixels.
+/// \param block 8 byte input block.
+/// \param pixels 16 RGBA pixels, row by row, whose alpha is overwritten.
+///
+void decodeAlphaBlock(const uint8_t *block, uint8_t *pixels);
+
+///
+/// \brief compress Compresses an image.
+/// \param pixels RGBA pixels, row by row.
+/// \param width Width of the image.
+/// \param height Height of the image.
+/// \param alpha Encode GL_COMPRESSED_RGBA8_ETC2_EAC instead of GL_COMPRESSED_RGB8_ETC2.
+/// \return Compressed blocks, row by row.
+///
+std::vector<uint8_t> compress(const uint8_t *pixels, int width, int height, bool alpha);
+
+///
+/// \brief decompress Decompresses an image compressed by Etc2::compress.
+/// \return RGBA pixels, row by row.
+///
+std::vector<uint8_t> decompress(const uint8_t *data, int width, int height, bool alpha);
+
+///
+/// \brief getCompressedSize Returns the number of bytes of a compressed image.
+///
+size_t getCompressedSize(int width, int height, bool alpha);
+
+} // namespace Etc2
+} // namespace age
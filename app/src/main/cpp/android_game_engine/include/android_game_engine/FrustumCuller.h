@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/fwd.hpp>
+#include <glm/vec4.hpp>
+
+namespace age {
+
+///
+/// \brief Tests axis aligned bounding boxes against a view frustum.
+///
+/// Boxes are stored as structure of arrays so that the planes of the frustum are
+/// tested against 4 boxes at a time with NEON or SSE, falling back to scalar code
+/// on other targets.
+///
+class FrustumCuller {
+public:
+    using Planes = std::array<glm::vec4, 6>;
+
+    struct Statistics {
+        unsigned int numVisible = 0;
+        unsigned int numCulled = 0;
+    };
+
+    ///
+    /// \brief clear Removes all bounding boxes.
+    ///
+    void clear();
+
+    ///
+    /// \brief extractPlanes Extracts the left, right, bottom, top, near and far planes
+    ///                      of the frustum of a projection view matrix.
+    ///
+    /// Plane normals point into the frustum and are not normalized so only the sign of
+    /// a distance to a plane is meaningful.
+    ///
+    static Planes extractPlanes(const glm::mat4 &projectionView);
+
+    ///
+    /// \brief add Adds an axis aligned bounding box.
+    /// \param center Center of the box in world coordinates.
+    /// \param extents Half of the box's dimensions along each world axis.
+    ///
+    void add(const glm::vec3 &center, const glm::vec3 &extents);
+
+    size_t size() const;
+
+    ///
+    /// \brief cull Tests all bounding boxes against the frustum of a projection view matrix.
+    ///
+    /// Boxes that intersect a corner of the frustum outside all of its planes may be
+    /// conservatively reported as visible.
+    ///
+    /// \param projectionView Projection view matrix defining the frustum.
+    /// \param[out] visibility Set to 1 for boxes inside or intersecting the frustum and 0
+    ///                        for boxes outside of it, in the order they were added.
+    /// \return The number of visible and culled boxes.
+    ///
+    Statistics cull(const glm::mat4 &projectionView, std::vector<uint8_t> &visibility) const;
+
+private:
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+};
+
+inline size_t FrustumCuller::size() const {return this->centerX.size();}
+
+} // namespace age
@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * Singleton cache of the OpenGL ES state of the current context. Every state change
+ * made through GLState is compared against the shadowed state and only issued to
+ * OpenGL when it changes something. All engine code must change cached state through
+ * GLState so that the shadowed state never goes stale. Call GLState::reset() whenever
+ * the context is (re)created or code outside the engine may have changed its state.
+ */
+
+#include <cstddef>
+
+#include <GLES3/gl32.h>
+
+namespace age {
+namespace GLState {
+
+struct Statistics {
+    unsigned int numCallsIssued = 0;
+    unsigned int numCallsSkipped = 0;
+};
+
+///
+/// \brief reset Forgets all shadowed state so that the next call to every state
+///              change is issued to OpenGL.
+///
+void reset();
+
+///
+/// \brief resetStatistics Resets the issued and skipped call counters.
+///                        This is called at the start of every frame.
+///
+void resetStatistics();
+
+///
+/// \brief getStatistics Returns the number of state changes issued to OpenGL and the
+///                      number of redundant state changes skipped since the last call
+///                      to GLState::resetStatistics().
+///
+Statistics getStatistics();
+
+void useProgram(GLuint program);
+void bindVertexArray(GLuint vao);
+
+///
+/// \brief bindBuffer Binds a buffer to a target. GL_ELEMENT_ARRAY_BUFFER bindings belong
+///                   to the bound vertex array and are always issued.
+///
+void bindBuffer(GLenum target, GLuint buffer);
+
+///
+/// \brief bindBufferBase Binds a buffer to an indexed binding point and, when issued, to
+///                       the generic binding point of target.
+///
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+///
+/// \brief bindBufferRange Binds a range of a buffer to an indexed binding point and, when
+///                        issued, to the generic binding point of target.
+///
+void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+///
+/// \brief activeTexture Selects the active texture unit.
+/// \param textureUnit Texture unit enum, e.g. GL_TEXTURE0 + i.
+///
+void activeTexture(GLenum textureUnit);
+void bindTexture(GLenum target, GLuint texture);
+
+void enable(GLenum capability);
+void disable(GLenum capability);
+void depthFunc(GLenum func);
+void depthMask(GLboolean flag);
+void cullFace(GLenum mode);
+void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+/// \name Deletion
+/// Deletes OpenGL objects and forgets any shadowed bindings to them since OpenGL
+/// may reuse their names for new objects.
+///@{
+void deleteProgram(GLuint program);
+void deleteVertexArrays(GLsizei n, const GLuint *vaos);
+void deleteBuffers(GLsizei n, const GLuint *buffers);
+void deleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+void deleteTextures(GLsizei n, const GLuint *textures);
+///@}
+
+///
+/// \brief updateUniform Records a uniform value of the current program.
+/// \param program Program currently in use.
+/// \param location Location of the uniform.
+/// \param value Pointer to the uniform value.
+/// \param size_bytes Size of the uniform value. Must be no larger than a glm::mat4.
+/// \return True if the value differs from the recorded value and must be set through
+///         glUniform*, false if setting it would be redundant.
+///
+bool updateUniform(GLuint program, GLint location, const void *value, size_t size_bytes);
+
+} // namespace GLState
+} // namespace age
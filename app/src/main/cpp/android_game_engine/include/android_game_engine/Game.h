@@ -2,16 +2,34 @@
 
 #include "GameTemplate.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "AABBTree.h"
 #include "CameraChase.h"
 #include "CameraFPV.h"
+#include "FrustumCuller.h"
+#include "GpuProfiler.h"
+#include "LodSelector.h"
+#include "Mesh.h"
+#include "OcclusionCuller.h"
 #include "PhysicsEngine.h"
+#include "RenderQueue.h"
+#include "RenderSnapshot.h"
 #include "ShaderProgram.h"
+#include "ShadowCascades.h"
 #include "ShadowMap.h"
 #include "Skybox.h"
+#include "TripleBuffer.h"
 #include "UniformBuffer.h"
 
 namespace age {
@@ -24,30 +42,227 @@ struct Ray {
     glm::vec3 direction;
 };
 
+class Box;
 class GameObject;
 class LightDirectional;
 
 /**
  * Users should subclass Game and then run it using GameEngine::run with the derived
  * Game class.
+ *
+ * Every update is captured into a render snapshot that frames are rendered from, so that
+ * the game can optionally be updated on a simulation thread while the GL thread renders
+ * the previous update. See Game::enableSimulationThread.
  */
 class Game : public GameTemplate {
 public:
+    ///
+    /// \brief Cost of rendering the shadow map in the last frame, summed over its cascades.
+    ///
+    struct ShadowStatistics {
+        std::chrono::duration<float> duration {0.0f}; ///< CPU time spent submitting the shadow passes
+        unsigned int numStaticLayersRefreshed = 0;
+        unsigned int numUncachedCascades = 0; ///< Cascades drawn without their static layer while their light moves
+        float staticLayerRefreshRate = 0.0f;  ///< Fraction of the static layers redrawn per frame, averaged over about 32 frames
+        unsigned int numStaticCasters = 0;  ///< Casters cached in the static layers
+        unsigned int numDynamicCasters = 0; ///< Casters drawn over the static layers
+        RenderQueue::Statistics staticPass; ///< Only counts static layers that were refreshed
+        RenderQueue::Statistics dynamicPass;
+    };
+
+    ///
+    /// \brief CPU timeline of a rendered frame and of the update it was rendered from.
+    ///
+    struct FrameTimeline {
+        unsigned int updateNumber = 0;
+        std::chrono::steady_clock::time_point updateBegin;
+        std::chrono::steady_clock::time_point updateEnd;
+        std::chrono::steady_clock::time_point renderBegin;
+        std::chrono::steady_clock::time_point renderEnd;
+        std::chrono::duration<float> overlap {0.0f}; ///< Time an update ran on the simulation thread during the render
+        unsigned int numUpdatesDropped = 0;          ///< Updates since the previous frame that were never rendered
+        unsigned int numSteps = 1;                   ///< Fixed timestep steps run by the update
+        float interpolation = 1.0f;                  ///< Fraction of a step the rendered transforms were interpolated by
+        std::chrono::duration<float> droppedDuration {0.0f}; ///< Time the update dropped beyond its catch-up budget
+    };
+
+    static constexpr size_t maxFrameTimelines = 120;
+
     Game(JNIEnv *env, jobject javaApplicationContext, jobject javaActivityObject);
+    ~Game() override;
 
     void onCreate() override;
+    void onDestroy() override;
 
     void onWindowChanged(int width, int height, int displayRotation) override;
 
+    ///
+    /// \brief update Updates the game and captures it into a render snapshot, or hands the
+    ///               update to the simulation thread when it's enabled.
+    ///
+    void update(std::chrono::duration<float> updateDuration) override;
     void onUpdate(std::chrono::duration<float> updateDuration) override;
     void render() override;
 
+    void postEvent(std::function<void()> event) override;
+
     bool onTouchDownEvent(float x, float y) override;
     bool onTouchMoveEvent(float x, float y) override;
     bool onTouchUpEvent(float x, float y) override;
     
     void enablePhysicsDebugDrawer(bool enable);
 
+    ///
+    /// \brief setFixedTimestep Updates the game in steps of a fixed duration instead of once
+    ///                         per frame with the frame's duration, so that physics and
+    ///                         controllers always advance by the same time.
+    ///
+    /// The time of every frame is accumulated and as many steps run as fit into it. The
+    /// world list objects and the camera are rendered interpolated between their transforms
+    /// before and after the last step by the fraction of a step left over, which delays
+    /// them by up to one step.
+    ///
+    /// GameAR updates ARCore in Game::onUpdate so it must keep updating once per frame.
+    ///
+    /// \param timestep Duration of a step, or zero to update once per frame.
+    /// \param maxStepsPerUpdate Largest number of steps an update catches up on. Time beyond
+    ///                          it is dropped so that updates that fall behind don't take
+    ///                          ever longer to catch up.
+    ///
+    void setFixedTimestep(std::chrono::duration<float> timestep, unsigned int maxStepsPerUpdate=5);
+    bool isFixedTimestepEnabled() const;
+
+    ///
+    /// \brief enableSimulationThread Runs Game::onUpdate, including the physics step, and
+    ///                               the events posted through Game::postEvent on a
+    ///                               simulation thread instead of the GL thread.
+    ///
+    /// Every frame the GL thread hands the time that passed to the simulation thread and
+    /// renders the latest render snapshot it published, so that updates overlap with
+    /// rendering. Updates that are slower than frames span several frames.
+    ///
+    /// While enabled, updates and events must not call OpenGL: game objects are created on
+    /// the GL thread, e.g. in Game::onCreate or through AssetLoader::enqueueUpload, and
+    /// world list objects must be instanceable. Render settings such as Game::setSkybox
+    /// and Game::setShadowDistance are changed on the GL thread.
+    ///
+    /// \exception age::Error The game can't use a simulation thread, see canUseSimulationThread.
+    ///
+    void enableSimulationThread(bool enable);
+    bool isSimulationThreadEnabled() const;
+
+    ///
+    /// \brief canUseSimulationThread Returns whether the game's updates can run on a
+    ///                               simulation thread. GameAR can't since ARCore updates
+    ///                               need the GL thread.
+    ///
+    virtual bool canUseSimulationThread() const;
+
+    ///
+    /// \brief getFrameTimelines Returns the CPU timelines of the last rendered frames,
+    ///                          oldest first.
+    ///
+    const std::deque<FrameTimeline>& getFrameTimelines() const;
+
+    ///
+    /// \brief enableOcclusionCulling Enables culling world list objects hidden behind
+    ///                               occluders registered through Game::addOccluder. The
+    ///                               rasterizer's worker threads are started when it's first
+    ///                               enabled.
+    ///
+    void enableOcclusionCulling(bool enable);
+
+    ///
+    /// \brief setLodSelector Sets how levels of detail of world list objects are selected
+    ///                       from their projected size on the screen.
+    ///
+    void setLodSelector(const LodSelector &lodSelector);
+
+    ///
+    /// \brief setShadowLodBias Sets how many levels of detail coarser than in the world pass
+    ///                         world list objects are drawn in the shadow pass.
+    ///
+    void setShadowLodBias(unsigned int shadowLodBias);
+
+    ///
+    /// \brief setShadowDistance Sets the distance from the camera up to which the shadow
+    ///                          cascades are spread when it's closer than the camera's far plane.
+    ///
+    void setShadowDistance(float shadowDistance);
+    const ShadowCascades& getShadowCascades() const;
+
+    ///
+    /// \brief setStaticShadowDelay Sets for how many frames a world list object must stay
+    ///                             still before its shadow is cached in the static layer
+    ///                             of the shadow map instead of being drawn every frame.
+    ///
+    /// Objects with an active physics body are never cached.
+    ///
+    void setStaticShadowDelay(unsigned int numFrames);
+
+    ///
+    /// \brief invalidateStaticShadows Redraws the static layers of the shadow map in the next
+    ///                                rendered update, e.g. after the mesh of a cached object changed.
+    ///
+    /// Moving a cached object already invalidates the static layers and moving the light
+    /// or the camera invalidates the static layers of the cascades that moved. Cascades that
+    /// moved in each of the last few frames draw all of their casters every frame instead,
+    /// until they stay put for a frame.
+    ///
+    void invalidateStaticShadows();
+
+    ///
+    /// \brief setAssetUploadBudget Sets how much of every frame can be spent uploading assets
+    ///                             loaded in the background through AssetLoader.
+    /// \param timeBudget Time that can be spent uploading per frame.
+    /// \param byteBudget Number of bytes that can be uploaded per frame.
+    ///
+    void setAssetUploadBudget(std::chrono::duration<float> timeBudget, size_t byteBudget);
+
+    ///
+    /// \brief getRenderStatistics Returns the number of instances, draw calls, shader and material
+    ///                            changes submitted by the render queue in the last frame.
+    ///
+    RenderQueue::Statistics getRenderStatistics() const;
+
+    ///
+    /// \brief getShadowRenderStatistics Returns the draws of the dynamic casters submitted to
+    ///                                  all cascades of the shadow map in the last frame.
+    ///
+    RenderQueue::Statistics getShadowRenderStatistics() const;
+
+    ///
+    /// \brief getShadowStatistics Returns the cost of rendering the shadow map in the last frame.
+    ///
+    ShadowStatistics getShadowStatistics() const;
+
+    ///
+    /// \brief getCullingStatistics Returns the number of world list objects that were
+    ///                             visible and culled by the camera frustum in the last frame.
+    ///
+    FrustumCuller::Statistics getCullingStatistics() const;
+
+    ///
+    /// \brief getShadowCullingStatistics Returns the number of world list objects that were
+    ///                                   visible and culled by the light frustums of the
+    ///                                   shadow cascades, summed over the cascades.
+    ///
+    FrustumCuller::Statistics getShadowCullingStatistics() const;
+
+    ///
+    /// \brief getOcclusionCullingStatistics Returns the number of world list objects inside
+    ///                                      the camera frustum that were visible and hidden
+    ///                                      behind occluders in the last frame.
+    ///
+    FrustumCuller::Statistics getOcclusionCullingStatistics() const;
+
+    ///
+    /// \brief getGpuProfiler Returns the profiler timing the render passes of every frame,
+    ///                       whose statistics are read back a few frames late.
+    ///
+    GpuProfiler& getGpuProfiler();
+    const GpuProfiler& getGpuProfiler() const;
+
 protected:
     void setGravity(const glm::vec3 &gravity);
 
@@ -56,6 +271,29 @@ protected:
     void addToWorldList(std::shared_ptr<GameObject> gameObject);
     void clearWorldList();
 
+    ///
+    /// \brief getWorldListIndex Returns the spatial index of the world list for gameplay queries,
+    ///                          e.g. the objects near a point or along a ray. The user data of
+    ///                          its proxies are the GameObject pointers.
+    ///
+    /// The index is updated with the world list on the update thread. Rendering doesn't query
+    /// it: the frustum and occlusion culling of the render snapshot test every object.
+    ///
+    const AABBTree& getWorldListIndex() const;
+
+    ///
+    /// \brief addOccluder Registers an opaque box that hides the objects behind it.
+    ///
+    void addOccluder(std::shared_ptr<Box> occluder);
+
+    ///
+    /// \brief addOccluder Registers a game object that hides the objects behind it.
+    /// \param occluder Opaque game object.
+    /// \param mesh Triangles rasterized in place of the game object, see OccluderMesh.
+    ///
+    void addOccluder(std::shared_ptr<GameObject> occluder, std::shared_ptr<const OccluderMesh> mesh);
+    void clearOccluders();
+
     void bindToProjectionViewUBO(ShaderProgram *shaderProgram);
     void bindToLightSpaceUBO(ShaderProgram *shaderProgram);
 
@@ -73,18 +311,107 @@ protected:
     virtual void onGameObjectTouched(GameObject *gameObject, const glm::vec3 &touchPoint,
                                      const glm::vec3 &touchDirection, const glm::vec3 &touchNormal);
 
+    ///
+    /// \brief processAssetUploads Uploads assets loaded in the background within the
+    ///                            asset upload budget. Call this at the start of every frame.
+    ///
+    void processAssetUploads();
+
+    ///
+    /// \brief acquireSnapshot Makes the latest captured update the render snapshot of the frame.
+    /// \return false until the first update was captured.
+    ///
+    bool acquireSnapshot();
+    const RenderSnapshot& getSnapshot() const;
+
     virtual void updateUBOs();
+
+    ///
+    /// \brief prepareRenderQueue Rebuilds and sorts the render queue. This must be called
+    ///                           once per frame before rendering the shadow map and the world.
+    ///
+    void prepareRenderQueue();
+
+    ///
+    /// \brief buildRenderQueue Adds the draw items of the frame to the render queue.
+    ///                         By default world list objects are added to the shadow
+    ///                         pass layer of every shadow cascade whose light frustum
+    ///                         they are inside, and to the world pass when they are
+    ///                         inside the camera's frustum.
+    ///
+    virtual void buildRenderQueue();
+
+    ///
+    /// \brief addToRenderQueue Adds a game object to a pass of the render queue with its
+    ///                         depth taken from the light in the shadow pass and from
+    ///                         the camera otherwise.
+    ///
+    void addToRenderQueue(RenderQueue::Pass pass, GameObject *gameObject, ShaderProgram *shader,
+                          const MaterialUniforms *uniforms, bool translucent=false,
+                          unsigned int lod=0, unsigned int layer=0);
+    ///
+    /// \brief addToRenderQueue Adds the object at an index of the render snapshot's world list
+    ///                         to a pass of the render queue. Objects that aren't instanceable
+    ///                         are skipped if the world list was cleared since the snapshot.
+    ///
+    void addToRenderQueue(RenderQueue::Pass pass, size_t worldListIndex, ShaderProgram *shader,
+                          const MaterialUniforms *uniforms, bool translucent=false,
+                          unsigned int lod=0, unsigned int layer=0);
+
+    ///
+    /// \brief useShader Makes a shader program current and sets its per-pass uniforms.
+    ///                  Called by the render queue whenever the shader changes.
+    ///
+    virtual void useShader(ShaderProgram *shaderProgram);
+
     void renderShadowMapSetup();
     void renderShadowMap();
     void renderWorldSetup();
     void renderWorld();
 
-    void bindShadowMap(ShaderProgram *shaderProgram);
+    ///
+    /// \brief renderWorldLayer Submits a layer of the world pass other than the one drawn by
+    ///                         Game::renderWorld, e.g. items a subclass times separately.
+    ///
+    void renderWorldLayer(unsigned int layer);
+
+    ///
+    /// \brief bindShadowMap Binds the shadow map to its texture unit and points the sampler of the
+    ///                      shader program, which must be in use, to it.
+    /// \param shadowMapUniform Handle of the shader program's shadowMap sampler.
+    ///
+    void bindShadowMap(ShaderProgram *shaderProgram, UniformHandle<int> shadowMapUniform);
 
     CameraType* getCam();
     LightDirectional* getDirectionalLight();
 
 private:
+    ///
+    /// \brief Transform of a world list object or the camera before the last fixed step.
+    ///
+    struct StepTransform {
+        const GameObject *gameObject; ///< nullptr for the camera
+        glm::vec3 position;
+        glm::mat3 orientation;
+    };
+
+    void advance(std::chrono::duration<float> updateDuration, RenderSnapshot &snapshot);
+    void saveStepTransforms();
+    void interpolateSnapshot(RenderSnapshot &snapshot, float interpolation) const;
+    void captureSnapshot(RenderSnapshot &snapshot);
+    void runSimulation();
+    void stopSimulationThread();
+    void recordFrameTimeline(std::chrono::steady_clock::time_point renderBegin);
+
+    void updateWorldListIndex();
+    void resizeWorldListState();
+    float getRenderDepth(RenderQueue::Pass pass, const glm::vec3 &position) const;
+    void cullWorldList();
+    void occlusionCullWorldList();
+    void selectWorldListLods();
+    void updateShadowCasters();
+    bool isStaticShadowCached(unsigned int cascade) const;
+
     void raycastTouch(const glm::vec2 &windowTouchPosition, float length);
     Ray getTouchRay(const glm::vec2 &windowTouchPosition);
 
@@ -93,16 +420,98 @@ private:
     ShaderProgram skyboxShader;
     ShaderProgram physicsDebugShader;
 
+    MaterialUniforms defaultMaterialUniforms;
+    UniformHandle<glm::vec3> viewPositionUniform;
+    UniformHandle<int> shadowMapUniform;
+    UniformHandle<glm::mat4> skyboxProjectionViewUniform;
+    UniformHandle<int> shadowCascadeUniform;
+
     UniformBuffer projectionViewUbo;
     UniformBuffer lightSpaceUbo;
+    UniformBufferRing drawUbo;
 
     int shadowMapTextureUnit; // Shadow map is placed as the last texture unit to deconflict with game object material textures
     
     std::unique_ptr<Skybox> skybox;
     std::unique_ptr<CameraType> cam;
     std::unique_ptr<LightDirectional> directionalLight;
+    std::unique_ptr<LightDirectional> renderLight; ///< Directional light of the render snapshot
     std::unique_ptr<ShadowMap> shadowMap;
+    ShadowCascades shadowCascades;
+    unsigned int currentShadowCascade;
     std::vector<std::shared_ptr<GameObject>> worldList;
+    AABBTree worldListIndex;
+
+    // Proxy of a world list object with the transform and load state it was last moved with
+    struct WorldListProxy {
+        int id;
+        glm::mat4 transform;
+        bool loaded;
+    };
+    std::vector<WorldListProxy> worldListProxies;
+    unsigned int worldListVersion;
+    RenderQueue renderQueue;
+    GpuProfiler gpuProfiler;
+
+    // Updates are captured into the write buffer and frames render the read buffer
+    TripleBuffer<RenderSnapshot> snapshots;
+    unsigned int updateNumber;
+    unsigned int renderedWorldListVersion;
+    unsigned int renderedStaticShadowVersion;
+
+    std::thread simulationThread;
+    std::mutex simulationMutex;
+    std::condition_variable simulationCondition;
+    bool simulationStopping;
+    bool simulationUpdatePending;
+    std::chrono::duration<float> pendingUpdateDuration;
+    std::vector<std::function<void()>> pendingEvents;
+    std::exception_ptr simulationError;
+    std::atomic<int64_t> simulationBeginTime; ///< Nanoseconds of the steady clock
+    std::atomic<int64_t> simulationEndTime;
+
+    std::deque<FrameTimeline> frameTimelines;
+
+    std::chrono::duration<float> fixedTimestep;
+    unsigned int maxFixedSteps;
+    std::chrono::duration<double> fixedTimeAccumulator;
+    std::vector<StepTransform> worldListStepTransforms;
+    StepTransform camStepTransform;
+    bool stepTransformsSaved;
+
+    FrustumCuller worldListCuller;
+    std::vector<uint8_t> cameraVisibility;
+    std::array<std::vector<uint8_t>, ShadowCascades::maxCascades> cascadeVisibility;
+    std::vector<uint8_t> lightVisibility; ///< Inside the light frustum of any cascade
+    FrustumCuller::Statistics cameraCullingStatistics;
+    FrustumCuller::Statistics lightCullingStatistics;
+
+    OcclusionCuller occlusionCuller;
+
+    struct Occluder {
+        std::shared_ptr<GameObject> gameObject;
+        std::shared_ptr<const OccluderMesh> mesh;
+    };
+    std::vector<Occluder> occluders;
+    FrustumCuller::Statistics occlusionCullingStatistics;
+    bool occlusionCulling;
+
+    LodSelector lodSelector;
+    std::vector<uint8_t> worldListLods;
+    unsigned int shadowLodBias;
+
+    std::vector<uint8_t> staticShadowCasters;
+    std::vector<glm::mat4> shadowCasterTransforms;
+    std::vector<unsigned int> shadowCasterStillFrames;
+    std::array<glm::mat4, ShadowCascades::maxCascades> staticShadowLightSpaces;
+    std::array<bool, ShadowCascades::maxCascades> staticShadowsInvalid;
+    std::array<unsigned int, ShadowCascades::maxCascades> shadowCascadeMovingFrames; ///< Consecutive frames the light space changed
+    unsigned int staticShadowDelay;
+    unsigned int staticShadowVersion;
+    ShadowStatistics shadowStatistics;
+
+    std::chrono::duration<float> assetUploadTimeBudget;
+    size_t assetUploadByteBudget;
     
     std::unique_ptr<PhysicsEngine> physics;
     bool drawDebugPhysics;
@@ -110,5 +519,20 @@ private:
 
 inline CameraType* Game::getCam() {return this->cam.get();}
 inline LightDirectional* Game::getDirectionalLight() {return this->directionalLight.get();}
+inline const AABBTree& Game::getWorldListIndex() const {return this->worldListIndex;}
+inline bool Game::isFixedTimestepEnabled() const {return this->fixedTimestep.count() > 0.0f;}
+inline bool Game::isSimulationThreadEnabled() const {return this->simulationThread.joinable();}
+inline bool Game::canUseSimulationThread() const {return true;}
+inline const std::deque<Game::FrameTimeline>& Game::getFrameTimelines() const {return this->frameTimelines;}
+inline const RenderSnapshot& Game::getSnapshot() const {return this->snapshots.getReadBuffer();}
+inline RenderQueue::Statistics Game::getRenderStatistics() const {return this->renderQueue.getStatistics(RenderQueue::Pass::WORLD);}
+inline RenderQueue::Statistics Game::getShadowRenderStatistics() const {return this->shadowStatistics.dynamicPass;}
+inline const ShadowCascades& Game::getShadowCascades() const {return this->shadowCascades;}
+inline Game::ShadowStatistics Game::getShadowStatistics() const {return this->shadowStatistics;}
+inline FrustumCuller::Statistics Game::getCullingStatistics() const {return this->cameraCullingStatistics;}
+inline FrustumCuller::Statistics Game::getShadowCullingStatistics() const {return this->lightCullingStatistics;}
+inline FrustumCuller::Statistics Game::getOcclusionCullingStatistics() const {return this->occlusionCullingStatistics;}
+inline GpuProfiler& Game::getGpuProfiler() {return this->gpuProfiler;}
+inline const GpuProfiler& Game::getGpuProfiler() const {return this->gpuProfiler;}
 
 } // namespace age
\ No newline at end of file
@@ -29,6 +29,8 @@ public:
     void onUpdate(std::chrono::duration<float> updateDuration) override;
     void render() override;
 
+    bool canUseSimulationThread() const override;
+
     bool onTouchDownEvent(float x, float y) override;
     bool onTouchMoveEvent(float x, float y) override;
     bool onTouchUpEvent(float x, float y) override;
@@ -46,6 +48,9 @@ protected:
 
     float getFloorAltitude() const;
 
+    void buildRenderQueue() override;
+    void useShader(ShaderProgram *shaderProgram) override;
+
 private:
     void updateCamera();
     void updatePlanes();
@@ -54,6 +59,8 @@ private:
     ShaderProgram arCameraBackgroundShader;
     ShaderProgram arPlaneShader;
     ShaderProgram arPlaneShadowedShader;
+    UniformHandle<int> arPlaneShadowMapUniform;
+    UniformHandle<int> arPlaneShadowedShadowMapUniform;
 
     /// \name State
     /// AR Games will have at least 2 states:
@@ -47,6 +47,7 @@ JNI_METHOD_DECLARATION(void, onResumeJNI)(JNIEnv *env, jobject);
 JNI_METHOD_DECLARATION(void, onPauseJNI)(JNIEnv *env, jobject);
 JNI_METHOD_DECLARATION(void, onStopJNI)(JNIEnv *env, jobject);
 JNI_METHOD_DECLARATION(void, onDestroyJNI)(JNIEnv *env, jobject);
+JNI_METHOD_DECLARATION(void, onTrimMemoryJNI)(JNIEnv *env, jobject, int level);
 JNI_METHOD_DECLARATION(void, onSurfaceChangedJNI)(JNIEnv *env, jobject, int width, int height, int displayRotation);
 JNI_METHOD_DECLARATION(void, updateJNI)(JNIEnv *env, jobject);
 JNI_METHOD_DECLARATION(void, renderJNI)(JNIEnv *env, jobject);
@@ -1,7 +1,11 @@
 #include <android/asset_manager_jni.h>
 
+#include "AssetLoader.h"
+#include "GLState.h"
 #include "GameTemplate.h"
 #include "ManagerAssets.h"
+#include "ManagerResources.h"
+#include "ProgramBinaryCache.h"
 #include "ManagerWindowing.h"
 
 namespace {
@@ -16,6 +20,8 @@ namespace GameEngineJNI {
 void init(JNIEnv *env, int windowWidth, int windowHeight, int displayRotation, jobject j_asset_manager) {
     ManagerWindowing::init(windowWidth, windowHeight, displayRotation);
     ManagerAssets::init(AAssetManager_fromJava(env, j_asset_manager));
+    AssetLoader::init();
+    ManagerResources::init();
 }
 
 void onCreate(std::unique_ptr<GameTemplate> g) {
@@ -48,41 +54,53 @@ JNI_METHOD_DEFINITION(void, onStopJNI)(JNIEnv *env, jobject) {
 JNI_METHOD_DEFINITION(void, onDestroyJNI)(JNIEnv *env, jobject) {
     game->onDestroy();
     game.reset();
+    AssetLoader::shutdown();
+    ProgramBinaryCache::shutdown();
+    ManagerResources::shutdown();
     ManagerAssets::shutdown();
     ManagerWindowing::shutdown();
 }
 
+JNI_METHOD_DEFINITION(void, onTrimMemoryJNI)(JNIEnv *env, jobject, int level) {
+    ManagerResources::onTrimMemory(level);
+}
+
 JNI_METHOD_DEFINITION(void, onSurfaceChangedJNI)(JNIEnv *env, jobject, int width, int height, int displayRotation) {
     ManagerWindowing::setWindowDimensions(width, height);
     ManagerWindowing::setDisplayRotation(displayRotation);
 
-    game->onWindowChanged(width, height, displayRotation);
+    game->postEvent([g = game.get(), width, height, displayRotation](){
+        g->onWindowChanged(width, height, displayRotation);
+    });
 }
 
 JNI_METHOD_DEFINITION(void, updateJNI)(JNIEnv *env, jobject) {
-    static std::chrono::system_clock::time_point lastUpdateTime = std::chrono::system_clock::now();
+    // The steady clock never jumps, unlike the system clock when the wall time is adjusted
+    static std::chrono::steady_clock::time_point lastUpdateTime = std::chrono::steady_clock::now();
 
-    auto currentUpdateTime = std::chrono::system_clock::now();
+    auto currentUpdateTime = std::chrono::steady_clock::now();
     auto updateDuration = currentUpdateTime - lastUpdateTime;
     lastUpdateTime = currentUpdateTime;
 
-    game->onUpdate(updateDuration);
+    game->update(updateDuration);
 }
 
 JNI_METHOD_DEFINITION(void, renderJNI)(JNIEnv *env, jobject) {
+    GLState::resetStatistics();
+    ManagerResources::processTrimMemory();
     game->render();
 }
 
 JNI_METHOD_DEFINITION(void, onTouchDownEventJNI)(JNIEnv *env, jobject, float x, float y) {
-    game->onTouchDownEvent(x, y);
+    game->postEvent([g = game.get(), x, y](){ g->onTouchDownEvent(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onTouchMoveEventJNI)(JNIEnv *env, jobject, float x, float y) {
-    game->onTouchMoveEvent(x, y);
+    game->postEvent([g = game.get(), x, y](){ g->onTouchMoveEvent(x, y); });
 }
 
 JNI_METHOD_DEFINITION(void, onTouchUpEventJNI)(JNIEnv *env, jobject, float x, float y) {
-    game->onTouchUpEvent(x, y);
+    game->postEvent([g = game.get(), x, y](){ g->onTouchUpEvent(x, y); });
 }
 
 } // namespace GameEngineJNI
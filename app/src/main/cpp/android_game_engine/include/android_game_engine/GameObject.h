@@ -6,8 +6,10 @@
 #include <BulletCollision/CollisionShapes/btCollisionShape.h>
 #include <glm/fwd.hpp>
 
+#include "AssetLoader.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "ModelLoader.h"
 #include "PhysicsRigidBody.h"
 
 namespace age {
@@ -26,11 +28,17 @@ public:
     ///
     /// \brief GameObject Loads vertex and texture data and creates a model
     ///                   for the game object.
+    ///
+    /// Game objects loading their model asynchronously are drawn and collide as an
+    /// untextured unit box until the model has been loaded in the background and
+    /// GameObject::finishLoading is called. Failures are logged instead of thrown.
+    ///
     /// \param modelFilepath Filepath to the model data.
+    /// \param mode Whether to load the model before returning or in the background.
     /// \exception ge::LoadError Failed to load mesh data from model file.
     /// \exception ge::LoadError Failed to load texture image from file.
     ///
-    explicit GameObject(const std::string &modelFilepath);
+    explicit GameObject(const std::string &modelFilepath, LoadMode mode=LoadMode::SYNCHRONOUS);
     
     virtual ~GameObject() = default;
 
@@ -52,10 +60,56 @@ public:
     
     virtual void updateFromPhysics();
 
+    ///
+    /// \brief finishLoading Replaces the placeholder of a model loaded in the background
+    ///                      once it is done loading. Game calls this for the world list
+    ///                      on every update.
+    ///
+    void finishLoading();
+
+    ///
+    /// \brief isLoaded Returns false while the game object's model is loading in the background.
+    ///
+    bool isLoaded() const;
+
     void renderShadow(ShaderProgram *shader);
-    virtual void render(ShaderProgram *shader);
+
+    ///
+    /// \brief render Draws the game object with its materials.
+    ///
+    /// \param shader Shader program currently in use.
+    /// \param uniforms Material uniforms of shader, resolved once per shader by the caller,
+    ///                 or nullptr to draw without materials.
+    ///
+    virtual void render(ShaderProgram *shader, const MaterialUniforms *uniforms);
+
+    ///
+    /// \brief isInstanceable Returns whether the game object can be drawn together with
+    ///                       other game objects sharing its meshes in one instanced draw call.
+    ///
+    /// Subclasses that override GameObject::render must return false so that their
+    /// render implementation is called instead.
+    ///
+    virtual bool isInstanceable() const;
+
+    ///
+    /// \brief getInstance Returns the per-instance vertex attributes of the game object.
+    ///
+    VertexArray::Instance getInstance() const;
     
     void setMesh(std::shared_ptr<Meshes> mesh);
+    const Meshes& getMeshes() const;
+
+    ///
+    /// \brief getSharedMeshes Returns the game object's meshes as a pointer that keeps them
+    ///                        alive, e.g. while they're drawn from a render snapshot.
+    ///
+    std::shared_ptr<const Meshes> getSharedMeshes() const;
+
+    ///
+    /// \brief getNumLods Returns the largest number of levels of detail of the game object's meshes.
+    ///
+    unsigned int getNumLods() const;
     
     glm::mat4 getModelMatrix() const;
     
@@ -134,10 +188,25 @@ public:
     void translateInLocalFrame(const glm::vec3 &translation);
     
     void setScale(const glm::vec3 &scale);
+    glm::vec3 getScale() const;
     
     glm::vec3 getScaledDimensions() const;
+
+    ///
+    /// \brief getBoundingBoxExtents Returns half of the dimensions of the world axis aligned
+    ///                              box enclosing the game object, centered at its position.
+    ///
+    glm::vec3 getBoundingBoxExtents() const;
     
     void setSpecularExponent(float specularExponent);
+    float getSpecularExponent() const;
+
+    ///
+    /// \brief setColor Sets a color that tints the game object's diffuse textures.
+    /// \param color RGB values between 0.0 and 1.0
+    ///
+    void setColor(const glm::vec3 &color);
+    glm::vec3 getColor() const;
     
     PhysicsRigidBody* getPhysicsBody();
     
@@ -166,12 +235,15 @@ protected:
 private:
     std::string label;
     Model model;
-    glm::vec3 unscaledDimensions;
+    glm::vec3 unscaledDimensions {0.0f};
     
     std::shared_ptr<Meshes> meshes;
     float specularExponent = 32.0f;
+    glm::vec3 color {1.0f};
     
     std::unique_ptr<PhysicsRigidBody> physicsBody = nullptr;
+
+    std::shared_ptr<const AsyncModel> asyncModel; // Model loading in the background
 };
 
 inline void GameObject::setLabel(const std::string &label) {this->label = label;}
@@ -186,6 +258,14 @@ inline glm::vec3 GameObject::getOrientationY() const {return this->model.getOrie
 inline glm::vec3 GameObject::getOrientationZ() const {return this->model.getOrientationZ();}
 inline glm::vec3 GameObject::getLookAtDirection() const {return this->model.getLookAtDirection();}
 inline glm::vec3 GameObject::getNormalDirection() const {return this->model.getNormalDirection();}
+inline bool GameObject::isInstanceable() const {return true;}
+inline bool GameObject::isLoaded() const {return this->asyncModel == nullptr;}
+inline const GameObject::Meshes& GameObject::getMeshes() const {return *this->meshes;}
+inline std::shared_ptr<const GameObject::Meshes> GameObject::getSharedMeshes() const {return this->meshes;}
+inline float GameObject::getSpecularExponent() const {return this->specularExponent;}
+inline void GameObject::setColor(const glm::vec3 &color) {this->color = color;}
+inline glm::vec3 GameObject::getColor() const {return this->color;}
+inline glm::vec3 GameObject::getScale() const {return this->model.getScale();}
 inline glm::vec3 GameObject::getScaledDimensions() const {return this->unscaledDimensions * this->model.getScale();}
 inline float GameObject::getMass() const {return this->physicsBody->getMass();}
 inline void GameObject::applyCentralForce(const glm::vec3 &force) {this->physicsBody->applyCentralForce(force);}
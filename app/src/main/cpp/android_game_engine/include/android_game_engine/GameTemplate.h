@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
+#include <string>
 
 #include <jni.h>
 
@@ -27,13 +29,32 @@ public:
 
     virtual void onWindowChanged(int width, int height, int displayRotation);
 
+    ///
+    /// \brief update Advances the game by a frame. Called on the GL thread before every
+    ///               render. By default it calls GameTemplate::onUpdate.
+    ///
+    virtual void update(std::chrono::duration<float> updateDuration);
+
     virtual void onUpdate(std::chrono::duration<float> updateDuration);
     virtual void render() = 0;
 
+    ///
+    /// \brief postEvent Runs an input or window event on the thread that updates the game,
+    ///                  before its next update. By default the event runs immediately.
+    ///
+    virtual void postEvent(std::function<void()> event);
+
     virtual bool onTouchDownEvent(float x, float y);
     virtual bool onTouchMoveEvent(float x, float y);
     virtual bool onTouchUpEvent(float x, float y);
 
+    ///
+    /// \brief writeTrace Writes the events recorded while Trace was enabled to a Chrome trace
+    ///                   JSON file in the app's cache directory, Context.getCacheDir().
+    /// \return Whether the file was written.
+    ///
+    bool writeTrace(const std::string &filename="trace.json");
+
 protected:
     JNIEnv* getJNIEnv();
     jobject getJavaApplicationContext();
@@ -43,6 +64,7 @@ private:
     JavaVM *javaVM;
     jobject javaApplicationContext;
     jobject javaActivityObject;
+    std::string cacheDirectory;
 };
 
 } // namespace age
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+
+#include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
+
+namespace age {
+
+///
+/// \brief Measures the GPU time of the render passes of every frame with
+///        GL_EXT_disjoint_timer_query and keeps rolling statistics per pass.
+///
+/// Queries are issued into a ring of frames and their results are only read once the GPU
+/// made them available, a few frames later, so that the CPU never waits for the GPU.
+/// Frames during which the GPU reported a disjoint operation, e.g. a change of its clock
+/// frequency, are discarded. Frames whose queries are still pending when their slot of the
+/// ring is reused are dropped as well.
+///
+/// When the extension isn't supported the passes are timed on the CPU instead, which only
+/// measures the time taken to submit their commands.
+///
+/// Passes are timed one after the other and can't be nested. Must be used on the GL thread.
+///
+class GpuProfiler {
+public:
+    enum class Pass {
+        SHADOW_MAP = 0,
+        WORLD,
+        PHYSICS_DEBUG,
+        SKYBOX,
+        AR_BACKGROUND,
+        AR_PLANE,
+        NUM_PASSES
+    };
+    static constexpr size_t numPasses = static_cast<size_t>(Pass::NUM_PASSES);
+
+    ///
+    /// \brief Rolling statistics of the durations of a pass over its last samples.
+    ///
+    struct Statistics {
+        unsigned int numSamples = 0;
+        std::chrono::duration<float> last {0.0f};
+        std::chrono::duration<float> average {0.0f};
+        std::chrono::duration<float> percentile50 {0.0f};
+        std::chrono::duration<float> percentile95 {0.0f};
+        std::chrono::duration<float> percentile99 {0.0f};
+    };
+
+    static constexpr unsigned int numFrames = 4;   ///< Frames in flight before results are read back
+    static constexpr size_t maxSamples = 120;      ///< Samples per pass the statistics are computed over
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler& operator=(const GpuProfiler &) = delete;
+
+    ///
+    /// \brief beginFrame Reads back the results of previous frames that are available and
+    ///                   starts timing a new frame. Call this once at the start of every frame.
+    ///
+    void beginFrame();
+
+    ///
+    /// \brief beginPass Starts timing a pass. Each pass can be timed once per frame.
+    ///
+    void beginPass(Pass pass);
+
+    ///
+    /// \brief endPass Stops timing the current pass.
+    ///
+    void endPass();
+
+    ///
+    /// \brief isGpuTimed Returns whether passes are timed on the GPU or fall back to CPU timings.
+    ///
+    bool isGpuTimed() const;
+
+    ///
+    /// \brief getStatistics Returns the statistics of the last samples of a pass.
+    ///
+    Statistics getStatistics(Pass pass) const;
+
+    ///
+    /// \brief getNumFramesDiscarded Returns the number of frames whose GPU timings were
+    ///                              discarded because they were disjoint or not ready in time.
+    ///
+    unsigned int getNumFramesDiscarded() const;
+
+    static const char* getPassName(Pass pass);
+
+private:
+    using Nanoseconds = std::chrono::duration<uint64_t, std::nano>;
+
+    struct Frame {
+        std::array<GLuint, numPasses> queries {};
+        std::array<bool, numPasses> issued {}; ///< Passes whose query was issued in the frame
+        bool pending = false;
+    };
+
+    bool collectFrame(Frame &frame);
+    void addSample(Pass pass, Nanoseconds duration);
+
+    PFNGLGETQUERYOBJECTUI64VEXTPROC getQueryObjectui64v = nullptr; ///< nullptr without the extension
+
+    std::array<Frame, numFrames> frames;
+    unsigned int currentFrame = 0;
+
+    bool passActive = false;
+    Pass currentPass = Pass::SHADOW_MAP;
+    std::chrono::steady_clock::time_point passBeginTime;
+
+    std::array<std::deque<Nanoseconds>, numPasses> samples;
+    unsigned int numFramesDiscarded = 0;
+};
+
+inline bool GpuProfiler::isGpuTimed() const {return this->getQueryObjectui64v != nullptr;}
+inline unsigned int GpuProfiler::getNumFramesDiscarded() const {return this->numFramesDiscarded;}
+
+} // namespace age
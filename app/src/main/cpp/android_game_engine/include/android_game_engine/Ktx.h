@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace age {
+
+///
+/// \brief Texture stored in the KTX 1.1 container format with all of its mipmap levels
+///        and cube map faces in the layout glTexImage2D and glCompressedTexImage2D take.
+///
+/// Only depends on the standard library so that textures can be written on the host.
+///
+struct KtxTexture {
+    uint32_t glType = 0; ///< 0 for compressed textures
+    uint32_t glTypeSize = 1;
+    uint32_t glFormat = 0; ///< 0 for compressed textures
+    uint32_t glInternalFormat = 0;
+    uint32_t glBaseInternalFormat = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t numFaces = 1; ///< 6 for cube maps, in the order +X, -X, +Y, -Y, +Z, -Z
+    uint32_t numMipmapLevels = 1; ///< 0 requests the mipmaps to be generated at load time
+
+    /// Image data of every mipmap level and face, indexed by level * numFaces + face
+    std::vector<std::vector<uint8_t>> images;
+
+    bool isCompressed() const;
+
+    const std::vector<uint8_t>& getImage(uint32_t level, uint32_t face) const;
+
+    ///
+    /// \brief read Parses a KTX 1.1 file.
+    /// \param data Contents of the file.
+    /// \param size Number of bytes of data.
+    /// \exception age::LoadError The data is not a valid KTX 1.1 file.
+    ///
+    static KtxTexture read(const uint8_t *data, size_t size);
+
+    ///
+    /// \brief write Serializes the texture as a KTX 1.1 file in native byte order.
+    ///
+    std::vector<uint8_t> write() const;
+};
+
+inline bool KtxTexture::isCompressed() const {return this->glType == 0;}
+
+inline const std::vector<uint8_t>& KtxTexture::getImage(uint32_t level, uint32_t face) const {
+    return this->images[level * this->numFaces + face];
+}
+
+} // namespace age
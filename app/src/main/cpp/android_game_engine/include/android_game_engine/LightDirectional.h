@@ -4,6 +4,10 @@
 
 #include <chrono>
 
+#include <glm/vec3.hpp>
+
+#include "UniformHandle.h"
+
 namespace age {
 
 ///
@@ -21,9 +25,21 @@ public:
     ///
     glm::mat4 getProjectionMatrix() const override;
     
+    ///
+    /// \brief render Sets the directionalLight uniforms of a shader program.
+    ///
+    /// Uniform handles are resolved on the first call and again only when a
+    /// different shader program is passed in.
+    ///
     void render(ShaderProgram *shader) override;
 
 private:
+    const ShaderProgram *uniformsShader = nullptr;
+    UniformHandle<glm::vec3> directionUniform;
+    UniformHandle<glm::vec3> ambientUniform;
+    UniformHandle<glm::vec3> diffuseUniform;
+    UniformHandle<glm::vec3> specularUniform;
+
     float left;
     float right;
     float bottom;
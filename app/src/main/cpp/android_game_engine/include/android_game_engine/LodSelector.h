@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/fwd.hpp>
+
+namespace age {
+
+///
+/// \brief Selects levels of detail from the projected size of objects on the screen.
+///
+/// Switching levels requires the projected size to cross a threshold by a margin so that
+/// objects hovering around a threshold don't switch back and forth every frame.
+///
+class LodSelector {
+public:
+    ///
+    /// \brief LodSelector constructor.
+    /// \param screenSizeThresholds Projected sizes, as fractions of the viewport height, in
+    ///                             descending order. Level i + 1 is selected below threshold i.
+    /// \param hysteresis Fraction of a threshold the projected size must cross it by to switch levels.
+    ///
+    explicit LodSelector(std::vector<float> screenSizeThresholds={0.25f, 0.1f, 0.04f},
+                         float hysteresis=0.1f);
+
+    ///
+    /// \brief getScreenSize Returns the projected diameter of a bounding sphere as a fraction of
+    ///                      the viewport height.
+    /// \param center Center of the sphere in world coordinates.
+    /// \param radius Radius of the sphere.
+    /// \param viewPosition Position of the camera in world coordinates.
+    /// \param projection Perspective projection matrix of the camera.
+    ///
+    static float getScreenSize(const glm::vec3 &center, float radius,
+                               const glm::vec3 &viewPosition, const glm::mat4 &projection);
+
+    ///
+    /// \brief select Returns the level of detail to use.
+    /// \param screenSize Projected size returned by LodSelector::getScreenSize.
+    /// \param currentLod Level of detail selected in the previous frame.
+    /// \param numLods Number of levels of detail available.
+    ///
+    unsigned int select(float screenSize, unsigned int currentLod, unsigned int numLods) const;
+
+private:
+    std::vector<float> screenSizeThresholds;
+    float hysteresis;
+};
+
+} // namespace age
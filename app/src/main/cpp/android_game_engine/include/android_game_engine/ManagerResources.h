@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * Singleton resource manager that keeps track of the textures and meshes loaded from
+ * files. Resources are keyed by their full filepath and sized by the number of bytes
+ * they occupy in GPU memory.
+ *
+ * Resources that are no longer used are kept in a least recently used cache so that
+ * loading them again is free, until the resident resources exceed the memory budget or
+ * Android asks the app to trim its memory. Resources that are still used are never evicted.
+ *
+ * All functions except ManagerResources::onTrimMemory must be called on the GL thread.
+ *
+ * Initialize ManagerResources after ManagerAssets.
+ * Shutdown ManagerResources before ManagerAssets, once the game released its resources.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace age {
+
+enum class ResourceType {
+    TEXTURE,
+    MESH,
+    NUM_TYPES
+};
+
+namespace ManagerResources {
+
+struct Statistics {
+    unsigned int numResident = 0;     ///< Resources in memory, used or cached
+    unsigned int numUnreferenced = 0; ///< Resident resources that are only kept by the cache
+    size_t residentBytes = 0;
+    size_t unreferencedBytes = 0;
+
+    unsigned int numHits = 0;      ///< Lookups of resident resources since initialization
+    unsigned int numMisses = 0;    ///< Lookups of resources that had to be loaded since initialization
+    unsigned int numEvictions = 0; ///< Cached resources released since initialization
+};
+
+///
+/// \brief init Initializes the resource manager.
+/// \param budget Number of bytes that resident resources can occupy before unused ones are evicted.
+///
+void init(size_t budget=128u * 1024u * 1024u);
+
+///
+/// \brief shutdown Releases the cached resources and resets the statistics.
+///
+void shutdown();
+
+///
+/// \brief setBudget Sets the memory budget and evicts unused resources until it is met.
+/// \param budget Number of bytes that resident resources can occupy before unused ones are evicted.
+///
+void setBudget(size_t budget);
+size_t getBudget();
+
+///
+/// \brief find Returns a resident resource and marks it as the most recently used.
+/// \param type Type of resource.
+/// \param filepath Filepath the resource was loaded from.
+/// \return Resource or nullptr if it isn't resident.
+///
+template<typename T>
+std::shared_ptr<T> find(ResourceType type, const std::string &filepath);
+
+///
+/// \brief isResident Checks whether a resource is resident without marking it as used.
+///
+bool isResident(ResourceType type, const std::string &filepath);
+
+///
+/// \brief insert Makes a resource resident and evicts unused resources if the budget is exceeded.
+///
+/// The returned pointer shares ownership of the resource. The resource is cached once
+/// it and all its copies are destroyed and released when it's evicted. The resident
+/// resource is returned instead if one was already inserted for the filepath.
+///
+/// \param type Type of resource.
+/// \param filepath Filepath the resource was loaded from.
+/// \param resource Resource, whose deleter releases its GPU memory.
+/// \param numBytes Number of bytes the resource occupies.
+/// \return Resource.
+///
+template<typename T>
+std::shared_ptr<T> insert(ResourceType type, const std::string &filepath,
+                          std::shared_ptr<T> resource, size_t numBytes);
+
+///
+/// \brief setSize Updates the number of bytes a resident resource occupies, for
+///                resources that finished loading in the background.
+///
+void setSize(ResourceType type, const std::string &filepath, size_t numBytes);
+
+///
+/// \brief onTrimMemory Requests unused resources to be evicted in response to
+///                     Android's ComponentCallbacks2.onTrimMemory.
+///
+/// Can be called from any thread. The resources are evicted on the GL thread by the next
+/// call to ManagerResources::processTrimMemory: all of them when the app is in the background
+/// or memory is critically low, enough to halve the budget when memory is running low.
+///
+/// \param level Trim memory level.
+///
+void onTrimMemory(int level);
+
+///
+/// \brief processTrimMemory Evicts the resources requested by ManagerResources::onTrimMemory.
+///                          This must be called on the GL thread once per frame.
+///
+void processTrimMemory();
+
+///
+/// \brief getStatistics Returns the residency statistics of a type of resource.
+///
+Statistics getStatistics(ResourceType type);
+
+std::shared_ptr<void> findResource(ResourceType type, const std::string &filepath);
+std::shared_ptr<void> insertResource(ResourceType type, const std::string &filepath,
+                                     std::shared_ptr<void> resource, size_t numBytes);
+
+template<typename T>
+std::shared_ptr<T> find(ResourceType type, const std::string &filepath) {
+    return std::static_pointer_cast<T>(findResource(type, filepath));
+}
+
+template<typename T>
+std::shared_ptr<T> insert(ResourceType type, const std::string &filepath,
+                          std::shared_ptr<T> resource, size_t numBytes) {
+    return std::static_pointer_cast<T>(insertResource(type, filepath, std::move(resource), numBytes));
+}
+
+} // namespace ManagerResources
+} // namespace age
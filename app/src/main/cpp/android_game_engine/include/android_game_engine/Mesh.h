@@ -1,15 +1,29 @@
 #pragma once
 
+#include <cstdint>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "Texture2D.h"
+#include "UniformHandle.h"
+#include "VertexArray.h"
 
 namespace age {
 
 class ShaderProgram;
-class VertexArray;
+
+///
+/// \brief Handles to the material uniforms of a shader program, resolved once so that
+///        binding materials on every frame doesn't build or look up uniform names.
+///
+struct MaterialUniforms {
+    explicit MaterialUniforms(const ShaderProgram &shader);
+
+    UniformHandle<float> specularExponent;
+    std::vector<UniformHandle<int>> diffuseTextures;
+    std::vector<UniformHandle<int>> specularTextures;
+};
 
 ///
 /// \brief Aggregates vertex and index data to load onto the GPU
@@ -17,24 +31,68 @@ class VertexArray;
 ///
 class Mesh {
 public:
+    ///
+    /// \brief Mesh Creates a mesh with textures loaded from image files.
+    /// \param textureMode Whether to load the textures before returning or in the background.
+    ///
     Mesh(std::shared_ptr<VertexArray> vao,
          const std::set<std::string> &diffuseTextureFilepaths,
-         const std::set<std::string> &specularTextureFilepaths);
+         const std::set<std::string> &specularTextureFilepaths,
+         LoadMode textureMode=LoadMode::SYNCHRONOUS);
 
     Mesh(std::shared_ptr<VertexArray> vao,
          const std::vector<Texture2D> &diffuseTextures,
          const std::vector<Texture2D> &specularTextures);
 
-    void bindTextures(ShaderProgram *shader);
-    void renderVAO(ShaderProgram *shader);
+    ///
+    /// \brief bindTextures Binds the diffuse and then the specular textures to consecutive
+    ///                     texture units starting at 0.
+    /// \param shader Shader program currently in use.
+    /// \param uniforms Material uniforms of shader. Textures without a matching uniform
+    ///                 are bound but not assigned to a sampler.
+    ///
+    void bindTextures(ShaderProgram *shader, const MaterialUniforms &uniforms) const;
+
+    ///
+    /// \brief renderVAO Draws the mesh geometry once for each instance.
+    /// \param instances Per-instance attributes.
+    /// \param numInstances Number of elements in instances.
+    /// \param lod Level of detail to draw. Levels past the coarsest draw the coarsest.
+    ///
+    void renderVAO(const VertexArray::Instance *instances, size_t numInstances,
+                   unsigned int lod=0) const;
+
+    ///
+    /// \brief addLod Adds a coarser level of detail sharing the mesh's materials.
+    /// \param vao Geometry of the level, coarser than all previously added levels.
+    ///
+    void addLod(std::shared_ptr<VertexArray> vao);
+
+    ///
+    /// \brief getNumLods Returns the number of levels of detail including the full detail level 0.
+    ///
+    unsigned int getNumLods() const;
+
+    VertexArray* getVertexArray(unsigned int lod=0) const;
+
+    ///
+    /// \brief getTextureSetId Returns the ID of the mesh's diffuse and specular textures,
+    ///                        which is the same for all meshes with the same textures.
+    ///
+    uint32_t getTextureSetId() const;
 
 private:
     void init();
 
     std::shared_ptr<VertexArray> vao;
+    std::vector<std::shared_ptr<VertexArray>> lods; // Levels of detail past level 0
 
     std::vector<Texture2D> diffuseTextures;
     std::vector<Texture2D> specularTextures;
+    uint32_t textureSetId;
 };
 
+inline unsigned int Mesh::getNumLods() const {return static_cast<unsigned int>(this->lods.size()) + 1u;}
+inline uint32_t Mesh::getTextureSetId() const {return this->textureSetId;}
+
 } // namespace age
\ No newline at end of file
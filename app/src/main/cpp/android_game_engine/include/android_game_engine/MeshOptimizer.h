@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * Offline-style optimization passes for indexed triangle meshes. These only
+ * depend on glm so they can be run at load time or from a host conversion tool.
+ *
+ * The passes are meant to be run in order:
+ *   1. optimizeVertexCache - reorder triangles for post-transform cache hits
+ *   2. optimizeOverdraw    - (optional) reorder clusters of triangles front to back
+ *   3. optimizeVertexFetch - reorder vertices in the order they are referenced
+ *
+ * simplify generates lower levels of detail that reuse the vertices of the original mesh.
+ */
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace age {
+namespace MeshOptimizer {
+
+struct VertexCacheStatistics {
+    size_t numTransformedVertices = 0;
+
+    float acmr = 0.0f; ///< Average cache miss ratio, transformed vertices per triangle
+    float atvr = 0.0f; ///< Average transform to vertex ratio, transformed vertices per referenced vertex
+};
+
+///
+/// \brief analyzeVertexCache Simulates a FIFO post-transform vertex cache.
+/// \param indices Triangle indices.
+/// \param numVertices Number of vertices referenced by indices.
+/// \param cacheSize Number of entries in the simulated cache.
+///
+VertexCacheStatistics analyzeVertexCache(const std::vector<glm::uvec3> &indices,
+                                         size_t numVertices, size_t cacheSize=16);
+
+///
+/// \brief optimizeVertexCache Reorders triangles for post-transform vertex cache
+///                            locality using Tom Forsyth's linear-speed algorithm.
+/// \param indices Triangle indices to reorder in place.
+/// \param numVertices Number of vertices referenced by indices.
+///
+void optimizeVertexCache(std::vector<glm::uvec3> &indices, size_t numVertices);
+
+///
+/// \brief optimizeOverdraw Splits a vertex cache optimized triangle list into clusters
+///                         and sorts the clusters so that outward facing clusters are
+///                         drawn first and occlude the rest of the mesh.
+/// \param indices Triangle indices, already reordered by optimizeVertexCache.
+/// \param positions Vertex positions.
+/// \param threshold Maximum ACMR degradation allowed when splitting clusters, 1.05 allows 5%.
+///
+void optimizeOverdraw(std::vector<glm::uvec3> &indices, const std::vector<glm::vec3> &positions,
+                      float threshold=1.05f);
+
+///
+/// \brief optimizeVertexFetch Reorders vertices in the order they are first referenced
+///                            by indices and drops unreferenced vertices.
+/// \param indices Triangle indices to remap in place.
+/// \param positions Vertex positions to reorder in place.
+/// \param normals Vertex normals to reorder in place.
+/// \param textureCoordinates Vertex texture coordinates to reorder in place.
+///
+void optimizeVertexFetch(std::vector<glm::uvec3> &indices,
+                         std::vector<glm::vec3> &positions,
+                         std::vector<glm::vec3> &normals,
+                         std::vector<glm::vec2> &textureCoordinates);
+
+///
+/// \brief simplify Reduces the number of triangles of a mesh by collapsing edges in the order
+///                 of their quadric error (Garland and Heckbert).
+///
+/// Vertices are only ever collapsed onto one of their neighbours so the returned triangles
+/// index into the original vertex attributes. Vertices on open borders and on attribute
+/// seams, where several vertices share a position, are never moved so that the mesh
+/// outline and texture mapping stay intact.
+///
+/// \param indices Triangle indices.
+/// \param positions Vertex positions.
+/// \param targetNumTriangles Number of triangles to stop simplifying at.
+/// \param targetError Maximum quadric error of a collapse, the root mean square distance of the
+///                    collapsed vertices to their original planes, relative to the largest
+///                    dimension of the mesh.
+/// \param resultError Set to the largest error of the collapses performed, relative to the
+///                    largest dimension of the mesh. Can be nullptr.
+/// \return Triangle indices of the simplified mesh. Returns fewer triangles than indices
+///         only when collapses within targetError were found.
+///
+std::vector<glm::uvec3> simplify(const std::vector<glm::uvec3> &indices,
+                                 const std::vector<glm::vec3> &positions,
+                                 size_t targetNumTriangles, float targetError,
+                                 float *resultError=nullptr);
+
+} // namespace MeshOptimizer
+} // namespace age
@@ -1,15 +1,43 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <BulletCollision/CollisionShapes/btCollisionShape.h>
 #include <glm/fwd.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 
+#include "AssetLoader.h"
 #include "Mesh.h"
 
 namespace age {
 
+///
+/// \brief Vertex data and texture filepaths of a mesh extracted from a model file.
+///
+struct MeshData {
+    struct Geometry {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec2> textureCoordinates;
+        std::vector<glm::uvec3> indices;
+
+        ///
+        /// \brief getSize Returns the approximate number of bytes uploaded for the geometry.
+        ///
+        size_t getSize() const;
+    };
+
+    std::vector<Geometry> lods; ///< Full detail geometry followed by coarser levels of detail
+    std::set<std::string> diffuseTextureFilepaths;
+    std::set<std::string> specularTextureFilepaths;
+};
+
 ///
 /// \brief Base class for loading and parsing 3D model files.
 ///        Subclass ModelLoader to provide implementations for specific 3D file types.
@@ -36,6 +64,22 @@ public:
     /// \return mesh data
     ///
     virtual std::shared_ptr<Meshes> loadMeshes() = 0;
+
+    ///
+    /// Extract vertex data and texture filepaths from the 3D model file without calling
+    /// OpenGL so that it can run on a worker thread.
+    /// \return mesh data
+    ///
+    virtual std::vector<MeshData> loadMeshData() = 0;
+
+    ///
+    /// Uploads mesh data to the GPU.
+    /// \param meshData Mesh data returned by ModelLoader::loadMeshData.
+    /// \param textureMode Whether to load the textures before returning or in the background.
+    /// \return meshes
+    ///
+    static Meshes createMeshes(const std::vector<MeshData> &meshData,
+                               LoadMode textureMode=LoadMode::SYNCHRONOUS);
     
     ///
     /// Extract collision shape from the 3D model file. The collision shape is internally cached.
@@ -56,4 +100,15 @@ private:
     std::string filename;
 };
 
+///
+/// \brief Model loaded in the background. Its members are set on the GL thread once
+///        the meshes have been uploaded or loading failed, and are only read once
+///        isDone is set, possibly by the thread updating the game.
+///
+struct AsyncModel {
+    std::atomic<bool> isDone {false};
+    std::shared_ptr<ModelLoader> loader; ///< Parsed model file, nullptr if loading failed
+    std::shared_ptr<ModelLoader::Meshes> meshes;
+};
+
 } // namespace age
\ No newline at end of file
@@ -14,9 +14,22 @@ public:
     explicit ModelLoader3ds(const std::string &filepath);
     
     std::shared_ptr<Meshes> loadMeshes() override;
+    std::vector<MeshData> loadMeshData() override;
     std::unique_ptr<btCollisionShape> loadCollisionShape() override;
     glm::vec3 loadDimensions() override;
 
+    ///
+    /// \brief loadAsync Parses a model file and extracts its mesh data on a worker thread
+    ///                  and uploads the meshes and loads their textures in the background.
+    ///
+    /// Loads of the same model file in progress are shared and loaded meshes are reused.
+    /// Must be called on the GL thread.
+    ///
+    /// \param filepath Filepath to the model.
+    /// \return Model that is done once AssetLoader::processUploads ran its upload.
+    ///
+    static std::shared_ptr<const AsyncModel> loadAsync(const std::string &filepath);
+
 private:
     std::unique_ptr<btCollisionShape> loadBox();
     std::unique_ptr<btCollisionShape> loadConvexHull();
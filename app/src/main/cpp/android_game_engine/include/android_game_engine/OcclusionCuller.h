@@ -0,0 +1,148 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "AABBTree.h"
+
+namespace age {
+
+///
+/// \brief Triangles of an occluder in the model space of its game object.
+///
+/// The triangles must lie within the opaque surface of the game object, e.g. its own mesh
+/// or a box inside a model, so that they never hide anything the game object doesn't.
+///
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+};
+
+///
+/// \brief Culls objects hidden behind occluders using a low resolution depth buffer
+///        rasterized on the CPU.
+///
+/// Occluder triangles are binned into screen tiles which are rasterized with 4 pixels at a
+/// time using NEON or SSE. Once OcclusionCuller::startWorkers was called, depth buffers with
+/// enough binned triangles to pay for waking the workers are rasterized in parallel by the
+/// calling thread and worker threads that live as long as the culler. Every tile is written
+/// by a single thread and the nearest depth is kept per pixel so the depth buffer doesn't
+/// depend on the number of threads or the order triangles are rasterized in.
+///
+class OcclusionCuller {
+public:
+    static constexpr int tileSize = 32;
+
+    /// Binned triangles per thread below which the calling thread rasterizes all tiles
+    static constexpr size_t minTileTrianglesPerThread = 256;
+
+    ///
+    /// \brief OcclusionCuller
+    /// \param width Width of the depth buffer, rounded up to a multiple of the tile size.
+    /// \param height Height of the depth buffer, rounded up to a multiple of the tile size.
+    /// \param numThreads Maximum number of threads rasterizing tiles, including the thread
+    ///                   calling OcclusionCuller::rasterize. 0 uses the number of hardware
+    ///                   threads, up to 4.
+    ///
+    explicit OcclusionCuller(int width=256, int height=128, unsigned int numThreads=1);
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    ///
+    /// \brief startWorkers Starts the worker threads if they aren't running yet. Until then,
+    ///                     the calling thread rasterizes all tiles.
+    ///
+    void startWorkers();
+
+    ///
+    /// \brief clearOccluders Removes all occluder triangles.
+    ///
+    void clearOccluders();
+
+    ///
+    /// \brief addOccluder Adds the triangles of an occluder.
+    /// \param mesh Triangles of the occluder in model space.
+    /// \param model Model matrix transforming the triangles into world coordinates.
+    ///
+    void addOccluder(const OccluderMesh &mesh, const glm::mat4 &model);
+
+    ///
+    /// \brief rasterize Rasterizes the occluders into the depth buffer.
+    /// \param projectionView Projection view matrix of the camera.
+    ///
+    void rasterize(const glm::mat4 &projectionView);
+
+    ///
+    /// \brief isVisible Tests a bounding box against the depth buffer of the last call to
+    ///                  OcclusionCuller::rasterize.
+    /// \return False if the box is fully hidden behind occluders.
+    ///
+    bool isVisible(const AABB &aabb) const;
+
+    int getWidth() const;
+    int getHeight() const;
+
+    size_t getNumOccluderTriangles() const;
+
+    ///
+    /// \brief getNumRasterizingThreads Returns the number of threads that rasterized the depth
+    ///                                 buffer of the last call to OcclusionCuller::rasterize.
+    ///
+    unsigned int getNumRasterizingThreads() const;
+
+    ///
+    /// \brief getDepthBuffer Returns the nearest depth in [0, 1] of every pixel from the
+    ///                       bottom row up, with 1 where there are no occluders.
+    ///
+    const std::vector<float>& getDepthBuffer() const;
+
+private:
+    struct ScreenTriangle {
+        glm::vec3 vertices[3];
+    };
+
+    void clipAndProject(const glm::vec4 (&clipVertices)[3]);
+    void rasterizeTiles(unsigned int thread, unsigned int numThreads);
+    void rasterizeTile(int tile);
+    void runWorker(unsigned int thread);
+
+    int width;
+    int height;
+    int numTilesX;
+    int numTilesY;
+    unsigned int numThreads;
+    unsigned int numRasterizingThreads = 1;
+
+    std::vector<glm::vec3> occluderVertices;
+
+    glm::mat4 projectionView {1.0f};
+    std::vector<ScreenTriangle> screenTriangles;
+    std::vector<std::vector<uint32_t>> tileTriangles;
+    std::vector<float> depthBuffer;
+
+    // Threads past the calling thread, which rasterizes the tiles of thread 0
+    std::vector<std::thread> workers;
+    std::mutex workerMutex;
+    std::condition_variable rasterizeCondition;
+    std::condition_variable doneCondition;
+    uint64_t rasterizeNumber = 0; // Incremented to start the workers on a depth buffer
+    unsigned int numBusyWorkers = 0;
+    bool stopping = false;
+};
+
+inline int OcclusionCuller::getWidth() const {return this->width;}
+inline int OcclusionCuller::getHeight() const {return this->height;}
+inline size_t OcclusionCuller::getNumOccluderTriangles() const {return this->occluderVertices.size() / 3;}
+inline unsigned int OcclusionCuller::getNumRasterizingThreads() const {return this->numRasterizingThreads;}
+inline const std::vector<float>& OcclusionCuller::getDepthBuffer() const {return this->depthBuffer;}
+
+} // namespace age
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 #include <LinearMath/btIDebugDraw.h>
+#include <glm/vec3.hpp>
 
 namespace age {
 
@@ -9,8 +13,19 @@ class ShaderProgram;
 ///
 /// \brief Draws debugging objects for the Physics Engine
 ///
+/// Lines are accumulated on the CPU while Bullet draws the world and drawn in a single
+/// draw call when Bullet flushes them at the end of btDiscreteDynamicsWorld::debugDrawWorld.
+///
+/// Flushed lines can instead be captured without calling OpenGL, so that the world is
+/// drawn on the thread stepping it and the lines are drawn later on the GL thread.
+///
 class PhysicsDebugDrawer : public btIDebugDraw {
 public:
+    struct LineVertex {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
     explicit PhysicsDebugDrawer(ShaderProgram *shader);
     ~PhysicsDebugDrawer();
 
@@ -18,6 +33,8 @@ public:
     PhysicsDebugDrawer& operator=(PhysicsDebugDrawer &&) noexcept = default;
     
     void drawLine(const btVector3 &from, const btVector3 &to, const btVector3 &color) override;
+    void drawLine(const btVector3 &from, const btVector3 &to,
+                  const btVector3 &fromColor, const btVector3 &toColor) override;
     void drawContactPoint(const btVector3 &PointOnB, const btVector3 &normalOnB, btScalar distance,
                           int lifeTime, const btVector3 &color) override;
     
@@ -27,11 +44,37 @@ public:
     
     void setDebugMode(int debugMode) override;
     int getDebugMode() const override;
+
+    ///
+    /// \brief clearLines Discards the lines accumulated since the last flush.
+    ///
+    void clearLines() override;
+
+    ///
+    /// \brief flushLines Uploads the accumulated lines and draws them with one draw call,
+    ///                   or moves them into the capture target if one is set.
+    ///
+    void flushLines() override;
+
+    ///
+    /// \brief setCaptureTarget Makes flushes move the accumulated lines into a vector
+    ///                         instead of drawing them.
+    /// \param lines Vector to move the lines into, or nullptr to draw them when flushed.
+    ///
+    void setCaptureTarget(std::vector<LineVertex> *lines);
+
+    ///
+    /// \brief drawLines Uploads lines and draws them with one draw call.
+    ///
+    void drawLines(const std::vector<LineVertex> &lines);
     
 private:
     ShaderProgram *shader;
     unsigned int vao;
     unsigned int vbo;
+    size_t vboCapacity; ///< Number of vertices the VBO can hold
+    std::vector<LineVertex> lineVertices;
+    std::vector<LineVertex> *captureTarget;
     int debugMode;
 };
 
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <memory>
+#include <vector>
 
 #include <BulletCollision/BroadphaseCollision/btBroadphaseInterface.h>
 #include <BulletCollision/CollisionDispatch/btCollisionDispatcher.h>
@@ -10,10 +11,11 @@
 #include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
 #include <glm/vec3.hpp>
 
+#include "PhysicsDebugDrawer.h"
+
 namespace age {
 
 class GameObject;
-class PhysicsDebugDrawer;
 class PhysicsRigidBody;
 class ShaderProgram;
 
@@ -39,8 +41,18 @@ public:
     PhysicsEngine(const PhysicsEngine&) = delete;
     PhysicsEngine& operator=(const PhysicsEngine&) = delete;
     
+    ///
+    /// \brief onUpdate Advances the simulation by an update's duration in substeps of 1/60 s,
+    ///                 interpolating the transforms of the rigid bodies between substeps.
+    ///
     void onUpdate(std::chrono::duration<float> updateDuration);
 
+    ///
+    /// \brief step Advances the simulation by exactly one step of a given duration, e.g.
+    ///             for games updated with a fixed timestep.
+    ///
+    void step(std::chrono::duration<float> timestep);
+
     void setGravity(const glm::vec3 &gravity);
 
     ///
@@ -58,6 +70,18 @@ public:
     ///
     void renderDebug();
 
+    ///
+    /// \brief captureDebug Collects the lines drawn by PhysicsEngine::renderDebug without
+    ///                     calling OpenGL, e.g. on a thread stepping the simulation.
+    /// \param lines Replaced by the collected lines.
+    ///
+    void captureDebug(std::vector<PhysicsDebugDrawer::LineVertex> &lines);
+
+    ///
+    /// \brief renderDebug Draws lines collected by PhysicsEngine::captureDebug.
+    ///
+    void renderDebug(const std::vector<PhysicsDebugDrawer::LineVertex> &lines);
+
 private:
     std::unique_ptr<PhysicsDebugDrawer> debugDrawer;
     std::unique_ptr<btCollisionConfiguration> collisionConfig;
@@ -35,6 +35,14 @@ public:
     float getMass() const;
     
     void setScale(const glm::vec3 &scale);
+
+    ///
+    /// \brief setCollisionShape Replaces the collision shape while keeping the scale and mass.
+    ///
+    /// The body can stay in its physics world. Bullet caches collision algorithms of
+    /// overlapping pairs by shape type, so the new shape must be of the same type.
+    ///
+    void setCollisionShape(std::unique_ptr<btCollisionShape> collisionShape);
     
     bool isActive() const;
     
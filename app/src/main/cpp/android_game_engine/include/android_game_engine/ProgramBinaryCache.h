@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * Singleton on-disk cache of linked shader program binaries, so that programs that were
+ * linked on a previous launch are loaded through glProgramBinary instead of being compiled
+ * and linked again.
+ *
+ * Binaries are stored in one file per program, named after a key that hashes everything
+ * the binary depends on: the shader sources, including their defines, and the driver's
+ * vendor, renderer and version strings. Files that are corrupt are removed when loaded and
+ * the least recently used files are removed once the cache exceeds its size limit.
+ *
+ * The cache doesn't call OpenGL. Its functions can be called from any thread.
+ *
+ * Initialize ProgramBinaryCache before creating shader programs. GameTemplate initializes
+ * it with the app's cache directory. The cache is disabled until initialized.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace age {
+namespace ProgramBinaryCache {
+
+///
+/// \brief Binary of a linked program as returned by glGetProgramBinary.
+///
+struct ProgramBinary {
+    uint32_t format = 0;
+    std::vector<uint8_t> data;
+};
+
+///
+/// \brief init Enables the cache.
+/// \param directory Directory to store the binaries in. It's created if it doesn't exist.
+/// \param maxBytes Total size of the binaries kept in the directory.
+///
+void init(const std::string &directory, size_t maxBytes=4u * 1024u * 1024u);
+
+///
+/// \brief shutdown Disables the cache. Binaries already stored are kept on disk.
+///
+void shutdown();
+
+bool isEnabled();
+
+///
+/// \brief computeKey Hashes everything a program binary depends on.
+/// \param parts Shader sources and driver strings. Their order matters.
+/// \return 64-bit FNV-1a hash.
+///
+uint64_t computeKey(const std::vector<std::string> &parts);
+
+///
+/// \brief getFilepath Returns the filepath of the binary stored for a key.
+///
+std::string getFilepath(uint64_t key);
+
+///
+/// \brief load Loads a stored program binary.
+/// \param key Key computed by ProgramBinaryCache::computeKey.
+/// \return The program binary or nullptr if none is stored or the stored file is corrupt.
+///
+std::unique_ptr<ProgramBinary> load(uint64_t key);
+
+///
+/// \brief store Writes a program binary to disk and removes the least recently used
+///              binaries that exceed the cache's size limit. Failures are logged.
+///
+/// The file is written under a temporary name and renamed so that readers never see a
+/// partially written binary.
+///
+/// \param key Key computed by ProgramBinaryCache::computeKey.
+/// \param binary Program binary.
+///
+void store(uint64_t key, const ProgramBinary &binary);
+
+///
+/// \brief remove Removes a stored program binary, e.g. one the driver rejected.
+///
+void remove(uint64_t key);
+
+} // namespace ProgramBinaryCache
+} // namespace age
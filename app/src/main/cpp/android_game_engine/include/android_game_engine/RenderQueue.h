@@ -0,0 +1,180 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexArray.h"
+
+namespace age {
+
+class GameObject;
+class Mesh;
+class ShaderProgram;
+class UniformBufferRing;
+struct MaterialUniforms;
+
+///
+/// \brief Collects the draw items of a frame, orders them by 64-bit sort keys and
+///        submits them with consecutive items sharing geometry and material merged
+///        into instanced draw calls.
+///
+/// From the most significant bit, opaque keys hold the pass and its layer, a translucency bit, the
+/// shader, the material, the vertex array and the depth so that state changes are
+/// minimized and ties are drawn front to back. Translucent keys hold the pass and its
+/// layer, the translucency bit and the inverted depth ahead of the state so that
+/// translucent items are drawn back to front after all opaque items.
+///
+/// Passes are split into layers that are rendered separately, e.g. for every cascade
+/// of the shadow map.
+///
+class RenderQueue {
+public:
+    enum class Pass : unsigned int {
+        STATIC_SHADOW = 0, ///< Casters cached in the static layer of the shadow map
+        SHADOW = 1,
+        WORLD = 2,
+        NUM_PASSES
+    };
+
+    static constexpr unsigned int maxLayers = 4;
+
+    ///
+    /// \brief Per-draw data of items drawn with materials, laid out as the std140
+    ///        DrawUB uniform block.
+    ///
+    struct DrawUniforms {
+        float specularExponent = 0.0f;
+        float padding[3] = {};
+    };
+
+    struct Statistics {
+        unsigned int numInstances = 0;
+        unsigned int numDrawCalls = 0;
+        unsigned int numShaderChanges = 0;
+        unsigned int numMaterialChanges = 0; ///< Times textures were bound for a draw call
+    };
+
+    ///
+    /// \brief clear Removes all draw items.
+    ///
+    void clear();
+
+    ///
+    /// \brief add Adds every mesh of a game object as a draw item.
+    ///
+    /// Game objects that are not instanceable are added as a single item that is drawn
+    /// through GameObject::render, or GameObject::renderShadow in the shadow passes.
+    ///
+    /// \param pass Render pass to draw the game object in.
+    /// \param gameObject Game object to draw. Must outlive the next call to RenderQueue::clear().
+    /// \param shader Shader program to draw with.
+    /// \param uniforms Material uniforms of shader, or nullptr to draw without materials.
+    /// \param depth Distance of the game object from the viewer.
+    /// \param translucent Translucent items are drawn back to front after all opaque items
+    ///                    with depth writes disabled. Blending must be enabled by the caller.
+    /// \param lod Level of detail of the game object's meshes to draw.
+    /// \param layer Layer of the pass, less than RenderQueue::maxLayers.
+    ///
+    void add(Pass pass, GameObject *gameObject, ShaderProgram *shader,
+             const MaterialUniforms *uniforms, float depth, bool translucent=false,
+             unsigned int lod=0, unsigned int layer=0);
+
+    ///
+    /// \brief add Adds every mesh of an instance as a draw item, e.g. of a game object
+    ///            captured into a render snapshot.
+    /// \param meshes Meshes to draw. Must outlive the next call to RenderQueue::clear().
+    /// \param instance Per-instance vertex attributes.
+    /// \param specularExponent Specular exponent of the instance's material.
+    ///
+    /// See the overload taking a game object for the other parameters.
+    ///
+    void add(Pass pass, const std::vector<Mesh> &meshes, const VertexArray::Instance &instance,
+             float specularExponent, ShaderProgram *shader, const MaterialUniforms *uniforms,
+             float depth, bool translucent=false, unsigned int lod=0, unsigned int layer=0);
+
+    ///
+    /// \brief sort Radix sorts all draw items by their sort keys.
+    ///
+    void sort();
+
+    ///
+    /// \brief writeDrawUniforms Begins a frame of a ring sized for the DrawUniforms of all
+    ///                          items drawn with materials, writes them into it and flushes
+    ///                          it. The ring is bound to the DrawUniforms of each draw call
+    ///                          when rendering.
+    /// \param ring Ring to write into.
+    ///
+    void writeDrawUniforms(UniformBufferRing &ring);
+
+    ///
+    /// \brief render Submits the sorted draw items of a layer of a pass.
+    /// \param pass Render pass to submit.
+    /// \param useShader Called to make a shader program current and set its per-pass
+    ///                  uniforms whenever consecutive items use different shaders.
+    /// \param layer Layer of the pass to submit.
+    ///
+    void render(Pass pass, const std::function<void(ShaderProgram*)> &useShader,
+                unsigned int layer=0);
+
+    ///
+    /// \brief getStatistics Returns the number of instances, draw calls, shader changes and
+    ///                      material changes submitted by the last render call of a layer
+    ///                      of a pass.
+    ///
+    Statistics getStatistics(Pass pass, unsigned int layer=0) const;
+
+private:
+    struct Item {
+        GameObject *gameObject; // Only set for game objects that aren't instanceable
+        const Mesh *mesh; // nullptr for game objects that aren't instanceable
+        ShaderProgram *shader;
+        const MaterialUniforms *uniforms;
+        VertexArray::Instance instance;
+        float specularExponent;
+        uint32_t shaderId;
+        uint32_t materialId;
+        uint32_t vaoId;
+        uint32_t drawUniformsOffset;
+        bool translucent;
+        unsigned int lod;
+    };
+
+    struct SortEntry {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    static uint64_t getPassBits(Pass pass, unsigned int layer);
+
+    void push(const Item &item, uint64_t passBits, float depth);
+
+    uint32_t getShaderId(ShaderProgram *shader);
+    uint32_t getMaterialId(const Mesh &mesh, float specularExponent);
+    uint32_t getVertexArrayId(VertexArray *vao);
+
+    bool canMerge(const Item &a, const Item &b) const;
+
+    std::vector<Item> items;
+    std::vector<SortEntry> sortEntries;
+    std::vector<SortEntry> sortScratch;
+    std::vector<VertexArray::Instance> mergedInstances;
+
+    // Per-frame IDs of the states encoded into sort keys
+    std::unordered_map<ShaderProgram*, uint32_t> shaderIds;
+    std::unordered_map<uint64_t, uint32_t> materialIds; // Texture set ID and specular exponent bits
+    std::unordered_map<VertexArray*, uint32_t> vaoIds;
+
+    const UniformBufferRing *drawUniformRing = nullptr;
+    std::unordered_map<float, uint32_t> drawUniformsOffsets;
+
+    std::array<Statistics, static_cast<size_t>(Pass::NUM_PASSES) * maxLayers> statistics;
+};
+
+inline RenderQueue::Statistics RenderQueue::getStatistics(Pass pass, unsigned int layer) const {
+    return this->statistics[getPassBits(pass, layer)];
+}
+
+} // namespace age
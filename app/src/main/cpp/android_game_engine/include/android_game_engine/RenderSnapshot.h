@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "AABBTree.h"
+#include "GameObject.h"
+#include "OcclusionCuller.h"
+#include "PhysicsDebugDrawer.h"
+#include "VertexArray.h"
+
+namespace age {
+
+///
+/// \brief Everything Game renders a frame from, captured after an update so that the
+///        frame can be rendered while the next update runs on another thread.
+///
+struct RenderSnapshot {
+    ///
+    /// \brief Object of Game's world list at the same index. Objects that aren't instanceable
+    ///        are drawn through the world list, see Game::addToRenderQueue.
+    ///
+    struct Object {
+        std::shared_ptr<const GameObject::Meshes> meshes;
+        VertexArray::Instance instance;
+        glm::vec3 position;
+        glm::vec3 boundingBoxExtents;
+        float specularExponent;
+        unsigned int numLods;
+        bool instanceable;
+        bool loaded;
+        bool simulated; ///< Has an active physics body with mass
+    };
+
+    struct Occluder {
+        std::shared_ptr<const OccluderMesh> mesh;
+        glm::mat4 model;
+    };
+
+    struct Camera {
+        glm::vec3 position;
+        glm::mat4 view;
+        glm::mat4 projection;
+        float nearPlane;
+        float farPlane;
+    };
+
+    struct Light {
+        glm::vec3 position;
+        glm::vec3 direction;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+    };
+
+    unsigned int updateNumber = 0; ///< Zero until the first update was captured
+    std::chrono::steady_clock::time_point updateBegin;
+    std::chrono::steady_clock::time_point updateEnd;
+
+    // Fixed timestep steps run by the update, see Game::setFixedTimestep
+    unsigned int numSteps = 1;
+    float interpolation = 1.0f; ///< Fraction of a step transforms were interpolated from the previous step
+    std::chrono::duration<float> droppedDuration {0.0f}; ///< Time beyond the catch-up budget that wasn't simulated
+
+    unsigned int worldListVersion = 0;    ///< Changes when the world list is cleared
+    unsigned int staticShadowVersion = 0; ///< Changes when the static shadows are invalidated
+
+    Camera camera;
+    Light light;
+    AABB worldListBounds;
+    std::vector<Object> worldList;
+    std::vector<Occluder> occluders;
+    std::vector<PhysicsDebugDrawer::LineVertex> physicsDebugLines;
+};
+
+} // namespace age
@@ -10,8 +10,31 @@ namespace age {
 
 class Shader {
 public:
+    ///
+    /// \brief Loads and compiles a shader.
+    /// \param filepath Filepath of the shader.
+    /// \param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
+    /// \exception age::LoadError Failed to read the shader.
+    /// \exception age::BuildError Failed to compile the shader.
+    ///
     Shader(const std::string &filepath, GLenum type);
 
+    ///
+    /// \brief Compiles a shader from source code that was already loaded.
+    /// \param filepath Filepath the source code was loaded from, for error messages.
+    /// \param source Source code of the shader.
+    /// \param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
+    /// \exception age::BuildError Failed to compile the shader.
+    ///
+    Shader(const std::string &filepath, const std::string &source, GLenum type);
+
+    ///
+    /// \brief loadSource Reads the source code of a shader.
+    /// \param filepath Filepath of the shader.
+    /// \exception age::LoadError Failed to read the shader.
+    ///
+    static std::string loadSource(const std::string &filepath);
+
     void attachToProgram(unsigned int program);
     void detachFromProgram(unsigned int program);
 
@@ -2,14 +2,18 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include <GLES3/gl32.h>
 
 #include <glm/fwd.hpp>
 
+#include "UniformHandle.h"
+
 namespace age {
 
 class UniformBuffer;
+class UniformBufferRing;
 
 ///
 /// \brief Manages loading, compiling, linking and working with shader programs.
@@ -19,8 +23,18 @@ class ShaderProgram
 public:
     ///
     /// \brief Loads, compiles, and links given shaders into an OpenGL shader program.
+    ///
+    /// The active uniforms and uniform blocks of the linked program are reflected once
+    /// so that later lookups by name don't query OpenGL.
+    ///
+    /// When ProgramBinaryCache is enabled, the binary linked on a previous launch is loaded
+    /// instead of compiling and linking the shaders. Otherwise, or if the driver rejects the
+    /// binary, the shaders are compiled and the linked binary is written to the cache on a
+    /// worker thread.
+    ///
     /// \param[in] vertexShaderPath Filepath of the vertex shader.
     /// \param[in] fragmentShaderPath Filepath of the fragment shader.
+    /// \exception age::LoadError Failed to read shaders.
     /// \exception age::BuildError Failed to compile or link shaders.
     ///
     ShaderProgram(const std::string &vertexShaderPath,
@@ -32,7 +46,7 @@ public:
     ///
     /// \brief Sets this program as the current active shader program.
     ///
-    /// This is a helper function that calls glUseProgram() on this shader program.
+    /// This is a helper function that calls GLState::useProgram() on this shader program.
     ///
     void use();
     
@@ -49,17 +63,55 @@ public:
     void setUniform(const std::string &name, const glm::vec4 &v);
     void setUniform(const std::string &name, const glm::mat3 &m);
     void setUniform(const std::string &name, const glm::mat4 &m);
+
+    void setUniform(UniformHandle<bool> handle, bool value);
+    void setUniform(UniformHandle<int> handle, int value);
+    void setUniform(UniformHandle<float> handle, float value);
+    void setUniform(UniformHandle<glm::vec2> handle, const glm::vec2 &v);
+    void setUniform(UniformHandle<glm::vec3> handle, const glm::vec3 &v);
+    void setUniform(UniformHandle<glm::vec4> handle, const glm::vec4 &v);
+    void setUniform(UniformHandle<glm::mat3> handle, const glm::mat3 &m);
+    void setUniform(UniformHandle<glm::mat4> handle, const glm::mat4 &m);
     ///@}
 
+    ///
+    /// \brief getUniformLocation Returns the location of an active uniform.
+    /// \param name Name of the uniform. Array elements may be named with or without
+    ///             a subscript, e.g. "lights" and "lights[0]" are equivalent.
+    /// \return The uniform location or -1 if the uniform is not active.
+    ///
+    int getUniformLocation(const std::string &name) const;
+
+    ///
+    /// \brief getUniformHandle Returns a typed handle to an active uniform that can be held
+    ///                         by callers to set the uniform without any string lookups.
+    /// \param name Name of the uniform.
+    /// \return The uniform handle, which is invalid if the uniform is not active.
+    ///
+    template<typename T>
+    UniformHandle<T> getUniformHandle(const std::string &name) const;
+
     ///
     /// \brief setUniformBlockBinding Links the uniform block of this shader to the binding point
     ///                               of the specified ubo.
     /// \param ubo Uniform Buffer Object to link against.
     ///
     void setUniformBlockBinding(const UniformBuffer &ubo);
+    void setUniformBlockBinding(const UniformBufferRing &ubo);
     
 private:
+    void reflect();
+    void setUniformBlockBinding(const std::string &uniformBlockName, unsigned int bindingPoint);
+
     std::unique_ptr<unsigned int, std::function<void(unsigned int *)>> program;
+
+    std::unordered_map<std::string, int> uniformLocations;
+    std::unordered_map<std::string, unsigned int> uniformBlockIndices;
 };
 
+template<typename T>
+inline UniformHandle<T> ShaderProgram::getUniformHandle(const std::string &name) const {
+    return UniformHandle<T>(this->getUniformLocation(name));
+}
+
 } // namespace age
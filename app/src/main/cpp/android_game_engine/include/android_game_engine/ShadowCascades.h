@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "AABBTree.h"
+
+namespace age {
+
+///
+/// \brief Splits the view frustum of a camera into slices that are each covered by a
+///        cascade of the shadow map so that shadows close to the camera get most texels.
+///
+/// The light projection of every cascade is fitted to the bounding sphere of its slice so
+/// that its size doesn't change as the camera turns, and is moved by whole shadow map
+/// texels so that shadow edges don't shimmer as the camera moves.
+///
+class ShadowCascades {
+public:
+    static constexpr unsigned int maxCascades = 4;
+
+    ///
+    /// \brief ShadowCascades constructor.
+    /// \param numCascades Number of cascades between 1 and ShadowCascades::maxCascades.
+    /// \param resolution Width and height of the shadow map of every cascade in texels.
+    /// \param shadowDistance Distance from the camera up to which shadows are drawn when
+    ///                       it's closer than the camera's far plane.
+    /// \param splitWeight Blends the split distances between uniform (0.0) and logarithmic (1.0).
+    ///
+    explicit ShadowCascades(unsigned int numCascades=3, unsigned int resolution=1024,
+                            float shadowDistance=50.0f, float splitWeight=0.75f);
+
+    unsigned int getNumCascades() const;
+    unsigned int getResolution() const;
+
+    void setShadowDistance(float shadowDistance);
+    float getShadowDistance() const;
+
+    ///
+    /// \brief update Fits the cascades to the view frustum of a camera.
+    /// \param projectionView Projection view matrix of the camera.
+    /// \param nearPlane Distance to the camera's near plane.
+    /// \param farPlane Distance to the camera's far plane.
+    /// \param lightDirection Direction the light is shining in.
+    /// \param casterBounds Box enclosing all shadow casters. The light projections extend
+    ///                     towards the light to include casters outside the view frustum.
+    ///
+    void update(const glm::mat4 &projectionView, float nearPlane, float farPlane,
+                const glm::vec3 &lightDirection, const AABB &casterBounds);
+
+    ///
+    /// \brief getLightSpaceMatrix Returns the projection view matrix of the light for a cascade.
+    ///
+    const glm::mat4& getLightSpaceMatrix(unsigned int cascade) const;
+
+    ///
+    /// \brief getSplitDistance Returns the distance from the camera to the far end of the
+    ///                         slice covered by a cascade.
+    ///
+    float getSplitDistance(unsigned int cascade) const;
+
+private:
+    unsigned int numCascades;
+    unsigned int resolution;
+    float shadowDistance;
+    float splitWeight;
+
+    std::array<glm::mat4, maxCascades> lightSpaceMatrices;
+    std::array<float, maxCascades> splitDistances;
+};
+
+inline unsigned int ShadowCascades::getNumCascades() const {return this->numCascades;}
+inline unsigned int ShadowCascades::getResolution() const {return this->resolution;}
+inline void ShadowCascades::setShadowDistance(float shadowDistance) {this->shadowDistance = shadowDistance;}
+inline float ShadowCascades::getShadowDistance() const {return this->shadowDistance;}
+inline const glm::mat4& ShadowCascades::getLightSpaceMatrix(unsigned int cascade) const {return this->lightSpaceMatrices[cascade];}
+inline float ShadowCascades::getSplitDistance(unsigned int cascade) const {return this->splitDistances[cascade];}
+
+} // namespace age
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <vector>
+
 namespace age {
 
 ///
 /// \brief Implements depth mapping for generating shadows.
 ///
+/// The shadow map is a 2D array texture with a layer for every shadow cascade. It only has
+/// depth attachments, sampled with hardware depth comparison through a sampler2DArrayShadow.
+/// Casters that don't move are drawn into a separate static layer for every cascade,
+/// which is only redrawn when it's invalidated and is copied into the shadow map every
+/// frame before the moving casters are drawn over it.
+///
 class ShadowMap {
 public:
-    ShadowMap(unsigned int width, unsigned int height);
+    ShadowMap(unsigned int width, unsigned int height, unsigned int numCascades=1);
 
     ~ShadowMap();
 
@@ -16,16 +24,32 @@ public:
 
     unsigned int getWidth() const;
     unsigned int getHeight() const;
+    unsigned int getNumCascades() const;
+
+    ///
+    /// \brief Sets the current framebuffer to the one associated with the static layer
+    ///        of a cascade.
+    ///
+    /// This should be used to redraw the static casters after the static layer was cleared.
+    ///
+    void bindStaticFramebuffer(unsigned int cascade);
 
     ///
-    /// \brief Sets the current framebuffer to the one associated with the shadow map.
+    /// \brief Copies the static layer of a cascade into the shadow map and sets the current
+    ///        framebuffer to the one associated with the cascade.
     ///
-    /// This should be used for the first pass in drawing game objects to calculate the depth map.
+    /// This should be used for the first pass in drawing the moving game objects over the
+    /// static casters to calculate the depth map.
     ///
-    void bindFramebuffer();
+    /// \param cascade Cascade to draw.
+    /// \param copyStaticLayer Whether to start from the static layer. Otherwise the layer is
+    ///                        cleared, for cascades whose static casters are drawn with the others.
+    ///
+    void bindFramebuffer(unsigned int cascade, bool copyStaticLayer=true);
 
     ///
-    /// \brief Binds the generated depth map as a GL_TEXTURE_2D texture.
+    /// \brief Binds the generated depth maps as a GL_TEXTURE_2D_ARRAY texture that compares
+    ///        the reference depth to the stored depth when sampled.
     ///
     /// This should be used on the 2nd pass after generating the depth map to use for calculating
     /// and drawing shadows.
@@ -36,12 +60,15 @@ private:
     unsigned int width;
     unsigned int height;
 
-    unsigned int fbo;
-    unsigned int colorBuffer;
-    unsigned int depthStencilBuffer;
+    unsigned int depthBuffer;
+    std::vector<unsigned int> fbos;
+
+    unsigned int staticDepthBuffer;
+    std::vector<unsigned int> staticFbos;
 };
 
 inline unsigned int ShadowMap::getWidth() const {return this->width;}
 inline unsigned int ShadowMap::getHeight() const {return this->height;}
+inline unsigned int ShadowMap::getNumCascades() const {return static_cast<unsigned int>(this->fbos.size());}
 
-} // namespace age
\ No newline at end of file
+} // namespace age
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <array>
+#include <memory>
 #include <string>
 
+#include "AssetLoader.h"
+
 namespace age {
 
 class ShaderProgram;
@@ -13,11 +17,17 @@ class Skybox {
 public:
     ///
     /// \brief Skybox Creates a cubemap for a skybox.
+    ///
+    /// Skyboxes loaded asynchronously are grey until the cube map has been decoded on a
+    /// worker thread and uploaded by AssetLoader::processUploads.
+    ///
     /// \param imageFilepaths 6 images for each side of the skybox in the order of:
     ///                       front, back, right, left, top, bottom
+    /// \param mode Whether to load the images before returning or in the background.
     /// \exception age::LoadError Failed to load texture data from image file.
     ///
-    explicit Skybox(const std::array<std::string, 6> &imageFilepaths);
+    explicit Skybox(const std::array<std::string, 6> &imageFilepaths,
+                    LoadMode mode=LoadMode::SYNCHRONOUS);
     ~Skybox();
 
     Skybox(Skybox &&) noexcept = default;
@@ -28,7 +38,7 @@ public:
 private:
     unsigned int vao;
     unsigned int vbo;
-    unsigned int texture;
+    std::shared_ptr<unsigned int> texture;
 };
 
 } // namespace age
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
 #include <glm/fwd.hpp>
 
+#include "AssetLoader.h"
+
 namespace age {
 
 ///
@@ -16,17 +19,28 @@ public:
     ///
     /// \brief loadTexture Loads and caches texture data from image file.
     ///
-    /// Texture2D object will automatically clean up cache and GPU data on
-    /// destruction. Do NOT call glDeleteTextures on this texture's id.
+    /// Textures are made resident through ManagerResources, which keeps them cached once
+    /// no Texture2D uses them and cleans up their GPU data when they're evicted.
+    /// Do NOT call glDeleteTextures on this texture's id.
+    ///
+    /// Textures loaded asynchronously are a single white texel until the image has been
+    /// decoded on a worker thread and uploaded by AssetLoader::processUploads. Their ID
+    /// doesn't change once uploaded. Failures are logged instead of thrown.
     ///
     /// \param imageFilepath Filepath to the image.
+    /// \param mode Whether to load the image before returning or in the background.
     /// \exception age::LoadError Failed to load image data from file.
     ///
-    explicit Texture2D(const std::string &imageFilepath);
+    explicit Texture2D(const std::string &imageFilepath, LoadMode mode=LoadMode::SYNCHRONOUS);
     
     ///
     /// \brief Creates a 2D texture of a solid color.
     ///
+    /// Solid color textures form a palette: colors that are equal once quantized to
+    /// 8 bits per channel share the same 1x1 texture and therefore the same ID, so
+    /// meshes using them share a material and can be drawn together. Prefer a white
+    /// texture tinted through GameObject::setColor for objects that only differ in color.
+    ///
     /// \param color RGB values between 0.0 and 1.0
     ///
     explicit Texture2D(const glm::vec3 &color);
@@ -34,10 +48,24 @@ public:
     ///
     /// \brief bind Binds this texture to the GPU for rendering.
     ///
-    void bind();
+    void bind() const;
+
+    ///
+    /// \brief getId Returns the OpenGL texture ID. Textures loaded from the same
+    ///              image share the same ID.
+    ///
+    unsigned int getId() const;
+
+    ///
+    /// \brief getNumTextures Returns the number of OpenGL textures currently resident,
+    ///                       including cached and solid color textures.
+    ///
+    static size_t getNumTextures();
 
 private:
     std::shared_ptr<unsigned int> id;
 };
 
+inline unsigned int Texture2D::getId() const {return *this->id;}
+
 } // namespace age
\ No newline at end of file
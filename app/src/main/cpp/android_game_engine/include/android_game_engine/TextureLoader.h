@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * Loads precompressed textures that were transcoded offline into KTX files and decodes
+ * source images. Loading and decoding don't call OpenGL so they can run on worker
+ * threads while only the uploads run on the GL thread.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ktx.h"
+
+namespace age {
+namespace TextureLoader {
+
+///
+/// \brief Decoded 8-bit image.
+///
+struct Image {
+    int width = 0;
+    int height = 0;
+    unsigned int format = 0; ///< GL_ALPHA, GL_RGB or GL_RGBA
+    std::vector<uint8_t> pixels;
+};
+
+///
+/// \brief getKtxFilepath Returns the filepath of the KTX file transcoded from a source image,
+///                       the image's filepath with its extension replaced by .ktx.
+///
+std::string getKtxFilepath(const std::string &imageFilepath);
+
+///
+/// \brief loadKtx Loads the KTX file transcoded from a source image.
+/// \param imageFilepath Filepath to the source image.
+/// \return The KTX texture or nullptr if the source image was not transcoded.
+/// \exception age::LoadError The KTX file is invalid.
+///
+std::unique_ptr<KtxTexture> loadKtx(const std::string &imageFilepath);
+
+///
+/// \brief uploadKtx Uploads every mipmap level and face of a KTX texture to the texture bound
+///                  to target without decoding or generating mipmaps on the device.
+/// \param target GL_TEXTURE_2D, or GL_TEXTURE_CUBE_MAP for textures with 6 faces.
+/// \param texture Texture to upload.
+/// \return False if the texture was rejected, such as for compressed formats the device
+///         doesn't support.
+///
+bool uploadKtx(unsigned int target, const KtxTexture &texture);
+
+///
+/// \brief getSize Returns the number of bytes of all mipmap levels and faces of a KTX texture.
+///
+size_t getSize(const KtxTexture &texture);
+
+///
+/// \brief loadImage Decodes an image.
+/// \param imageFilepath Filepath to the image.
+/// \param flipVertically Flip the image so that its first row is the bottom row.
+/// \exception age::LoadError Failed to load image data from file.
+///
+Image loadImage(const std::string &imageFilepath, bool flipVertically);
+
+///
+/// \brief uploadImage Uploads a decoded image to level 0 of the texture bound to target.
+/// \param target GL_TEXTURE_2D or a cube map face.
+/// \param image Image to upload.
+///
+void uploadImage(unsigned int target, const Image &image);
+
+} // namespace TextureLoader
+} // namespace age
@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ * Singleton CPU trace of the engine's hot paths, exported as Chrome trace JSON that
+ * chrome://tracing and ui.perfetto.dev open.
+ *
+ * Scopes marked with AGE_TRACE_SCOPE are recorded as complete events into a ring buffer
+ * owned by the thread that ran them. Threads only write their own ring, without locks, so
+ * a scope costs two timestamps and a few stores. On arm64 timestamps are read from the
+ * virtual counter the steady clock is based on and converted to time when exported.
+ * Once a ring is full its oldest events are overwritten, and exporting the full ring of
+ * another running thread drops the oldest event too since the thread may be overwriting it.
+ * Rings of threads that exited are reused by new threads, without their events.
+ *
+ * Tracing is off until enabled with Trace::setEnabled, which also records the scopes of
+ * the network library. Building with the CMake option AGE_TRACE off compiles the scopes
+ * out entirely.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace age {
+namespace Trace {
+
+using Clock = std::chrono::steady_clock;
+
+///
+/// \brief Timestamp of a scope, in counter ticks on arm64 and in nanoseconds of the
+///        steady clock elsewhere.
+///
+using Ticks = uint64_t;
+
+constexpr size_t maxEventsPerThread = 16384;
+
+///
+/// \brief setEnabled Starts or stops recording scopes. Events already recorded are kept.
+///
+void setEnabled(bool enabled);
+bool isEnabled();
+
+///
+/// \brief setThreadName Names the calling thread in the exported trace.
+///
+void setThreadName(const std::string &name);
+
+///
+/// \brief record Records a complete event into the calling thread's ring.
+/// \param name Name of the event. It isn't copied, so it must outlive the trace,
+///             e.g. a string literal.
+/// \param begin Time the event began.
+/// \param end Time the event ended.
+///
+void record(const char *name, Clock::time_point begin, Clock::time_point end);
+void record(const char *name, Ticks begin, Ticks end);
+
+///
+/// \brief now Returns the current timestamp.
+///
+inline Ticks now();
+
+///
+/// \brief clear Removes all recorded events.
+///
+void clear();
+
+///
+/// \brief exportChromeJson Returns the recorded events of all threads in the Chrome
+///                         trace event format.
+///
+std::string exportChromeJson();
+
+///
+/// \brief writeChromeJson Writes the recorded events to a file in the Chrome trace event
+///                        format. Failures are logged.
+/// \return Whether the file was written.
+///
+bool writeChromeJson(const std::string &filepath);
+
+///
+/// \brief Records the enclosing scope if tracing is enabled when it's entered.
+///
+class Scope {
+public:
+    explicit Scope(const char *name);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope& operator=(const Scope &) = delete;
+
+private:
+    const char *name; ///< nullptr while tracing is disabled
+    Ticks begin;
+};
+
+inline Ticks now() {
+#if defined(__aarch64__)
+    // Skips the conversion and retry loop of clock_gettime, which cost more than the rest of a scope
+    Ticks ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<Ticks>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline Scope::Scope(const char *name) : name(isEnabled() ? name : nullptr) {
+    if (this->name != nullptr) this->begin = now();
+}
+
+inline Scope::~Scope() {
+    if (this->name != nullptr) record(this->name, this->begin, now());
+}
+
+} // namespace Trace
+} // namespace age
+
+#define AGE_TRACE_CONCAT_IMPL(a, b) a##b
+#define AGE_TRACE_CONCAT(a, b) AGE_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef AGE_TRACE
+#define AGE_TRACE_SCOPE(name) ::age::Trace::Scope AGE_TRACE_CONCAT(ageTraceScope, __LINE__)(name)
+#else
+#define AGE_TRACE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace age {
+
+///
+/// \brief Hands the latest of a stream of values from one producer thread to one consumer
+///        thread without locks or waiting.
+///
+/// The producer fills the write buffer and publishes it, which swaps it with the middle
+/// buffer. The consumer acquires the middle buffer once a newer value was published, which
+/// swaps it with the read buffer. Neither thread touches the other's buffer, so values that
+/// are published faster than they are acquired are dropped.
+///
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer& operator=(const TripleBuffer &) = delete;
+
+    ///
+    /// \brief getWriteBuffer Returns the buffer filled by the producer. It holds an older
+    ///                       value, which must be overwritten.
+    ///
+    T& getWriteBuffer();
+
+    ///
+    /// \brief publish Makes the write buffer the latest value. Called by the producer.
+    ///
+    void publish();
+
+    ///
+    /// \brief acquire Makes the latest published value the read buffer. Called by the consumer.
+    /// \return Whether a value was published since the last call.
+    ///
+    bool acquire();
+
+    ///
+    /// \brief getReadBuffer Returns the buffer read by the consumer.
+    ///
+    const T& getReadBuffer() const;
+
+private:
+    // The middle index is stored with a bit telling whether it was published since it was last acquired
+    static constexpr uint8_t indexMask = 3u;
+    static constexpr uint8_t publishedBit = 4u;
+
+    std::array<T, 3> buffers;
+    uint8_t writeIndex = 0u;
+    std::atomic<uint8_t> middleIndex {1u};
+    uint8_t readIndex = 2u;
+};
+
+template<typename T>
+inline T& TripleBuffer<T>::getWriteBuffer() {return this->buffers[this->writeIndex];}
+
+template<typename T>
+inline void TripleBuffer<T>::publish() {
+    this->writeIndex = this->middleIndex.exchange(this->writeIndex | publishedBit,
+                                                  std::memory_order_acq_rel) & indexMask;
+}
+
+template<typename T>
+inline bool TripleBuffer<T>::acquire() {
+    if ((this->middleIndex.load(std::memory_order_relaxed) & publishedBit) == 0u) return false;
+
+    this->readIndex = this->middleIndex.exchange(this->readIndex, std::memory_order_acq_rel) & indexMask;
+    return true;
+}
+
+template<typename T>
+inline const T& TripleBuffer<T>::getReadBuffer() const {return this->buffers[this->readIndex];}
+
+} // namespace age
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+#include <GLES3/gl32.h>
 
 namespace age {
 
@@ -48,4 +51,93 @@ private:
     unsigned int bindingPoint;
 };
 
+///
+/// \brief Uniform buffer object for data written every frame, such as per-draw data.
+///
+/// The buffer is split into regions for consecutive frames. The region of a frame is
+/// mapped once and written through the mapped pointer without synchronizing with the GPU,
+/// which is safe because a fence placed after the frame's draw calls is waited on before
+/// its region is reused. Data is bound per draw with glBindBufferRange.
+///
+class UniformBufferRing {
+public:
+    ///
+    /// \brief UniformBufferRing Creates a ring uniform buffer object linked against a
+    ///                          generated binding point.
+    /// \param uniformBlockName Name of the uniform block the data is bound to.
+    /// \param frameSize_bytes Initial number of bytes that can be written each frame. Frame
+    ///                        regions grow when a frame needs more.
+    /// \param numFrames Number of frames that can be in flight.
+    ///
+    UniformBufferRing(const std::string &uniformBlockName, unsigned int frameSize_bytes,
+                      unsigned int numFrames=3);
+
+    ~UniformBufferRing();
+
+    UniformBufferRing(const UniformBufferRing &) = delete;
+    UniformBufferRing& operator=(const UniformBufferRing &) = delete;
+
+    std::string getUniformBlockName() const;
+    unsigned int getBindingPoint() const;
+
+    ///
+    /// \brief getAlignedSize Returns the number of bytes a push takes in a frame's region.
+    /// \param size_bytes Size in bytes of the pushed data.
+    ///
+    unsigned int getAlignedSize(unsigned int size_bytes) const;
+
+    ///
+    /// \brief beginFrame Fences the previous frame's region, then waits for the GPU to
+    ///                   finish with the next region and maps the bytes to write in it.
+    ///
+    /// Regions are reallocated larger when they are smaller than the bytes to write. If the
+    /// GPU doesn't release the next region within a second, e.g. because it hung, the buffer
+    /// is orphaned instead of waiting longer. This must be called after all draw calls using
+    /// data of the previous frame.
+    ///
+    /// \param size_bytes Number of bytes pushed this frame, see getAlignedSize.
+    ///
+    void beginFrame(unsigned int size_bytes);
+
+    ///
+    /// \brief push Copies data into the current frame's region.
+    /// \param data Pointer to data to copy.
+    /// \param size_bytes Size in bytes of the data.
+    /// \return Offset in bytes of the data to bind with UniformBufferRing::bind.
+    /// \exception age::Error More bytes were pushed than passed to beginFrame.
+    ///
+    unsigned int push(const void *data, unsigned int size_bytes);
+
+    ///
+    /// \brief flush Unmaps the current frame's region. This must be called before any
+    ///              draw call using data pushed this frame.
+    ///
+    void flush();
+
+    ///
+    /// \brief bind Binds pushed data to the binding point of this object.
+    ///
+    void bind(unsigned int offset_bytes, unsigned int size_bytes) const;
+
+private:
+    ///
+    /// \brief resize Reallocates the buffer with regions of at least a number of bytes.
+    ///
+    void resize(unsigned int frameSize_bytes);
+
+    std::string uniformBlockName;
+    unsigned int ubo;
+    unsigned int bindingPoint;
+
+    unsigned int offsetAlignment;
+    unsigned int frameSize;
+    unsigned int mappedSize = 0;
+
+    std::vector<GLsync> fences;
+    unsigned int frame;
+    unsigned int frameOffset = 0;
+    bool frameStarted = false;
+    unsigned char *mappedFrame = nullptr;
+};
+
 } // namespace age
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace age {
+
+///
+/// \brief Pre-resolved location of a uniform of type T in a shader program.
+///
+/// Handles are obtained once through ShaderProgram::getUniformHandle() and
+/// passed to ShaderProgram::setUniform() so that no string lookups are done
+/// when setting uniform values on every frame.
+///
+template<typename T>
+class UniformHandle {
+public:
+    UniformHandle() = default;
+    explicit UniformHandle(int location);
+
+    ///
+    /// \brief isValid Returns whether the uniform is active in the shader program.
+    ///
+    bool isValid() const;
+
+    int getLocation() const;
+
+private:
+    int location = -1;
+};
+
+template<typename T>
+inline UniformHandle<T>::UniformHandle(int location) : location(location) {}
+
+template<typename T>
+inline bool UniformHandle<T>::isValid() const {return this->location != -1;}
+
+template<typename T>
+inline int UniformHandle<T>::getLocation() const {return this->location;}
+
+} // namespace age
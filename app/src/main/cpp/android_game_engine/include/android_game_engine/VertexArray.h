@@ -2,33 +2,78 @@
 
 #include <vector>
 
-#include <glm/fwd.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "VertexLayout.h"
 
 namespace age {
 
     ///
     /// \brief Wrapper class for OpenGL Vertex Array Object.
     ///
+    /// Each vertex array also owns a per-instance attribute buffer so that
+    /// the same geometry can be drawn many times in a single instanced draw call.
+    ///
     class VertexArray {
     public:
+        ///
+        /// \brief Per-instance vertex attributes.
+        ///
+        /// Bound to attribute locations 3-6 (model), 7-9 (normal) and 10 (color).
+        ///
+        struct Instance {
+            glm::mat4 model;
+            glm::mat3 normal;
+            glm::vec3 color;
+        };
+
+        ///
+        /// \brief VertexArray Uploads interleaved vertex data and indices to the GPU.
+        ///
+        /// Indices are stored as 16-bit integers when there are at most 65535 vertices.
+        ///
+        /// \param positions Vertex positions.
+        /// \param normals Vertex normals.
+        /// \param textureCoordinates Vertex texture coordinates.
+        /// \param indices Vertex indices of the triangles.
+        /// \param layout Storage formats of the vertex attributes.
+        ///
         VertexArray(const std::vector<glm::vec3> &positions,
                     const std::vector<glm::vec3> &normals,
                     const std::vector<glm::vec2> &textureCoordinates,
-                    const std::vector<glm::uvec3> &indices);
+                    const std::vector<glm::uvec3> &indices,
+                    const VertexLayout &layout=VertexLayout());
 
         ~VertexArray();
 
-        VertexArray(VertexArray &&) noexcept = default;
-        VertexArray& operator=(VertexArray &&) noexcept = default;
+        ///
+        /// \brief VertexArray Takes over the GL objects of other, which is left without any.
+        ///
+        VertexArray(VertexArray &&other) noexcept;
+
+        ///
+        /// \brief operator= Swaps the GL objects with other, whose destructor deletes the previous ones.
+        ///
+        VertexArray& operator=(VertexArray &&other) noexcept;
 
-        void render();
+        ///
+        /// \brief render Draws the vertex array once for each instance.
+        /// \param instances Per-instance attributes to stream to the GPU.
+        /// \param numInstances Number of elements in instances.
+        ///
+        void render(const Instance *instances, size_t numInstances);
 
     private:
         unsigned int vao;
         unsigned int vbo;
         unsigned int ebo;
+        unsigned int instanceVbo;
 
         size_t numIndices;
+        unsigned int indexType;
+        size_t instanceCapacity;
     };
 
 } // namespace age
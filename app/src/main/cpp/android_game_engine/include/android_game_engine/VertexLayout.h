@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace age {
+
+///
+/// \brief Describes the storage formats of the vertex attributes of an interleaved
+///        vertex buffer.
+///
+/// Every vertex stores its position (attribute location 0), normal (location 1) and
+/// texture coordinates (location 2) in that order, each aligned to 4 bytes. The default
+/// layout packs a vertex into 20 bytes instead of the 32 bytes of planar float arrays.
+///
+struct VertexLayout {
+    enum class PositionFormat {
+        FLOAT3,
+        HALF4 // w is padding so that the next attribute stays aligned
+    };
+
+    enum class NormalFormat {
+        FLOAT3,
+        INT_2_10_10_10_REV // Signed normalized, normals are normalized when packed
+    };
+
+    enum class TextureCoordinateFormat {
+        FLOAT2,
+        HALF2
+    };
+
+    PositionFormat position = PositionFormat::FLOAT3;
+    NormalFormat normal = NormalFormat::INT_2_10_10_10_REV;
+    TextureCoordinateFormat textureCoordinate = TextureCoordinateFormat::HALF2;
+
+    size_t getNormalOffset() const;
+    size_t getTextureCoordinateOffset() const;
+    size_t getStride() const;
+
+    ///
+    /// \brief interleave Packs vertex attributes into the interleaved vertex buffer
+    ///                   format described by this layout.
+    /// \param positions Vertex positions.
+    /// \param normals Vertex normals, with as many elements as positions.
+    /// \param textureCoordinates Vertex texture coordinates, with as many elements as positions.
+    /// \return Interleaved vertex data of getStride() bytes per vertex.
+    ///
+    std::vector<uint8_t> interleave(const std::vector<glm::vec3> &positions,
+                                    const std::vector<glm::vec3> &normals,
+                                    const std::vector<glm::vec2> &textureCoordinates) const;
+};
+
+///
+/// \brief packNormal Packs a normal into the GL_INT_2_10_10_10_REV format with x in
+///                   the least significant bits.
+///
+uint32_t packNormal(const glm::vec3 &normal);
+
+///
+/// \brief unpackNormal Unpacks a normal packed with packNormal the way OpenGL ES
+///                     converts signed normalized attributes.
+///
+glm::vec3 unpackNormal(uint32_t packedNormal);
+
+} // namespace age
@@ -0,0 +1,354 @@
+#include <android_game_engine/AABBTree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <android_game_engine/FrustumCuller.h>
+
+namespace age {
+
+AABB AABB::merge(const AABB &a, const AABB &b) {
+    return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+AABBTree::AABBTree(float margin) : margin(margin) {}
+
+int AABBTree::createProxy(const AABB &aabb, void *userData) {
+    const auto proxyId = this->allocateNode();
+
+    auto &node = this->nodes[proxyId];
+    node.aabb = {aabb.min - this->margin, aabb.max + this->margin};
+    node.userData = userData;
+
+    this->insertLeaf(proxyId);
+    ++this->numProxies;
+
+    return proxyId;
+}
+
+void AABBTree::destroyProxy(int proxyId) {
+    this->removeLeaf(proxyId);
+    this->freeNode(proxyId);
+    --this->numProxies;
+}
+
+bool AABBTree::moveProxy(int proxyId, const AABB &aabb) {
+    if (this->nodes[proxyId].aabb.contains(aabb)) {
+        return false;
+    }
+
+    this->removeLeaf(proxyId);
+    this->nodes[proxyId].aabb = {aabb.min - this->margin, aabb.max + this->margin};
+    this->insertLeaf(proxyId);
+
+    return true;
+}
+
+void AABBTree::queryFrustum(const glm::mat4 &projectionView, const QueryCallback &callback) const {
+    const auto planes = FrustumCuller::extractPlanes(projectionView);
+
+    auto overlaps = [&planes](const AABB &aabb) {
+        const auto center = (aabb.min + aabb.max) * 0.5f;
+        const auto extents = (aabb.max - aabb.min) * 0.5f;
+        for (const auto &plane : planes) {
+            const glm::vec3 normal(plane);
+            if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extents) < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto contained = [&planes](const AABB &aabb) {
+        const auto center = (aabb.min + aabb.max) * 0.5f;
+        const auto extents = (aabb.max - aabb.min) * 0.5f;
+        for (const auto &plane : planes) {
+            const glm::vec3 normal(plane);
+            if (glm::dot(normal, center) + plane.w - glm::dot(glm::abs(normal), extents) < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    this->query(overlaps, contained, callback);
+}
+
+void AABBTree::querySphere(const glm::vec3 &center, float radius, const QueryCallback &callback) const {
+    const auto radiusSquared = radius * radius;
+
+    auto overlaps = [&center, radiusSquared](const AABB &aabb) {
+        const auto offset = glm::clamp(center, aabb.min, aabb.max) - center;
+        return glm::dot(offset, offset) <= radiusSquared;
+    };
+
+    auto contained = [&center, radiusSquared](const AABB &aabb) {
+        const auto farthestOffset = glm::max(glm::abs(aabb.min - center), glm::abs(aabb.max - center));
+        return glm::dot(farthestOffset, farthestOffset) <= radiusSquared;
+    };
+
+    this->query(overlaps, contained, callback);
+}
+
+void AABBTree::queryBox(const AABB &aabb, const QueryCallback &callback) const {
+    this->query([&aabb](const AABB &nodeAABB){ return aabb.overlaps(nodeAABB); },
+                [&aabb](const AABB &nodeAABB){ return aabb.contains(nodeAABB); },
+                callback);
+}
+
+void AABBTree::queryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                        const QueryCallback &callback) const {
+    // Axes the ray is parallel to have no finite inverse. Their slabs are tested on the origin
+    // instead since 0 * inf is NaN for boxes whose faces pass through the origin.
+    glm::vec3 invDirection;
+    glm::bvec3 parallel;
+    for (int axis = 0; axis < 3; ++axis) {
+        invDirection[axis] = 1.0f / direction[axis];
+        parallel[axis] = !std::isfinite(invDirection[axis]);
+    }
+
+    // Slab test
+    auto overlaps = [&origin, &invDirection, &parallel, maxDistance](const AABB &aabb) {
+        auto enter = 0.0f;
+        auto exit = maxDistance;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (parallel[axis]) {
+                if (origin[axis] < aabb.min[axis] || origin[axis] > aabb.max[axis]) return false;
+                continue;
+            }
+
+            const auto t1 = (aabb.min[axis] - origin[axis]) * invDirection[axis];
+            const auto t2 = (aabb.max[axis] - origin[axis]) * invDirection[axis];
+            enter = std::max(enter, std::min(t1, t2));
+            exit = std::min(exit, std::max(t1, t2));
+        }
+        return enter <= exit;
+    };
+
+    this->query(overlaps, [](const AABB&){ return false; }, callback);
+}
+
+int AABBTree::allocateNode() {
+    int node;
+    if (this->freeList == nullProxy) {
+        node = static_cast<int>(this->nodes.size());
+        this->nodes.emplace_back();
+    } else {
+        node = this->freeList;
+        this->freeList = this->nodes[node].parent;
+    }
+
+    this->nodes[node] = Node();
+    this->nodes[node].height = 0;
+    return node;
+}
+
+void AABBTree::freeNode(int node) {
+    this->nodes[node].parent = this->freeList;
+    this->nodes[node].height = -1;
+    this->freeList = node;
+}
+
+void AABBTree::insertLeaf(int leaf) {
+    if (this->root == nullProxy) {
+        this->root = leaf;
+        this->nodes[leaf].parent = nullProxy;
+        return;
+    }
+
+    // Find the sibling that minimizes the increase in surface area of the tree
+    const auto leafAABB = this->nodes[leaf].aabb;
+    auto index = this->root;
+    while (!this->nodes[index].isLeaf()) {
+        const auto &node = this->nodes[index];
+
+        const auto area = node.aabb.getSurfaceArea();
+        const auto combinedArea = AABB::merge(node.aabb, leafAABB).getSurfaceArea();
+
+        // Cost of creating a new parent for this node and the leaf
+        const auto cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        const auto inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [this, &leafAABB, inheritanceCost](int child) {
+            const auto &childNode = this->nodes[child];
+            const auto mergedArea = AABB::merge(leafAABB, childNode.aabb).getSurfaceArea();
+            return (childNode.isLeaf() ? mergedArea : mergedArea - childNode.aabb.getSurfaceArea()) +
+                    inheritanceCost;
+        };
+
+        const auto cost1 = descendCost(node.child1);
+        const auto cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+
+        index = (cost1 < cost2) ? node.child1 : node.child2;
+    }
+
+    const auto sibling = index;
+    const auto oldParent = this->nodes[sibling].parent;
+    const auto newParent = this->allocateNode();
+
+    this->nodes[newParent].parent = oldParent;
+    this->nodes[newParent].child1 = sibling;
+    this->nodes[newParent].child2 = leaf;
+    this->nodes[newParent].aabb = AABB::merge(leafAABB, this->nodes[sibling].aabb);
+    this->nodes[newParent].height = this->nodes[sibling].height + 1;
+
+    if (oldParent == nullProxy) {
+        this->root = newParent;
+    } else if (this->nodes[oldParent].child1 == sibling) {
+        this->nodes[oldParent].child1 = newParent;
+    } else {
+        this->nodes[oldParent].child2 = newParent;
+    }
+
+    this->nodes[sibling].parent = newParent;
+    this->nodes[leaf].parent = newParent;
+
+    for (index = newParent; index != nullProxy; index = this->nodes[index].parent) {
+        index = this->balance(index);
+        this->refit(index);
+    }
+}
+
+void AABBTree::removeLeaf(int leaf) {
+    if (leaf == this->root) {
+        this->root = nullProxy;
+        return;
+    }
+
+    const auto parent = this->nodes[leaf].parent;
+    const auto grandParent = this->nodes[parent].parent;
+    const auto sibling = (this->nodes[parent].child1 == leaf) ?
+            this->nodes[parent].child2 : this->nodes[parent].child1;
+
+    this->freeNode(parent);
+
+    if (grandParent == nullProxy) {
+        this->root = sibling;
+        this->nodes[sibling].parent = nullProxy;
+        return;
+    }
+
+    // Replace the parent with the sibling
+    if (this->nodes[grandParent].child1 == parent) {
+        this->nodes[grandParent].child1 = sibling;
+    } else {
+        this->nodes[grandParent].child2 = sibling;
+    }
+    this->nodes[sibling].parent = grandParent;
+
+    for (auto index = grandParent; index != nullProxy; index = this->nodes[index].parent) {
+        index = this->balance(index);
+        this->refit(index);
+    }
+}
+
+int AABBTree::balance(int iA) {
+    auto &a = this->nodes[iA];
+    if (a.isLeaf() || a.height < 2) {
+        return iA;
+    }
+
+    const auto iB = a.child1;
+    const auto iC = a.child2;
+    auto &b = this->nodes[iB];
+    auto &c = this->nodes[iC];
+
+    // Promotes the taller grandchild's parent in place of A
+    auto rotateUp = [this, iA, &a](int iUp, Node &up, Node &other, int &aChildSlot) {
+        const auto iF = up.child1;
+        const auto iG = up.child2;
+        auto &f = this->nodes[iF];
+        auto &g = this->nodes[iG];
+
+        up.child1 = iA;
+        up.parent = a.parent;
+        a.parent = iUp;
+
+        if (up.parent == nullProxy) {
+            this->root = iUp;
+        } else if (this->nodes[up.parent].child1 == iA) {
+            this->nodes[up.parent].child1 = iUp;
+        } else {
+            this->nodes[up.parent].child2 = iUp;
+        }
+
+        // The taller grandchild stays under the promoted node and the shorter one moves to A
+        const auto fTaller = f.height > g.height;
+        const auto iKeep = fTaller ? iF : iG;
+        const auto iMove = fTaller ? iG : iF;
+        auto &keep = this->nodes[iKeep];
+        auto &move = this->nodes[iMove];
+
+        up.child2 = iKeep;
+        aChildSlot = iMove;
+        move.parent = iA;
+
+        a.aabb = AABB::merge(other.aabb, move.aabb);
+        a.height = 1 + std::max(other.height, move.height);
+        up.aabb = AABB::merge(a.aabb, keep.aabb);
+        up.height = 1 + std::max(a.height, keep.height);
+
+        return iUp;
+    };
+
+    const auto imbalance = c.height - b.height;
+    if (imbalance > 1) {
+        return rotateUp(iC, c, b, a.child2);
+    }
+    if (imbalance < -1) {
+        return rotateUp(iB, b, c, a.child1);
+    }
+
+    return iA;
+}
+
+void AABBTree::refit(int node) {
+    auto &n = this->nodes[node];
+    const auto &child1 = this->nodes[n.child1];
+    const auto &child2 = this->nodes[n.child2];
+
+    n.height = 1 + std::max(child1.height, child2.height);
+    n.aabb = AABB::merge(child1.aabb, child2.aabb);
+}
+
+template<typename Overlaps, typename Contained>
+void AABBTree::query(const Overlaps &overlaps, const Contained &contained,
+                     const QueryCallback &callback) const {
+    if (this->root == nullProxy) return;
+
+    // Subtrees fully contained in the query volume are reported without further tests
+    std::vector<std::pair<int, bool>> stack;
+    stack.reserve(64);
+    stack.emplace_back(this->root, false);
+
+    while (!stack.empty()) {
+        auto entry = stack.back();
+        stack.pop_back();
+
+        const auto &node = this->nodes[entry.first];
+        auto isContained = entry.second;
+        if (!isContained) {
+            if (!overlaps(node.aabb)) continue;
+            isContained = contained(node.aabb);
+        }
+
+        if (node.isLeaf()) {
+            if (!callback(entry.first)) return;
+        } else {
+            stack.emplace_back(node.child1, isContained);
+            stack.emplace_back(node.child2, isContained);
+        }
+    }
+}
+
+} // namespace age
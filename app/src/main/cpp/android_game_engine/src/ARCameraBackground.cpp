@@ -3,6 +3,7 @@
 #include <GLES3/gl32.h>
 #include <GLES2/gl2ext.h>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/ShaderProgram.h>
 
 namespace {
@@ -27,10 +28,10 @@ namespace age {
 ARCameraBackground::ARCameraBackground() : textureCoordinates(positions.size()) {
     // Store vertex data
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
 
     glBufferData(GL_ARRAY_BUFFER,
                  positionsSize_bytes + textureCoordinatesSize_bytes,
@@ -48,21 +49,21 @@ ARCameraBackground::ARCameraBackground() : textureCoordinates(positions.size())
                           reinterpret_cast<GLvoid*>(positionsSize_bytes));
     glEnableVertexAttribArray(1u);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 
     // Store texture
     glGenTextures(1, &this->texture);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, this->texture);
+    GLState::bindTexture(GL_TEXTURE_EXTERNAL_OES, this->texture);
     glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
+    GLState::bindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
 }
 
 ARCameraBackground::~ARCameraBackground() {
-    glDeleteTextures(1, &this->texture);
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
+    GLState::deleteTextures(1, &this->texture);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
 }
 
 void ARCameraBackground::onUpdate(const ArSession *arSession, const ArFrame *arFrame) {
@@ -77,27 +78,27 @@ void ARCameraBackground::onUpdate(const ArSession *arSession, const ArFrame *arF
         this->textureCoordinatesInitialized = true;
 
         // Store new texture coordinates
-        glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
         glBufferSubData(GL_ARRAY_BUFFER, positionsSize_bytes,
                         textureCoordinatesSize_bytes, this->textureCoordinates.data());
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
     }
 }
 
 void ARCameraBackground::render(age::ShaderProgram *shader, int64_t arFrameTimestamp) {
     if (arFrameTimestamp == 0) return;
 
-    glDepthMask(GL_FALSE);
+    GLState::depthMask(GL_FALSE);
 
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     shader->setUniform("backgroundTexture", 0);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, this->texture);
+    GLState::bindTexture(GL_TEXTURE_EXTERNAL_OES, this->texture);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-    glDepthMask(GL_TRUE);
+    GLState::depthMask(GL_TRUE);
 }
 
 unsigned int ARCameraBackground::getTexture() const {return this->texture;}
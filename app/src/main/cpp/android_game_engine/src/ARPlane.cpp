@@ -5,6 +5,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/ShaderProgram.h>
 
 namespace {
@@ -51,11 +52,11 @@ ARPlane::ARPlane(const Texture2D &texture) : GameObject(),
     const auto opacitiesOffset = this->textureCoordinatesOffset + textureCoordinatesSize_bytes;
 
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     // Store vertex data
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
     glBufferData(GL_ARRAY_BUFFER, positionsSize_bytes + textureCoordinatesSize_bytes + opacitiesSize_bytes,
                  nullptr, GL_DYNAMIC_DRAW);
 
@@ -81,14 +82,20 @@ ARPlane::ARPlane(const Texture2D &texture) : GameObject(),
     this->numIndices = indices.size() * 3;
 
     glGenBuffers(1, &this->ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(glm::uvec3),
                  indices.data(), GL_STATIC_DRAW);
 
     // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    std::vector<unsigned int> occluderIndices;
+    for (const auto &triangle : indices) {
+        occluderIndices.insert(occluderIndices.end(), {triangle.x, triangle.y, triangle.z});
+    }
+    this->occluderMesh = std::make_shared<const OccluderMesh>(OccluderMesh{positions, std::move(occluderIndices)});
 
     // Create collision shape
     this->setCollisionShape(std::make_unique<btBoxShape>(btVector3(0.5f, 0.5f, thickness * 0.5f)));
@@ -110,20 +117,20 @@ std::vector<glm::vec2> ARPlane::generateTextureCoordinates(float scale) {
 }
 
 ARPlane::~ARPlane() {
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
-    glDeleteBuffers(1, &this->ebo);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
+    GLState::deleteBuffers(1, &this->ebo);
 }
 
-void ARPlane::render(age::ShaderProgram *shader) {
+void ARPlane::render(age::ShaderProgram *shader, const age::MaterialUniforms *uniforms) {
     shader->setUniform("model", this->getModelMatrix());
     shader->setUniform("normal", this->getNormalDirection());
 
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     shader->setUniform("planeTexture", 0);
     this->texture.bind();
 
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
     glDrawElements(GL_TRIANGLES, this->numIndices,
                    GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(0));
 }
@@ -134,11 +141,11 @@ void ARPlane::setDimensions(const glm::vec2 &dimensions) {
 
     // Update vertex texture coordinates
     auto textureCoordinates = this->generateTextureCoordinates(scale);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
     glBufferSubData(GL_ARRAY_BUFFER, this->textureCoordinatesOffset,
                     textureCoordinates.size() * textureCoordinatesStride,
                     textureCoordinates.data());
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void ARPlane::setCollisionDiameter(float diameter) {
@@ -0,0 +1,172 @@
+#include <android_game_engine/AssetLoader.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <android_game_engine/Log.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Upload {
+    std::function<void()> upload;
+    size_t numBytes;
+};
+
+std::vector<std::thread> workers;
+bool stopping = false;
+
+std::mutex loadMutex;
+std::condition_variable loadCondition;
+std::deque<std::function<void()>> loads;
+unsigned int numRunningLoads = 0;
+
+std::mutex uploadMutex;
+std::deque<Upload> uploads;
+
+// Guarded by loadMutex for the load counters and by uploadMutex for the upload counters
+age::AssetLoader::Statistics statistics;
+
+void runLoad(const std::function<void()> &load) {
+    const auto start = Clock::now();
+    try {
+        load();
+    } catch (const std::exception &e) {
+        age::Log::error(std::string("Failed to load asset in the background: ") + e.what());
+    }
+    const std::chrono::duration<float> duration = Clock::now() - start;
+
+    std::lock_guard<std::mutex> lock(loadMutex);
+    ++statistics.numLoads;
+    statistics.maxLoadDuration = std::max(statistics.maxLoadDuration, duration);
+}
+
+void runWorker() {
+    while (true) {
+        std::function<void()> load;
+        {
+            std::unique_lock<std::mutex> lock(loadMutex);
+            loadCondition.wait(lock, [](){ return stopping || !loads.empty(); });
+            if (stopping) return;
+
+            load = std::move(loads.front());
+            loads.pop_front();
+            ++numRunningLoads;
+        }
+
+        runLoad(load);
+
+        std::lock_guard<std::mutex> lock(loadMutex);
+        --numRunningLoads;
+    }
+}
+
+} // namespace
+
+namespace age {
+namespace AssetLoader {
+
+void init(unsigned int numThreads) {
+    stopping = false;
+    for (auto i = 0u; i < numThreads; ++i) {
+        workers.emplace_back(runWorker);
+    }
+}
+
+void shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        stopping = true;
+    }
+    loadCondition.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    std::lock_guard<std::mutex> uploadLock(uploadMutex);
+    loads.clear();
+    uploads.clear();
+    statistics = {};
+}
+
+void enqueueLoad(std::function<void()> load) {
+    if (workers.empty()) {
+        runLoad(load);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        loads.push_back(std::move(load));
+    }
+    loadCondition.notify_one();
+}
+
+void enqueueUpload(std::function<void()> upload, size_t numBytes) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    uploads.push_back({std::move(upload), numBytes});
+}
+
+void processUploads(std::chrono::duration<float> timeBudget, size_t byteBudget) {
+    const auto start = Clock::now();
+    auto numUploads = 0u;
+    size_t numBytes = 0;
+
+    while (true) {
+        Upload upload;
+        {
+            std::lock_guard<std::mutex> lock(uploadMutex);
+            if (uploads.empty()) break;
+
+            // Stop once a budget is used up, but always make progress
+            if (numUploads > 0 &&
+                (Clock::now() - start >= timeBudget || numBytes + uploads.front().numBytes > byteBudget)) {
+                break;
+            }
+
+            upload = std::move(uploads.front());
+            uploads.pop_front();
+        }
+
+        try {
+            upload.upload();
+        } catch (const std::exception &e) {
+            Log::error(std::string("Failed to upload asset: ") + e.what());
+        }
+
+        ++numUploads;
+        numBytes += upload.numBytes;
+    }
+
+    const std::chrono::duration<float> duration = Clock::now() - start;
+
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    statistics.numUploads += numUploads;
+    statistics.frameUploadDuration = duration;
+    statistics.frameUploadBytes = numBytes;
+    statistics.maxFrameUploadDuration = std::max(statistics.maxFrameUploadDuration, duration);
+}
+
+Statistics getStatistics() {
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    std::lock_guard<std::mutex> uploadLock(uploadMutex);
+
+    auto result = statistics;
+    result.numPendingLoads = static_cast<unsigned int>(loads.size()) + numRunningLoads;
+    result.numPendingUploads = static_cast<unsigned int>(uploads.size());
+    return result;
+}
+
+} // namespace AssetLoader
+} // namespace age
@@ -1,7 +1,9 @@
 #include <android_game_engine/Box.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <utility>
 
 #include <BulletCollision/CollisionShapes/btBoxShape.h>
 #include <LinearMath/btVector3.h>
@@ -134,6 +136,40 @@ const std::vector<glm::uvec3> indices {
     {21u, 20u, 23u}
 };
 
+std::map<std::pair<float, float>, std::weak_ptr<age::VertexArray>> vertexArrayCache;
+
+///
+/// \brief loadVertexArray Loads and caches the vertex array for a texture repeat count so that
+///                        all instances with the same geometry share one vertex array.
+///
+std::shared_ptr<age::VertexArray> loadVertexArray(const glm::vec2 &numTextureRepeat) {
+    const auto key = std::make_pair(numTextureRepeat.x, numTextureRepeat.y);
+
+    // Check cache to avoid reloading
+    auto vao = vertexArrayCache[key].lock();
+    if (vao) return vao;
+
+    std::vector<glm::vec2> repeatTextureCoords(textureCoordinates);
+    std::transform(repeatTextureCoords.begin(), repeatTextureCoords.end(),
+                   repeatTextureCoords.begin(),
+                   [numTextureRepeat](const auto &tc){
+                       return glm::vec2(tc.x * numTextureRepeat.x, tc.y * numTextureRepeat.y);
+                   });
+
+    // Unit geometry is exactly representable with half float positions
+    age::VertexLayout layout;
+    layout.position = age::VertexLayout::PositionFormat::HALF4;
+
+    // The entry is erased with the vertex array so that the cache doesn't grow with every repeat count
+    vao = std::shared_ptr<age::VertexArray>(new age::VertexArray(positions, normals, repeatTextureCoords, indices, layout),
+                                            [key](age::VertexArray *vertexArray) {
+                                                vertexArrayCache.erase(key);
+                                                delete vertexArray;
+                                            });
+    vertexArrayCache[key] = vao;
+    return vao;
+}
+
 } // namespace
 
 namespace age {
@@ -164,13 +200,7 @@ void Box::init(const std::vector<age::Texture2D> &diffuseTextures,
                const std::vector<age::Texture2D> &specularTextures,
                const glm::vec2 &numTextureRepeat) {
     // Create mesh
-    std::vector<glm::vec2> repeatTextureCoords(textureCoordinates);
-    std::transform(repeatTextureCoords.begin(), repeatTextureCoords.end(),
-                   repeatTextureCoords.begin(),
-                   [numTextureRepeat](const auto &tc){
-                       return glm::vec2(tc.x * numTextureRepeat.x, tc.y * numTextureRepeat.y);
-                   });
-    auto vao = std::make_shared<VertexArray>(positions, normals, repeatTextureCoords, indices);
+    auto vao = loadVertexArray(numTextureRepeat);
 
     std::shared_ptr<Meshes> meshes(new Meshes{Mesh(std::move(vao),
                                                    diffuseTextures,
@@ -0,0 +1,567 @@
+#include <android_game_engine/Etc2.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+using Color = std::array<int, 3>;
+
+// Modifiers of the individual and differential modes, in pixel index order +a, +b, -a, -b
+const int colorModifiers[8][4] = {
+    {2, 8, -2, -8},
+    {5, 17, -5, -17},
+    {9, 29, -9, -29},
+    {13, 42, -13, -42},
+    {18, 60, -18, -60},
+    {24, 80, -24, -80},
+    {33, 106, -33, -106},
+    {47, 183, -47, -183}
+};
+
+const int alphaModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+int clamp255(int value) {
+    return std::min(std::max(value, 0), 255);
+}
+
+uint64_t readBlock(const uint8_t *block) {
+    uint64_t bits = 0;
+    for (auto i = 0; i < 8; ++i) {
+        bits = (bits << 8u) | block[i];
+    }
+    return bits;
+}
+
+void writeBlock(uint64_t bits, uint8_t *block) {
+    for (auto i = 7; i >= 0; --i) {
+        block[i] = static_cast<uint8_t>(bits & 0xFFu);
+        bits >>= 8u;
+    }
+}
+
+uint64_t getBits(uint64_t bits, unsigned int lowBit, unsigned int numBits) {
+    return (bits >> lowBit) & ((uint64_t(1) << numBits) - 1u);
+}
+
+int signExtend3(uint64_t value) {
+    return value >= 4 ? static_cast<int>(value) - 8 : static_cast<int>(value);
+}
+
+int expand4(int value) {return (value << 4) | value;}
+int expand5(int value) {return (value << 3) | (value >> 2);}
+int expand6(int value) {return (value << 2) | (value >> 4);}
+int expand7(int value) {return (value << 1) | (value >> 6);}
+
+int quantize(float value, int maxQuantized) {
+    return std::min(std::max(static_cast<int>(std::lround(value * maxQuantized / 255.0f)), 0), maxQuantized);
+}
+
+int getSquaredError(const Color &color, const uint8_t *pixel) {
+    auto error = 0;
+    for (auto c = 0; c < 3; ++c) {
+        auto difference = color[c] - pixel[c];
+        error += difference * difference;
+    }
+    return error;
+}
+
+// Pixel indices of ETC blocks run down the columns
+int getPixelIndex(int x, int y) {return x * 4 + y;}
+
+bool isInSubblock(int x, int y, bool flip, int subblock) {
+    return (flip ? y : x) / 2 == subblock;
+}
+
+struct SubblockEncoding {
+    unsigned int table = 0;
+    int error = std::numeric_limits<int>::max();
+};
+
+///
+/// \brief encodeSubblock Picks the modifier table and pixel indices of a subblock with a base color.
+/// \param indices Pixel indices of the subblock's pixels are written in ETC pixel order.
+///
+SubblockEncoding encodeSubblock(const uint8_t *pixels, bool flip, int subblock,
+                                const Color &base, std::array<unsigned int, 16> &indices) {
+    SubblockEncoding best;
+    std::array<unsigned int, 16> tableIndices;
+
+    for (auto table = 0u; table < 8; ++table) {
+        auto error = 0;
+        for (auto y = 0; y < 4; ++y) {
+            for (auto x = 0; x < 4; ++x) {
+                if (!isInSubblock(x, y, flip, subblock)) continue;
+
+                const auto *pixel = pixels + 4 * (y * 4 + x);
+                auto bestPixelError = std::numeric_limits<int>::max();
+                for (auto i = 0u; i < 4; ++i) {
+                    const auto modifier = colorModifiers[table][i];
+                    const Color color {clamp255(base[0] + modifier),
+                                       clamp255(base[1] + modifier),
+                                       clamp255(base[2] + modifier)};
+                    auto pixelError = getSquaredError(color, pixel);
+                    if (pixelError < bestPixelError) {
+                        bestPixelError = pixelError;
+                        tableIndices[getPixelIndex(x, y)] = i;
+                    }
+                }
+                error += bestPixelError;
+            }
+        }
+
+        if (error < best.error) {
+            best.table = table;
+            best.error = error;
+            for (auto y = 0; y < 4; ++y) {
+                for (auto x = 0; x < 4; ++x) {
+                    if (isInSubblock(x, y, flip, subblock)) {
+                        indices[getPixelIndex(x, y)] = tableIndices[getPixelIndex(x, y)];
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+uint64_t packIndices(const std::array<unsigned int, 16> &indices) {
+    uint64_t bits = 0;
+    for (auto p = 0u; p < 16; ++p) {
+        bits |= uint64_t(indices[p] >> 1u) << (16u + p);
+        bits |= uint64_t(indices[p] & 1u) << p;
+    }
+    return bits;
+}
+
+std::array<float, 3> getSubblockAverage(const uint8_t *pixels, bool flip, int subblock) {
+    std::array<float, 3> sum {0.0f, 0.0f, 0.0f};
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            if (!isInSubblock(x, y, flip, subblock)) continue;
+            for (auto c = 0; c < 3; ++c) {
+                sum[c] += pixels[4 * (y * 4 + x) + c];
+            }
+        }
+    }
+    for (auto &channel : sum) channel /= 8.0f;
+    return sum;
+}
+
+struct BlockEncoding {
+    uint64_t bits = 0;
+    int error = std::numeric_limits<int>::max();
+};
+
+BlockEncoding encodeIndividualOrDifferential(const uint8_t *pixels, bool flip) {
+    BlockEncoding best;
+    const std::array<std::array<float, 3>, 2> averages {getSubblockAverage(pixels, flip, 0),
+                                                        getSubblockAverage(pixels, flip, 1)};
+
+    // Individual mode, two 4-bit base colors
+    {
+        std::array<Color, 2> quantized, bases;
+        for (auto s = 0; s < 2; ++s) {
+            for (auto c = 0; c < 3; ++c) {
+                quantized[s][c] = quantize(averages[s][c], 15);
+                bases[s][c] = expand4(quantized[s][c]);
+            }
+        }
+
+        std::array<unsigned int, 16> indices;
+        auto encoding0 = encodeSubblock(pixels, flip, 0, bases[0], indices);
+        auto encoding1 = encodeSubblock(pixels, flip, 1, bases[1], indices);
+
+        uint64_t bits = 0;
+        for (auto c = 0u; c < 3; ++c) {
+            bits |= uint64_t(quantized[0][c]) << (60u - 8u * c);
+            bits |= uint64_t(quantized[1][c]) << (56u - 8u * c);
+        }
+        bits |= uint64_t(encoding0.table) << 37u;
+        bits |= uint64_t(encoding1.table) << 34u;
+        bits |= uint64_t(flip) << 32u;
+        bits |= packIndices(indices);
+
+        best.bits = bits;
+        best.error = encoding0.error + encoding1.error;
+    }
+
+    // Differential mode, a 5-bit base color and a 3-bit signed difference to the second one
+    {
+        std::array<Color, 2> quantized, bases;
+        auto representable = true;
+        for (auto s = 0; s < 2; ++s) {
+            for (auto c = 0; c < 3; ++c) {
+                quantized[s][c] = quantize(averages[s][c], 31);
+                bases[s][c] = expand5(quantized[s][c]);
+            }
+        }
+        for (auto c = 0; c < 3; ++c) {
+            auto difference = quantized[1][c] - quantized[0][c];
+            representable = representable && difference >= -4 && difference <= 3;
+        }
+
+        if (representable) {
+            std::array<unsigned int, 16> indices;
+            auto encoding0 = encodeSubblock(pixels, flip, 0, bases[0], indices);
+            auto encoding1 = encodeSubblock(pixels, flip, 1, bases[1], indices);
+
+            if (encoding0.error + encoding1.error < best.error) {
+                uint64_t bits = 0;
+                for (auto c = 0u; c < 3; ++c) {
+                    auto difference = quantized[1][c] - quantized[0][c];
+                    bits |= uint64_t(quantized[0][c]) << (59u - 8u * c);
+                    bits |= uint64_t(difference & 7) << (56u - 8u * c);
+                }
+                bits |= uint64_t(encoding0.table) << 37u;
+                bits |= uint64_t(encoding1.table) << 34u;
+                bits |= uint64_t(1) << 33u;
+                bits |= uint64_t(flip) << 32u;
+                bits |= packIndices(indices);
+
+                best.bits = bits;
+                best.error = encoding0.error + encoding1.error;
+            }
+        }
+    }
+
+    return best;
+}
+
+///
+/// \brief decodePlanar Decodes the color of a pixel from the 8-bit origin, horizontal and
+///                     vertical colors of a planar block.
+///
+Color decodePlanar(const Color &origin, const Color &horizontal, const Color &vertical, int x, int y) {
+    Color color;
+    for (auto c = 0; c < 3; ++c) {
+        color[c] = clamp255((x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) +
+                             4 * origin[c] + 2) >> 2);
+    }
+    return color;
+}
+
+bool isPlanar(uint64_t bits) {
+    if (!getBits(bits, 33, 1)) return false;
+
+    auto overflows = [bits](unsigned int channelBit){
+        auto value = static_cast<int>(getBits(bits, channelBit + 3, 5)) + signExtend3(getBits(bits, channelBit, 3));
+        return value < 0 || value > 31;
+    };
+    return !overflows(56) && !overflows(48) && overflows(40);
+}
+
+BlockEncoding encodePlanar(const uint8_t *pixels) {
+    // Least squares fit of a plane to each channel
+    std::array<float, 3> mean {0.0f, 0.0f, 0.0f}, slopeX {0.0f, 0.0f, 0.0f}, slopeY {0.0f, 0.0f, 0.0f};
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            for (auto c = 0; c < 3; ++c) {
+                const float value = pixels[4 * (y * 4 + x) + c];
+                mean[c] += value / 16.0f;
+                slopeX[c] += (x - 1.5f) * value / 20.0f;
+                slopeY[c] += (y - 1.5f) * value / 20.0f;
+            }
+        }
+    }
+
+    const int maxQuantized[3] = {63, 127, 63};
+    Color origin, horizontal, vertical;
+    Color quantizedOrigin, quantizedHorizontal, quantizedVertical;
+    for (auto c = 0; c < 3; ++c) {
+        auto o = mean[c] - 1.5f * (slopeX[c] + slopeY[c]);
+        quantizedOrigin[c] = quantize(o, maxQuantized[c]);
+        quantizedHorizontal[c] = quantize(o + 4.0f * slopeX[c], maxQuantized[c]);
+        quantizedVertical[c] = quantize(o + 4.0f * slopeY[c], maxQuantized[c]);
+
+        auto expand = c == 1 ? expand7 : expand6;
+        origin[c] = expand(quantizedOrigin[c]);
+        horizontal[c] = expand(quantizedHorizontal[c]);
+        vertical[c] = expand(quantizedVertical[c]);
+    }
+
+    BlockEncoding encoding;
+    encoding.error = 0;
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            encoding.error += getSquaredError(decodePlanar(origin, horizontal, vertical, x, y),
+                                              pixels + 4 * (y * 4 + x));
+        }
+    }
+
+    uint64_t bits = 0;
+    bits |= uint64_t(quantizedOrigin[0]) << 57u;
+    bits |= uint64_t(quantizedOrigin[1] >> 6) << 56u;
+    bits |= uint64_t(quantizedOrigin[1] & 0x3F) << 49u;
+    bits |= uint64_t(quantizedOrigin[2] >> 5) << 48u;
+    bits |= uint64_t((quantizedOrigin[2] >> 3) & 0x3) << 43u;
+    bits |= uint64_t(quantizedOrigin[2] & 0x7) << 39u;
+    bits |= uint64_t(quantizedHorizontal[0] >> 1) << 34u;
+    bits |= uint64_t(1) << 33u;
+    bits |= uint64_t(quantizedHorizontal[0] & 1) << 32u;
+    bits |= uint64_t(quantizedHorizontal[1]) << 25u;
+    bits |= uint64_t(quantizedHorizontal[2]) << 19u;
+    bits |= uint64_t(quantizedVertical[0]) << 13u;
+    bits |= uint64_t(quantizedVertical[1]) << 6u;
+    bits |= uint64_t(quantizedVertical[2]);
+
+    // The unused bits 63, 55, 47-45 and 42 must make only the blue channel of the
+    // differential mode overflow for decoders to select the planar mode
+    const unsigned int fillerBits[] = {63, 55, 47, 46, 45, 42};
+    for (auto filler = 0u; filler < 64u; ++filler) {
+        auto candidate = bits;
+        for (auto i = 0u; i < 6; ++i) {
+            candidate |= uint64_t((filler >> i) & 1u) << fillerBits[i];
+        }
+        if (isPlanar(candidate)) {
+            encoding.bits = candidate;
+            return encoding;
+        }
+    }
+
+    assert(false && "No filler bits select the planar mode");
+    encoding.error = std::numeric_limits<int>::max();
+    return encoding;
+}
+
+void getBlockPixels(const uint8_t *pixels, int width, int height, int blockX, int blockY,
+                    std::array<uint8_t, 64> &blockPixels) {
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            auto imageX = std::min(blockX * 4 + x, width - 1);
+            auto imageY = std::min(blockY * 4 + y, height - 1);
+            std::copy_n(pixels + 4 * (imageY * width + imageX), 4, blockPixels.begin() + 4 * (y * 4 + x));
+        }
+    }
+}
+
+} // namespace
+
+namespace age {
+namespace Etc2 {
+
+void encodeRgbBlock(const uint8_t *pixels, uint8_t *block) {
+    auto best = encodePlanar(pixels);
+    for (auto flip : {false, true}) {
+        auto encoding = encodeIndividualOrDifferential(pixels, flip);
+        if (encoding.error < best.error) best = encoding;
+    }
+    writeBlock(best.bits, block);
+}
+
+void decodeRgbBlock(const uint8_t *block, uint8_t *pixels) {
+    const auto bits = readBlock(block);
+
+    auto writePixel = [pixels](int x, int y, const Color &color){
+        auto *pixel = pixels + 4 * (y * 4 + x);
+        for (auto c = 0; c < 3; ++c) pixel[c] = static_cast<uint8_t>(color[c]);
+        pixel[3] = 255;
+    };
+
+    if (isPlanar(bits)) {
+        const Color origin {expand6(static_cast<int>(getBits(bits, 57, 6))),
+                            expand7(static_cast<int>((getBits(bits, 56, 1) << 6u) | getBits(bits, 49, 6))),
+                            expand6(static_cast<int>((getBits(bits, 48, 1) << 5u) | (getBits(bits, 43, 2) << 3u) |
+                                                     getBits(bits, 39, 3)))};
+        const Color horizontal {expand6(static_cast<int>((getBits(bits, 34, 5) << 1u) | getBits(bits, 32, 1))),
+                                expand7(static_cast<int>(getBits(bits, 25, 7))),
+                                expand6(static_cast<int>(getBits(bits, 19, 6)))};
+        const Color vertical {expand6(static_cast<int>(getBits(bits, 13, 6))),
+                              expand7(static_cast<int>(getBits(bits, 6, 7))),
+                              expand6(static_cast<int>(getBits(bits, 0, 6)))};
+
+        for (auto y = 0; y < 4; ++y) {
+            for (auto x = 0; x < 4; ++x) {
+                writePixel(x, y, decodePlanar(origin, horizontal, vertical, x, y));
+            }
+        }
+        return;
+    }
+
+    std::array<Color, 2> bases;
+    if (getBits(bits, 33, 1)) {
+        for (auto c = 0u; c < 3; ++c) {
+            auto base = static_cast<int>(getBits(bits, 59 - 8 * c, 5));
+            auto second = base + signExtend3(getBits(bits, 56 - 8 * c, 3));
+            assert(second >= 0 && second <= 31 && "T and H mode blocks are not supported");
+            bases[0][c] = expand5(base);
+            bases[1][c] = expand5(std::min(std::max(second, 0), 31));
+        }
+    } else {
+        for (auto c = 0u; c < 3; ++c) {
+            bases[0][c] = expand4(static_cast<int>(getBits(bits, 60 - 8 * c, 4)));
+            bases[1][c] = expand4(static_cast<int>(getBits(bits, 56 - 8 * c, 4)));
+        }
+    }
+
+    const unsigned int tables[2] = {static_cast<unsigned int>(getBits(bits, 37, 3)),
+                                    static_cast<unsigned int>(getBits(bits, 34, 3))};
+    const bool flip = getBits(bits, 32, 1);
+
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            const auto subblock = isInSubblock(x, y, flip, 0) ? 0 : 1;
+            const auto p = static_cast<unsigned int>(getPixelIndex(x, y));
+            const auto index = (getBits(bits, 16 + p, 1) << 1u) | getBits(bits, p, 1);
+            const auto modifier = colorModifiers[tables[subblock]][index];
+
+            writePixel(x, y, {clamp255(bases[subblock][0] + modifier),
+                              clamp255(bases[subblock][1] + modifier),
+                              clamp255(bases[subblock][2] + modifier)});
+        }
+    }
+}
+
+void encodeAlphaBlock(const uint8_t *pixels, uint8_t *block) {
+    auto minAlpha = 255, maxAlpha = 0;
+    for (auto i = 0; i < 16; ++i) {
+        minAlpha = std::min<int>(minAlpha, pixels[4 * i + 3]);
+        maxAlpha = std::max<int>(maxAlpha, pixels[4 * i + 3]);
+    }
+
+    // Table 13 has a zero modifier for blocks of a single alpha value, such as opaque blocks
+    const auto zeroModifierTable = 13u;
+    const auto zeroModifierIndex = 4u;
+    if (minAlpha == maxAlpha) {
+        uint64_t bits = (uint64_t(minAlpha) << 56u) | (uint64_t(1) << 52u) | (uint64_t(zeroModifierTable) << 48u);
+        for (auto p = 0u; p < 16; ++p) {
+            bits |= uint64_t(zeroModifierIndex) << (45u - 3u * p);
+        }
+        writeBlock(bits, block);
+        return;
+    }
+
+    uint64_t bestBits = 0;
+    auto bestError = std::numeric_limits<int>::max();
+
+    for (auto table = 0u; table < 16 && bestError > 0; ++table) {
+        const auto *modifiers = alphaModifiers[table];
+        const auto modifierRange = modifiers[7] - modifiers[3];
+
+        // Stretch the table over the range of the block and try nearby fits
+        auto idealMultiplier = static_cast<int>(std::lround(static_cast<float>(maxAlpha - minAlpha) / modifierRange));
+        for (auto multiplier = std::max(idealMultiplier - 1, 1); multiplier <= std::min(idealMultiplier + 1, 15); ++multiplier) {
+            auto idealBase = clamp255(minAlpha - modifiers[3] * multiplier);
+            for (auto base = std::max(idealBase - 1, 0); base <= std::min(idealBase + 1, 255); ++base) {
+                uint64_t bits = (uint64_t(base) << 56u) | (uint64_t(multiplier) << 52u) | (uint64_t(table) << 48u);
+                auto error = 0;
+
+                for (auto y = 0; y < 4; ++y) {
+                    for (auto x = 0; x < 4; ++x) {
+                        const int alpha = pixels[4 * (y * 4 + x) + 3];
+                        auto bestPixelError = std::numeric_limits<int>::max();
+                        auto bestIndex = 0u;
+                        for (auto i = 0u; i < 8; ++i) {
+                            auto difference = clamp255(base + modifiers[i] * multiplier) - alpha;
+                            if (difference * difference < bestPixelError) {
+                                bestPixelError = difference * difference;
+                                bestIndex = i;
+                            }
+                        }
+                        error += bestPixelError;
+                        bits |= uint64_t(bestIndex) << (45u - 3u * getPixelIndex(x, y));
+                    }
+                }
+
+                if (error < bestError) {
+                    bestError = error;
+                    bestBits = bits;
+                }
+            }
+        }
+    }
+
+    writeBlock(bestBits, block);
+}
+
+void decodeAlphaBlock(const uint8_t *block, uint8_t *pixels) {
+    const auto bits = readBlock(block);
+    const auto base = static_cast<int>(getBits(bits, 56, 8));
+    const auto multiplier = static_cast<int>(getBits(bits, 52, 4));
+    const auto *modifiers = alphaModifiers[getBits(bits, 48, 4)];
+
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            auto index = getBits(bits, 45u - 3u * getPixelIndex(x, y), 3);
+            pixels[4 * (y * 4 + x) + 3] = static_cast<uint8_t>(clamp255(base + modifiers[index] * multiplier));
+        }
+    }
+}
+
+std::vector<uint8_t> compress(const uint8_t *pixels, int width, int height, bool alpha) {
+    std::vector<uint8_t> data(getCompressedSize(width, height, alpha));
+    auto *block = data.data();
+
+    std::array<uint8_t, 64> blockPixels;
+    for (auto blockY = 0; blockY < (height + 3) / 4; ++blockY) {
+        for (auto blockX = 0; blockX < (width + 3) / 4; ++blockX) {
+            getBlockPixels(pixels, width, height, blockX, blockY, blockPixels);
+
+            // The alpha block precedes the color block
+            if (alpha) {
+                encodeAlphaBlock(blockPixels.data(), block);
+                block += 8;
+            }
+            encodeRgbBlock(blockPixels.data(), block);
+            block += 8;
+        }
+    }
+
+    return data;
+}
+
+std::vector<uint8_t> decompress(const uint8_t *data, int width, int height, bool alpha) {
+    std::vector<uint8_t> pixels(4 * width * height);
+    const auto *block = data;
+
+    std::array<uint8_t, 64> blockPixels;
+    for (auto blockY = 0; blockY < (height + 3) / 4; ++blockY) {
+        for (auto blockX = 0; blockX < (width + 3) / 4; ++blockX) {
+            if (alpha) {
+                decodeRgbBlock(block + 8, blockPixels.data());
+                decodeAlphaBlock(block, blockPixels.data());
+                block += 16;
+            } else {
+                decodeRgbBlock(block, blockPixels.data());
+                block += 8;
+            }
+
+            for (auto y = 0; y < 4 && blockY * 4 + y < height; ++y) {
+                for (auto x = 0; x < 4 && blockX * 4 + x < width; ++x) {
+                    std::copy_n(blockPixels.begin() + 4 * (y * 4 + x), 4,
+                                pixels.begin() + 4 * ((blockY * 4 + y) * width + blockX * 4 + x));
+                }
+            }
+        }
+    }
+
+    return pixels;
+}
+
+size_t getCompressedSize(int width, int height, bool alpha) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * (alpha ? rgbaBlockSize : rgbBlockSize);
+}
+
+} // namespace Etc2
+} // namespace age
@@ -0,0 +1,134 @@
+#include <android_game_engine/FrustumCuller.h>
+
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace age {
+
+void FrustumCuller::clear() {
+    this->centerX.clear();
+    this->centerY.clear();
+    this->centerZ.clear();
+    this->extentX.clear();
+    this->extentY.clear();
+    this->extentZ.clear();
+}
+
+FrustumCuller::Planes FrustumCuller::extractPlanes(const glm::mat4 &m) {
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    return {row3 + row0, row3 - row0,
+            row3 + row1, row3 - row1,
+            row3 + row2, row3 - row2};
+}
+
+void FrustumCuller::add(const glm::vec3 &center, const glm::vec3 &extents) {
+    this->centerX.push_back(center.x);
+    this->centerY.push_back(center.y);
+    this->centerZ.push_back(center.z);
+    this->extentX.push_back(extents.x);
+    this->extentY.push_back(extents.y);
+    this->extentZ.push_back(extents.z);
+}
+
+FrustumCuller::Statistics FrustumCuller::cull(const glm::mat4 &projectionView,
+                                              std::vector<uint8_t> &visibility) const {
+    const auto planes = extractPlanes(projectionView);
+    const auto numBoxes = this->size();
+    visibility.resize(numBoxes);
+
+    // A box is outside the frustum if it's fully behind any plane, that is if
+    // dot(n, center) + w + dot(|n|, extents) < 0
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    for (; i + 4 <= numBoxes; i += 4) {
+        const auto cx = vld1q_f32(&this->centerX[i]);
+        const auto cy = vld1q_f32(&this->centerY[i]);
+        const auto cz = vld1q_f32(&this->centerZ[i]);
+        const auto ex = vld1q_f32(&this->extentX[i]);
+        const auto ey = vld1q_f32(&this->extentY[i]);
+        const auto ez = vld1q_f32(&this->extentZ[i]);
+
+        auto outside = vdupq_n_u32(0);
+        for (const auto &plane : planes) {
+            auto distance = vmlaq_n_f32(vdupq_n_f32(plane.w), cx, plane.x);
+            distance = vmlaq_n_f32(distance, cy, plane.y);
+            distance = vmlaq_n_f32(distance, cz, plane.z);
+            distance = vmlaq_n_f32(distance, ex, std::abs(plane.x));
+            distance = vmlaq_n_f32(distance, ey, std::abs(plane.y));
+            distance = vmlaq_n_f32(distance, ez, std::abs(plane.z));
+            outside = vorrq_u32(outside, vcltq_f32(distance, vdupq_n_f32(0.0f)));
+        }
+
+        visibility[i] = vgetq_lane_u32(outside, 0) == 0;
+        visibility[i + 1] = vgetq_lane_u32(outside, 1) == 0;
+        visibility[i + 2] = vgetq_lane_u32(outside, 2) == 0;
+        visibility[i + 3] = vgetq_lane_u32(outside, 3) == 0;
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= numBoxes; i += 4) {
+        const auto cx = _mm_loadu_ps(&this->centerX[i]);
+        const auto cy = _mm_loadu_ps(&this->centerY[i]);
+        const auto cz = _mm_loadu_ps(&this->centerZ[i]);
+        const auto ex = _mm_loadu_ps(&this->extentX[i]);
+        const auto ey = _mm_loadu_ps(&this->extentY[i]);
+        const auto ez = _mm_loadu_ps(&this->extentZ[i]);
+
+        auto outside = _mm_setzero_ps();
+        for (const auto &plane : planes) {
+            auto distance = _mm_set1_ps(plane.w);
+            distance = _mm_add_ps(distance, _mm_mul_ps(cx, _mm_set1_ps(plane.x)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ex, _mm_set1_ps(std::abs(plane.x))));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ey, _mm_set1_ps(std::abs(plane.y))));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ez, _mm_set1_ps(std::abs(plane.z))));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+
+        const auto outsideMask = _mm_movemask_ps(outside);
+        visibility[i] = (outsideMask & 0x1) == 0;
+        visibility[i + 1] = (outsideMask & 0x2) == 0;
+        visibility[i + 2] = (outsideMask & 0x4) == 0;
+        visibility[i + 3] = (outsideMask & 0x8) == 0;
+    }
+#endif
+
+    // Remaining boxes that don't fill a SIMD register
+    for (; i < numBoxes; ++i) {
+        bool outside = false;
+        for (const auto &plane : planes) {
+            const auto distance = plane.w +
+                    this->centerX[i] * plane.x +
+                    this->centerY[i] * plane.y +
+                    this->centerZ[i] * plane.z +
+                    this->extentX[i] * std::abs(plane.x) +
+                    this->extentY[i] * std::abs(plane.y) +
+                    this->extentZ[i] * std::abs(plane.z);
+            outside |= distance < 0.0f;
+        }
+        visibility[i] = !outside;
+    }
+
+    Statistics statistics;
+    for (auto visible : visibility) {
+        statistics.numVisible += visible;
+    }
+    statistics.numCulled = numBoxes - statistics.numVisible;
+
+    return statistics;
+}
+
+} // namespace age
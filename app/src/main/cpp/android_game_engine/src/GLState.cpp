@@ -0,0 +1,336 @@
+#include <android_game_engine/GLState.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <GLES2/gl2ext.h>
+#include <glm/mat4x4.hpp>
+
+namespace {
+
+// Sentinel for state that is unknown and must be issued on the next change
+constexpr GLuint unknown = ~0u;
+
+enum TextureTarget : size_t {
+    TEXTURE_2D,
+    TEXTURE_2D_ARRAY,
+    TEXTURE_CUBE_MAP,
+    TEXTURE_EXTERNAL_OES,
+    NUM_TEXTURE_TARGETS
+};
+
+struct IndexedBufferBinding {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size; // -1 for the whole buffer
+
+    bool operator==(const IndexedBufferBinding &other) const {
+        return this->buffer == other.buffer && this->offset == other.offset && this->size == other.size;
+    }
+};
+
+struct UniformValue {
+    std::array<unsigned char, sizeof(glm::mat4)> data;
+    size_t size_bytes;
+};
+
+GLuint program = unknown;
+GLuint vao = unknown;
+GLuint drawFramebuffer = unknown;
+GLuint readFramebuffer = unknown;
+std::unordered_map<GLenum, GLuint> buffers;
+std::map<std::pair<GLenum, GLuint>, IndexedBufferBinding> indexedBuffers;
+
+GLuint activeTextureUnit = unknown;
+std::vector<std::array<GLuint, NUM_TEXTURE_TARGETS>> textureUnits;
+
+std::unordered_map<GLenum, bool> capabilities;
+GLuint depthFunction = unknown;
+GLuint depthWriteMask = unknown;
+GLuint cullFaceMode = unknown;
+GLuint blendSourceFactor = unknown;
+GLuint blendDestinationFactor = unknown;
+
+std::unordered_map<GLuint, std::unordered_map<GLint, UniformValue>> uniforms;
+
+age::GLState::Statistics statistics;
+
+///
+/// \brief update Records a new value of shadowed state.
+/// \return True if the value changed and the call must be issued to OpenGL.
+///
+template<typename T>
+bool update(T &state, T value) {
+    if (state == value) {
+        ++statistics.numCallsSkipped;
+        return false;
+    }
+
+    state = value;
+    ++statistics.numCallsIssued;
+    return true;
+}
+
+bool getTextureTarget(GLenum target, size_t &textureTarget) {
+    switch (target) {
+        case GL_TEXTURE_2D:
+            textureTarget = TEXTURE_2D;
+            return true;
+
+        case GL_TEXTURE_2D_ARRAY:
+            textureTarget = TEXTURE_2D_ARRAY;
+            return true;
+
+        case GL_TEXTURE_CUBE_MAP:
+            textureTarget = TEXTURE_CUBE_MAP;
+            return true;
+
+        case GL_TEXTURE_EXTERNAL_OES:
+            textureTarget = TEXTURE_EXTERNAL_OES;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void setCapability(GLenum capability, bool enabled) {
+    auto state = capabilities.find(capability);
+    if (state != capabilities.end() && state->second == enabled) {
+        ++statistics.numCallsSkipped;
+        return;
+    }
+
+    capabilities[capability] = enabled;
+    ++statistics.numCallsIssued;
+
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+} // namespace
+
+namespace age {
+namespace GLState {
+
+void reset() {
+    program = unknown;
+    vao = unknown;
+    drawFramebuffer = unknown;
+    readFramebuffer = unknown;
+    buffers.clear();
+    indexedBuffers.clear();
+
+    activeTextureUnit = unknown;
+    textureUnits.clear();
+
+    capabilities.clear();
+    depthFunction = unknown;
+    depthWriteMask = unknown;
+    cullFaceMode = unknown;
+    blendSourceFactor = unknown;
+    blendDestinationFactor = unknown;
+
+    uniforms.clear();
+}
+
+void resetStatistics() {statistics = {};}
+Statistics getStatistics() {return statistics;}
+
+void useProgram(GLuint p) {
+    if (update(program, p)) glUseProgram(p);
+}
+
+void bindVertexArray(GLuint v) {
+    if (update(vao, v)) glBindVertexArray(v);
+}
+
+void bindBuffer(GLenum target, GLuint buffer) {
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        ++statistics.numCallsIssued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    auto state = buffers.emplace(target, unknown).first;
+    if (update(state->second, buffer)) glBindBuffer(target, buffer);
+}
+
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    auto state = indexedBuffers.emplace(std::make_pair(target, index),
+                                        IndexedBufferBinding{unknown, 0, -1}).first;
+    if (update(state->second, {buffer, 0, -1})) {
+        // Also binds the buffer to the generic binding point of target
+        buffers[target] = buffer;
+        glBindBufferBase(target, index, buffer);
+    }
+}
+
+void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    auto state = indexedBuffers.emplace(std::make_pair(target, index),
+                                        IndexedBufferBinding{unknown, 0, -1}).first;
+    if (update(state->second, {buffer, offset, size})) {
+        // Also binds the buffer to the generic binding point of target
+        buffers[target] = buffer;
+        glBindBufferRange(target, index, buffer, offset, size);
+    }
+}
+
+void bindFramebuffer(GLenum target, GLuint framebuffer) {
+    switch (target) {
+        case GL_DRAW_FRAMEBUFFER:
+            if (update(drawFramebuffer, framebuffer)) glBindFramebuffer(target, framebuffer);
+            break;
+
+        case GL_READ_FRAMEBUFFER:
+            if (update(readFramebuffer, framebuffer)) glBindFramebuffer(target, framebuffer);
+            break;
+
+        default:
+            if (drawFramebuffer == framebuffer && readFramebuffer == framebuffer) {
+                ++statistics.numCallsSkipped;
+            } else {
+                drawFramebuffer = readFramebuffer = framebuffer;
+                ++statistics.numCallsIssued;
+                glBindFramebuffer(target, framebuffer);
+            }
+            break;
+    }
+}
+
+void activeTexture(GLenum textureUnit) {
+    if (update(activeTextureUnit, static_cast<GLuint>(textureUnit))) glActiveTexture(textureUnit);
+}
+
+void bindTexture(GLenum target, GLuint texture) {
+    size_t textureTarget;
+    if (activeTextureUnit == unknown || !getTextureTarget(target, textureTarget)) {
+        ++statistics.numCallsIssued;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    const auto unit = activeTextureUnit - GL_TEXTURE0;
+    if (unit >= textureUnits.size()) {
+        std::array<GLuint, NUM_TEXTURE_TARGETS> unknownTextures;
+        unknownTextures.fill(unknown);
+        textureUnits.resize(unit + 1, unknownTextures);
+    }
+
+    if (update(textureUnits[unit][textureTarget], texture)) glBindTexture(target, texture);
+}
+
+void enable(GLenum capability) {setCapability(capability, true);}
+void disable(GLenum capability) {setCapability(capability, false);}
+
+void depthFunc(GLenum func) {
+    if (update(depthFunction, static_cast<GLuint>(func))) glDepthFunc(func);
+}
+
+void depthMask(GLboolean flag) {
+    if (update(depthWriteMask, static_cast<GLuint>(flag))) glDepthMask(flag);
+}
+
+void cullFace(GLenum mode) {
+    if (update(cullFaceMode, static_cast<GLuint>(mode))) glCullFace(mode);
+}
+
+void blendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+    if (blendSourceFactor == sourceFactor && blendDestinationFactor == destinationFactor) {
+        ++statistics.numCallsSkipped;
+        return;
+    }
+
+    blendSourceFactor = sourceFactor;
+    blendDestinationFactor = destinationFactor;
+    ++statistics.numCallsIssued;
+    glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void deleteProgram(GLuint p) {
+    glDeleteProgram(p);
+
+    // A program in use is only deleted once it is no longer in use,
+    // so its name can't be reused before then.
+    uniforms.erase(p);
+}
+
+void deleteVertexArrays(GLsizei n, const GLuint *vaos) {
+    glDeleteVertexArrays(n, vaos);
+
+    if (std::find(vaos, vaos + n, vao) != vaos + n) {
+        vao = 0;
+    }
+}
+
+void deleteBuffers(GLsizei n, const GLuint *deletedBuffers) {
+    glDeleteBuffers(n, deletedBuffers);
+
+    for (auto &buffer : buffers) {
+        if (std::find(deletedBuffers, deletedBuffers + n, buffer.second) != deletedBuffers + n) {
+            buffer.second = 0;
+        }
+    }
+
+    for (auto &binding : indexedBuffers) {
+        if (std::find(deletedBuffers, deletedBuffers + n, binding.second.buffer) != deletedBuffers + n) {
+            binding.second = {0, 0, -1};
+        }
+    }
+}
+
+void deleteFramebuffers(GLsizei n, const GLuint *framebuffers) {
+    glDeleteFramebuffers(n, framebuffers);
+
+    if (std::find(framebuffers, framebuffers + n, drawFramebuffer) != framebuffers + n) {
+        drawFramebuffer = 0;
+    }
+
+    if (std::find(framebuffers, framebuffers + n, readFramebuffer) != framebuffers + n) {
+        readFramebuffer = 0;
+    }
+}
+
+void deleteTextures(GLsizei n, const GLuint *textures) {
+    glDeleteTextures(n, textures);
+
+    for (auto &unit : textureUnits) {
+        for (auto &texture : unit) {
+            if (std::find(textures, textures + n, texture) != textures + n) {
+                texture = 0;
+            }
+        }
+    }
+}
+
+bool updateUniform(GLuint p, GLint location, const void *value, size_t size_bytes) {
+    assert(size_bytes <= sizeof(glm::mat4) && "Uniform value is too large to cache");
+
+    auto &programUniforms = uniforms[p];
+    auto uniform = programUniforms.find(location);
+    if (uniform != programUniforms.end() &&
+        uniform->second.size_bytes == size_bytes &&
+        std::memcmp(uniform->second.data.data(), value, size_bytes) == 0) {
+        ++statistics.numCallsSkipped;
+        return false;
+    }
+
+    auto &cachedValue = programUniforms[location];
+    std::memcpy(cachedValue.data.data(), value, size_bytes);
+    cachedValue.size_bytes = size_bytes;
+
+    ++statistics.numCallsIssued;
+    return true;
+}
+
+} // namespace GLState
+} // namespace age
@@ -1,12 +1,77 @@
 #include <android_game_engine/Game.h>
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
 #include <GLES3/gl32.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include <android_game_engine/AssetLoader.h>
+#include <android_game_engine/Box.h>
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/GameObject.h>
 #include <android_game_engine/Exception.h>
 #include <android_game_engine/LightDirectional.h>
+#include <android_game_engine/Log.h>
 #include <android_game_engine/ManagerWindowing.h>
+#include <android_game_engine/PhysicsRigidBody.h>
+#include <android_game_engine/Trace.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+age::AABB getBoundingBox(const age::GameObject &gameObject) {
+    const auto position = gameObject.getPosition();
+    const auto extents = gameObject.getBoundingBoxExtents();
+    return {position - extents, position + extents};
+}
+
+age::AABB getBoundingBox(const age::RenderSnapshot::Object &object) {
+    return {object.position - object.boundingBoxExtents, object.position + object.boundingBoxExtents};
+}
+
+// Cascades whose light space changed in this many consecutive frames, e.g. while the camera
+// moves, draw their static casters with the dynamic ones instead of redrawing and copying
+// their static layer every frame
+constexpr unsigned int uncachedShadowCascadeFrames = 3;
+
+// Weight of the last frame in the average static layer refresh rate
+constexpr float staticLayerRefreshRateWeight = 1.0f / 32.0f;
+
+int64_t toNanoseconds(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+///
+/// \brief Light space matrices of the shadow cascades, laid out as the std140
+///        LightSpaceUB uniform block.
+///
+struct LightSpaceUniforms {
+    glm::mat4 lightSpace[age::ShadowCascades::maxCascades];
+    int32_t numCascades;
+    int32_t padding[3];
+};
+
+// Mesh of every box, a unit cube centered on the origin
+const auto boxOccluderMesh = std::make_shared<const age::OccluderMesh>(age::OccluderMesh{
+    {
+        {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {0.5f, 0.5f, -0.5f},
+        {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}
+    },
+    {
+        0, 2, 3, 0, 3, 1, // -z
+        4, 5, 7, 4, 7, 6, // +z
+        0, 1, 5, 0, 5, 4, // -y
+        2, 6, 7, 2, 7, 3, // +y
+        0, 4, 6, 0, 6, 2, // -x
+        1, 3, 7, 1, 7, 5  // +x
+    }
+});
+
+} // namespace
 
 namespace age {
 
@@ -16,9 +81,24 @@ Game::Game(JNIEnv *env, jobject javaApplicationContext, jobject javaActivityObje
                 defaultShader("shaders/Default.vert", "shaders/Default.frag"),
                 skyboxShader("shaders/Skybox.vert", "shaders/Skybox.frag"),
                 physicsDebugShader("shaders/PhysicsDebug.vert", "shaders/PhysicsDebug.frag"),
+                defaultMaterialUniforms(this->defaultShader),
+                viewPositionUniform(this->defaultShader.getUniformHandle<glm::vec3>("viewPosition")),
+                shadowMapUniform(this->defaultShader.getUniformHandle<int>("shadowMap")),
+                skyboxProjectionViewUniform(this->skyboxShader.getUniformHandle<glm::mat4>("projection_view")),
+                shadowCascadeUniform(this->shadowMapShader.getUniformHandle<int>("cascade")),
                 projectionViewUbo("ProjectionViewUB", sizeof(glm::mat4)),
-                lightSpaceUbo("LightSpaceUB", sizeof(glm::mat4)),
-                skybox(nullptr), cam(nullptr), directionalLight(nullptr), shadowMap(nullptr),
+                lightSpaceUbo("LightSpaceUB", sizeof(LightSpaceUniforms)),
+                drawUbo("DrawUB", 4 * 1024),
+                skybox(nullptr), cam(nullptr), directionalLight(nullptr), renderLight(nullptr), shadowMap(nullptr),
+                currentShadowCascade(0), worldListVersion(0),
+                updateNumber(0), renderedWorldListVersion(0), renderedStaticShadowVersion(0),
+                simulationStopping(false), simulationUpdatePending(false), pendingUpdateDuration(0.0f),
+                simulationBeginTime(0), simulationEndTime(0),
+                fixedTimestep(0.0f), maxFixedSteps(5), fixedTimeAccumulator(0.0),
+                camStepTransform{nullptr, glm::vec3(0.0f), glm::mat3(1.0f)}, stepTransformsSaved(false),
+                occlusionCuller(256, 128, 0), occlusionCulling(false), shadowLodBias(1),
+                staticShadowDelay(30), staticShadowVersion(0),
+                assetUploadTimeBudget(std::chrono::milliseconds(2)), assetUploadByteBudget(4 * 1024 * 1024),
                 physics(new PhysicsEngine(&this->physicsDebugShader)),
                 drawDebugPhysics(false) {
     // Link shaders to necessary UBOs
@@ -28,13 +108,23 @@ Game::Game(JNIEnv *env, jobject javaApplicationContext, jobject javaActivityObje
     this->defaultShader.setUniformBlockBinding(this->lightSpaceUbo);
     this->shadowMapShader.setUniformBlockBinding(this->lightSpaceUbo);
 
+    this->defaultShader.setUniformBlockBinding(this->drawUbo);
+
+    this->staticShadowLightSpaces.fill(glm::mat4(0.0f));
+    this->staticShadowsInvalid.fill(true);
+    this->shadowCascadeMovingFrames.fill(0);
+
     // Shadow depth map texture
     glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &this->shadowMapTextureUnit);
     this->shadowMapTextureUnit -= 1;
 
     // OpenGL settings
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_CULL_FACE);
+}
+
+Game::~Game() {
+    this->stopSimulationThread();
 }
 
 void Game::onCreate() {
@@ -53,9 +143,19 @@ void Game::onCreate() {
     this->directionalLight->setPosition({0.0f, 0.0f, lightLimit * 1.5f});
     this->directionalLight->setNormalDirection({1.0f, 1.0f, 1.0f});
     this->directionalLight->setLookAtPoint({0.0f, 0.0f, 0.0f});
+    this->renderLight = std::make_unique<LightDirectional>(*this->directionalLight);
 
-    const auto shadowMapDimension = 2048u;
-    this->shadowMap = std::make_unique<ShadowMap>(shadowMapDimension, shadowMapDimension);
+    // Shadows are spread over cascades fitted to the camera's frustum
+    const auto shadowMapDimension = this->shadowCascades.getResolution();
+    this->shadowMap = std::make_unique<ShadowMap>(shadowMapDimension, shadowMapDimension,
+                                                  this->shadowCascades.getNumCascades());
+}
+
+void Game::onDestroy() {
+    // The simulation thread calls into derived games, which are destroyed before Game
+    this->stopSimulationThread();
+
+    GameTemplate::onDestroy();
 }
 
 void Game::onWindowChanged(int width, int height, int displayRotation) {
@@ -64,97 +164,750 @@ void Game::onWindowChanged(int width, int height, int displayRotation) {
     this->cam->setAspectRatioWidthToHeight(static_cast<float>(width) / height);
 }
 
+void Game::update(std::chrono::duration<float> updateDuration) {
+    if (!this->isSimulationThreadEnabled()) {
+        auto &snapshot = this->snapshots.getWriteBuffer();
+        snapshot.updateBegin = Clock::now();
+        this->advance(updateDuration, snapshot);
+        snapshot.updateEnd = Clock::now();
+        this->snapshots.publish();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->simulationMutex);
+    if (this->simulationError) {
+        std::rethrow_exception(this->simulationError);
+    }
+
+    // Time keeps accumulating while the simulation thread is busy with a previous update
+    this->pendingUpdateDuration += updateDuration;
+    this->simulationUpdatePending = true;
+    this->simulationCondition.notify_one();
+}
+
+void Game::postEvent(std::function<void()> event) {
+    if (!this->isSimulationThreadEnabled()) {
+        event();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->simulationMutex);
+    this->pendingEvents.push_back(std::move(event));
+}
+
 void Game::onUpdate(std::chrono::duration<float> updateDuration) {
+    AGE_TRACE_SCOPE("Game::onUpdate");
     GameTemplate::onUpdate(updateDuration);
 
     this->cam->onUpdate(updateDuration);
     
     for (auto &gameObject : this->worldList) {
+        AGE_TRACE_SCOPE("GameObject::onUpdate");
+        gameObject->finishLoading();
         gameObject->onUpdate(updateDuration);
     }
 
-    this->physics->onUpdate(updateDuration);
+    if (this->isFixedTimestepEnabled()) {
+        this->physics->step(updateDuration);
+    } else {
+        this->physics->onUpdate(updateDuration);
+    }
     for (auto &gameObject : this->worldList) {
         gameObject->updateFromPhysics();
     }
+
+    this->updateWorldListIndex();
+}
+
+void Game::advance(std::chrono::duration<float> updateDuration, RenderSnapshot &snapshot) {
+    if (!this->isFixedTimestepEnabled()) {
+        this->onUpdate(updateDuration);
+        this->captureSnapshot(snapshot);
+        snapshot.numSteps = 1;
+        snapshot.interpolation = 1.0f;
+        snapshot.droppedDuration = std::chrono::duration<float>(0.0f);
+        return;
+    }
+
+    // Time beyond the catch-up budget is dropped so that a slow update doesn't make the next ones slower
+    const std::chrono::duration<double> timestep = this->fixedTimestep;
+    const auto maxAccumulated = timestep * this->maxFixedSteps;
+    this->fixedTimeAccumulator += updateDuration;
+    snapshot.droppedDuration = std::chrono::duration<float>(0.0f);
+    if (this->fixedTimeAccumulator > maxAccumulated) {
+        snapshot.droppedDuration = this->fixedTimeAccumulator - maxAccumulated;
+        this->fixedTimeAccumulator = maxAccumulated;
+    }
+
+    snapshot.numSteps = 0;
+    while (this->fixedTimeAccumulator >= timestep) {
+        this->saveStepTransforms();
+        this->onUpdate(this->fixedTimestep);
+        this->fixedTimeAccumulator -= timestep;
+        ++snapshot.numSteps;
+    }
+
+    this->captureSnapshot(snapshot);
+    snapshot.interpolation = static_cast<float>(this->fixedTimeAccumulator / timestep);
+    this->interpolateSnapshot(snapshot, snapshot.interpolation);
+}
+
+void Game::saveStepTransforms() {
+    this->worldListStepTransforms.clear();
+    for (const auto &gameObject : this->worldList) {
+        this->worldListStepTransforms.push_back({gameObject.get(), gameObject->getPosition(),
+                                                 gameObject->getOrientation()});
+    }
+
+    this->camStepTransform = {nullptr, this->cam->getPosition(), this->cam->getOrientation()};
+    this->stepTransformsSaved = true;
+}
+
+void Game::interpolateSnapshot(RenderSnapshot &snapshot, float interpolation) const {
+    if (!this->stepTransformsSaved) return;
+
+    auto interpolate = [interpolation](const StepTransform &previous, glm::vec3 &position, glm::mat3 &orientation) {
+        if (previous.position == position && previous.orientation == orientation) return false;
+
+        position = glm::mix(previous.position, position, interpolation);
+        orientation = glm::mat3_cast(glm::slerp(glm::quat_cast(previous.orientation), glm::quat_cast(orientation),
+                                                interpolation));
+        return true;
+    };
+
+    // The snapshot was just captured from the world list, their objects share indices
+    for (size_t i = 0; i < snapshot.worldList.size() && i < this->worldListStepTransforms.size(); ++i) {
+        const auto &previous = this->worldListStepTransforms[i];
+        const auto &gameObject = *this->worldList[i];
+        auto &object = snapshot.worldList[i];
+
+        // Objects added during the last step have no previous transform
+        if (previous.gameObject != &gameObject) continue;
+
+        auto position = gameObject.getPosition();
+        auto orientation = gameObject.getOrientation();
+        if (!interpolate(previous, position, orientation)) continue;
+
+        glm::mat4 modelMatrix(orientation);
+        modelMatrix[3] = glm::vec4(position, 1.0f);
+        modelMatrix = glm::scale(modelMatrix, gameObject.getScale());
+
+        object.position = position;
+        object.instance.model = modelMatrix;
+        object.instance.normal = glm::mat3(glm::transpose(glm::inverse(modelMatrix)));
+    }
+
+    auto position = this->cam->getPosition();
+    auto orientation = this->cam->getOrientation();
+    if (interpolate(this->camStepTransform, position, orientation)) {
+        snapshot.camera.position = position;
+        snapshot.camera.view = glm::lookAt(position, position + orientation[0], orientation[2]);
+    }
+}
+
+void Game::setFixedTimestep(std::chrono::duration<float> timestep, unsigned int maxStepsPerUpdate) {
+    this->fixedTimestep = std::max(timestep, std::chrono::duration<float>(0.0f));
+    this->maxFixedSteps = std::max(maxStepsPerUpdate, 1u);
+    this->fixedTimeAccumulator = std::chrono::duration<double>(0.0);
+
+    // Transforms from before the last step are only saved while stepping
+    this->worldListStepTransforms.clear();
+    this->stepTransformsSaved = false;
+}
+
+void Game::captureSnapshot(RenderSnapshot &snapshot) {
+    AGE_TRACE_SCOPE("Game::captureSnapshot");
+
+    // The snapshot being overwritten can hold the last references to meshes, whose GL
+    // objects must be released on the GL thread
+    if (this->isSimulationThreadEnabled() && !snapshot.worldList.empty()) {
+        auto retiredObjects = std::make_shared<std::vector<RenderSnapshot::Object>>();
+        retiredObjects->swap(snapshot.worldList);
+        AssetLoader::enqueueUpload([retiredObjects](){}, 0);
+    }
+
+    snapshot.updateNumber = ++this->updateNumber;
+    snapshot.worldListVersion = this->worldListVersion;
+    snapshot.staticShadowVersion = this->staticShadowVersion;
+
+    snapshot.camera = {this->cam->getPosition(), this->cam->getViewMatrix(), this->cam->getProjectionMatrix(),
+                       this->cam->getNearPlane(), this->cam->getFarPlane()};
+    snapshot.light = {this->directionalLight->getPosition(), this->directionalLight->getLookAtDirection(),
+                      this->directionalLight->getAmbient(), this->directionalLight->getDiffuse(),
+                      this->directionalLight->getSpecular()};
+    snapshot.worldListBounds = this->worldListIndex.getBounds();
+
+    snapshot.worldList.clear();
+    snapshot.worldList.reserve(this->worldList.size());
+    for (const auto &gameObject : this->worldList) {
+        // Objects that aren't instanceable are drawn through themselves, which would race with the update
+        assert((!this->isSimulationThreadEnabled() || gameObject->isInstanceable()) &&
+               "World list objects must be instanceable while the simulation thread is enabled");
+
+        const auto physicsBody = gameObject->getPhysicsBody();
+        const auto simulated = physicsBody != nullptr && physicsBody->getMass() > 0.0f && physicsBody->isActive();
+
+        snapshot.worldList.push_back({gameObject->getSharedMeshes(), gameObject->getInstance(),
+                                      gameObject->getPosition(), gameObject->getBoundingBoxExtents(),
+                                      gameObject->getSpecularExponent(), gameObject->getNumLods(),
+                                      gameObject->isInstanceable(), gameObject->isLoaded(), simulated});
+    }
+
+    snapshot.occluders.clear();
+    for (const auto &occluder : this->occluders) {
+        snapshot.occluders.push_back({occluder.mesh, occluder.gameObject->getModelMatrix()});
+    }
+
+    if (this->drawDebugPhysics) {
+        this->physics->captureDebug(snapshot.physicsDebugLines);
+    } else {
+        snapshot.physicsDebugLines.clear();
+    }
+}
+
+void Game::runSimulation() {
+    Trace::setThreadName("Simulation");
+
+    while (true) {
+        std::chrono::duration<float> updateDuration;
+        std::vector<std::function<void()>> events;
+        {
+            std::unique_lock<std::mutex> lock(this->simulationMutex);
+            this->simulationCondition.wait(lock, [this](){
+                return this->simulationUpdatePending || this->simulationStopping;
+            });
+            if (this->simulationStopping) return;
+
+            updateDuration = this->pendingUpdateDuration;
+            this->pendingUpdateDuration = std::chrono::duration<float>(0.0f);
+            this->simulationUpdatePending = false;
+            events.swap(this->pendingEvents);
+        }
+
+        try {
+            auto &snapshot = this->snapshots.getWriteBuffer();
+            snapshot.updateBegin = Clock::now();
+            this->simulationBeginTime = toNanoseconds(snapshot.updateBegin);
+
+            for (auto &event : events) {
+                event();
+            }
+            this->advance(updateDuration, snapshot);
+
+            snapshot.updateEnd = Clock::now();
+            this->simulationEndTime = toNanoseconds(snapshot.updateEnd);
+            this->snapshots.publish();
+        } catch (...) {
+            // Rethrown on the GL thread by the next update
+            std::lock_guard<std::mutex> lock(this->simulationMutex);
+            this->simulationError = std::current_exception();
+            return;
+        }
+    }
+}
+
+void Game::enableSimulationThread(bool enable) {
+    if (enable == this->isSimulationThreadEnabled()) return;
+
+    if (enable && !this->canUseSimulationThread()) {
+        throw Error("The game can't update on a simulation thread");
+    }
+
+    if (!enable) {
+        this->stopSimulationThread();
+
+        // Events that arrived after the last update still run, now on this thread
+        std::vector<std::function<void()>> events;
+        events.swap(this->pendingEvents);
+        for (auto &event : events) {
+            event();
+        }
+        return;
+    }
+
+    this->simulationStopping = false;
+    this->simulationUpdatePending = false;
+    this->pendingUpdateDuration = std::chrono::duration<float>(0.0f);
+    this->simulationError = nullptr;
+    this->simulationThread = std::thread(&Game::runSimulation, this);
+    Log::info("Updating the game on a simulation thread");
+}
+
+void Game::stopSimulationThread() {
+    if (!this->isSimulationThreadEnabled()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->simulationMutex);
+        this->simulationStopping = true;
+    }
+    this->simulationCondition.notify_one();
+    this->simulationThread.join();
+}
+
+void Game::updateWorldListIndex() {
+    // Proxies are only reinserted once objects move out of their enlarged boxes. Only objects with
+    // an active physics body or a changed transform or model can have moved since the last update.
+    for (size_t i = 0; i < this->worldList.size(); ++i) {
+        auto &gameObject = *this->worldList[i];
+        auto &proxy = this->worldListProxies[i];
+
+        const auto physicsBody = gameObject.getPhysicsBody();
+        const auto simulated = physicsBody != nullptr && physicsBody->getMass() > 0.0f && physicsBody->isActive();
+        const auto transform = gameObject.getModelMatrix();
+        const auto loaded = gameObject.isLoaded();
+        if (!simulated && transform == proxy.transform && loaded == proxy.loaded) continue;
+
+        proxy.transform = transform;
+        proxy.loaded = loaded;
+        this->worldListIndex.moveProxy(proxy.id, getBoundingBox(gameObject));
+    }
 }
 
 void Game::render() {
+    AGE_TRACE_SCOPE("Game::render");
+    const auto renderBegin = Clock::now();
+    this->processAssetUploads();
+    this->gpuProfiler.beginFrame();
+
+    // The simulation thread hasn't finished its first update yet
+    if (!this->acquireSnapshot()) {
+        this->renderWorldSetup();
+        return;
+    }
+
     this->updateUBOs();
+    this->prepareRenderQueue();
 
     this->renderShadowMapSetup();
     this->renderShadowMap();
 
     this->renderWorldSetup();
     this->renderWorld();
+
+    this->recordFrameTimeline(renderBegin);
+}
+
+bool Game::acquireSnapshot() {
+    this->snapshots.acquire();
+    const auto &snapshot = this->getSnapshot();
+
+    const auto &light = snapshot.light;
+    this->renderLight->setPosition(light.position);
+    this->renderLight->setLookAtDirection(light.direction);
+    this->renderLight->setAmbient(light.ambient);
+    this->renderLight->setDiffuse(light.diffuse);
+    this->renderLight->setSpecular(light.specular);
+
+    return snapshot.updateNumber > 0;
+}
+
+void Game::recordFrameTimeline(Clock::time_point renderBegin) {
+    const auto &snapshot = this->getSnapshot();
+
+    FrameTimeline timeline;
+    timeline.updateNumber = snapshot.updateNumber;
+    timeline.updateBegin = snapshot.updateBegin;
+    timeline.updateEnd = snapshot.updateEnd;
+    timeline.renderBegin = renderBegin;
+    timeline.renderEnd = Clock::now();
+    timeline.numSteps = snapshot.numSteps;
+    timeline.interpolation = snapshot.interpolation;
+    timeline.droppedDuration = snapshot.droppedDuration;
+
+    if (!this->frameTimelines.empty() && snapshot.updateNumber > this->frameTimelines.back().updateNumber) {
+        timeline.numUpdatesDropped = snapshot.updateNumber - this->frameTimelines.back().updateNumber - 1;
+    }
+
+    // Overlap with the update that ran last on the simulation thread, which is still running if it hasn't ended
+    if (this->isSimulationThreadEnabled()) {
+        const auto simulationBegin = this->simulationBeginTime.load();
+        auto simulationEnd = this->simulationEndTime.load();
+        if (simulationEnd < simulationBegin) simulationEnd = toNanoseconds(timeline.renderEnd);
+
+        const auto overlap = std::min(simulationEnd, toNanoseconds(timeline.renderEnd)) -
+                             std::max(simulationBegin, toNanoseconds(renderBegin));
+        timeline.overlap = std::chrono::nanoseconds(std::max<int64_t>(overlap, 0));
+    }
+
+    this->frameTimelines.push_back(timeline);
+    if (this->frameTimelines.size() > maxFrameTimelines) {
+        this->frameTimelines.pop_front();
+    }
+}
+
+void Game::processAssetUploads() {
+    AGE_TRACE_SCOPE("Game::processAssetUploads");
+    AssetLoader::processUploads(this->assetUploadTimeBudget, this->assetUploadByteBudget);
 }
 
 void Game::updateUBOs() {
-    const auto projectionView = this->cam->getProjectionMatrix() * this->cam->getViewMatrix();
+    const auto &snapshot = this->getSnapshot();
+    const auto projectionView = snapshot.camera.projection * snapshot.camera.view;
     this->projectionViewUbo.bufferSubData(0, sizeof(glm::mat4), glm::value_ptr(projectionView));
 
-    const auto lightSpace = this->directionalLight->getProjectionMatrix() *
-            this->directionalLight->getViewMatrix();
-    this->lightSpaceUbo.bufferSubData(0, sizeof(glm::mat4), glm::value_ptr(lightSpace));
+    this->shadowCascades.update(projectionView, snapshot.camera.nearPlane, snapshot.camera.farPlane,
+                                snapshot.light.direction, snapshot.worldListBounds);
+
+    LightSpaceUniforms lightSpaceUniforms {};
+    for (unsigned int cascade = 0; cascade < this->shadowCascades.getNumCascades(); ++cascade) {
+        lightSpaceUniforms.lightSpace[cascade] = this->shadowCascades.getLightSpaceMatrix(cascade);
+    }
+    lightSpaceUniforms.numCascades = this->shadowCascades.getNumCascades();
+    this->lightSpaceUbo.bufferSubData(0, sizeof(lightSpaceUniforms), &lightSpaceUniforms);
+}
+
+void Game::prepareRenderQueue() {
+    AGE_TRACE_SCOPE("Game::prepareRenderQueue");
+    this->renderQueue.clear();
+    this->buildRenderQueue();
+    this->renderQueue.sort();
+
+    this->renderQueue.writeDrawUniforms(this->drawUbo);
+}
+
+void Game::buildRenderQueue() {
+    this->resizeWorldListState();
+    this->cullWorldList();
+
+    if (this->occlusionCulling && !this->getSnapshot().occluders.empty()) {
+        this->occlusionCullWorldList();
+    } else {
+        this->occlusionCullingStatistics = {this->cameraCullingStatistics.numVisible, 0};
+    }
+
+    this->selectWorldListLods();
+    this->updateShadowCasters();
+
+    this->shadowStatistics.numStaticCasters = 0;
+    this->shadowStatistics.numDynamicCasters = 0;
+
+    const auto &worldList = this->getSnapshot().worldList;
+    for (unsigned int cascade = 0; cascade < this->shadowCascades.getNumCascades(); ++cascade) {
+        const auto &visibility = this->cascadeVisibility[cascade];
+
+        for (size_t i = 0; i < worldList.size(); ++i) {
+            if (!visibility[i]) continue;
+
+            // Static casters are only drawn when the static layer is redrawn, or every frame
+            // while the cascade moves
+            if (!this->staticShadowCasters[i] || !this->isStaticShadowCached(cascade)) {
+                this->addToRenderQueue(RenderQueue::Pass::SHADOW, i, &this->shadowMapShader,
+                                       nullptr, false, this->worldListLods[i] + this->shadowLodBias, cascade);
+                ++this->shadowStatistics.numDynamicCasters;
+            } else {
+                if (this->staticShadowsInvalid[cascade]) {
+                    this->addToRenderQueue(RenderQueue::Pass::STATIC_SHADOW, i,
+                                           &this->shadowMapShader, nullptr, false,
+                                           this->worldListLods[i] + this->shadowLodBias, cascade);
+                }
+                ++this->shadowStatistics.numStaticCasters;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < worldList.size(); ++i) {
+        if (this->cameraVisibility[i]) {
+            this->addToRenderQueue(RenderQueue::Pass::WORLD, i, &this->defaultShader,
+                                   &this->defaultMaterialUniforms, false, this->worldListLods[i]);
+        }
+    }
+}
+
+void Game::resizeWorldListState() {
+    const auto &snapshot = this->getSnapshot();
+
+    // Objects are only ever appended to the world list until it's cleared
+    if (snapshot.worldListVersion != this->renderedWorldListVersion ||
+        snapshot.worldList.size() < this->worldListLods.size()) {
+        this->worldListLods.clear();
+        this->staticShadowCasters.clear();
+        this->shadowCasterTransforms.clear();
+        this->shadowCasterStillFrames.clear();
+        this->staticShadowsInvalid.fill(true);
+        this->renderedWorldListVersion = snapshot.worldListVersion;
+    }
+
+    if (snapshot.staticShadowVersion != this->renderedStaticShadowVersion) {
+        this->staticShadowsInvalid.fill(true);
+        this->renderedStaticShadowVersion = snapshot.staticShadowVersion;
+    }
+
+    for (auto i = this->worldListLods.size(); i < snapshot.worldList.size(); ++i) {
+        this->worldListLods.push_back(0);
+        this->staticShadowCasters.push_back(0);
+        this->shadowCasterTransforms.push_back(snapshot.worldList[i].instance.model);
+        this->shadowCasterStillFrames.push_back(0);
+    }
+}
+
+void Game::cullWorldList() {
+    const auto &snapshot = this->getSnapshot();
+
+    // The world list index belongs to the update thread, so the snapshot's objects are culled
+    // linearly instead. Testing their boxes in SIMD batches costs about as much as querying the
+    // tree at 10000 objects, and fills the per-object visibility the later passes index.
+
+    this->worldListCuller.clear();
+    for (const auto &object : snapshot.worldList) {
+        this->worldListCuller.add(object.position, object.boundingBoxExtents);
+    }
+
+    this->cameraCullingStatistics = this->worldListCuller.cull(
+            snapshot.camera.projection * snapshot.camera.view, this->cameraVisibility);
+
+    // Every cascade only draws the casters inside its own light frustum
+    this->lightCullingStatistics = {};
+    this->lightVisibility.assign(snapshot.worldList.size(), 0);
+    for (unsigned int cascade = 0; cascade < this->shadowCascades.getNumCascades(); ++cascade) {
+        auto &visibility = this->cascadeVisibility[cascade];
+        const auto statistics = this->worldListCuller.cull(this->shadowCascades.getLightSpaceMatrix(cascade),
+                                                           visibility);
+        this->lightCullingStatistics.numVisible += statistics.numVisible;
+        this->lightCullingStatistics.numCulled += statistics.numCulled;
+
+        for (size_t i = 0; i < visibility.size(); ++i) {
+            this->lightVisibility[i] |= visibility[i];
+        }
+    }
+}
+
+void Game::occlusionCullWorldList() {
+    this->occlusionCullingStatistics = {};
+
+    const auto &snapshot = this->getSnapshot();
+
+    this->occlusionCuller.clearOccluders();
+    for (const auto &occluder : snapshot.occluders) {
+        this->occlusionCuller.addOccluder(*occluder.mesh, occluder.model);
+    }
+    this->occlusionCuller.rasterize(snapshot.camera.projection * snapshot.camera.view);
+
+    for (size_t i = 0; i < snapshot.worldList.size(); ++i) {
+        if (!this->cameraVisibility[i]) continue;
+
+        if (this->occlusionCuller.isVisible(getBoundingBox(snapshot.worldList[i]))) {
+            ++this->occlusionCullingStatistics.numVisible;
+        } else {
+            this->cameraVisibility[i] = 0;
+            ++this->occlusionCullingStatistics.numCulled;
+        }
+    }
+}
+
+void Game::selectWorldListLods() {
+    const auto &snapshot = this->getSnapshot();
+
+    for (size_t i = 0; i < snapshot.worldList.size(); ++i) {
+        if (!this->cameraVisibility[i] && !this->lightVisibility[i]) continue;
+
+        const auto &object = snapshot.worldList[i];
+        const auto screenSize = LodSelector::getScreenSize(object.position, glm::length(object.boundingBoxExtents),
+                                                           snapshot.camera.position, snapshot.camera.projection);
+        this->worldListLods[i] = static_cast<uint8_t>(
+                this->lodSelector.select(screenSize, this->worldListLods[i], object.numLods));
+    }
+}
+
+void Game::updateShadowCasters() {
+    // Static layers are drawn from the light of their cascade so they're stale once it moves.
+    // Cascades follow the camera, so they move every frame while it does.
+    for (unsigned int cascade = 0; cascade < this->shadowCascades.getNumCascades(); ++cascade) {
+        const auto &lightSpace = this->shadowCascades.getLightSpaceMatrix(cascade);
+        auto &movingFrames = this->shadowCascadeMovingFrames[cascade];
+        if (lightSpace != this->staticShadowLightSpaces[cascade]) {
+            this->staticShadowLightSpaces[cascade] = lightSpace;
+            this->staticShadowsInvalid[cascade] = true;
+            movingFrames = std::min(movingFrames + 1, uncachedShadowCascadeFrames);
+        } else {
+            movingFrames = 0;
+        }
+    }
+
+    const auto &worldList = this->getSnapshot().worldList;
+
+    auto reclassify = false;
+    for (size_t i = 0; i < worldList.size(); ++i) {
+        const auto &object = worldList[i];
+        const auto &modelMatrix = object.instance.model;
+
+        const auto isStill = object.loaded && modelMatrix == this->shadowCasterTransforms[i] && !object.simulated;
+        this->shadowCasterTransforms[i] = modelMatrix;
+        this->shadowCasterStillFrames[i] = isStill ?
+                std::min(this->shadowCasterStillFrames[i] + 1, this->staticShadowDelay) : 0;
+
+        if (this->staticShadowCasters[i]) {
+            // A cached caster that moved left its old shadow behind in the static layers
+            if (!isStill) reclassify = true;
+        } else if (this->shadowCasterStillFrames[i] >= this->staticShadowDelay) {
+            reclassify = true;
+        }
+    }
+
+    if (!reclassify) return;
+
+    // Casters can only move in or out of the static layers when all of them are redrawn
+    this->staticShadowsInvalid.fill(true);
+    for (size_t i = 0; i < worldList.size(); ++i) {
+        this->staticShadowCasters[i] = this->shadowCasterStillFrames[i] >= this->staticShadowDelay;
+    }
+}
+
+bool Game::isStaticShadowCached(unsigned int cascade) const {
+    return this->shadowCascadeMovingFrames[cascade] < uncachedShadowCascadeFrames;
+}
+
+void Game::addToRenderQueue(RenderQueue::Pass pass, GameObject *gameObject, ShaderProgram *shader,
+                            const MaterialUniforms *uniforms, bool translucent, unsigned int lod,
+                            unsigned int layer) {
+    this->renderQueue.add(pass, gameObject, shader, uniforms, this->getRenderDepth(pass, gameObject->getPosition()),
+                          translucent, lod, layer);
+}
+
+void Game::addToRenderQueue(RenderQueue::Pass pass, size_t worldListIndex, ShaderProgram *shader,
+                            const MaterialUniforms *uniforms, bool translucent, unsigned int lod,
+                            unsigned int layer) {
+    const auto &snapshot = this->getSnapshot();
+    const auto &object = snapshot.worldList[worldListIndex];
+
+    if (!object.instanceable) {
+        // Only captured without the simulation thread, so the world list is updated on this
+        // thread and only ever appended to until it's cleared
+        if (snapshot.worldListVersion == this->worldListVersion) {
+            this->addToRenderQueue(pass, this->worldList[worldListIndex].get(), shader, uniforms, translucent, lod, layer);
+        }
+        return;
+    }
+
+    this->renderQueue.add(pass, *object.meshes, object.instance, object.specularExponent, shader, uniforms,
+                          this->getRenderDepth(pass, object.position), translucent, lod, layer);
+}
+
+float Game::getRenderDepth(RenderQueue::Pass pass, const glm::vec3 &position) const {
+    const auto &snapshot = this->getSnapshot();
+
+    if (pass == RenderQueue::Pass::STATIC_SHADOW || pass == RenderQueue::Pass::SHADOW) {
+        return glm::dot(position - snapshot.light.position, snapshot.light.direction);
+    }
+    return glm::distance(position, snapshot.camera.position);
+}
+
+void Game::useShader(ShaderProgram *shaderProgram) {
+    shaderProgram->use();
+
+    if (shaderProgram == &this->defaultShader) {
+        this->defaultShader.setUniform(this->viewPositionUniform, this->getSnapshot().camera.position);
+
+        // Set shadow properties
+        this->bindShadowMap(&this->defaultShader, this->shadowMapUniform);
+        this->renderLight->render(&this->defaultShader);
+    } else if (shaderProgram == &this->shadowMapShader) {
+        this->shadowMapShader.setUniform(this->shadowCascadeUniform, static_cast<int>(this->currentShadowCascade));
+    }
 }
 
 void Game::renderShadowMapSetup() {
     glViewport(0, 0, this->shadowMap->getWidth(), this->shadowMap->getHeight());
-    this->shadowMap->bindFramebuffer();
-
-    glCullFace(GL_FRONT);
-    glClear(GL_DEPTH_BUFFER_BIT);
+    GLState::cullFace(GL_FRONT);
 }
 
 void Game::renderShadowMap() {
-    this->shadowMapShader.use();
-    for (auto &gameObject : this->worldList) {
-        gameObject->renderShadow(&this->shadowMapShader);
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto useShader = [this](ShaderProgram *shaderProgram){ this->useShader(shaderProgram); };
+
+    this->shadowStatistics.numStaticLayersRefreshed = 0;
+    this->shadowStatistics.numUncachedCascades = 0;
+    this->shadowStatistics.staticPass = {};
+    this->shadowStatistics.dynamicPass = {};
+    this->gpuProfiler.beginPass(GpuProfiler::Pass::SHADOW_MAP);
+    auto addStatistics = [](RenderQueue::Statistics &sum, const RenderQueue::Statistics &statistics) {
+        sum.numInstances += statistics.numInstances;
+        sum.numDrawCalls += statistics.numDrawCalls;
+        sum.numShaderChanges += statistics.numShaderChanges;
+        sum.numMaterialChanges += statistics.numMaterialChanges;
+    };
+
+    for (unsigned int cascade = 0; cascade < this->shadowCascades.getNumCascades(); ++cascade) {
+        this->currentShadowCascade = cascade;
+
+        // Moving cascades keep their static layer invalid until they stay put
+        const auto cached = this->isStaticShadowCached(cascade);
+        if (!cached) {
+            ++this->shadowStatistics.numUncachedCascades;
+        } else if (this->staticShadowsInvalid[cascade]) {
+            this->shadowMap->bindStaticFramebuffer(cascade);
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+            this->renderQueue.render(RenderQueue::Pass::STATIC_SHADOW, useShader, cascade);
+            addStatistics(this->shadowStatistics.staticPass,
+                          this->renderQueue.getStatistics(RenderQueue::Pass::STATIC_SHADOW, cascade));
+            ++this->shadowStatistics.numStaticLayersRefreshed;
+            this->staticShadowsInvalid[cascade] = false;
+        }
+
+        // Dynamic casters are drawn over a copy of the static layer
+        this->shadowMap->bindFramebuffer(cascade, cached);
+        this->renderQueue.render(RenderQueue::Pass::SHADOW, useShader, cascade);
+        addStatistics(this->shadowStatistics.dynamicPass,
+                      this->renderQueue.getStatistics(RenderQueue::Pass::SHADOW, cascade));
     }
+
+    const auto refreshRate = static_cast<float>(this->shadowStatistics.numStaticLayersRefreshed) /
+                             this->shadowCascades.getNumCascades();
+    this->shadowStatistics.staticLayerRefreshRate +=
+            (refreshRate - this->shadowStatistics.staticLayerRefreshRate) * staticLayerRefreshRateWeight;
+
+    this->gpuProfiler.endPass();
+    this->shadowStatistics.duration = std::chrono::steady_clock::now() - startTime;
 }
 
 void Game::renderWorldSetup() {
     glViewport(0, 0, ManagerWindowing::getWindowWidth(), ManagerWindowing::getWindowHeight());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glCullFace(GL_BACK);
+    GLState::cullFace(GL_BACK);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void Game::renderWorld() {
-    this->defaultShader.use();
-    this->defaultShader.setUniform("viewPosition", this->cam->getPosition());
-
-    // Set shadow properties
-    this->bindShadowMap(&this->defaultShader);
-    this->directionalLight->render(&this->defaultShader);
+    this->gpuProfiler.beginPass(GpuProfiler::Pass::WORLD);
+    this->renderQueue.render(RenderQueue::Pass::WORLD,
+                             [this](ShaderProgram *shaderProgram){ this->useShader(shaderProgram); });
+    this->gpuProfiler.endPass();
 
-    for (auto &gameObject : this->worldList) {
-        gameObject->render(&this->defaultShader);
-    }
+    const auto &snapshot = this->getSnapshot();
 
-    // Render physics debugging attributes
-    if (this->drawDebugPhysics) {
+    // Render physics debugging attributes captured with the update
+    if (!snapshot.physicsDebugLines.empty()) {
+        this->gpuProfiler.beginPass(GpuProfiler::Pass::PHYSICS_DEBUG);
         this->physicsDebugShader.use();
-        this->physics->renderDebug();
+        this->physics->renderDebug(snapshot.physicsDebugLines);
+        this->gpuProfiler.endPass();
     }
 
     // Render skybox
     if (this->skybox != nullptr) {
-        glDepthFunc(GL_LEQUAL);
-        auto view = this->cam->getViewMatrix();
+        this->gpuProfiler.beginPass(GpuProfiler::Pass::SKYBOX);
+        GLState::depthFunc(GL_LEQUAL);
+        auto view = snapshot.camera.view;
         view[3] = glm::vec4(0.0f);
         this->skyboxShader.use();
-        this->skyboxShader.setUniform("projection_view", this->cam->getProjectionMatrix() * view);
-        this->skybox->render(&this->defaultShader);
-        glDepthFunc(GL_LESS);
+        this->skyboxShader.setUniform(this->skyboxProjectionViewUniform,
+                                      snapshot.camera.projection * view);
+        this->skybox->render(&this->skyboxShader);
+        GLState::depthFunc(GL_LESS);
+        this->gpuProfiler.endPass();
     }
 }
 
-void Game::bindShadowMap(age::ShaderProgram *shaderProgram) {
-    glActiveTexture(GL_TEXTURE0 + this->shadowMapTextureUnit);
+void Game::renderWorldLayer(unsigned int layer) {
+    this->renderQueue.render(RenderQueue::Pass::WORLD,
+                             [this](ShaderProgram *shaderProgram){ this->useShader(shaderProgram); }, layer);
+}
+
+void Game::bindShadowMap(age::ShaderProgram *shaderProgram, UniformHandle<int> shadowMapUniform) {
+    GLState::activeTexture(GL_TEXTURE0 + this->shadowMapTextureUnit);
     this->shadowMap->bindDepthMap();
-    shaderProgram->setUniform("shadowMap", this->shadowMapTextureUnit);
+    shaderProgram->setUniform(shadowMapUniform, this->shadowMapTextureUnit);
 }
 
 bool Game::onTouchDownEvent(float x, float y) {
@@ -167,6 +920,33 @@ bool Game::onTouchUpEvent(float x, float y) {return true;}
 
 void Game::enablePhysicsDebugDrawer(bool enable) {this->drawDebugPhysics = enable;}
 
+void Game::enableOcclusionCulling(bool enable) {
+    // Games that never cull occluders don't keep idle rasterizer threads
+    if (enable) {
+        this->occlusionCuller.startWorkers();
+    }
+    this->occlusionCulling = enable;
+}
+
+void Game::setLodSelector(const LodSelector &lodSelector) {this->lodSelector = lodSelector;}
+
+void Game::setShadowLodBias(unsigned int shadowLodBias) {this->shadowLodBias = shadowLodBias;}
+
+void Game::setStaticShadowDelay(unsigned int numFrames) {
+    // Casters must be still for at least a frame to tell that they don't move
+    this->staticShadowDelay = std::max(numFrames, 1u);
+    this->staticShadowsInvalid.fill(true);
+}
+
+void Game::invalidateStaticShadows() {++this->staticShadowVersion;}
+
+void Game::setShadowDistance(float shadowDistance) {this->shadowCascades.setShadowDistance(shadowDistance);}
+
+void Game::setAssetUploadBudget(std::chrono::duration<float> timeBudget, size_t byteBudget) {
+    this->assetUploadTimeBudget = timeBudget;
+    this->assetUploadByteBudget = byteBudget;
+}
+
 void Game::setGravity(const glm::vec3 &gravity) {this->physics->setGravity(gravity);}
 
 void Game::setSkybox(std::unique_ptr<age::Skybox> skybox) {this->skybox = std::move(skybox);}
@@ -174,6 +954,8 @@ void Game::setSkybox(std::unique_ptr<age::Skybox> skybox) {this->skybox = std::m
 void Game::addToWorldList(std::shared_ptr<age::GameObject> gameObject) {
     this->registerPhysics(gameObject.get());
 
+    this->worldListProxies.push_back({this->worldListIndex.createProxy(getBoundingBox(*gameObject), gameObject.get()),
+                                      gameObject->getModelMatrix(), gameObject->isLoaded()});
     this->worldList.push_back(std::move(gameObject));
 }
 
@@ -182,7 +964,35 @@ void Game::clearWorldList() {
         this->unregisterPhysics(gameObject.get());
     }
 
+    for (const auto &proxy : this->worldListProxies) {
+        this->worldListIndex.destroyProxy(proxy.id);
+    }
+
+    // Off the GL thread, the objects can hold the last references to meshes, whose GL
+    // objects must be released on the GL thread
+    if (this->isSimulationThreadEnabled()) {
+        AssetLoader::enqueueUpload([retiredObjects = std::move(this->worldList)](){}, 0);
+    }
     this->worldList.clear();
+    this->worldListProxies.clear();
+
+    // Frames reset their per-object state once they render the cleared world list
+    ++this->worldListVersion;
+}
+
+void Game::addOccluder(std::shared_ptr<Box> occluder) {
+    this->addOccluder(std::move(occluder), boxOccluderMesh);
+}
+
+void Game::addOccluder(std::shared_ptr<GameObject> occluder, std::shared_ptr<const OccluderMesh> mesh) {
+    this->occluders.push_back({std::move(occluder), std::move(mesh)});
+}
+
+void Game::clearOccluders() {
+    if (this->isSimulationThreadEnabled()) {
+        AssetLoader::enqueueUpload([retiredOccluders = std::move(this->occluders)](){}, 0);
+    }
+    this->occluders.clear();
 }
 
 void Game::bindToProjectionViewUBO(age::ShaderProgram *shaderProgram) {
@@ -4,8 +4,10 @@
 
 #include <android_game_engine/ARPlane.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/LightDirectional.h>
 #include <android_game_engine/ManagerWindowing.h>
+#include <android_game_engine/Trace.h>
 
 namespace {
 const auto T_game_android = glm::rotate(glm::mat4(1.0f),
@@ -21,6 +23,9 @@ const auto R_ar_game = static_cast<glm::mat3>(glm::rotate(glm::mat4(1.0f),
                                               glm::rotate(glm::mat4(1.0f),
                                                           glm::radians(90.0f),
                                                           {0.0f, 1.0f, 0.0f}));
+
+// Planes are drawn in their own layer of the world pass so that they're timed separately
+constexpr unsigned int planeLayer = 1;
 } // namespace
 
 namespace age {
@@ -29,7 +34,9 @@ GameAR::GameAR(JNIEnv *env, jobject javaApplicationContext, jobject javaActivity
     Game(env, javaApplicationContext, javaActivityObject),
     arCameraBackgroundShader("shaders/ARCameraBackground.vert", "shaders/ARCameraBackground.frag"),
     arPlaneShader("shaders/ARPlane.vert", "shaders/ARPlane.frag"),
-    arPlaneShadowedShader("shaders/ARPlaneShadowed.vert", "shaders/ARPlaneShadowed.frag") {
+    arPlaneShadowedShader("shaders/ARPlaneShadowed.vert", "shaders/ARPlaneShadowed.frag"),
+    arPlaneShadowMapUniform(this->arPlaneShader.getUniformHandle<int>("shadowMap")),
+    arPlaneShadowedShadowMapUniform(this->arPlaneShadowedShader.getUniformHandle<int>("shadowMap")) {
 
     this->bindToProjectionViewUBO(&this->arPlaneShader);
 
@@ -37,8 +44,8 @@ GameAR::GameAR(JNIEnv *env, jobject javaApplicationContext, jobject javaActivity
     this->bindToLightSpaceUBO(&this->arPlaneShadowedShader);
 
     // Enable blending for transparent plane indicators
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 GameAR::~GameAR() {
@@ -117,6 +124,7 @@ void GameAR::onWindowChanged(int width, int height, int displayRotation) {
 }
 
 void GameAR::onUpdate(std::chrono::duration<float> updateDuration) {
+    AGE_TRACE_SCOPE("GameAR::onUpdate");
     Game::onUpdate(updateDuration);
 
     if (this->arSession == nullptr) return;
@@ -125,6 +133,9 @@ void GameAR::onUpdate(std::chrono::duration<float> updateDuration) {
     ArSession_setCameraTextureName(this->arSession, this->arCameraBackground.getTexture());
     ArSession_update(this->arSession, this->arFrame);
 
+    // ARCore may change GL state when updating the camera texture
+    GLState::reset();
+
     this->updateCamera();
 
     this->arCameraBackground.onUpdate(this->arSession, this->arFrame);
@@ -229,6 +240,7 @@ void GameAR::updatePlanes() {
         if (this->floor == nullptr) {
             this->floor = std::make_shared<ARPlane>(Texture2D("images/trigrid.png"));
             this->registerPhysics(this->floor.get());
+            this->addOccluder(this->floor, this->floor->getOccluderMesh());
 
             // Signal to Java activity that a plane was found
             auto env = this->getJNIEnv();
@@ -276,8 +288,12 @@ void GameAR::updateDirectionalLight() {
 }
 
 void GameAR::render() {
+    AGE_TRACE_SCOPE("GameAR::render");
     if (this->arSession == nullptr) return;
 
+    this->processAssetUploads();
+    this->getGpuProfiler().beginFrame();
+    if (!this->acquireSnapshot()) return;
     this->updateUBOs();
 
     // Render camera image in background
@@ -288,34 +304,57 @@ void GameAR::render() {
     int64_t arFrameTimestamp;
     ArFrame_getTimestamp(this->arSession, this->arFrame, &arFrameTimestamp);
 
+    this->getGpuProfiler().beginPass(GpuProfiler::Pass::AR_BACKGROUND);
     this->arCameraBackground.render(&this->arCameraBackgroundShader, arFrameTimestamp);
+    this->getGpuProfiler().endPass();
 
     // Don't render world scene if camera is not tracking
     if (this->arCameraTrackingState != AR_TRACKING_STATE_TRACKING) return;
 
     // Render world scene
+    this->prepareRenderQueue();
     this->renderShadowMapSetup();
     this->renderShadowMap();
 
     glViewport(0, 0, ManagerWindowing::getWindowWidth(), ManagerWindowing::getWindowHeight());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glCullFace(GL_BACK);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::cullFace(GL_BACK);
     this->renderWorld();
 
-    // Render planes
+    this->getGpuProfiler().beginPass(GpuProfiler::Pass::AR_PLANE);
+    this->renderWorldLayer(planeLayer);
+    this->getGpuProfiler().endPass();
+}
+
+void GameAR::buildRenderQueue() {
+    Game::buildRenderQueue();
+
+    // Planes are translucent so they're drawn over the world with depth writes disabled
     if (this->floor != nullptr) {
         auto floorShader = (this->state == State::TRACK_PLANES) ?
                 &this->arPlaneShader : &this->arPlaneShadowedShader;
+        this->addToRenderQueue(RenderQueue::Pass::WORLD, this->floor.get(), floorShader, nullptr, true,
+                               0, planeLayer);
+    }
+}
 
-        glDepthMask(GL_FALSE);
-        floorShader->use();
-        this->bindShadowMap(floorShader);
-        this->floor->render(floorShader);
-
-        glDepthMask(GL_TRUE);
+void GameAR::useShader(ShaderProgram *shaderProgram) {
+    if (shaderProgram == &this->arPlaneShader) {
+        shaderProgram->use();
+        this->bindShadowMap(shaderProgram, this->arPlaneShadowMapUniform);
+    } else if (shaderProgram == &this->arPlaneShadowedShader) {
+        shaderProgram->use();
+        this->bindShadowMap(shaderProgram, this->arPlaneShadowedShadowMapUniform);
+    } else {
+        Game::useShader(shaderProgram);
     }
 }
 
+bool GameAR::canUseSimulationThread() const {
+    // ARCore updates the camera and planes from the GL thread
+    return false;
+}
+
 bool GameAR::onTouchDownEvent(float x, float y) {
     return Game::onTouchDownEvent(x, y) && this->stateOnTouchDownEvent(x, y);
 }
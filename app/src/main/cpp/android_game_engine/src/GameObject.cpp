@@ -1,18 +1,38 @@
 #include <android_game_engine/GameObject.h>
 
+#include <algorithm>
 #include <tuple>
+#include <vector>
 
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <glm/common.hpp>
 #include <glm/mat3x3.hpp>
 #include <glm/vec3.hpp>
 
+#include <android_game_engine/AssetLoader.h>
+#include <android_game_engine/Box.h>
 #include <android_game_engine/ModelLoader3ds.h>
 #include <android_game_engine/ShaderProgram.h>
+#include <android_game_engine/Trace.h>
 
 namespace age {
 
 GameObject::GameObject() : meshes(std::make_shared<Meshes>()) {}
 
-GameObject::GameObject(const std::string &modelFilepath){
+GameObject::GameObject(const std::string &modelFilepath, LoadMode mode){
+    if (mode == LoadMode::ASYNCHRONOUS) {
+        // Use the meshes and collision shape of a unit box until the model is loaded
+        const Box placeholder(std::vector<Texture2D>{}, std::vector<Texture2D>{});
+        this->meshes = static_cast<const GameObject&>(placeholder).meshes;
+        this->unscaledDimensions = glm::vec3(1.0f);
+        this->physicsBody = std::make_unique<PhysicsRigidBody>(this,
+                                                               std::make_unique<btBoxShape>(btVector3(0.5f, 0.5f, 0.5f)));
+
+        this->asyncModel = ModelLoader3ds::loadAsync(modelFilepath);
+        this->finishLoading();
+        return;
+    }
+
     ModelLoader3ds modelLoader(modelFilepath);
     this->unscaledDimensions = modelLoader.loadDimensions();
     this->meshes = std::move(modelLoader.loadMeshes());
@@ -23,6 +43,7 @@ GameObject::GameObject(const std::string &modelFilepath){
 void GameObject::onUpdate(std::chrono::duration<float> updateDuration) {}
 
 void GameObject::updateFromPhysics() {
+    AGE_TRACE_SCOPE("GameObject::updateFromPhysics");
     if (this->physicsBody && this->physicsBody->isActive()) {
         auto transform = this->physicsBody->getTransform();
         this->model.setOrientation(std::get<0>(transform));
@@ -30,30 +51,62 @@ void GameObject::updateFromPhysics() {
     }
 }
 
+void GameObject::finishLoading() {
+    if (!this->asyncModel || !this->asyncModel->isDone) return;
+
+    // Keep the placeholder if loading failed
+    if (this->asyncModel->loader) {
+        // The placeholder's GL objects must be released on the GL thread, which may not be this one
+        AssetLoader::enqueueUpload([placeholder = std::move(this->meshes)](){}, 0);
+
+        this->meshes = this->asyncModel->meshes;
+        this->unscaledDimensions = this->asyncModel->loader->loadDimensions();
+        this->physicsBody->setCollisionShape(this->asyncModel->loader->loadCollisionShape());
+    }
+
+    this->asyncModel.reset();
+}
+
 void GameObject::renderShadow(ShaderProgram *shader) {
-    shader->setUniform("model", this->model.getModelMatrix());
+    const auto instance = this->getInstance();
 
     for (auto& mesh : *this->meshes) {
-        mesh.renderVAO(shader);
+        mesh.renderVAO(&instance, 1);
     }
 }
 
-void GameObject::render(ShaderProgram *shader) {
-    shader->setUniform("model", this->model.getModelMatrix());
-    shader->setUniform("normal", this->model.getNormalMatrix());
+void GameObject::render(ShaderProgram *shader, const MaterialUniforms *uniforms) {
+    if (uniforms == nullptr) {
+        this->renderShadow(shader);
+        return;
+    }
 
-    shader->setUniform("material.specularExponent", this->specularExponent);
+    const auto instance = this->getInstance();
+
+    shader->setUniform(uniforms->specularExponent, this->specularExponent);
 
     for (auto& mesh : *this->meshes) {
-        mesh.bindTextures(shader);
-        mesh.renderVAO(shader);
+        mesh.bindTextures(shader, *uniforms);
+        mesh.renderVAO(&instance, 1);
     }
 }
 
+VertexArray::Instance GameObject::getInstance() const {
+    return {this->model.getModelMatrix(), this->model.getNormalMatrix(), this->color};
+}
+
 void GameObject::setMesh(std::shared_ptr<Meshes> mesh) {
     this->meshes = std::move(mesh);
 }
 
+unsigned int GameObject::getNumLods() const {
+    unsigned int numLods = 1;
+    for (const auto &mesh : *this->meshes) {
+        numLods = std::max(numLods, mesh.getNumLods());
+    }
+    return numLods;
+}
+
 void GameObject::setPosition(const glm::vec3 &position) {
     this->model.setPosition(position);
     
@@ -136,6 +189,12 @@ void GameObject::setScale(const glm::vec3& scale) {
     }
 }
 
+glm::vec3 GameObject::getBoundingBoxExtents() const {
+    const auto orientation = this->getOrientation();
+    const glm::mat3 absOrientation(glm::abs(orientation[0]), glm::abs(orientation[1]), glm::abs(orientation[2]));
+    return absOrientation * (this->getScaledDimensions() * 0.5f);
+}
+
 void GameObject::setCollisionShapeScale(const glm::vec3 &scale) {
     this->physicsBody->setScale(scale);
 }
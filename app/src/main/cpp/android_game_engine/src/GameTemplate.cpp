@@ -1,6 +1,37 @@
 #include <android_game_engine/GameTemplate.h>
 
+#include <string>
+
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/ProgramBinaryCache.h>
+#include <android_game_engine/Trace.h>
+
+namespace {
+
+///
+/// \brief getCacheDirectory Returns the app's cache directory, Context.getCacheDir().
+///
+std::string getCacheDirectory(JNIEnv *env, jobject javaApplicationContext) {
+    auto contextClass = env->GetObjectClass(javaApplicationContext);
+    auto getCacheDir = env->GetMethodID(contextClass, "getCacheDir", "()Ljava/io/File;");
+    auto cacheDir = env->CallObjectMethod(javaApplicationContext, getCacheDir);
+
+    auto fileClass = env->GetObjectClass(cacheDir);
+    auto getAbsolutePath = env->GetMethodID(fileClass, "getAbsolutePath", "()Ljava/lang/String;");
+    auto path = static_cast<jstring>(env->CallObjectMethod(cacheDir, getAbsolutePath));
+
+    auto pathChars = env->GetStringUTFChars(path, nullptr);
+    std::string cacheDirectory(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+
+    env->DeleteLocalRef(path);
+    env->DeleteLocalRef(fileClass);
+    env->DeleteLocalRef(cacheDir);
+    env->DeleteLocalRef(contextClass);
+    return cacheDirectory;
+}
+
+} // namespace
 
 namespace age {
 
@@ -8,6 +39,12 @@ GameTemplate::GameTemplate(JNIEnv *env, jobject javaApplicationContext, jobject
     if (env->GetJavaVM(&this->javaVM) != JNI_OK) throw JNIError("Failed to obtain Java VM.");
     this->javaApplicationContext = env->NewGlobalRef(javaApplicationContext);
     this->javaActivityObject = env->NewGlobalRef(javaActivityObject);
+
+    Trace::setThreadName("GL");
+
+    // Shader programs are created by the derived games' constructors
+    this->cacheDirectory = getCacheDirectory(env, javaApplicationContext);
+    ProgramBinaryCache::init(this->cacheDirectory + "/program_binaries");
 }
 
 GameTemplate::~GameTemplate() {
@@ -34,9 +71,15 @@ void GameTemplate::onPause() {}
 void GameTemplate::onStop() {}
 void GameTemplate::onDestroy() {}
 void GameTemplate::onWindowChanged(int width, int height, int displayRotation) {}
+void GameTemplate::update(std::chrono::duration<float> updateDuration) {this->onUpdate(updateDuration);}
 void GameTemplate::onUpdate(std::chrono::duration<float> updateDuration) {}
+void GameTemplate::postEvent(std::function<void()> event) {event();}
 bool GameTemplate::onTouchDownEvent(float x, float y) {return true;}
 bool GameTemplate::onTouchMoveEvent(float x, float y) {return true;}
 bool GameTemplate::onTouchUpEvent(float x, float y) {return true;}
 
+bool GameTemplate::writeTrace(const std::string &filename) {
+    return Trace::writeChromeJson(this->cacheDirectory + "/" + filename);
+}
+
 } // namespace age
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <android_game_engine/GpuProfiler.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include <EGL/egl.h>
+
+#include <android_game_engine/Log.h>
+#include <android_game_engine/Trace.h>
+
+namespace {
+
+bool hasExtension(const char *name) {
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+    for (GLint i = 0; i < numExtensions; ++i) {
+        auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension != nullptr && std::strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+///
+/// \brief percentile Returns the nearest-rank percentile of sorted samples.
+///
+template<typename T>
+T percentile(const std::vector<T> &sortedSamples, float fraction) {
+    const auto rank = static_cast<size_t>(std::ceil(fraction * sortedSamples.size()));
+    return sortedSamples[std::min(std::max<size_t>(rank, 1), sortedSamples.size()) - 1];
+}
+
+} // namespace
+
+namespace age {
+
+GpuProfiler::GpuProfiler() {
+    if (hasExtension("GL_EXT_disjoint_timer_query")) {
+        this->getQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+                eglGetProcAddress("glGetQueryObjectui64vEXT"));
+    }
+
+    if (!this->isGpuTimed()) {
+        Log::info("GL_EXT_disjoint_timer_query is not supported, render passes are timed on the CPU");
+        return;
+    }
+
+    for (auto &frame : this->frames) {
+        glGenQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+
+    // Clear a disjoint operation reported before the first frame
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+}
+
+GpuProfiler::~GpuProfiler() {
+    if (!this->isGpuTimed()) return;
+
+    for (auto &frame : this->frames) {
+        glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+void GpuProfiler::beginFrame() {
+    assert(!this->passActive && "Pass was not ended before the next frame");
+
+    if (!this->isGpuTimed()) return;
+
+    // Reading the flag clears it, so it tells whether any query in flight may be invalid
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    // Collect from the oldest frame on; queries complete in order so a frame that isn't ready stops the search
+    for (unsigned int i = 1; i <= numFrames; ++i) {
+        auto &frame = this->frames[(this->currentFrame + i) % numFrames];
+        if (!frame.pending) continue;
+
+        if (disjoint) {
+            frame.pending = false;
+            ++this->numFramesDiscarded;
+        } else if (!this->collectFrame(frame)) {
+            break;
+        }
+    }
+
+    this->currentFrame = (this->currentFrame + 1) % numFrames;
+    auto &frame = this->frames[this->currentFrame];
+
+    // Don't wait on a frame that is still in flight after the whole ring was used
+    if (frame.pending) {
+        frame.pending = false;
+        ++this->numFramesDiscarded;
+    }
+    frame.issued.fill(false);
+}
+
+bool GpuProfiler::collectFrame(Frame &frame) {
+    for (size_t pass = 0; pass < numPasses; ++pass) {
+        if (!frame.issued[pass]) continue;
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.queries[pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) return false;
+    }
+
+    for (size_t pass = 0; pass < numPasses; ++pass) {
+        if (!frame.issued[pass]) continue;
+
+        GLuint64 elapsed = 0;
+        this->getQueryObjectui64v(frame.queries[pass], GL_QUERY_RESULT, &elapsed);
+        this->addSample(static_cast<Pass>(pass), Nanoseconds(elapsed));
+    }
+
+    frame.pending = false;
+    return true;
+}
+
+void GpuProfiler::beginPass(Pass pass) {
+    assert(!this->passActive && "Passes can't be nested");
+    this->passActive = true;
+    this->currentPass = pass;
+    this->passBeginTime = std::chrono::steady_clock::now();
+
+    if (this->isGpuTimed()) {
+        const auto index = static_cast<size_t>(pass);
+        auto &frame = this->frames[this->currentFrame];
+        assert(!frame.issued[index] && "Pass was already timed in this frame");
+
+        glBeginQuery(GL_TIME_ELAPSED_EXT, frame.queries[index]);
+    }
+}
+
+void GpuProfiler::endPass() {
+    assert(this->passActive && "No pass was begun");
+    this->passActive = false;
+    const auto passEndTime = std::chrono::steady_clock::now();
+
+    if (this->isGpuTimed()) {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+
+        auto &frame = this->frames[this->currentFrame];
+        frame.issued[static_cast<size_t>(this->currentPass)] = true;
+        frame.pending = true;
+    } else {
+        this->addSample(this->currentPass, std::chrono::duration_cast<Nanoseconds>(
+                passEndTime - this->passBeginTime));
+    }
+
+#ifdef AGE_TRACE
+    // The CPU side of the pass shows up in the trace
+    if (Trace::isEnabled()) {
+        Trace::record(getPassName(this->currentPass), this->passBeginTime, passEndTime);
+    }
+#endif
+}
+
+void GpuProfiler::addSample(Pass pass, Nanoseconds duration) {
+    auto &passSamples = this->samples[static_cast<size_t>(pass)];
+    passSamples.push_back(duration);
+    if (passSamples.size() > maxSamples) {
+        passSamples.pop_front();
+    }
+}
+
+GpuProfiler::Statistics GpuProfiler::getStatistics(Pass pass) const {
+    const auto &passSamples = this->samples[static_cast<size_t>(pass)];
+
+    Statistics statistics;
+    if (passSamples.empty()) return statistics;
+
+    std::vector<Nanoseconds> sortedSamples(passSamples.begin(), passSamples.end());
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+
+    statistics.numSamples = static_cast<unsigned int>(sortedSamples.size());
+    statistics.last = passSamples.back();
+    statistics.average = std::accumulate(sortedSamples.begin(), sortedSamples.end(), Nanoseconds(0)) /
+                         sortedSamples.size();
+    statistics.percentile50 = percentile(sortedSamples, 0.50f);
+    statistics.percentile95 = percentile(sortedSamples, 0.95f);
+    statistics.percentile99 = percentile(sortedSamples, 0.99f);
+    return statistics;
+}
+
+const char* GpuProfiler::getPassName(Pass pass) {
+    switch (pass) {
+        case Pass::SHADOW_MAP: return "shadow map";
+        case Pass::WORLD: return "world";
+        case Pass::PHYSICS_DEBUG: return "physics debug";
+        case Pass::SKYBOX: return "skybox";
+        case Pass::AR_BACKGROUND: return "AR background";
+        case Pass::AR_PLANE: return "AR plane";
+        default: return "unknown";
+    }
+}
+
+} // namespace age
@@ -0,0 +1,191 @@
+#include <android_game_engine/Ktx.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+
+#include <android_game_engine/Exception.h>
+
+namespace {
+
+const std::array<uint8_t, 12> identifier {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr uint32_t endianness = 0x04030201;
+constexpr size_t numHeaderWords = 13;
+
+uint32_t byteSwap(uint32_t value) {
+    return ((value & 0xFFu) << 24u) | ((value & 0xFF00u) << 8u) |
+           ((value >> 8u) & 0xFF00u) | (value >> 24u);
+}
+
+size_t alignTo4(size_t size) {
+    return (size + 3u) & ~size_t(3);
+}
+
+///
+/// \brief getMaxMipmapLevels Returns floor(log2(max(width, height))) + 1, the length of a
+///                            full mipmap chain.
+///
+uint32_t getMaxMipmapLevels(uint32_t width, uint32_t height) {
+    auto numLevels = 1u;
+    for (auto size = std::max(width, height); size > 1u; size >>= 1u) {
+        ++numLevels;
+    }
+    return numLevels;
+}
+
+///
+/// \brief Reads 32-bit words from a KTX file, swapping them if the file was written
+///        with the opposite byte order.
+///
+class KtxReader {
+public:
+    KtxReader(const uint8_t *data, size_t size) : data(data), size(size) {}
+
+    void setByteSwap(bool swap) {this->swap = swap;}
+
+    uint32_t readWord() {
+        uint32_t word;
+        std::memcpy(&word, this->readBytes(sizeof(word)), sizeof(word));
+        return this->swap ? byteSwap(word) : word;
+    }
+
+    const uint8_t* readBytes(size_t count) {
+        if (count > this->size - this->offset) {
+            throw age::LoadError("Unexpected end of KTX file.");
+        }
+
+        const auto *bytes = this->data + this->offset;
+        this->offset += count;
+        return bytes;
+    }
+
+    void skip(size_t count) {this->readBytes(count);}
+
+private:
+    const uint8_t *data;
+    size_t size;
+    size_t offset = 0;
+    bool swap = false;
+};
+
+void appendWord(std::vector<uint8_t> &data, uint32_t word) {
+    const auto *bytes = reinterpret_cast<const uint8_t*>(&word);
+    data.insert(data.end(), bytes, bytes + sizeof(word));
+}
+
+} // namespace
+
+namespace age {
+
+KtxTexture KtxTexture::read(const uint8_t *data, size_t size) {
+    if (size < identifier.size() || !std::equal(identifier.cbegin(), identifier.cend(), data)) {
+        throw LoadError("Missing KTX 1.1 file identifier.");
+    }
+
+    KtxReader reader(data, size);
+    reader.skip(identifier.size());
+
+    const auto fileEndianness = reader.readWord();
+    const auto swapped = fileEndianness != endianness;
+    if (swapped) {
+        if (byteSwap(fileEndianness) != endianness) {
+            throw LoadError("Invalid KTX endianness.");
+        }
+        reader.setByteSwap(true);
+    }
+
+    KtxTexture texture;
+    texture.glType = reader.readWord();
+    texture.glTypeSize = reader.readWord();
+    texture.glFormat = reader.readWord();
+    texture.glInternalFormat = reader.readWord();
+    texture.glBaseInternalFormat = reader.readWord();
+    texture.width = reader.readWord();
+    texture.height = reader.readWord();
+    const auto depth = reader.readWord();
+    const auto numArrayElements = reader.readWord();
+    texture.numFaces = reader.readWord();
+    texture.numMipmapLevels = reader.readWord();
+    const auto keyValueDataSize = reader.readWord();
+
+    if (depth > 1 || numArrayElements > 0) {
+        throw LoadError("3D and array KTX textures are not supported.");
+    }
+    if (texture.numFaces != 1 && texture.numFaces != 6) {
+        throw LoadError("Invalid number of KTX faces: " + std::to_string(texture.numFaces));
+    }
+    if (texture.isCompressed() != (texture.glFormat == 0)) {
+        throw LoadError("KTX glType and glFormat must both be 0 for compressed textures.");
+    }
+    if (texture.glTypeSize != 1 && swapped) {
+        throw LoadError("Byte swapping KTX image data is not supported.");
+    }
+    if (texture.width == 0 || texture.height == 0) {
+        throw LoadError("KTX textures must have a width and height, 1D textures are not supported.");
+    }
+
+    // Checked before reserving the images, so that a corrupt header can't request billions of them
+    const auto maxMipmapLevels = getMaxMipmapLevels(texture.width, texture.height);
+    if (texture.numMipmapLevels > maxMipmapLevels) {
+        throw LoadError("Invalid number of KTX mipmap levels: " + std::to_string(texture.numMipmapLevels) +
+                        ", a " + std::to_string(texture.width) + "x" + std::to_string(texture.height) +
+                        " texture has at most " + std::to_string(maxMipmapLevels));
+    }
+
+    reader.skip(keyValueDataSize);
+
+    const auto numLevels = std::max(texture.numMipmapLevels, 1u);
+    texture.images.reserve(numLevels * texture.numFaces);
+    for (auto level = 0u; level < numLevels; ++level) {
+        const auto imageSize = reader.readWord();
+
+        for (auto face = 0u; face < texture.numFaces; ++face) {
+            const auto *image = reader.readBytes(imageSize);
+            texture.images.emplace_back(image, image + imageSize);
+
+            // Cube faces are padded to 4 bytes, which also pads the mipmap level
+            reader.skip(alignTo4(imageSize) - imageSize);
+        }
+    }
+
+    return texture;
+}
+
+std::vector<uint8_t> KtxTexture::write() const {
+    std::vector<uint8_t> data(identifier.cbegin(), identifier.cend());
+
+    const uint32_t header[numHeaderWords] = {
+        endianness,
+        this->glType,
+        this->glTypeSize,
+        this->glFormat,
+        this->glInternalFormat,
+        this->glBaseInternalFormat,
+        this->width,
+        this->height,
+        0u, // pixelDepth
+        0u, // numberOfArrayElements
+        this->numFaces,
+        this->numMipmapLevels,
+        0u // bytesOfKeyValueData
+    };
+    for (auto word : header) {
+        appendWord(data, word);
+    }
+
+    const auto numLevels = std::max(this->numMipmapLevels, 1u);
+    for (auto level = 0u; level < numLevels; ++level) {
+        appendWord(data, static_cast<uint32_t>(this->getImage(level, 0).size()));
+
+        for (auto face = 0u; face < this->numFaces; ++face) {
+            const auto &image = this->getImage(level, face);
+            data.insert(data.end(), image.cbegin(), image.cend());
+            data.resize(alignTo4(data.size()), 0);
+        }
+    }
+
+    return data;
+}
+
+} // namespace age
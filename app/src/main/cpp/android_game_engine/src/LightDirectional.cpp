@@ -18,10 +18,18 @@ glm::mat4 LightDirectional::getProjectionMatrix() const {
 }
 
 void LightDirectional::render(ShaderProgram *shader) {
-    shader->setUniform("directionalLight.direction", this->getLookAtDirection());
-    shader->setUniform("directionalLight.lighting.ambient", this->getAmbient());
-    shader->setUniform("directionalLight.lighting.diffuse", this->getDiffuse());
-    shader->setUniform("directionalLight.lighting.specular", this->getSpecular());
+    if (shader != this->uniformsShader) {
+        this->directionUniform = shader->getUniformHandle<glm::vec3>("directionalLight.direction");
+        this->ambientUniform = shader->getUniformHandle<glm::vec3>("directionalLight.lighting.ambient");
+        this->diffuseUniform = shader->getUniformHandle<glm::vec3>("directionalLight.lighting.diffuse");
+        this->specularUniform = shader->getUniformHandle<glm::vec3>("directionalLight.lighting.specular");
+        this->uniformsShader = shader;
+    }
+
+    shader->setUniform(this->directionUniform, this->getLookAtDirection());
+    shader->setUniform(this->ambientUniform, this->getAmbient());
+    shader->setUniform(this->diffuseUniform, this->getDiffuse());
+    shader->setUniform(this->specularUniform, this->getSpecular());
 }
 
 } // namespace age
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include <android_game_engine/LodSelector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace age {
+
+LodSelector::LodSelector(std::vector<float> screenSizeThresholds, float hysteresis)
+        : screenSizeThresholds(std::move(screenSizeThresholds)), hysteresis(hysteresis) {
+    assert(std::is_sorted(this->screenSizeThresholds.crbegin(), this->screenSizeThresholds.crend()) &&
+           "LOD screen size thresholds must be in descending order");
+}
+
+float LodSelector::getScreenSize(const glm::vec3 &center, float radius,
+                                 const glm::vec3 &viewPosition, const glm::mat4 &projection) {
+    const auto distance = glm::distance(center, viewPosition);
+    if (distance <= radius) return std::numeric_limits<float>::max();
+
+    // projection[1][1] is the cotangent of half the vertical field of view
+    return radius * projection[1][1] / distance;
+}
+
+unsigned int LodSelector::select(float screenSize, unsigned int currentLod, unsigned int numLods) const {
+    if (numLods <= 1) return 0;
+
+    const auto maxLod = std::min<unsigned int>(numLods, this->screenSizeThresholds.size() + 1) - 1;
+    auto lod = std::min(currentLod, maxLod);
+
+    while (lod < maxLod && screenSize < this->screenSizeThresholds[lod] * (1.0f - this->hysteresis)) {
+        ++lod;
+    }
+
+    while (lod > 0 && screenSize > this->screenSizeThresholds[lod - 1] * (1.0f + this->hysteresis)) {
+        --lod;
+    }
+
+    return lod;
+}
+
+} // namespace age
@@ -0,0 +1,230 @@
+#include <android_game_engine/ManagerResources.h>
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Levels of Android's ComponentCallbacks2.onTrimMemory
+constexpr int trimMemoryRunningModerate = 5;
+constexpr int trimMemoryRunningCritical = 15;
+constexpr int noTrimMemory = 0;
+
+using Key = std::pair<age::ResourceType, std::string>;
+using LruList = std::list<Key>;
+
+struct Entry {
+    std::shared_ptr<void> resource;
+    std::weak_ptr<void> handle; ///< Shared by the users of the resource, expired when unreferenced
+    size_t numBytes = 0;
+    LruList::iterator lruPosition; ///< Valid when unreferenced
+};
+
+constexpr auto numTypes = static_cast<size_t>(age::ResourceType::NUM_TYPES);
+
+std::array<std::unordered_map<std::string, Entry>, numTypes> entries;
+std::array<age::ManagerResources::Statistics, numTypes> statistics;
+
+// Unreferenced resources, most recently used first
+LruList lru;
+
+size_t memoryBudget = 0;
+size_t residentBytes = 0;
+bool evicting = false;
+
+std::atomic<int> pendingTrimLevel {noTrimMemory};
+
+std::unordered_map<std::string, Entry>& getEntries(age::ResourceType type) {
+    return entries[static_cast<size_t>(type)];
+}
+
+age::ManagerResources::Statistics& getTypeStatistics(age::ResourceType type) {
+    return statistics[static_cast<size_t>(type)];
+}
+
+///
+/// \brief evict Releases the least recently used unreferenced resources until the
+///              resident resources fit in the budget.
+///
+void evict(size_t targetBytes) {
+    // Releasing a resource can unreference the resources it uses, which are evicted by the outer loop
+    if (evicting) return;
+    evicting = true;
+
+    while (residentBytes > targetBytes && !lru.empty()) {
+        std::vector<std::shared_ptr<void>> evicted;
+
+        while (residentBytes > targetBytes && !lru.empty()) {
+            const auto key = std::move(lru.back());
+            lru.pop_back();
+
+            auto &typeEntries = getEntries(key.first);
+            auto entry = typeEntries.find(key.second);
+
+            auto &stats = getTypeStatistics(key.first);
+            --stats.numResident;
+            --stats.numUnreferenced;
+            stats.residentBytes -= entry->second.numBytes;
+            stats.unreferencedBytes -= entry->second.numBytes;
+            ++stats.numEvictions;
+            residentBytes -= entry->second.numBytes;
+
+            evicted.push_back(std::move(entry->second.resource));
+            typeEntries.erase(entry);
+        }
+    }
+
+    evicting = false;
+}
+
+///
+/// \brief release Moves a resource that is no longer referenced to the front of the cache.
+///
+void release(age::ResourceType type, const std::string &filepath) {
+    auto &typeEntries = getEntries(type);
+    auto entry = typeEntries.find(filepath);
+    if (entry == typeEntries.end()) return;
+
+    entry->second.handle.reset();
+    entry->second.lruPosition = lru.insert(lru.begin(), {type, filepath});
+
+    auto &stats = getTypeStatistics(type);
+    ++stats.numUnreferenced;
+    stats.unreferencedBytes += entry->second.numBytes;
+
+    evict(memoryBudget);
+}
+
+///
+/// \brief reference Returns a pointer shared by the users of a resource.
+///
+std::shared_ptr<void> reference(age::ResourceType type, const std::string &filepath, Entry &entry) {
+    auto handle = entry.handle.lock();
+    if (handle) return handle;
+
+    // The handle keeps the resource alive in case it's released while still in use
+    handle = std::shared_ptr<void>(entry.resource.get(), [type, filepath, resource = entry.resource](void *){
+        release(type, filepath);
+    });
+    entry.handle = handle;
+    return handle;
+}
+
+} // namespace
+
+namespace age {
+namespace ManagerResources {
+
+void init(size_t budget) {
+    memoryBudget = budget;
+}
+
+void shutdown() {
+    evict(0);
+
+    for (auto &typeEntries : entries) {
+        typeEntries.clear();
+    }
+    lru.clear();
+
+    statistics = {};
+    residentBytes = 0;
+    pendingTrimLevel = noTrimMemory;
+}
+
+void setBudget(size_t budget) {
+    memoryBudget = budget;
+    evict(memoryBudget);
+}
+
+size_t getBudget() {
+    return memoryBudget;
+}
+
+bool isResident(ResourceType type, const std::string &filepath) {
+    const auto &typeEntries = getEntries(type);
+    return typeEntries.find(filepath) != typeEntries.cend();
+}
+
+std::shared_ptr<void> findResource(ResourceType type, const std::string &filepath) {
+    auto &typeEntries = getEntries(type);
+    auto &stats = getTypeStatistics(type);
+
+    auto entry = typeEntries.find(filepath);
+    if (entry == typeEntries.end()) {
+        ++stats.numMisses;
+        return nullptr;
+    }
+    ++stats.numHits;
+
+    // Take cached resources out of the cache
+    if (entry->second.handle.expired()) {
+        lru.erase(entry->second.lruPosition);
+        --stats.numUnreferenced;
+        stats.unreferencedBytes -= entry->second.numBytes;
+    }
+
+    return reference(type, filepath, entry->second);
+}
+
+std::shared_ptr<void> insertResource(ResourceType type, const std::string &filepath,
+                                     std::shared_ptr<void> resource, size_t numBytes) {
+    if (isResident(type, filepath)) {
+        return findResource(type, filepath);
+    }
+
+    auto &entry = getEntries(type)[filepath];
+    entry.resource = std::move(resource);
+    entry.numBytes = numBytes;
+
+    auto &stats = getTypeStatistics(type);
+    ++stats.numResident;
+    stats.residentBytes += numBytes;
+    residentBytes += numBytes;
+
+    auto handle = reference(type, filepath, entry);
+    evict(memoryBudget);
+    return handle;
+}
+
+void setSize(ResourceType type, const std::string &filepath, size_t numBytes) {
+    auto &typeEntries = getEntries(type);
+    auto entry = typeEntries.find(filepath);
+    if (entry == typeEntries.end()) return;
+
+    auto &stats = getTypeStatistics(type);
+    stats.residentBytes += numBytes - entry->second.numBytes;
+    if (entry->second.handle.expired()) {
+        stats.unreferencedBytes += numBytes - entry->second.numBytes;
+    }
+    residentBytes += numBytes - entry->second.numBytes;
+    entry->second.numBytes = numBytes;
+
+    evict(memoryBudget);
+}
+
+void onTrimMemory(int level) {
+    auto pendingLevel = pendingTrimLevel.load();
+    while (level > pendingLevel && !pendingTrimLevel.compare_exchange_weak(pendingLevel, level));
+}
+
+void processTrimMemory() {
+    const auto level = pendingTrimLevel.exchange(noTrimMemory);
+
+    if (level >= trimMemoryRunningCritical) {
+        evict(0);
+    } else if (level >= trimMemoryRunningModerate) {
+        evict(memoryBudget / 2);
+    }
+}
+
+Statistics getStatistics(ResourceType type) {
+    return getTypeStatistics(type);
+}
+
+} // namespace ManagerResources
+} // namespace age
@@ -2,6 +2,7 @@
 
 #include <android_game_engine/Log.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
 
 namespace {
 
@@ -82,6 +83,8 @@ void init(ANativeWindow *window) {
     } else {
         Log::info("Made GL context current.");
     }
+
+    GLState::reset();
     
     // Obtain window dimensions.
     eglQuerySurface(display, surface, EGL_WIDTH, &windowWidth);
@@ -95,6 +98,9 @@ void init(int width, int height, int rotation) {
     windowWidth = width;
     windowHeight = height;
     displayRotation = rotation;
+
+    // The GL context is created externally and may be new
+    GLState::reset();
 }
 
 void shutdown() {
@@ -1,23 +1,62 @@
 #include <android_game_engine/Mesh.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 #include <GLES3/gl32.h>
 #include <glm/vec3.hpp>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/ShaderProgram.h>
-#include <android_game_engine/VertexArray.h>
+
+namespace {
+
+std::mutex textureSetIdsMutex;
+std::map<std::vector<unsigned int>, uint32_t> textureSetIds;
+
+///
+/// \brief getTextureSetId Returns the ID of a set of textures, assigning the next one to sets
+///                        that weren't seen before.
+/// \param textureIds Number of diffuse textures followed by the IDs of all diffuse and
+///                   specular textures.
+///
+uint32_t getTextureSetId(std::vector<unsigned int> textureIds) {
+    std::lock_guard<std::mutex> lock(textureSetIdsMutex);
+    const auto id = static_cast<uint32_t>(textureSetIds.size());
+    return textureSetIds.emplace(std::move(textureIds), id).first->second;
+}
+
+} // namespace
 
 namespace age {
 
+MaterialUniforms::MaterialUniforms(const ShaderProgram &shader)
+        : specularExponent(shader.getUniformHandle<float>("material.specularExponent")) {
+    for (auto i = 0u; ; ++i) {
+        auto handle = shader.getUniformHandle<int>("material.diffuseTexture" + std::to_string(i));
+        if (!handle.isValid()) break;
+        this->diffuseTextures.push_back(handle);
+    }
+
+    for (auto i = 0u; ; ++i) {
+        auto handle = shader.getUniformHandle<int>("material.specularTexture" + std::to_string(i));
+        if (!handle.isValid()) break;
+        this->specularTextures.push_back(handle);
+    }
+}
+
 Mesh::Mesh(std::shared_ptr<age::VertexArray> vao,
            const std::set<std::string> &diffuseTextureFilepaths,
-           const std::set<std::string> &specularTextureFilepaths)
+           const std::set<std::string> &specularTextureFilepaths,
+           LoadMode textureMode)
         : vao(std::move(vao)) {
     for (const auto& file : diffuseTextureFilepaths) {
-        this->diffuseTextures.emplace_back(file);
+        this->diffuseTextures.emplace_back(file, textureMode);
     }
 
     for (const auto& file : specularTextureFilepaths) {
-        this->specularTextures.emplace_back(file);
+        this->specularTextures.emplace_back(file, textureMode);
     }
 
     this->init();
@@ -39,28 +78,57 @@ void Mesh::init() {
     if (this->specularTextures.empty()) {
         this->specularTextures.emplace_back(glm::vec3(1.0f));
     }
+
+    // Texture IDs don't change once created, so the set is identified once instead of per draw
+    std::vector<unsigned int> textureIds;
+    textureIds.reserve(1 + this->diffuseTextures.size() + this->specularTextures.size());
+    textureIds.push_back(static_cast<unsigned int>(this->diffuseTextures.size()));
+
+    for (const auto &texture : this->diffuseTextures) {
+        textureIds.push_back(texture.getId());
+    }
+
+    for (const auto &texture : this->specularTextures) {
+        textureIds.push_back(texture.getId());
+    }
+
+    this->textureSetId = ::getTextureSetId(std::move(textureIds));
 }
 
-void Mesh::bindTextures(ShaderProgram *shader) {
+void Mesh::bindTextures(ShaderProgram *shader, const MaterialUniforms &uniforms) const {
     int textureUnit = 0;
     
     for (size_t i = 0; i < this->diffuseTextures.size(); ++i, ++textureUnit) {
-        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(textureUnit));
-        shader->setUniform("material.diffuseTexture" + std::to_string(i), textureUnit);
+        GLState::activeTexture(GL_TEXTURE0 + static_cast<GLenum>(textureUnit));
+        if (i < uniforms.diffuseTextures.size()) {
+            shader->setUniform(uniforms.diffuseTextures[i], textureUnit);
+        }
         this->diffuseTextures[i].bind();
     }
     
     for (size_t i = 0; i < this->specularTextures.size(); ++i, ++textureUnit) {
-        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(textureUnit));
-        shader->setUniform("material.specularTexture" + std::to_string(i), textureUnit);
+        GLState::activeTexture(GL_TEXTURE0 + static_cast<GLenum>(textureUnit));
+        if (i < uniforms.specularTextures.size()) {
+            shader->setUniform(uniforms.specularTextures[i], textureUnit);
+        }
         this->specularTextures[i].bind();
     }
     
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+void Mesh::renderVAO(const VertexArray::Instance *instances, size_t numInstances,
+                     unsigned int lod) const {
+    this->getVertexArray(lod)->render(instances, numInstances);
+}
+
+void Mesh::addLod(std::shared_ptr<VertexArray> vao) {
+    this->lods.push_back(std::move(vao));
 }
 
-void Mesh::renderVAO(ShaderProgram *shader) {
-    this->vao->render();
+VertexArray* Mesh::getVertexArray(unsigned int lod) const {
+    if (lod == 0 || this->lods.empty()) return this->vao.get();
+    return this->lods[std::min<size_t>(lod, this->lods.size()) - 1].get();
 }
 
 } // namespace ge
@@ -0,0 +1,679 @@
+#include <android_game_engine/MeshOptimizer.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+namespace {
+
+// Forsyth's tuning constants from "Linear-Speed Vertex Cache Optimisation"
+constexpr size_t maxCacheSize = 32;
+constexpr float cacheDecayPower = 1.5f;
+constexpr float lastTriangleScore = 0.75f;
+constexpr float valenceBoostScale = 2.0f;
+constexpr float valenceBoostPower = 0.5f;
+constexpr size_t maxValenceScores = 32;
+
+struct VertexScoreTable {
+    VertexScoreTable() {
+        for (size_t i = 0; i < maxCacheSize; ++i) {
+            if (i < 3) {
+                // Vertices of the last triangle get a fixed score so that the algorithm
+                // does not favour reusing the same edge over and over
+                this->cache[i] = lastTriangleScore;
+            } else {
+                auto scaler = 1.0f / (maxCacheSize - 3);
+                this->cache[i] = std::pow(1.0f - (i - 3) * scaler, cacheDecayPower);
+            }
+        }
+
+        this->valence[0] = 0.0f;
+        for (size_t i = 1; i < maxValenceScores; ++i) {
+            this->valence[i] = valenceBoostScale * std::pow(static_cast<float>(i), -valenceBoostPower);
+        }
+    }
+
+    float cache[maxCacheSize];
+    float valence[maxValenceScores];
+};
+
+float getVertexScore(int cachePosition, uint32_t numRemainingTriangles) {
+    static const VertexScoreTable table;
+
+    if (numRemainingTriangles == 0) {
+        // No triangle needs this vertex anymore
+        return -1.0f;
+    }
+
+    auto score = cachePosition < 0 ? 0.0f : table.cache[cachePosition];
+
+    // Boost vertices with few remaining triangles to get rid of lone triangles
+    score += numRemainingTriangles < maxValenceScores ?
+             table.valence[numRemainingTriangles] :
+             valenceBoostScale * std::pow(static_cast<float>(numRemainingTriangles), -valenceBoostPower);
+    return score;
+}
+
+///
+/// \brief Simulated FIFO post-transform cache. A vertex is cached if it was transformed
+///        within the last cacheSize transforms.
+///
+class FifoCache {
+public:
+    FifoCache(size_t numVertices, size_t cacheSize)
+        : timestamps(numVertices, 0), timestamp(cacheSize + 1), cacheSize(cacheSize) {}
+
+    void clear() {
+        this->timestamp += this->cacheSize + 1;
+    }
+
+    ///
+    /// \brief access Accesses a vertex and returns the number of cache misses (0 or 1).
+    ///
+    unsigned int access(uint32_t vertex) {
+        if (this->timestamp - this->timestamps[vertex] > this->cacheSize) {
+            this->timestamps[vertex] = this->timestamp++;
+            return 1;
+        }
+        return 0;
+    }
+
+    unsigned int access(const glm::uvec3 &triangle) {
+        return this->access(triangle[0]) + this->access(triangle[1]) + this->access(triangle[2]);
+    }
+
+private:
+    std::vector<size_t> timestamps;
+    size_t timestamp;
+    size_t cacheSize;
+};
+
+constexpr size_t overdrawCacheSize = 16;
+
+// Collapses may rotate the normal of a neighbouring triangle by at most acos(0.25)
+constexpr float maxCollapseNormalCosine = 0.25f;
+
+///
+/// \brief Symmetric 4x4 error quadric of the squared distances to a set of planes,
+///        weighted by triangle area so that the error is a mean squared distance.
+///
+struct Quadric {
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0;
+    double a11 = 0.0, a12 = 0.0;
+    double a22 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double weight = 0.0;
+
+    static Quadric fromPlane(const glm::dvec3 &normal, double distance, double weight) {
+        Quadric q;
+        q.a00 = weight * normal.x * normal.x;
+        q.a01 = weight * normal.x * normal.y;
+        q.a02 = weight * normal.x * normal.z;
+        q.a11 = weight * normal.y * normal.y;
+        q.a12 = weight * normal.y * normal.z;
+        q.a22 = weight * normal.z * normal.z;
+        q.b0 = weight * normal.x * distance;
+        q.b1 = weight * normal.y * distance;
+        q.b2 = weight * normal.z * distance;
+        q.c = weight * distance * distance;
+        q.weight = weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric &other) {
+        this->a00 += other.a00; this->a01 += other.a01; this->a02 += other.a02;
+        this->a11 += other.a11; this->a12 += other.a12;
+        this->a22 += other.a22;
+        this->b0 += other.b0; this->b1 += other.b1; this->b2 += other.b2;
+        this->c += other.c;
+        this->weight += other.weight;
+        return *this;
+    }
+
+    ///
+    /// \brief evaluate Returns the weighted mean squared distance of a point to the planes.
+    ///
+    double evaluate(const glm::dvec3 &p) const {
+        auto error = p.x * (this->a00 * p.x + 2.0 * (this->a01 * p.y + this->a02 * p.z + this->b0)) +
+                     p.y * (this->a11 * p.y + 2.0 * (this->a12 * p.z + this->b1)) +
+                     p.z * (this->a22 * p.z + 2.0 * this->b2) +
+                     this->c;
+        return this->weight > 0.0 ? std::max(error, 0.0) / this->weight : 0.0;
+    }
+};
+
+struct PositionKey {
+    uint32_t bits[3];
+
+    explicit PositionKey(const glm::vec3 &position) {
+        std::memcpy(this->bits, &position[0], sizeof(this->bits));
+    }
+
+    bool operator==(const PositionKey &other) const {
+        return std::equal(std::begin(this->bits), std::end(this->bits), std::begin(other.bits));
+    }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey &key) const {
+        return (key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u);
+    }
+};
+
+uint64_t getEdgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t(a) << 32u) | b : (uint64_t(b) << 32u) | a;
+}
+
+bool hasDuplicateIndex(const glm::uvec3 &triangle) {
+    return triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2];
+}
+
+} // namespace
+
+namespace age {
+namespace MeshOptimizer {
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<glm::uvec3> &indices,
+                                         size_t numVertices, size_t cacheSize) {
+    VertexCacheStatistics statistics;
+    if (indices.empty()) return statistics;
+
+    FifoCache cache(numVertices, cacheSize);
+    std::vector<bool> referenced(numVertices, false);
+    size_t numReferencedVertices = 0;
+
+    for (const auto &triangle : indices) {
+        statistics.numTransformedVertices += cache.access(triangle);
+
+        for (auto i = 0; i < 3; ++i) {
+            if (!referenced[triangle[i]]) {
+                referenced[triangle[i]] = true;
+                ++numReferencedVertices;
+            }
+        }
+    }
+
+    statistics.acmr = static_cast<float>(statistics.numTransformedVertices) / indices.size();
+    statistics.atvr = static_cast<float>(statistics.numTransformedVertices) / numReferencedVertices;
+    return statistics;
+}
+
+void optimizeVertexCache(std::vector<glm::uvec3> &indices, size_t numVertices) {
+    const auto numTriangles = indices.size();
+    if (numTriangles == 0) return;
+
+    // Build vertex to triangle adjacency. The first numRemainingTriangles[v] entries of a
+    // vertex's range are the triangles that have not been emitted yet.
+    std::vector<uint32_t> numRemainingTriangles(numVertices, 0);
+    for (const auto &triangle : indices) {
+        for (auto i = 0; i < 3; ++i) {
+            assert(triangle[i] < numVertices && "Vertex index out of range");
+            ++numRemainingTriangles[triangle[i]];
+        }
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+    std::partial_sum(numRemainingTriangles.cbegin(), numRemainingTriangles.cend(),
+                     adjacencyOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+    {
+        auto fillOffsets = adjacencyOffsets;
+        for (uint32_t t = 0; t < numTriangles; ++t) {
+            for (auto i = 0; i < 3; ++i) {
+                adjacency[fillOffsets[indices[t][i]]++] = t;
+            }
+        }
+    }
+
+    std::vector<int> cachePositions(numVertices, -1);
+    std::vector<float> vertexScores(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+        vertexScores[v] = getVertexScore(-1, numRemainingTriangles[v]);
+    }
+
+    std::vector<float> triangleScores(numTriangles);
+    std::vector<bool> emitted(numTriangles, false);
+    for (size_t t = 0; t < numTriangles; ++t) {
+        const auto &triangle = indices[t];
+        triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+    }
+
+    std::vector<glm::uvec3> optimizedIndices;
+    optimizedIndices.reserve(numTriangles);
+
+    std::vector<uint32_t> cache, newCache;
+    cache.reserve(maxCacheSize + 3);
+    newCache.reserve(maxCacheSize + 3);
+
+    size_t nextInputTriangle = 0;
+    auto bestTriangle = static_cast<uint32_t>(std::max_element(triangleScores.cbegin(), triangleScores.cend()) -
+                                              triangleScores.cbegin());
+
+    while (optimizedIndices.size() < numTriangles) {
+        const auto triangle = indices[bestTriangle];
+        optimizedIndices.push_back(triangle);
+        emitted[bestTriangle] = true;
+
+        // Remove the triangle from its vertices' remaining triangles
+        for (auto i = 0; i < 3; ++i) {
+            auto v = triangle[i];
+            auto begin = adjacency.begin() + adjacencyOffsets[v];
+            auto end = begin + numRemainingTriangles[v];
+            auto it = std::find(begin, end, bestTriangle);
+            assert(it != end && "Triangle missing from vertex adjacency");
+            std::iter_swap(it, end - 1);
+            --numRemainingTriangles[v];
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        newCache.assign({triangle[0], triangle[1], triangle[2]});
+        for (auto v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache.push_back(v);
+            }
+        }
+
+        // Vertices pushed out of the cache must be rescored too
+        for (size_t i = maxCacheSize; i < newCache.size(); ++i) {
+            cachePositions[newCache[i]] = -1;
+        }
+        for (size_t i = 0; i < std::min(newCache.size(), maxCacheSize); ++i) {
+            cachePositions[newCache[i]] = static_cast<int>(i);
+        }
+
+        // Update scores of triangles touching the cache and pick the best one
+        auto bestScore = -1.0f;
+        bestTriangle = ~0u;
+        for (auto v : newCache) {
+            auto score = getVertexScore(cachePositions[v], numRemainingTriangles[v]);
+            auto delta = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            auto begin = adjacencyOffsets[v];
+            auto end = begin + numRemainingTriangles[v];
+            for (auto j = begin; j < end; ++j) {
+                auto t = adjacency[j];
+                triangleScores[t] += delta;
+            }
+        }
+        for (size_t i = 0; i < std::min(newCache.size(), maxCacheSize); ++i) {
+            auto v = newCache[i];
+            auto begin = adjacencyOffsets[v];
+            auto end = begin + numRemainingTriangles[v];
+            for (auto j = begin; j < end; ++j) {
+                auto t = adjacency[j];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (newCache.size() > maxCacheSize) newCache.resize(maxCacheSize);
+        std::swap(cache, newCache);
+
+        // Dead end, restart from the next triangle in input order
+        if (bestTriangle == ~0u && optimizedIndices.size() < numTriangles) {
+            while (emitted[nextInputTriangle]) ++nextInputTriangle;
+            bestTriangle = static_cast<uint32_t>(nextInputTriangle);
+        }
+    }
+
+    indices = std::move(optimizedIndices);
+}
+
+void optimizeOverdraw(std::vector<glm::uvec3> &indices, const std::vector<glm::vec3> &positions,
+                      float threshold) {
+    const auto numTriangles = indices.size();
+    if (numTriangles == 0) return;
+
+    // Hard boundaries are triangles that miss the cache for all their vertices.
+    // Reordering clusters at these boundaries doesn't affect cache efficiency.
+    std::vector<size_t> hardClusters;
+    {
+        FifoCache cache(positions.size(), overdrawCacheSize);
+        for (size_t t = 0; t < numTriangles; ++t) {
+            if (cache.access(indices[t]) == 3) {
+                hardClusters.push_back(t);
+            }
+        }
+    }
+    hardClusters.push_back(numTriangles);
+
+    // Split hard clusters further as long as the cluster's ACMR stays within threshold
+    std::vector<size_t> clusters;
+    for (size_t c = 0; c + 1 < hardClusters.size(); ++c) {
+        auto begin = hardClusters[c];
+        auto end = hardClusters[c + 1];
+
+        FifoCache cache(positions.size(), overdrawCacheSize);
+        size_t numMisses = 0;
+        for (auto t = begin; t < end; ++t) {
+            numMisses += cache.access(indices[t]);
+        }
+        auto targetAcmr = threshold * numMisses / (end - begin);
+
+        cache.clear();
+        clusters.push_back(begin);
+        size_t numClusterMisses = 0;
+        for (auto t = begin; t < end; ++t) {
+            numClusterMisses += cache.access(indices[t]);
+
+            auto numClusterTriangles = t + 1 - clusters.back();
+            if (t + 1 < end && numClusterMisses <= targetAcmr * numClusterTriangles) {
+                clusters.push_back(t + 1);
+                cache.clear();
+                numClusterMisses = 0;
+            }
+        }
+    }
+    clusters.push_back(numTriangles);
+
+    // Sort clusters so that those facing away from the mesh centroid come first
+    const auto numClusters = clusters.size() - 1;
+    std::vector<glm::vec3> clusterCentroids(numClusters, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(numClusters, glm::vec3(0.0f));
+    std::vector<float> clusterAreas(numClusters, 0.0f);
+
+    glm::vec3 meshCentroid(0.0f);
+    auto meshArea = 0.0f;
+
+    for (size_t c = 0; c < numClusters; ++c) {
+        for (auto t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const auto &a = positions[indices[t][0]];
+            const auto &b = positions[indices[t][1]];
+            const auto &c0 = positions[indices[t][2]];
+
+            auto normal = glm::cross(b - a, c0 - a);
+            auto area = glm::length(normal);
+
+            clusterCentroids[c] += (a + b + c0) * (area / 3.0f);
+            clusterNormals[c] += normal;
+            clusterAreas[c] += area;
+        }
+
+        meshCentroid += clusterCentroids[c];
+        meshArea += clusterAreas[c];
+    }
+    if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+    std::vector<float> clusterSortKeys(numClusters, 0.0f);
+    for (size_t c = 0; c < numClusters; ++c) {
+        if (clusterAreas[c] <= 0.0f) continue;
+
+        auto normalLength = glm::length(clusterNormals[c]);
+        if (normalLength <= 0.0f) continue;
+
+        auto centroid = clusterCentroids[c] / clusterAreas[c];
+        clusterSortKeys[c] = glm::dot(centroid - meshCentroid, clusterNormals[c] / normalLength);
+    }
+
+    std::vector<size_t> clusterOrder(numClusters);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](auto lhs, auto rhs){
+        return clusterSortKeys[lhs] > clusterSortKeys[rhs];
+    });
+
+    std::vector<glm::uvec3> sortedIndices;
+    sortedIndices.reserve(numTriangles);
+    for (auto c : clusterOrder) {
+        sortedIndices.insert(sortedIndices.end(),
+                             indices.cbegin() + clusters[c], indices.cbegin() + clusters[c + 1]);
+    }
+    indices = std::move(sortedIndices);
+}
+
+void optimizeVertexFetch(std::vector<glm::uvec3> &indices,
+                         std::vector<glm::vec3> &positions,
+                         std::vector<glm::vec3> &normals,
+                         std::vector<glm::vec2> &textureCoordinates) {
+    assert(normals.size() == positions.size() && textureCoordinates.size() == positions.size() &&
+           "Vertex attributes must have the same number of elements");
+
+    const auto unassigned = ~0u;
+    std::vector<uint32_t> remap(positions.size(), unassigned);
+    uint32_t numVertices = 0;
+
+    for (auto &triangle : indices) {
+        for (auto i = 0; i < 3; ++i) {
+            auto &index = remap[triangle[i]];
+            if (index == unassigned) index = numVertices++;
+            triangle[i] = index;
+        }
+    }
+
+    std::vector<glm::vec3> newPositions(numVertices), newNormals(numVertices);
+    std::vector<glm::vec2> newTextureCoordinates(numVertices);
+    for (size_t v = 0; v < remap.size(); ++v) {
+        if (remap[v] == unassigned) continue;
+        newPositions[remap[v]] = positions[v];
+        newNormals[remap[v]] = normals[v];
+        newTextureCoordinates[remap[v]] = textureCoordinates[v];
+    }
+
+    positions = std::move(newPositions);
+    normals = std::move(newNormals);
+    textureCoordinates = std::move(newTextureCoordinates);
+}
+
+std::vector<glm::uvec3> simplify(const std::vector<glm::uvec3> &indices,
+                                 const std::vector<glm::vec3> &positions,
+                                 size_t targetNumTriangles, float targetError,
+                                 float *resultError) {
+    const auto numVertices = positions.size();
+
+    std::vector<glm::uvec3> result;
+    result.reserve(indices.size());
+    for (const auto &triangle : indices) {
+        if (!hasDuplicateIndex(triangle)) result.push_back(triangle);
+    }
+
+    if (resultError) *resultError = 0.0f;
+    if (result.size() <= targetNumTriangles) return result;
+
+    // Measure errors relative to the largest dimension of the mesh
+    glm::vec3 minBound(std::numeric_limits<float>::max());
+    glm::vec3 maxBound(std::numeric_limits<float>::lowest());
+    for (const auto &position : positions) {
+        minBound = glm::min(minBound, position);
+        maxBound = glm::max(maxBound, position);
+    }
+    const auto extent = std::max({maxBound.x - minBound.x, maxBound.y - minBound.y, maxBound.z - minBound.z});
+    const auto scale = extent > 0.0f ? 1.0 / extent : 1.0;
+
+    std::vector<glm::dvec3> scaledPositions(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+        scaledPositions[v] = glm::dvec3(positions[v] - minBound) * scale;
+    }
+
+    // Lock vertices on attribute seams, sharing their position with other vertices
+    std::vector<uint32_t> canonicalVertices(numVertices);
+    std::vector<bool> locked(numVertices, false);
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstVertices;
+        for (uint32_t v = 0; v < numVertices; ++v) {
+            auto first = firstVertices.emplace(PositionKey(positions[v]), v).first->second;
+            canonicalVertices[v] = first;
+            if (first != v) {
+                locked[v] = true;
+                locked[first] = true;
+            }
+        }
+    }
+
+    // Lock vertices on open borders and non-manifold edges
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeCounts;
+        for (const auto &triangle : result) {
+            for (auto i = 0; i < 3; ++i) {
+                ++edgeCounts[getEdgeKey(canonicalVertices[triangle[i]], canonicalVertices[triangle[(i + 1) % 3]])];
+            }
+        }
+
+        for (const auto &triangle : result) {
+            for (auto i = 0; i < 3; ++i) {
+                auto a = triangle[i];
+                auto b = triangle[(i + 1) % 3];
+                if (edgeCounts[getEdgeKey(canonicalVertices[a], canonicalVertices[b])] != 2) {
+                    locked[a] = true;
+                    locked[b] = true;
+                }
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(numVertices);
+    for (const auto &triangle : result) {
+        const auto &a = scaledPositions[triangle[0]];
+        const auto &b = scaledPositions[triangle[1]];
+        const auto &c = scaledPositions[triangle[2]];
+
+        auto normal = glm::cross(b - a, c - a);
+        auto doubleArea = glm::length(normal);
+        if (doubleArea <= 0.0) continue;
+
+        normal /= doubleArea;
+        auto quadric = Quadric::fromPlane(normal, -glm::dot(normal, a), doubleArea * 0.5);
+        for (auto i = 0; i < 3; ++i) {
+            quadrics[triangle[i]] += quadric;
+        }
+    }
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double error;
+    };
+
+    const auto maxError = static_cast<double>(targetError) * targetError;
+    auto largestError = 0.0;
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> adjacencyOffsets, adjacency;
+    std::vector<uint32_t> remap(numVertices);
+    std::vector<bool> touched(numVertices);
+
+    // Collapse a batch of the cheapest independent edges per pass until the target is reached
+    while (result.size() > targetNumTriangles) {
+        std::vector<uint32_t> numAdjacentTriangles(numVertices, 0);
+        for (const auto &triangle : result) {
+            for (auto i = 0; i < 3; ++i) ++numAdjacentTriangles[triangle[i]];
+        }
+
+        adjacencyOffsets.assign(numVertices + 1, 0);
+        std::partial_sum(numAdjacentTriangles.cbegin(), numAdjacentTriangles.cend(),
+                         adjacencyOffsets.begin() + 1);
+        adjacency.resize(adjacencyOffsets.back());
+        {
+            auto fillOffsets = adjacencyOffsets;
+            for (uint32_t t = 0; t < result.size(); ++t) {
+                for (auto i = 0; i < 3; ++i) {
+                    adjacency[fillOffsets[result[t][i]]++] = t;
+                }
+            }
+        }
+
+        // Pick the cheaper direction of every edge
+        collapses.clear();
+        for (const auto &triangle : result) {
+            for (auto i = 0; i < 3; ++i) {
+                auto a = triangle[i];
+                auto b = triangle[(i + 1) % 3];
+                if (locked[a] && locked[b]) continue;
+
+                auto errorAB = locked[a] ? std::numeric_limits<double>::max() :
+                               quadrics[a].evaluate(scaledPositions[b]) + quadrics[b].evaluate(scaledPositions[b]);
+                auto errorBA = locked[b] ? std::numeric_limits<double>::max() :
+                               quadrics[a].evaluate(scaledPositions[a]) + quadrics[b].evaluate(scaledPositions[a]);
+
+                if (errorAB <= errorBA) {
+                    collapses.push_back({a, b, errorAB});
+                } else {
+                    collapses.push_back({b, a, errorBA});
+                }
+            }
+        }
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const auto &lhs, const auto &rhs){
+            return lhs.error < rhs.error;
+        });
+
+        // Don't spend this pass on expensive collapses that cheaper ones may make unnecessary
+        const auto numTrianglesToRemove = result.size() - targetNumTriangles;
+        const auto passLimitIndex = std::min(numTrianglesToRemove / 2, collapses.size() - 1);
+        const auto passMaxError = std::min(maxError, collapses[passLimitIndex].error * 1.5);
+
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+        size_t numTrianglesRemoved = 0;
+
+        for (const auto &collapse : collapses) {
+            if (collapse.error > passMaxError || numTrianglesRemoved >= numTrianglesToRemove) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            // Reject collapses that flip or fold neighbouring triangles
+            const auto &to = scaledPositions[collapse.to];
+            auto valid = true;
+            size_t numCollapsedTriangles = 0;
+            for (auto j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1] && valid; ++j) {
+                const auto &triangle = result[adjacency[j]];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    ++numCollapsedTriangles;
+                    continue;
+                }
+
+                glm::dvec3 corners[3];
+                for (auto i = 0; i < 3; ++i) {
+                    corners[i] = scaledPositions[triangle[i]];
+                }
+                auto oldNormal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                for (auto i = 0; i < 3; ++i) {
+                    if (triangle[i] == collapse.from) corners[i] = to;
+                }
+                auto newNormal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+                valid = glm::dot(oldNormal, newNormal) >
+                        maxCollapseNormalCosine * glm::length(oldNormal) * glm::length(newNormal);
+            }
+            if (!valid) continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            largestError = std::max(largestError, collapse.error);
+            numTrianglesRemoved += numCollapsedTriangles;
+
+            // Neighbouring collapses in the same pass would invalidate the flip test
+            for (auto vertex : {collapse.from, collapse.to}) {
+                for (auto j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex + 1]; ++j) {
+                    const auto &triangle = result[adjacency[j]];
+                    touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+                }
+            }
+        }
+        if (numTrianglesRemoved == 0) break;
+
+        auto last = result.begin();
+        for (const auto &triangle : result) {
+            glm::uvec3 remapped(remap[triangle[0]], remap[triangle[1]], remap[triangle[2]]);
+            if (!hasDuplicateIndex(remapped)) *last++ = remapped;
+        }
+        result.erase(last, result.end());
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(largestError));
+    return result;
+}
+
+} // namespace MeshOptimizer
+} // namespace age
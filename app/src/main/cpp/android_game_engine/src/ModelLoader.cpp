@@ -1,13 +1,43 @@
 #include <android_game_engine/ModelLoader.h>
 
+#include <android_game_engine/VertexArray.h>
+
 namespace age {
 
+size_t MeshData::Geometry::getSize() const {
+    return this->positions.size() * (sizeof(glm::vec3) * 2 + sizeof(glm::vec2)) +
+           this->indices.size() * sizeof(glm::uvec3);
+}
+
 ModelLoader::ModelLoader(const std::string &filepath) : filepath(filepath) {
     auto i = filepath.find_last_of('/') + 1;
     this->directory = filepath.substr(0, i);
     this->filename = filepath.substr(i);
 }
 
+ModelLoader::Meshes ModelLoader::createMeshes(const std::vector<MeshData> &meshData,
+                                              LoadMode textureMode) {
+    Meshes meshes;
+    meshes.reserve(meshData.size());
+
+    for (const auto &data : meshData) {
+        if (data.lods.empty()) continue;
+
+        auto vertexArray = [](const MeshData::Geometry &geometry){
+            return std::make_shared<VertexArray>(geometry.positions, geometry.normals,
+                                                 geometry.textureCoordinates, geometry.indices);
+        };
+
+        meshes.emplace_back(vertexArray(data.lods.front()),
+                            data.diffuseTextureFilepaths, data.specularTextureFilepaths, textureMode);
+        for (size_t i = 1; i < data.lods.size(); ++i) {
+            meshes.back().addLod(vertexArray(data.lods[i]));
+        }
+    }
+
+    return meshes;
+}
+
 std::string ModelLoader::getFilepath() const {return this->filepath;}
 std::string ModelLoader::getDirectory() const {return this->directory;}
 std::string ModelLoader::getFilename() const {return this->filename;}
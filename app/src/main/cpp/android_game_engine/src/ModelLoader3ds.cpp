@@ -1,5 +1,7 @@
 #include <android_game_engine/ModelLoader3ds.h>
 
+#include <chrono>
+#include <cstring>
 #include <set>
 #include <unordered_map>
 
@@ -9,9 +11,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <android_game_engine/Asset.h>
+#include <android_game_engine/AssetLoader.h>
 #include <android_game_engine/PhysicsCompoundShape.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/Log.h>
 #include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/ManagerResources.h>
+#include <android_game_engine/MeshOptimizer.h>
 #include <android_game_engine/VertexArray.h>
 
 namespace {
@@ -21,7 +27,23 @@ struct Material {
     std::string specularTextureFilename;
 };
 
-std::unordered_map<std::string, std::weak_ptr<age::ModelLoader3ds::Meshes>> meshesCache;
+// Models being loaded in the background, accessed on the GL thread only
+std::unordered_map<std::string, std::weak_ptr<age::AsyncModel>> asyncModelCache;
+
+// Coarser levels of detail generated for every mesh
+struct LodLevel {
+    float triangleRatio; // Target number of triangles relative to the full detail mesh
+    float targetError; // Maximum simplification error relative to the mesh's largest dimension
+};
+
+const LodLevel lodLevels[] = {
+    {0.5f, 0.005f},
+    {0.25f, 0.01f},
+    {0.125f, 0.02f}
+};
+
+// Levels that don't remove at least this fraction of the previous level's triangles are skipped
+constexpr float minLodTriangleReduction = 0.2f;
 
 long assetio_seek_func(void *self, long offset, Lib3dsIoSeek origin) {
     auto asset = reinterpret_cast<age::Asset*>(self);
@@ -81,6 +103,89 @@ std::shared_ptr<Lib3dsFile> lib3ds_asset_open(const std::string &filepath) {
     return std::shared_ptr<Lib3dsFile>(lib3dsFile, [](auto file){lib3ds_file_free(file);});
 }
 
+///
+/// \brief createResidentMeshes Uploads the meshes of a model and makes them resident.
+/// \param filepath Filepath to the model.
+/// \param meshData Mesh data extracted from the model.
+/// \param textureMode Whether to load the textures before returning or in the background.
+///
+std::shared_ptr<age::ModelLoader3ds::Meshes> createResidentMeshes(const std::string &filepath,
+                                                                  const std::vector<age::MeshData> &meshData,
+                                                                  age::LoadMode textureMode) {
+    size_t numBytes = 0;
+    for (const auto &data : meshData) {
+        for (const auto &geometry : data.lods) {
+            numBytes += geometry.getSize();
+        }
+    }
+    
+    auto meshes = std::make_shared<age::ModelLoader3ds::Meshes>(age::ModelLoader::createMeshes(meshData, textureMode));
+    return age::ManagerResources::insert(age::ResourceType::MESH, filepath, std::move(meshes), numBytes);
+}
+
+///
+/// \brief enqueueAsyncModelLoad Parses a model file and extracts its mesh data on a worker
+///                              thread, then completes the model on the GL thread.
+/// \param filepath Filepath to the model.
+/// \param loader Loader that already parsed the model file, or nullptr to parse it.
+/// \param meshesResident Whether the meshes were resident when the load was requested, in
+///                       which case their mesh data isn't extracted.
+/// \param requestTime Time the load was requested at.
+/// \param weakModel Model to complete.
+///
+void enqueueAsyncModelLoad(const std::string &filepath, std::shared_ptr<age::ModelLoader3ds> loader,
+                           bool meshesResident, std::chrono::steady_clock::time_point requestTime,
+                           std::weak_ptr<age::AsyncModel> weakModel) {
+    age::AssetLoader::enqueueLoad([filepath, loader, meshesResident, requestTime, weakModel]() mutable {
+        auto meshData = std::make_shared<std::vector<age::MeshData>>();
+        size_t numBytes = 0;
+        
+        try {
+            if (!loader) {
+                loader = std::make_shared<age::ModelLoader3ds>(filepath);
+            }
+            if (!meshesResident) {
+                *meshData = loader->loadMeshData();
+            }
+        } catch (const age::LoadError &e) {
+            age::Log::error(e.what());
+            loader.reset();
+        }
+        
+        for (const auto &data : *meshData) {
+            for (const auto &geometry : data.lods) {
+                numBytes += geometry.getSize();
+            }
+        }
+        
+        age::AssetLoader::enqueueUpload([filepath, meshesResident, requestTime, weakModel, loader, meshData](){
+            auto model = weakModel.lock();
+            if (!model) return;
+            
+            if (!loader) {
+                model->isDone = true;
+                return;
+            }
+            
+            // Meshes can have been evicted in the meantime, their mesh data is then extracted
+            // on a worker again instead of stalling the GL thread
+            model->meshes = age::ManagerResources::find<age::ModelLoader3ds::Meshes>(age::ResourceType::MESH, filepath);
+            if (!model->meshes) {
+                if (meshesResident) {
+                    enqueueAsyncModelLoad(filepath, loader, false, requestTime, weakModel);
+                    return;
+                }
+                model->meshes = createResidentMeshes(filepath, *meshData, age::LoadMode::ASYNCHRONOUS);
+            }
+            model->loader = loader;
+            model->isDone = true;
+            
+            const std::chrono::duration<float, std::milli> loadTime = std::chrono::steady_clock::now() - requestTime;
+            age::Log::info("Loaded " + filepath + " in the background in " + std::to_string(loadTime.count()) + " ms");
+        }, numBytes);
+    });
+}
+
 } // namespace
 
 namespace age {
@@ -89,17 +194,16 @@ ModelLoader3ds::ModelLoader3ds(const std::string &filepath)
     : ModelLoader(filepath), lib3dsFile(lib3ds_asset_open(filepath)) {}
 
 std::shared_ptr<ModelLoader3ds::Meshes> ModelLoader3ds::loadMeshes() {
-    // Check cached meshes to avoid reloading
-    auto meshes = meshesCache[this->getFilename()].lock();
+    // Check resident meshes to avoid reloading
+    auto meshes = ManagerResources::find<Meshes>(ResourceType::MESH, this->getFilepath());
     if (meshes) return meshes;
     
-    auto filename = this->getFilename();
-    auto meshesDeleter = [filename](auto meshes){
-        // Clear cache
-        meshesCache.erase(filename);
-        delete meshes;
-    };
-    meshes = std::shared_ptr<Meshes>(new Meshes, meshesDeleter);
+    return createResidentMeshes(this->getFilepath(), this->loadMeshData(), LoadMode::SYNCHRONOUS);
+}
+
+std::vector<MeshData> ModelLoader3ds::loadMeshData() {
+    std::vector<MeshData> meshData;
+    meshData.reserve(this->lib3dsFile->nmeshes);
     
     // Extract mesh data from lib3ds file
     for (auto i = 0; i < this->lib3dsFile->nmeshes; ++i) {
@@ -134,7 +238,8 @@ std::shared_ptr<ModelLoader3ds::Meshes> ModelLoader3ds::loadMeshes() {
         
         std::vector<glm::vec3> normals(mesh->nvertices);
         
-        std::set<std::string> diffuseTextures, specularTextures;
+        meshData.emplace_back();
+        auto &data = meshData.back();
         
         for (auto j = 0; j < mesh->nfaces; ++j) {
             // Copy indices
@@ -155,20 +260,72 @@ std::shared_ptr<ModelLoader3ds::Meshes> ModelLoader3ds::loadMeshes() {
             auto specularTextureFilename = materials[face.material].specularTextureFilename;
             
             if (!diffuseTextureFilename.empty()) {
-                diffuseTextures.insert(this->getDirectory() + diffuseTextureFilename);
+                data.diffuseTextureFilepaths.insert(this->getDirectory() + diffuseTextureFilename);
             }
             
             if (!specularTextureFilename.empty()) {
-                specularTextures.insert(this->getDirectory() + specularTextureFilename);
+                data.specularTextureFilepaths.insert(this->getDirectory() + specularTextureFilename);
             }
         }
         
-        meshes->emplace_back(std::make_shared<VertexArray>(positions, normals, textureCoords, indices),
-                             diffuseTextures, specularTextures);
+        // Reorder triangles and vertices for the GPU's post-transform and fetch caches
+        auto before = MeshOptimizer::analyzeVertexCache(indices, positions.size());
+        MeshOptimizer::optimizeVertexCache(indices, positions.size());
+        MeshOptimizer::optimizeOverdraw(indices, positions);
+        MeshOptimizer::optimizeVertexFetch(indices, positions, normals, textureCoords);
+        auto after = MeshOptimizer::analyzeVertexCache(indices, positions.size());
+        
+        Log::info(this->getFilename() + " mesh " + std::to_string(i) +
+                  ": ACMR " + std::to_string(before.acmr) + " -> " + std::to_string(after.acmr) +
+                  ", ATVR " + std::to_string(before.atvr) + " -> " + std::to_string(after.atvr));
+        
+        // Generate levels of detail from the full detail mesh so that errors don't accumulate
+        auto numLodTriangles = indices.size();
+        for (const auto &level : lodLevels) {
+            float error;
+            auto lodIndices = MeshOptimizer::simplify(indices, positions,
+                                                      static_cast<size_t>(indices.size() * level.triangleRatio),
+                                                      level.targetError, &error);
+            if (lodIndices.size() > numLodTriangles * (1.0f - minLodTriangleReduction)) break;
+            numLodTriangles = lodIndices.size();
+            
+            auto lodPositions = positions;
+            auto lodNormals = normals;
+            auto lodTextureCoords = textureCoords;
+            MeshOptimizer::optimizeVertexCache(lodIndices, positions.size());
+            MeshOptimizer::optimizeVertexFetch(lodIndices, lodPositions, lodNormals, lodTextureCoords);
+            
+            Log::info(this->getFilename() + " mesh " + std::to_string(i) +
+                      ": LOD " + std::to_string(data.lods.size() + 1) +
+                      " " + std::to_string(indices.size()) + " -> " + std::to_string(lodIndices.size()) +
+                      " triangles, error " + std::to_string(error));
+            data.lods.push_back({std::move(lodPositions), std::move(lodNormals),
+                                 std::move(lodTextureCoords), std::move(lodIndices)});
+        }
+        
+        data.lods.insert(data.lods.begin(), {std::move(positions), std::move(normals),
+                                             std::move(textureCoords), std::move(indices)});
     }
     
-    meshesCache[this->getFilename()] = meshes;
-    return meshes;
+    return meshData;
+}
+
+std::shared_ptr<const AsyncModel> ModelLoader3ds::loadAsync(const std::string &filepath) {
+    // Share models that are still being loaded
+    auto model = asyncModelCache[filepath].lock();
+    if (model) return model;
+    
+    model = std::shared_ptr<AsyncModel>(new AsyncModel, [filepath](auto model){
+        asyncModelCache.erase(filepath);
+        delete model;
+    });
+    asyncModelCache[filepath] = model;
+    
+    // Meshes that are already resident only need the model file to be parsed for collision shapes
+    const auto meshesResident = ManagerResources::isResident(ResourceType::MESH, filepath);
+    enqueueAsyncModelLoad(filepath, nullptr, meshesResident, std::chrono::steady_clock::now(), model);
+    
+    return model;
 }
 
 std::unique_ptr<btCollisionShape> ModelLoader3ds::loadCollisionShape() {
@@ -0,0 +1,374 @@
+#include <android_game_engine/OcclusionCuller.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+
+namespace {
+
+/// \name 4-wide float operations
+///@{
+#if defined(__ARM_NEON)
+using Float4 = float32x4_t;
+using Mask4 = uint32x4_t;
+
+inline Float4 set1(float value) {return vdupq_n_f32(value);}
+inline Float4 setRamp(float start) {
+    const float values[4] = {start, start + 1.0f, start + 2.0f, start + 3.0f};
+    return vld1q_f32(values);
+}
+inline Float4 load(const float *p) {return vld1q_f32(p);}
+inline void store(float *p, Float4 value) {vst1q_f32(p, value);}
+inline Float4 add(Float4 a, Float4 b) {return vaddq_f32(a, b);}
+inline Float4 mul(Float4 a, Float4 b) {return vmulq_f32(a, b);}
+inline Float4 min(Float4 a, Float4 b) {return vminq_f32(a, b);}
+inline Mask4 isNonNegative(Float4 a) {return vcgeq_f32(a, vdupq_n_f32(0.0f));}
+inline Mask4 bitAnd(Mask4 a, Mask4 b) {return vandq_u32(a, b);}
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {return vbslq_f32(mask, a, b);}
+#elif defined(__SSE2__)
+using Float4 = __m128;
+using Mask4 = __m128;
+
+inline Float4 set1(float value) {return _mm_set1_ps(value);}
+inline Float4 setRamp(float start) {return _mm_setr_ps(start, start + 1.0f, start + 2.0f, start + 3.0f);}
+inline Float4 load(const float *p) {return _mm_loadu_ps(p);}
+inline void store(float *p, Float4 value) {_mm_storeu_ps(p, value);}
+inline Float4 add(Float4 a, Float4 b) {return _mm_add_ps(a, b);}
+inline Float4 mul(Float4 a, Float4 b) {return _mm_mul_ps(a, b);}
+inline Float4 min(Float4 a, Float4 b) {return _mm_min_ps(a, b);}
+inline Mask4 isNonNegative(Float4 a) {return _mm_cmpge_ps(a, _mm_setzero_ps());}
+inline Mask4 bitAnd(Mask4 a, Mask4 b) {return _mm_and_ps(a, b);}
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));}
+#else
+struct Float4 {float v[4];};
+struct Mask4 {bool v[4];};
+
+inline Float4 set1(float value) {return {{value, value, value, value}};}
+inline Float4 setRamp(float start) {return {{start, start + 1.0f, start + 2.0f, start + 3.0f}};}
+inline Float4 load(const float *p) {return {{p[0], p[1], p[2], p[3]}};}
+inline void store(float *p, Float4 value) {std::copy(value.v, value.v + 4, p);}
+inline Float4 add(Float4 a, Float4 b) {return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};}
+inline Float4 mul(Float4 a, Float4 b) {return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};}
+inline Float4 min(Float4 a, Float4 b) {
+    return {{std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])}};
+}
+inline Mask4 isNonNegative(Float4 a) {return {{a.v[0] >= 0.0f, a.v[1] >= 0.0f, a.v[2] >= 0.0f, a.v[3] >= 0.0f}};}
+inline Mask4 bitAnd(Mask4 a, Mask4 b) {return {{a.v[0] && b.v[0], a.v[1] && b.v[1], a.v[2] && b.v[2], a.v[3] && b.v[3]}};}
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {
+    return {{mask.v[0] ? a.v[0] : b.v[0], mask.v[1] ? a.v[1] : b.v[1],
+             mask.v[2] ? a.v[2] : b.v[2], mask.v[3] ? a.v[3] : b.v[3]}};
+}
+#endif
+///@}
+
+///
+/// \brief Edge function A * x + B * y + C that is non-negative on the inner side of an edge.
+///
+struct Edge {
+    float a, b, c;
+
+    Edge(const glm::vec3 &from, const glm::vec3 &to) :
+            a(from.y - to.y), b(to.x - from.x), c(-(a * from.x + b * from.y)) {}
+
+    float evaluate(float x, float y) const {return this->a * x + this->b * y + this->c;}
+};
+
+constexpr float clearDepth = 1.0f;
+
+///
+/// \brief toPixel Converts a screen coordinate to a pixel index. Coordinates are clamped
+///                to just outside the depth buffer so that they can't overflow.
+///
+int toPixel(float coordinate, int size) {
+    return static_cast<int>(std::floor(std::min(std::max(coordinate, -1.0f), static_cast<float>(size))));
+}
+
+} // namespace
+
+namespace age {
+
+OcclusionCuller::OcclusionCuller(int width, int height, unsigned int numThreads) :
+        width((width + tileSize - 1) / tileSize * tileSize),
+        height((height + tileSize - 1) / tileSize * tileSize),
+        numTilesX(this->width / tileSize), numTilesY(this->height / tileSize),
+        numThreads(numThreads), tileTriangles(this->numTilesX * this->numTilesY),
+        depthBuffer(this->width * this->height, clearDepth) {
+    if (this->numThreads == 0) {
+        this->numThreads = std::min(std::max(1u, std::thread::hardware_concurrency()), 4u);
+    }
+    this->numThreads = std::min<unsigned int>(this->numThreads, this->numTilesX * this->numTilesY);
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    {
+        std::lock_guard<std::mutex> lock(this->workerMutex);
+        this->stopping = true;
+    }
+    this->rasterizeCondition.notify_all();
+
+    for (auto &worker : this->workers) {
+        worker.join();
+    }
+}
+
+void OcclusionCuller::startWorkers() {
+    if (!this->workers.empty()) return;
+
+    for (auto thread = 1u; thread < this->numThreads; ++thread) {
+        this->workers.emplace_back(&OcclusionCuller::runWorker, this, thread);
+    }
+}
+
+void OcclusionCuller::clearOccluders() {
+    this->occluderVertices.clear();
+}
+
+void OcclusionCuller::addOccluder(const OccluderMesh &mesh, const glm::mat4 &model) {
+    for (auto index : mesh.indices) {
+        this->occluderVertices.emplace_back(model * glm::vec4(mesh.positions[index], 1.0f));
+    }
+}
+
+void OcclusionCuller::rasterize(const glm::mat4 &projectionView) {
+    this->projectionView = projectionView;
+
+    // Transform, clip and bin triangles into tiles
+    this->screenTriangles.clear();
+    for (auto &triangles : this->tileTriangles) {
+        triangles.clear();
+    }
+
+    for (size_t i = 0; i + 2 < this->occluderVertices.size(); i += 3) {
+        const glm::vec4 clipVertices[3] = {projectionView * glm::vec4(this->occluderVertices[i], 1.0f),
+                                           projectionView * glm::vec4(this->occluderVertices[i + 1], 1.0f),
+                                           projectionView * glm::vec4(this->occluderVertices[i + 2], 1.0f)};
+        this->clipAndProject(clipVertices);
+    }
+
+    // Waking the workers and waiting for them costs more than rasterizing a few triangles
+    size_t numTileTriangles = 0;
+    for (const auto &triangles : this->tileTriangles) {
+        numTileTriangles += triangles.size();
+    }
+
+    const auto numThreads = static_cast<unsigned int>(this->workers.size()) + 1u;
+    if (numThreads == 1u || numTileTriangles < minTileTrianglesPerThread * numThreads) {
+        this->numRasterizingThreads = 1;
+        this->rasterizeTiles(0, 1);
+        return;
+    }
+
+    // Rasterize tiles in parallel with a fixed assignment of tiles to threads
+    this->numRasterizingThreads = numThreads;
+    {
+        std::lock_guard<std::mutex> lock(this->workerMutex);
+        ++this->rasterizeNumber;
+        this->numBusyWorkers = static_cast<unsigned int>(this->workers.size());
+    }
+    this->rasterizeCondition.notify_all();
+
+    this->rasterizeTiles(0, numThreads);
+
+    std::unique_lock<std::mutex> lock(this->workerMutex);
+    this->doneCondition.wait(lock, [this](){ return this->numBusyWorkers == 0; });
+}
+
+bool OcclusionCuller::isVisible(const AABB &aabb) const {
+    glm::vec2 screenMin(std::numeric_limits<float>::max());
+    glm::vec2 screenMax(std::numeric_limits<float>::lowest());
+    float nearestDepth = std::numeric_limits<float>::max();
+
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec4 corner((i & 1) ? aabb.max.x : aabb.min.x,
+                               (i & 2) ? aabb.max.y : aabb.min.y,
+                               (i & 4) ? aabb.max.z : aabb.min.z, 1.0f);
+        const auto clip = this->projectionView * corner;
+
+        // Boxes crossing the near plane can't be projected
+        if (clip.z < -clip.w || clip.w <= 0.0f) return true;
+
+        const auto ndc = glm::vec3(clip) / clip.w;
+        const glm::vec2 screen((ndc.x * 0.5f + 0.5f) * this->width, (ndc.y * 0.5f + 0.5f) * this->height);
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    const auto xMin = std::max(0, toPixel(screenMin.x, this->width));
+    const auto xMax = std::min(this->width - 1, toPixel(screenMax.x, this->width));
+    const auto yMin = std::max(0, toPixel(screenMin.y, this->height));
+    const auto yMax = std::min(this->height - 1, toPixel(screenMax.y, this->height));
+
+    // Off screen boxes are left to frustum culling
+    if (xMin > xMax || yMin > yMax) return true;
+
+    for (auto y = yMin; y <= yMax; ++y) {
+        const auto row = &this->depthBuffer[y * this->width];
+        for (auto x = xMin; x <= xMax; ++x) {
+            if (nearestDepth <= row[x]) return true;
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::clipAndProject(const glm::vec4 (&clipVertices)[3]) {
+    // Clip against the near plane z = -w
+    glm::vec4 clipped[4];
+    size_t numClipped = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        const auto &from = clipVertices[i];
+        const auto &to = clipVertices[(i + 1) % 3];
+        const auto fromDistance = from.z + from.w;
+        const auto toDistance = to.z + to.w;
+
+        if (fromDistance >= 0.0f) {
+            clipped[numClipped++] = from;
+        }
+        if ((fromDistance >= 0.0f) != (toDistance >= 0.0f)) {
+            clipped[numClipped++] = from + (to - from) * (fromDistance / (fromDistance - toDistance));
+        }
+    }
+
+    if (numClipped < 3) return;
+
+    glm::vec3 screen[4];
+    for (size_t i = 0; i < numClipped; ++i) {
+        if (clipped[i].w <= 0.0f) return;
+
+        const auto ndc = glm::vec3(clipped[i]) / clipped[i].w;
+        screen[i] = {(ndc.x * 0.5f + 0.5f) * this->width, (ndc.y * 0.5f + 0.5f) * this->height,
+                     ndc.z * 0.5f + 0.5f};
+    }
+
+    // Triangulate as a fan and bin
+    for (size_t i = 1; i + 1 < numClipped; ++i) {
+        ScreenTriangle triangle {{screen[0], screen[i], screen[i + 1]}};
+
+        const auto area = Edge(triangle.vertices[0], triangle.vertices[1]).evaluate(triangle.vertices[2].x,
+                                                                                  triangle.vertices[2].y);
+        if (area == 0.0f) continue;
+
+        // Rasterize both windings with counter clockwise edge functions
+        if (area < 0.0f) {
+            std::swap(triangle.vertices[1], triangle.vertices[2]);
+        }
+
+        const auto minX = std::min({triangle.vertices[0].x, triangle.vertices[1].x, triangle.vertices[2].x});
+        const auto maxX = std::max({triangle.vertices[0].x, triangle.vertices[1].x, triangle.vertices[2].x});
+        const auto minY = std::min({triangle.vertices[0].y, triangle.vertices[1].y, triangle.vertices[2].y});
+        const auto maxY = std::max({triangle.vertices[0].y, triangle.vertices[1].y, triangle.vertices[2].y});
+
+        if (maxX < 0.0f || maxY < 0.0f || minX >= this->width || minY >= this->height) continue;
+
+        const auto tileXMin = std::max(0, toPixel(minX, this->width)) / tileSize;
+        const auto tileXMax = std::min(this->width - 1, toPixel(maxX, this->width)) / tileSize;
+        const auto tileYMin = std::max(0, toPixel(minY, this->height)) / tileSize;
+        const auto tileYMax = std::min(this->height - 1, toPixel(maxY, this->height)) / tileSize;
+
+        const auto triangleIndex = static_cast<uint32_t>(this->screenTriangles.size());
+        this->screenTriangles.push_back(triangle);
+
+        for (auto tileY = tileYMin; tileY <= tileYMax; ++tileY) {
+            for (auto tileX = tileXMin; tileX <= tileXMax; ++tileX) {
+                this->tileTriangles[tileY * this->numTilesX + tileX].push_back(triangleIndex);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTiles(unsigned int thread, unsigned int numThreads) {
+    const auto numTiles = this->numTilesX * this->numTilesY;
+    for (auto tile = static_cast<int>(thread); tile < numTiles; tile += numThreads) {
+        this->rasterizeTile(tile);
+    }
+}
+
+void OcclusionCuller::runWorker(unsigned int thread) {
+    uint64_t rasterized = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->workerMutex);
+            this->rasterizeCondition.wait(lock, [this, rasterized](){
+                return this->stopping || this->rasterizeNumber != rasterized;
+            });
+            if (this->stopping) return;
+            rasterized = this->rasterizeNumber;
+        }
+
+        this->rasterizeTiles(thread, this->numThreads);
+
+        {
+            std::lock_guard<std::mutex> lock(this->workerMutex);
+            --this->numBusyWorkers;
+        }
+        this->doneCondition.notify_one();
+    }
+}
+
+void OcclusionCuller::rasterizeTile(int tile) {
+    const auto tileX0 = (tile % this->numTilesX) * tileSize;
+    const auto tileY0 = (tile / this->numTilesX) * tileSize;
+
+    for (auto y = tileY0; y < tileY0 + tileSize; ++y) {
+        std::fill_n(&this->depthBuffer[y * this->width + tileX0], tileSize, clearDepth);
+    }
+
+    for (auto triangleIndex : this->tileTriangles[tile]) {
+        const auto &v = this->screenTriangles[triangleIndex].vertices;
+
+        const Edge e0(v[1], v[2]);
+        const Edge e1(v[2], v[0]);
+        const Edge e2(v[0], v[1]);
+
+        // Depth is affine in screen space so interpolate it as a plane
+        const auto area = e2.evaluate(v[2].x, v[2].y);
+        const auto depthA = (e0.a * v[0].z + e1.a * v[1].z + e2.a * v[2].z) / area;
+        const auto depthB = (e0.b * v[0].z + e1.b * v[1].z + e2.b * v[2].z) / area;
+        const auto depthC = (e0.c * v[0].z + e1.c * v[1].z + e2.c * v[2].z) / area;
+
+        // Bounding box within the tile, aligned to 4 pixels horizontally
+        const auto xMin = std::max(tileX0, toPixel(std::min({v[0].x, v[1].x, v[2].x}), this->width)) & ~3;
+        const auto xMax = std::min(tileX0 + tileSize - 1, toPixel(std::max({v[0].x, v[1].x, v[2].x}), this->width));
+        const auto yMin = std::max(tileY0, toPixel(std::min({v[0].y, v[1].y, v[2].y}), this->height));
+        const auto yMax = std::min(tileY0 + tileSize - 1, toPixel(std::max({v[0].y, v[1].y, v[2].y}), this->height));
+
+        const auto e0A = set1(e0.a);
+        const auto e1A = set1(e1.a);
+        const auto e2A = set1(e2.a);
+        const auto depthA4 = set1(depthA);
+
+        for (auto y = yMin; y <= yMax; ++y) {
+            const auto pixelY = y + 0.5f;
+            const auto e0Row = set1(e0.b * pixelY + e0.c);
+            const auto e1Row = set1(e1.b * pixelY + e1.c);
+            const auto e2Row = set1(e2.b * pixelY + e2.c);
+            const auto depthRow = set1(depthB * pixelY + depthC);
+
+            auto row = &this->depthBuffer[y * this->width];
+            for (auto x = xMin; x <= xMax; x += 4) {
+                const auto pixelX = setRamp(x + 0.5f);
+
+                const auto inside = bitAnd(bitAnd(isNonNegative(add(mul(e0A, pixelX), e0Row)),
+                                                  isNonNegative(add(mul(e1A, pixelX), e1Row))),
+                                           isNonNegative(add(mul(e2A, pixelX), e2Row)));
+                const auto depth = add(mul(depthA4, pixelX), depthRow);
+
+                const auto storedDepth = load(row + x);
+                store(row + x, select(inside, min(storedDepth, depth), storedDepth));
+            }
+        }
+    }
+}
+
+} // namespace age
@@ -1,49 +1,70 @@
 #include <android_game_engine/PhysicsDebugDrawer.h>
 
+#include <cstddef>
+
 #include <GLES3/gl32.h>
 #include <glm/vec3.hpp>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/Log.h>
 #include <android_game_engine/ShaderProgram.h>
 
+namespace {
+
+// Length of the contact normals drawn at contact points
+constexpr btScalar contactNormalLength = 0.25f;
+
+glm::vec3 toGlm(const btVector3 &v) {
+    return {v.x(), v.y(), v.z()};
+}
+
+} // namespace
+
 namespace age {
 
-PhysicsDebugDrawer::PhysicsDebugDrawer(age::ShaderProgram *shader) : shader(shader) {
-    float positions[] = {0.0f, 0.0f, 0.0f,
-                         1.0f, 1.0f, 1.0f};
+PhysicsDebugDrawer::PhysicsDebugDrawer(age::ShaderProgram *shader) :
+        shader(shader), vboCapacity(0), captureTarget(nullptr), debugMode(DBG_NoDebug) {
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
-    glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), reinterpret_cast<GLvoid*>(0));
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex),
+                          reinterpret_cast<GLvoid*>(offsetof(LineVertex, position)));
     glEnableVertexAttribArray(0u);
+    glVertexAttribPointer(1u, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex),
+                          reinterpret_cast<GLvoid*>(offsetof(LineVertex, color)));
+    glEnableVertexAttribArray(1u);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 }
 
 PhysicsDebugDrawer::~PhysicsDebugDrawer() {
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
 }
 
 void PhysicsDebugDrawer::drawLine(const btVector3 &from, const btVector3 &to,
                                   const btVector3 &color) {
-    this->shader->setUniform("origin", glm::vec3 (from.x(), from.y(), from.z()));
-    this->shader->setUniform("basis", glm::vec3 (to.x() - from.x(),
-                                                 to.y() - from.y(),
-                                                 to.z() - from.z()));
-    this->shader->setUniform("color", glm::vec3(color.x(), color.y(), color.z()));
+    this->drawLine(from, to, color, color);
+}
 
-    glBindVertexArray(this->vao);
-    glDrawArrays(GL_LINES, 0, 2);
+void PhysicsDebugDrawer::drawLine(const btVector3 &from, const btVector3 &to,
+                                  const btVector3 &fromColor, const btVector3 &toColor) {
+    this->lineVertices.push_back({toGlm(from), toGlm(fromColor)});
+    this->lineVertices.push_back({toGlm(to), toGlm(toColor)});
 }
 
 void PhysicsDebugDrawer::drawContactPoint(const btVector3 &PointOnB, const btVector3 &normalOnB,
                                           btScalar distance, int lifeTime,
-                                          const btVector3 &color) {}
+                                          const btVector3 &color) {
+    // Contact normal, followed by the penetration depth along the normal
+    this->drawLine(PointOnB, PointOnB + normalOnB * contactNormalLength, color);
+    if (distance < 0.0f) {
+        this->drawLine(PointOnB, PointOnB + normalOnB * distance, color);
+    }
+}
                                           
 void PhysicsDebugDrawer::reportErrorWarning(const char *warningString) {
     Log::error(warningString);
@@ -53,4 +74,37 @@ void PhysicsDebugDrawer::draw3dText(const btVector3 &location, const char *textS
 
 void PhysicsDebugDrawer::setDebugMode(int debugMode) {this->debugMode = debugMode;}
 
+void PhysicsDebugDrawer::clearLines() {
+    this->lineVertices.clear();
+}
+
+void PhysicsDebugDrawer::flushLines() {
+    if (this->captureTarget) {
+        this->captureTarget->swap(this->lineVertices);
+    } else {
+        this->drawLines(this->lineVertices);
+    }
+
+    this->lineVertices.clear();
+}
+
+void PhysicsDebugDrawer::setCaptureTarget(std::vector<LineVertex> *lines) {this->captureTarget = lines;}
+
+void PhysicsDebugDrawer::drawLines(const std::vector<LineVertex> &lines) {
+    if (lines.empty()) return;
+
+    GLState::bindVertexArray(this->vao);
+
+    // Orphan the previous lines so the driver doesn't stall on draws still in flight
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    if (lines.size() > this->vboCapacity) {
+        this->vboCapacity = lines.capacity();
+    }
+    glBufferData(GL_ARRAY_BUFFER, this->vboCapacity * sizeof(LineVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, lines.size() * sizeof(LineVertex), lines.data());
+
+    this->shader->use();
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lines.size()));
+}
+
 } // namespace age
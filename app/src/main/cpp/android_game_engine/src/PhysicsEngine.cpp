@@ -6,6 +6,7 @@
 
 #include <android_game_engine/PhysicsDebugDrawer.h>
 #include <android_game_engine/PhysicsRigidBody.h>
+#include <android_game_engine/Trace.h>
 
 namespace age {
 
@@ -21,15 +22,24 @@ PhysicsEngine::PhysicsEngine(ShaderProgram *debugShader)
                                                     this->collisionConfig.get())) {
     this->dynamicsWorld->setGravity({0.0f, 0.0f, -9.80665f});
     this->dynamicsWorld->setDebugDrawer(this->debugDrawer.get());
-    this->debugDrawer->setDebugMode(btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawAabb);
+    this->debugDrawer->setDebugMode(btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawAabb |
+                                    btIDebugDraw::DBG_DrawContactPoints);
 }
 
 PhysicsEngine::~PhysicsEngine() = default;
 
 void PhysicsEngine::onUpdate(std::chrono::duration<float> updateDuration) {
+    AGE_TRACE_SCOPE("PhysicsEngine::onUpdate");
     this->dynamicsWorld->stepSimulation(updateDuration.count(), 10);
 }
 
+void PhysicsEngine::step(std::chrono::duration<float> timestep) {
+    AGE_TRACE_SCOPE("PhysicsEngine::step");
+
+    // Without substeps Bullet steps by the whole duration
+    this->dynamicsWorld->stepSimulation(timestep.count(), 0);
+}
+
 void PhysicsEngine::setGravity(const glm::vec3 &gravity) {
     this->dynamicsWorld->setGravity({gravity.x, gravity.y, gravity.z});
 }
@@ -62,4 +72,16 @@ void PhysicsEngine::renderDebug() {
     this->dynamicsWorld->debugDrawWorld();
 }
 
+void PhysicsEngine::captureDebug(std::vector<PhysicsDebugDrawer::LineVertex> &lines) {
+    lines.clear();
+
+    this->debugDrawer->setCaptureTarget(&lines);
+    this->dynamicsWorld->debugDrawWorld();
+    this->debugDrawer->setCaptureTarget(nullptr);
+}
+
+void PhysicsEngine::renderDebug(const std::vector<PhysicsDebugDrawer::LineVertex> &lines) {
+    this->debugDrawer->drawLines(lines);
+}
+
 } // namespace age
\ No newline at end of file
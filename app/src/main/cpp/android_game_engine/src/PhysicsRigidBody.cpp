@@ -1,5 +1,7 @@
 #include <android_game_engine/PhysicsRigidBody.h>
 
+#include <cassert>
+
 #include <android_game_engine/PhysicsMotionState.h>
 
 namespace age {
@@ -57,6 +59,18 @@ void PhysicsRigidBody::setScale(const glm::vec3 &scale) {
     this->collisionShape->setLocalScaling({scale.x, scale.y, scale.z});
 }
 
+void PhysicsRigidBody::setCollisionShape(std::unique_ptr<btCollisionShape> collisionShape) {
+    assert(collisionShape->getShapeType() == this->collisionShape->getShapeType() &&
+           "Collision shapes must be of the same type");
+
+    collisionShape->setLocalScaling(this->collisionShape->getLocalScaling());
+    this->body->setCollisionShape(collisionShape.get());
+    this->collisionShape = std::move(collisionShape);
+
+    this->setMass(this->getMass());
+    this->body->activate(true);
+}
+
 std::pair<glm::mat3, glm::vec3> PhysicsRigidBody::getTransform() const {
     btTransform transform;
     this->motionState->getWorldTransform(transform);
@@ -0,0 +1,220 @@
+#include <android_game_engine/ProgramBinaryCache.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+#include <android_game_engine/Log.h>
+
+namespace {
+
+// Bump when the file layout changes, which also changes every key
+constexpr uint32_t fileVersion = 1;
+constexpr char fileMagic[4] = {'A', 'G', 'P', 'B'};
+const std::string fileExtension = ".bin";
+
+constexpr uint64_t fnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t fnvPrime = 1099511628211ull;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t size;
+    uint64_t checksum; ///< FNV-1a hash of the binary data
+};
+
+std::mutex cacheMutex;
+std::string cacheDirectory;
+size_t cacheMaxBytes = 0;
+
+uint64_t fnv1a(const void *data, size_t numBytes, uint64_t seed=fnvOffsetBasis) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < numBytes; ++i) {
+        seed = (seed ^ bytes[i]) * fnvPrime;
+    }
+    return seed;
+}
+
+std::string getBinaryFilepath(const std::string &directory, uint64_t key) {
+    std::ostringstream filepath;
+    filepath << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << key << fileExtension;
+    return filepath.str();
+}
+
+///
+/// \brief prune Removes the least recently used binaries until the directory fits in the size limit.
+/// \param directory Cache directory.
+/// \param maxBytes Size limit.
+/// \param keepFilepath Binary that was just stored, which is never removed.
+///
+void prune(const std::string &directory, size_t maxBytes, const std::string &keepFilepath) {
+    struct CachedFile {
+        std::string filepath;
+        time_t lastUsedTime;
+        size_t size;
+    };
+
+    auto dir = opendir(directory.c_str());
+    if (!dir) return;
+
+    std::vector<CachedFile> files;
+    size_t totalBytes = 0;
+    while (auto entry = readdir(dir)) {
+        const std::string filename = entry->d_name;
+        if (filename.size() <= fileExtension.size() ||
+            filename.compare(filename.size() - fileExtension.size(), fileExtension.size(), fileExtension) != 0) {
+            continue;
+        }
+
+        const auto filepath = directory + '/' + filename;
+        struct stat fileStat;
+        if (stat(filepath.c_str(), &fileStat) != 0) continue;
+
+        files.push_back({filepath, fileStat.st_mtime, static_cast<size_t>(fileStat.st_size)});
+        totalBytes += files.back().size;
+    }
+    closedir(dir);
+
+    std::sort(files.begin(), files.end(), [](const auto &a, const auto &b){
+        return a.lastUsedTime < b.lastUsedTime;
+    });
+
+    for (const auto &file : files) {
+        if (totalBytes <= maxBytes) break;
+        if (file.filepath == keepFilepath) continue;
+
+        if (std::remove(file.filepath.c_str()) == 0) {
+            totalBytes -= file.size;
+        }
+    }
+}
+
+} // namespace
+
+namespace age {
+namespace ProgramBinaryCache {
+
+void init(const std::string &directory, size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheDirectory = directory;
+    cacheMaxBytes = maxBytes;
+
+    if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        Log::warn("Failed to create program binary cache directory " + directory + ": " + std::strerror(errno));
+        cacheDirectory.clear();
+    }
+}
+
+void shutdown() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheDirectory.clear();
+}
+
+bool isEnabled() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return !cacheDirectory.empty();
+}
+
+uint64_t computeKey(const std::vector<std::string> &parts) {
+    auto key = fnv1a(&fileVersion, sizeof(fileVersion));
+
+    // Hash the lengths as well so that moving text from one part to the next changes the key
+    for (const auto &part : parts) {
+        const uint64_t length = part.size();
+        key = fnv1a(&length, sizeof(length), key);
+        key = fnv1a(part.data(), part.size(), key);
+    }
+    return key;
+}
+
+std::string getFilepath(uint64_t key) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return getBinaryFilepath(cacheDirectory, key);
+}
+
+std::unique_ptr<ProgramBinary> load(uint64_t key) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cacheDirectory.empty()) return nullptr;
+
+    const auto filepath = getBinaryFilepath(cacheDirectory, key);
+    auto file = std::fopen(filepath.c_str(), "rb");
+    if (!file) return nullptr;
+
+    FileHeader header;
+    auto binary = std::make_unique<ProgramBinary>();
+    auto isValid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                   std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) == 0 &&
+                   header.version == fileVersion && header.key == key && header.size > 0;
+    if (isValid) {
+        binary->format = header.format;
+        binary->data.resize(header.size);
+        isValid = std::fread(binary->data.data(), 1, binary->data.size(), file) == binary->data.size() &&
+                  std::fgetc(file) == EOF &&
+                  fnv1a(binary->data.data(), binary->data.size()) == header.checksum;
+    }
+    std::fclose(file);
+
+    if (!isValid) {
+        Log::warn("Removing corrupt program binary " + filepath);
+        std::remove(filepath.c_str());
+        return nullptr;
+    }
+
+    // Mark as recently used for pruning
+    utime(filepath.c_str(), nullptr);
+    return binary;
+}
+
+void store(uint64_t key, const ProgramBinary &binary) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cacheDirectory.empty() || binary.data.empty()) return;
+
+    FileHeader header;
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.key = key;
+    header.format = binary.format;
+    header.size = static_cast<uint32_t>(binary.data.size());
+    header.checksum = fnv1a(binary.data.data(), binary.data.size());
+
+    const auto filepath = getBinaryFilepath(cacheDirectory, key);
+    const auto temporaryFilepath = filepath + ".tmp";
+
+    auto file = std::fopen(temporaryFilepath.c_str(), "wb");
+    if (!file) {
+        Log::warn("Failed to write program binary " + temporaryFilepath + ": " + std::strerror(errno));
+        return;
+    }
+
+    auto written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(binary.data.data(), 1, binary.data.size(), file) == binary.data.size();
+    written = std::fclose(file) == 0 && written;
+
+    if (!written || std::rename(temporaryFilepath.c_str(), filepath.c_str()) != 0) {
+        Log::warn("Failed to write program binary " + filepath);
+        std::remove(temporaryFilepath.c_str());
+        return;
+    }
+
+    prune(cacheDirectory, cacheMaxBytes, filepath);
+}
+
+void remove(uint64_t key) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cacheDirectory.empty()) return;
+
+    std::remove(getBinaryFilepath(cacheDirectory, key).c_str());
+}
+
+} // namespace ProgramBinaryCache
+} // namespace age
@@ -0,0 +1,310 @@
+#include <android_game_engine/RenderQueue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <GLES3/gl32.h>
+
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/GameObject.h>
+#include <android_game_engine/Mesh.h>
+#include <android_game_engine/ShaderProgram.h>
+#include <android_game_engine/UniformBuffer.h>
+
+namespace {
+
+// The pass and its layer are stored together as pass * maxLayers + layer
+constexpr unsigned int passShift = 60u;
+constexpr unsigned int translucentShift = 59u;
+static_assert(static_cast<unsigned int>(age::RenderQueue::Pass::NUM_PASSES) * age::RenderQueue::maxLayers <= (1u << (64u - passShift)),
+              "Passes and their layers don't fit in the sort key");
+
+// Opaque key layout
+constexpr unsigned int opaqueShaderShift = 51u;
+constexpr unsigned int opaqueMaterialShift = 35u;
+constexpr unsigned int opaqueVaoShift = 19u;
+constexpr unsigned int opaqueDepthBits = 19u;
+
+// Translucent key layout
+constexpr unsigned int translucentDepthShift = 37u;
+constexpr unsigned int translucentDepthBits = 22u;
+constexpr unsigned int translucentShaderShift = 29u;
+constexpr unsigned int translucentMaterialShift = 13u;
+
+constexpr uint64_t shaderMask = (1u << 8u) - 1u;
+constexpr uint64_t materialMask = (1u << 16u) - 1u;
+constexpr uint64_t opaqueVaoMask = (1u << 16u) - 1u;
+constexpr uint64_t translucentVaoMask = (1u << 13u) - 1u;
+
+constexpr uint32_t noDrawUniforms = ~0u;
+constexpr uint32_t noMaterial = ~0u;
+
+///
+/// \brief getId Returns the ID of a key, inserting newId for keys that don't have one yet.
+///
+/// Most keys were already seen this frame, and emplace would allocate a node before finding them.
+///
+template<typename Key>
+uint32_t getId(std::unordered_map<Key, uint32_t> &ids, const Key &key, uint32_t newId) {
+    const auto id = ids.find(key);
+    if (id != ids.end()) return id->second;
+    return ids.emplace(key, newId).first->second;
+}
+
+///
+/// \brief quantizeDepth Quantizes a depth into its most significant bits.
+///
+/// The bit pattern of a non-negative IEEE 754 float increases monotonically with
+/// its value so it can be truncated instead of normalized against a far plane.
+///
+uint64_t quantizeDepth(float depth, unsigned int numBits) {
+    depth = std::max(depth, 0.0f);
+
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (32u - numBits);
+}
+
+///
+/// \brief radixSort Sorts entries by key with a least significant digit radix sort
+///                  over 8-bit digits. Digits that are equal for all keys are skipped.
+/// \param entries Entries to sort.
+/// \param scratch Scratch space that is resized to the number of entries.
+///
+template<typename Entry>
+void radixSort(std::vector<Entry> &entries, std::vector<Entry> &scratch) {
+    constexpr unsigned int digitBits = 8u;
+    constexpr unsigned int numBuckets = 1u << digitBits;
+
+    scratch.resize(entries.size());
+
+    for (unsigned int shift = 0u; shift < 64u; shift += digitBits) {
+        std::array<size_t, numBuckets> counts {};
+        for (const auto &entry : entries) {
+            ++counts[(entry.key >> shift) & (numBuckets - 1u)];
+        }
+
+        if (std::any_of(counts.begin(), counts.end(),
+                        [size = entries.size()](auto count){ return count == size; })) {
+            continue;
+        }
+
+        // Exclusive prefix sum into bucket offsets
+        size_t offset = 0;
+        for (auto &count : counts) {
+            const auto bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+
+        for (const auto &entry : entries) {
+            scratch[counts[(entry.key >> shift) & (numBuckets - 1u)]++] = entry;
+        }
+
+        entries.swap(scratch);
+    }
+}
+
+} // namespace
+
+namespace age {
+
+void RenderQueue::clear() {
+    this->items.clear();
+    this->sortEntries.clear();
+
+    this->shaderIds.clear();
+    this->materialIds.clear();
+    this->vaoIds.clear();
+
+    this->drawUniformRing = nullptr;
+}
+
+uint64_t RenderQueue::getPassBits(Pass pass, unsigned int layer) {
+    assert(layer < maxLayers && "Render pass layer out of range");
+    return static_cast<uint64_t>(pass) * maxLayers + layer;
+}
+
+void RenderQueue::add(Pass pass, GameObject *gameObject, ShaderProgram *shader,
+                      const MaterialUniforms *uniforms, float depth, bool translucent,
+                      unsigned int lod, unsigned int layer) {
+    if (gameObject->isInstanceable()) {
+        this->add(pass, gameObject->getMeshes(), gameObject->getInstance(), gameObject->getSpecularExponent(),
+                  shader, uniforms, depth, translucent, lod, layer);
+        return;
+    }
+
+    const Item item {gameObject, nullptr, shader, uniforms, gameObject->getInstance(),
+                     gameObject->getSpecularExponent(), this->getShaderId(shader), 0u, 0u, noDrawUniforms,
+                     translucent, lod};
+    this->push(item, getPassBits(pass, layer), depth);
+}
+
+void RenderQueue::add(Pass pass, const std::vector<Mesh> &meshes, const VertexArray::Instance &instance,
+                      float specularExponent, ShaderProgram *shader, const MaterialUniforms *uniforms,
+                      float depth, bool translucent, unsigned int lod, unsigned int layer) {
+    Item item {nullptr, nullptr, shader, uniforms, instance, specularExponent, this->getShaderId(shader),
+               0u, 0u, noDrawUniforms, translucent, lod};
+
+    const auto passBits = getPassBits(pass, layer);
+    for (const auto &mesh : meshes) {
+        item.mesh = &mesh;
+        item.materialId = uniforms ? this->getMaterialId(mesh, item.specularExponent) : 0u;
+        item.vaoId = this->getVertexArrayId(mesh.getVertexArray(lod));
+        this->push(item, passBits, depth);
+    }
+}
+
+void RenderQueue::push(const Item &item, uint64_t passBits, float depth) {
+    auto key = passBits << passShift;
+
+    if (item.translucent) {
+        const auto maxDepth = (uint64_t(1) << translucentDepthBits) - 1u;
+        key |= uint64_t(1) << translucentShift;
+        key |= (maxDepth - quantizeDepth(depth, translucentDepthBits)) << translucentDepthShift;
+        key |= std::min<uint64_t>(item.shaderId, shaderMask) << translucentShaderShift;
+        key |= std::min<uint64_t>(item.materialId, materialMask) << translucentMaterialShift;
+        key |= std::min<uint64_t>(item.vaoId, translucentVaoMask);
+    } else {
+        key |= std::min<uint64_t>(item.shaderId, shaderMask) << opaqueShaderShift;
+        key |= std::min<uint64_t>(item.materialId, materialMask) << opaqueMaterialShift;
+        key |= std::min<uint64_t>(item.vaoId, opaqueVaoMask) << opaqueVaoShift;
+        key |= quantizeDepth(depth, opaqueDepthBits);
+    }
+
+    this->sortEntries.push_back({key, static_cast<uint32_t>(this->items.size())});
+    this->items.push_back(item);
+}
+
+void RenderQueue::sort() {
+    radixSort(this->sortEntries, this->sortScratch);
+}
+
+void RenderQueue::writeDrawUniforms(UniformBufferRing &ring) {
+    this->drawUniformRing = &ring;
+
+    // Items sharing draw data share one copy of it, so the frame only holds the distinct data
+    this->drawUniformsOffsets.clear();
+    for (const auto &item : this->items) {
+        if (item.uniforms != nullptr) this->drawUniformsOffsets.emplace(item.specularExponent, 0);
+    }
+
+    ring.beginFrame(ring.getAlignedSize(sizeof(DrawUniforms)) * static_cast<unsigned int>(this->drawUniformsOffsets.size()));
+    for (auto &offset : this->drawUniformsOffsets) {
+        DrawUniforms drawUniforms;
+        drawUniforms.specularExponent = offset.first;
+        offset.second = ring.push(&drawUniforms, sizeof(drawUniforms));
+    }
+    ring.flush();
+
+    for (auto &item : this->items) {
+        if (item.uniforms != nullptr) item.drawUniformsOffset = this->drawUniformsOffsets[item.specularExponent];
+    }
+}
+
+void RenderQueue::render(Pass pass, const std::function<void(ShaderProgram*)> &useShader,
+                         unsigned int layer) {
+    const auto passBits = getPassBits(pass, layer);
+    auto &statistics = this->statistics[passBits];
+    statistics = {};
+
+    // Items of a pass are contiguous since the pass occupies the most significant bits
+    const auto begin = std::partition_point(this->sortEntries.begin(), this->sortEntries.end(),
+                                            [passBits](const auto &entry){ return (entry.key >> passShift) < passBits; });
+    const auto end = std::partition_point(begin, this->sortEntries.end(),
+                                          [passBits](const auto &entry){ return (entry.key >> passShift) == passBits; });
+
+    ShaderProgram *currentShader = nullptr;
+    auto currentMaterialId = noMaterial;
+    bool depthWritesDisabled = false;
+
+    for (auto entry = begin; entry != end;) {
+        const auto &item = this->items[entry->item];
+
+        if (item.shader != currentShader) {
+            useShader(item.shader);
+            currentShader = item.shader;
+            currentMaterialId = noMaterial;
+            ++statistics.numShaderChanges;
+        }
+
+        if (item.translucent && !depthWritesDisabled) {
+            GLState::depthMask(GL_FALSE);
+            depthWritesDisabled = true;
+        }
+
+        if (item.mesh == nullptr) {
+            if (pass == Pass::STATIC_SHADOW || pass == Pass::SHADOW) {
+                item.gameObject->renderShadow(item.shader);
+            } else {
+                item.gameObject->render(item.shader, item.uniforms);
+            }
+            currentMaterialId = noMaterial;
+
+            ++statistics.numInstances;
+            ++statistics.numDrawCalls;
+            ++entry;
+            continue;
+        }
+
+        // Merge consecutive items sharing the same state into one instanced draw call
+        this->mergedInstances.clear();
+        auto last = entry;
+        for (; last != end && this->canMerge(item, this->items[last->item]); ++last) {
+            this->mergedInstances.push_back(this->items[last->item].instance);
+        }
+
+        if (item.uniforms) {
+            // Shaders without the DrawUB uniform block take the data as uniforms
+            item.shader->setUniform(item.uniforms->specularExponent, item.specularExponent);
+
+            // Textures and their sampler uniforms stay bound while the material is unchanged
+            if (item.materialId != currentMaterialId) {
+                item.mesh->bindTextures(item.shader, *item.uniforms);
+                currentMaterialId = item.materialId;
+                ++statistics.numMaterialChanges;
+            }
+        }
+
+        if (this->drawUniformRing && item.drawUniformsOffset != noDrawUniforms) {
+            this->drawUniformRing->bind(item.drawUniformsOffset, sizeof(DrawUniforms));
+        }
+        item.mesh->renderVAO(this->mergedInstances.data(), this->mergedInstances.size(), item.lod);
+
+        statistics.numInstances += this->mergedInstances.size();
+        ++statistics.numDrawCalls;
+        entry = last;
+    }
+
+    if (depthWritesDisabled) {
+        GLState::depthMask(GL_TRUE);
+    }
+}
+
+uint32_t RenderQueue::getShaderId(ShaderProgram *shader) {
+    return getId(this->shaderIds, shader, static_cast<uint32_t>(this->shaderIds.size()));
+}
+
+uint32_t RenderQueue::getMaterialId(const Mesh &mesh, float specularExponent) {
+    // ID 0 is reserved for items drawn without materials
+    uint32_t specularExponentBits;
+    std::memcpy(&specularExponentBits, &specularExponent, sizeof(specularExponentBits));
+
+    const auto key = (static_cast<uint64_t>(mesh.getTextureSetId()) << 32u) | specularExponentBits;
+    return getId(this->materialIds, key, static_cast<uint32_t>(this->materialIds.size() + 1));
+}
+
+uint32_t RenderQueue::getVertexArrayId(VertexArray *vao) {
+    return getId(this->vaoIds, vao, static_cast<uint32_t>(this->vaoIds.size()));
+}
+
+bool RenderQueue::canMerge(const Item &a, const Item &b) const {
+    return a.mesh != nullptr && b.mesh != nullptr &&
+           a.shaderId == b.shaderId &&
+           a.materialId == b.materialId &&
+           a.vaoId == b.vaoId &&
+           a.translucent == b.translucent;
+}
+
+} // namespace age
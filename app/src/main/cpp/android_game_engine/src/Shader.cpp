@@ -10,18 +10,14 @@
 namespace age {
 
 Shader::Shader(const std::string &filepath, GLenum type) :
+    Shader(filepath, loadSource(filepath), type) {}
+
+Shader::Shader(const std::string &filepath, const std::string &source, GLenum type) :
     shader(new GLuint(glCreateShader(type)),
            [](GLuint *shader){ glDeleteShader(*shader); delete shader; }) {
-    auto asset = age::ManagerAssets::openAsset(filepath);
-    auto length = asset.getLength();
-    std::unique_ptr<GLchar[]> buffer(new GLchar[length]);
-    if (asset.read(buffer.get(), length) < 0) {
-        throw age::LoadError("Failed to read shader code from file: " + filepath);
-    }
-
     // Compile shader
-    auto shaderCode = buffer.get();
-    std::array<GLint, 1> shaderCodeSize{static_cast<GLint>(length)};
+    auto shaderCode = source.data();
+    std::array<GLint, 1> shaderCodeSize{static_cast<GLint>(source.size())};
     glShaderSource(*this->shader, 1, &shaderCode, shaderCodeSize.data());
     glCompileShader(*this->shader);
 
@@ -37,12 +33,21 @@ Shader::Shader(const std::string &filepath, GLenum type) :
         glGetShaderInfoLog(*this->shader, logLength, nullptr, compileLog.get());
 
         std::stringstream errorMsg;
-        errorMsg << "Failed to compile " << filepath << "\n" << compileLog;
+        errorMsg << "Failed to compile " << filepath << "\n" << compileLog.get();
 
         throw age::BuildError(errorMsg.str());
     }
 }
 
+std::string Shader::loadSource(const std::string &filepath) {
+    auto asset = age::ManagerAssets::openAsset(filepath);
+    std::string source(static_cast<size_t>(asset.getLength()), '\0');
+    if (asset.read(&source[0], source.size()) < 0) {
+        throw age::LoadError("Failed to read shader code from file: " + filepath);
+    }
+    return source;
+}
+
 void Shader::attachToProgram(unsigned int program) {
     glAttachShader(program, *this->shader);
 }
@@ -1,6 +1,9 @@
 #include <android_game_engine/ShaderProgram.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <sstream>
 
@@ -10,16 +13,117 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <android_game_engine/AssetLoader.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/Log.h>
+#include <android_game_engine/ProgramBinaryCache.h>
 #include <android_game_engine/Shader.h>
 #include <android_game_engine/UniformBuffer.h>
 
+namespace {
+
+///
+/// \brief isUniformChanged Returns whether a uniform value must be set on the program because
+///                         the uniform is active and the value differs from its current value.
+///
+template<typename T, typename V>
+bool isUniformChanged(GLuint program, age::UniformHandle<T> handle, const V &value) {
+    return handle.isValid() &&
+           age::GLState::updateUniform(program, handle.getLocation(), &value, sizeof(value));
+}
+
+std::string getGLString(GLenum name) {
+    auto string = glGetString(name);
+    return string ? reinterpret_cast<const char*>(string) : "";
+}
+
+///
+/// \brief isProgramBinarySupported Checks whether the driver can save and load program binaries.
+///
+bool isProgramBinarySupported() {
+    static const bool supported = [](){
+        GLint numFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        return numFormats > 0;
+    }();
+    return supported;
+}
+
+///
+/// \brief loadProgramBinary Links a program from the binary cached on a previous launch.
+/// \param program Program to link.
+/// \param key Key of the cached binary.
+/// \return True if the program was linked. Binaries the driver rejects are removed from the cache.
+///
+bool loadProgramBinary(GLuint program, uint64_t key) {
+    auto binary = age::ProgramBinaryCache::load(key);
+    if (!binary) return false;
+
+    glProgramBinary(program, binary->format, binary->data.data(), static_cast<GLsizei>(binary->data.size()));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        age::Log::warn("Driver rejected cached program binary " + age::ProgramBinaryCache::getFilepath(key));
+        age::ProgramBinaryCache::remove(key);
+    }
+    return linked;
+}
+
+///
+/// \brief storeProgramBinary Retrieves the binary of a linked program and writes it to
+///                           the cache on a worker thread.
+/// \param program Linked program.
+/// \param key Key of the binary.
+///
+void storeProgramBinary(GLuint program, uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    auto binary = std::make_shared<age::ProgramBinaryCache::ProgramBinary>();
+    binary->data.resize(static_cast<size_t>(length));
+
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary->data.data());
+    binary->format = format;
+
+    age::AssetLoader::enqueueLoad([key, binary](){
+        age::ProgramBinaryCache::store(key, *binary);
+    });
+}
+
+} // namespace
+
 namespace age {
+
 ShaderProgram::ShaderProgram(const std::string &vertexShaderPath,
                              const std::string &fragmentShaderPath) :
                              program(new unsigned int(glCreateProgram()),
-                                     [](unsigned int *program){ glDeleteProgram(*program); delete program; }){
+                                     [](unsigned int *program){ GLState::deleteProgram(*program); delete program; }){
+    const auto start = std::chrono::steady_clock::now();
+    const auto vertexShaderSource = Shader::loadSource(vertexShaderPath);
+    const auto fragmentShaderSource = Shader::loadSource(fragmentShaderPath);
+
+    // Load the binary linked on a previous launch by the same driver
+    const auto useBinaryCache = ProgramBinaryCache::isEnabled() && isProgramBinarySupported();
+    uint64_t binaryKey = 0;
+    if (useBinaryCache) {
+        binaryKey = ProgramBinaryCache::computeKey({vertexShaderSource, fragmentShaderSource,
+                                                    getGLString(GL_VENDOR), getGLString(GL_RENDERER),
+                                                    getGLString(GL_VERSION)});
+
+        if (loadProgramBinary(*this->program, binaryKey)) {
+            this->reflect();
+
+            const std::chrono::duration<float, std::milli> loadTime = std::chrono::steady_clock::now() - start;
+            Log::info("Successfully loaded program binary in " + std::to_string(loadTime.count()) + " ms:\n" +
+                      vertexShaderPath + "\n" + fragmentShaderPath);
+            return;
+        }
+    }
+
     // Compile shaders
     auto shaderDeleter = [program=*this->program](Shader *shader) {
         shader->detachFromProgram(program);
@@ -27,14 +131,18 @@ ShaderProgram::ShaderProgram(const std::string &vertexShaderPath,
     };
 
     std::unique_ptr<Shader, decltype(shaderDeleter)> vertexShader(
-            new Shader(vertexShaderPath, GL_VERTEX_SHADER), shaderDeleter);
+            new Shader(vertexShaderPath, vertexShaderSource, GL_VERTEX_SHADER), shaderDeleter);
     vertexShader->attachToProgram(*this->program);
 
     std::unique_ptr<Shader, decltype(shaderDeleter)> fragmentShader(
-            new Shader(fragmentShaderPath, GL_FRAGMENT_SHADER), shaderDeleter);
+            new Shader(fragmentShaderPath, fragmentShaderSource, GL_FRAGMENT_SHADER), shaderDeleter);
     fragmentShader->attachToProgram(*this->program);
 
     // Link shaders
+    if (useBinaryCache) {
+        glProgramParameteri(*this->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     int linked;
     glLinkProgram(*this->program);
     glGetProgramiv(*this->program, GL_LINK_STATUS, &linked);
@@ -46,71 +154,192 @@ ShaderProgram::ShaderProgram(const std::string &vertexShaderPath,
         glGetProgramInfoLog(*this->program, logLength, nullptr, linkLog.get());
 
         std::stringstream errorMsg;
-        errorMsg << "Failed to link shaders\n" << linkLog;
+        errorMsg << "Failed to link shaders\n" << linkLog.get();
 
         throw age::BuildError(errorMsg.str());
     }
 
-    Log::info("Successfully compiled and linked shaders:\n" +
+    this->reflect();
+
+    if (useBinaryCache) {
+        storeProgramBinary(*this->program, binaryKey);
+    }
+
+    const std::chrono::duration<float, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+    Log::info("Successfully compiled and linked shaders in " + std::to_string(buildTime.count()) + " ms:\n" +
               vertexShaderPath + "\n" + fragmentShaderPath);
 }
 
 void ShaderProgram::use() {
-    glUseProgram(*this->program);
+    GLState::useProgram(*this->program);
 }
 
 void ShaderProgram::setUniform(const std::string &name, bool value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform1i(location, value);
+    auto handle = this->getUniformHandle<bool>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, value);
 }
 
 void ShaderProgram::setUniform(const std::string &name, int value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform1i(location, value);
+    auto handle = this->getUniformHandle<int>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, value);
 }
 
 void ShaderProgram::setUniform(const std::string &name, float value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform1f(location, value);
+    auto handle = this->getUniformHandle<float>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, value);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec2 &v) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform2f(location, v.x, v.y);
+    auto handle = this->getUniformHandle<glm::vec2>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, v);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec3 &v) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform3f(location, v.x, v.y, v.z);
+    auto handle = this->getUniformHandle<glm::vec3>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, v);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec4 &v) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniform4f(location, v.x, v.y, v.z, v.w);
+    auto handle = this->getUniformHandle<glm::vec4>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, v);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::mat3 &m) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(m));
+    auto handle = this->getUniformHandle<glm::mat3>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, m);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::mat4 &m) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    assert(("Failed to glGetUniformLocation()", location != -1));
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(m));
+    auto handle = this->getUniformHandle<glm::mat4>(name);
+    assert(handle.isValid() && "Failed to find active uniform");
+    this->setUniform(handle, m);
+}
+
+void ShaderProgram::setUniform(UniformHandle<bool> handle, bool value) {
+    const GLint intValue = value;
+    if (isUniformChanged(*this->program, handle, intValue)) {
+        glUniform1i(handle.getLocation(), intValue);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<int> handle, int value) {
+    if (isUniformChanged(*this->program, handle, value)) {
+        glUniform1i(handle.getLocation(), value);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<float> handle, float value) {
+    if (isUniformChanged(*this->program, handle, value)) {
+        glUniform1f(handle.getLocation(), value);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec2> handle, const glm::vec2 &v) {
+    if (isUniformChanged(*this->program, handle, v)) {
+        glUniform2f(handle.getLocation(), v.x, v.y);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec3> handle, const glm::vec3 &v) {
+    if (isUniformChanged(*this->program, handle, v)) {
+        glUniform3f(handle.getLocation(), v.x, v.y, v.z);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec4> handle, const glm::vec4 &v) {
+    if (isUniformChanged(*this->program, handle, v)) {
+        glUniform4f(handle.getLocation(), v.x, v.y, v.z, v.w);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::mat3> handle, const glm::mat3 &m) {
+    if (isUniformChanged(*this->program, handle, m)) {
+        glUniformMatrix3fv(handle.getLocation(), 1, GL_FALSE, glm::value_ptr(m));
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::mat4> handle, const glm::mat4 &m) {
+    if (isUniformChanged(*this->program, handle, m)) {
+        glUniformMatrix4fv(handle.getLocation(), 1, GL_FALSE, glm::value_ptr(m));
+    }
+}
+
+int ShaderProgram::getUniformLocation(const std::string &name) const {
+    auto location = this->uniformLocations.find(name);
+    return location == this->uniformLocations.end() ? -1 : location->second;
 }
 
 void ShaderProgram::setUniformBlockBinding(const UniformBuffer &ubo) {
-    glUniformBlockBinding(*this->program,
-                          glGetUniformBlockIndex(*this->program, ubo.getUniformBlockName().c_str()),
-                          ubo.getBindingPoint());
+    this->setUniformBlockBinding(ubo.getUniformBlockName(), ubo.getBindingPoint());
+}
+
+void ShaderProgram::setUniformBlockBinding(const UniformBufferRing &ubo) {
+    this->setUniformBlockBinding(ubo.getUniformBlockName(), ubo.getBindingPoint());
+}
+
+void ShaderProgram::setUniformBlockBinding(const std::string &uniformBlockName, unsigned int bindingPoint) {
+    auto blockIndex = this->uniformBlockIndices.find(uniformBlockName);
+    assert(blockIndex != this->uniformBlockIndices.end() && "Failed to find active uniform block");
+    if (blockIndex == this->uniformBlockIndices.end()) return;
+
+    glUniformBlockBinding(*this->program, blockIndex->second, bindingPoint);
+}
+
+void ShaderProgram::reflect() {
+    // Uniforms in the default block
+    GLint numUniforms = 0, maxUniformNameLength = 0;
+    glGetProgramiv(*this->program, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(*this->program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformNameLength);
+
+    std::unique_ptr<char[]> name(new char[std::max(maxUniformNameLength, 1)]);
+    for (GLint i = 0; i < numUniforms; ++i) {
+        GLsizei nameLength = 0;
+        GLint arraySize = 0;
+        GLenum type;
+        glGetActiveUniform(*this->program, static_cast<GLuint>(i), maxUniformNameLength,
+                           &nameLength, &arraySize, &type, name.get());
+
+        // Uniforms within uniform blocks don't have a location
+        auto location = glGetUniformLocation(*this->program, name.get());
+        if (location == -1) continue;
+
+        std::string uniformName(name.get(), static_cast<size_t>(nameLength));
+        this->uniformLocations[uniformName] = location;
+
+        // Arrays are reported by their first element, e.g. "lights[0]"
+        const std::string arraySuffix = "[0]";
+        if (uniformName.size() > arraySuffix.size() &&
+            uniformName.compare(uniformName.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0) {
+            const auto arrayName = uniformName.substr(0, uniformName.size() - arraySuffix.size());
+            this->uniformLocations[arrayName] = location;
+
+            for (GLint j = 1; j < arraySize; ++j) {
+                const auto elementName = arrayName + "[" + std::to_string(j) + "]";
+                this->uniformLocations[elementName] = glGetUniformLocation(*this->program, elementName.c_str());
+            }
+        }
+    }
+
+    // Uniform blocks
+    GLint numUniformBlocks = 0, maxUniformBlockNameLength = 0;
+    glGetProgramiv(*this->program, GL_ACTIVE_UNIFORM_BLOCKS, &numUniformBlocks);
+    glGetProgramiv(*this->program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxUniformBlockNameLength);
+
+    name.reset(new char[std::max(maxUniformBlockNameLength, 1)]);
+    for (GLint i = 0; i < numUniformBlocks; ++i) {
+        GLsizei nameLength = 0;
+        glGetActiveUniformBlockName(*this->program, static_cast<GLuint>(i), maxUniformBlockNameLength,
+                                    &nameLength, name.get());
+        this->uniformBlockIndices[std::string(name.get(), static_cast<size_t>(nameLength))] =
+                static_cast<unsigned int>(i);
+    }
 }
 
 } // namespace age
\ No newline at end of file
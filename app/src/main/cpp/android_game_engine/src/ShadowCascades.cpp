@@ -0,0 +1,107 @@
+#include <android_game_engine/ShadowCascades.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+// Bounding spheres are rounded up so that floating point noise in the corners of the
+// slices doesn't change the size of the cascades as the camera turns
+constexpr float radiusGranularity = 1.0f / 16.0f;
+
+// Light projections are extended towards the light in whole meters so that casters
+// moving slightly don't change them
+constexpr float casterDistanceGranularity = 1.0f;
+
+} // namespace
+
+namespace age {
+
+ShadowCascades::ShadowCascades(unsigned int numCascades, unsigned int resolution,
+                               float shadowDistance, float splitWeight) :
+        numCascades(numCascades), resolution(resolution),
+        shadowDistance(shadowDistance), splitWeight(splitWeight) {
+    assert(numCascades > 0 && numCascades <= maxCascades && "Number of shadow cascades out of range");
+    this->lightSpaceMatrices.fill(glm::mat4(1.0f));
+    this->splitDistances.fill(0.0f);
+}
+
+void ShadowCascades::update(const glm::mat4 &projectionView, float nearPlane, float farPlane,
+                            const glm::vec3 &lightDirection, const AABB &casterBounds) {
+    const auto farDistance = std::max(std::min(farPlane, this->shadowDistance), nearPlane);
+
+    // Corners of the view frustum, view depth is linear along the rays through them
+    const auto inverseProjectionView = glm::inverse(projectionView);
+    std::array<glm::vec3, 4> nearCorners;
+    std::array<glm::vec3, 4> cornerRays;
+    for (int i = 0; i < 4; ++i) {
+        const auto x = (i & 1) ? 1.0f : -1.0f;
+        const auto y = (i & 2) ? 1.0f : -1.0f;
+        const auto nearCorner = inverseProjectionView * glm::vec4(x, y, -1.0f, 1.0f);
+        const auto farCorner = inverseProjectionView * glm::vec4(x, y, 1.0f, 1.0f);
+        nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+        cornerRays[i] = (glm::vec3(farCorner) / farCorner.w - nearCorners[i]) / (farPlane - nearPlane);
+    }
+
+    // The light's view only rotates so that cascades can be moved by whole texels in light space
+    const auto up = std::abs(lightDirection.z) < 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    const auto lightView = glm::lookAt(glm::vec3(0.0f), lightDirection, up);
+
+    // The light looks down -z so the caster closest to the light has the largest z
+    auto casterMaxZ = std::numeric_limits<float>::lowest();
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec3 corner((i & 1) ? casterBounds.max.x : casterBounds.min.x,
+                               (i & 2) ? casterBounds.max.y : casterBounds.min.y,
+                               (i & 4) ? casterBounds.max.z : casterBounds.min.z);
+        casterMaxZ = std::max(casterMaxZ, (lightView * glm::vec4(corner, 1.0f)).z);
+    }
+    casterMaxZ = std::ceil(casterMaxZ / casterDistanceGranularity) * casterDistanceGranularity;
+
+    auto sliceNear = nearPlane;
+    for (unsigned int cascade = 0; cascade < this->numCascades; ++cascade) {
+        // Blend logarithmic splits, which keep the texel density even across cascades,
+        // with uniform splits, which keep the first cascades from getting too small
+        const auto fraction = static_cast<float>(cascade + 1) / this->numCascades;
+        const auto logarithmicSplit = nearPlane * std::pow(farDistance / nearPlane, fraction);
+        const auto uniformSplit = nearPlane + (farDistance - nearPlane) * fraction;
+        const auto sliceFar = this->splitWeight * logarithmicSplit + (1.0f - this->splitWeight) * uniformSplit;
+        this->splitDistances[cascade] = sliceFar;
+
+        // Bounding sphere of the slice
+        std::array<glm::vec3, 8> corners;
+        auto center = glm::vec3(0.0f);
+        for (int i = 0; i < 4; ++i) {
+            corners[i] = nearCorners[i] + cornerRays[i] * (sliceNear - nearPlane);
+            corners[i + 4] = nearCorners[i] + cornerRays[i] * (sliceFar - nearPlane);
+            center += corners[i] + corners[i + 4];
+        }
+        center /= 8.0f;
+
+        auto radius = 0.0f;
+        for (const auto &corner : corners) {
+            radius = std::max(radius, glm::distance(center, corner));
+        }
+        radius = std::ceil(radius / radiusGranularity) * radiusGranularity;
+
+        // Move by whole texels so that world positions keep falling on the same texels
+        const auto texelSize = 2.0f * radius / this->resolution;
+        auto lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        lightCenter = glm::floor(lightCenter / texelSize) * texelSize;
+
+        // Extend towards the light to include casters between the light and the slice
+        const auto nearZ = std::max(lightCenter.z + radius, casterMaxZ);
+        const auto projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                           lightCenter.y - radius, lightCenter.y + radius,
+                                           -nearZ, radius - lightCenter.z);
+        this->lightSpaceMatrices[cascade] = projection * lightView;
+
+        sliceNear = sliceFar;
+    }
+}
+
+} // namespace age
@@ -3,49 +3,92 @@
 #include <GLES3/gl32.h>
 
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
+
+namespace {
+
+void createDepthBuffer(unsigned int width, unsigned int height, unsigned int numCascades, GLuint *depthBuffer) {
+    glGenTextures(1, depthBuffer);
+    age::GLState::bindTexture(GL_TEXTURE_2D_ARRAY, *depthBuffer);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, width, height, numCascades);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void createDepthFramebuffers(GLuint depthBuffer, std::vector<GLuint> &fbos) {
+    glGenFramebuffers(fbos.size(), fbos.data());
+
+    for (size_t cascade = 0; cascade < fbos.size(); ++cascade) {
+        age::GLState::bindFramebuffer(GL_FRAMEBUFFER, fbos[cascade]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthBuffer, 0, cascade);
+
+        // Depth only
+        const GLenum drawBuffer = GL_NONE;
+        glDrawBuffers(1, &drawBuffer);
+        glReadBuffer(GL_NONE);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw age::Error("Failed to build complete FBO for shadow map.");
+        }
+    }
+}
+
+} // namespace
 
 namespace age {
 
-ShadowMap::ShadowMap(unsigned int width, unsigned int height) : width(width), height(height) {
-    // Generate color buffer
-    glGenTextures(1, &this->colorBuffer);
-    glBindTexture(GL_TEXTURE_2D, this->colorBuffer);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->width, this->height, 0,
-                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-    // Generate depth and stencil buffer for shadow map
-    glGenTextures(1, &this->depthStencilBuffer);
-    glBindTexture(GL_TEXTURE_2D, this->depthStencilBuffer);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, this->width, this->height, 0,
-                 GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+ShadowMap::ShadowMap(unsigned int width, unsigned int height, unsigned int numCascades) :
+        width(width), height(height), fbos(numCascades), staticFbos(numCascades) {
+    // Generate depth maps, which are compared against the reference depth when sampled.
+    // Linear filtering blends the results of the 4 nearest comparisons for softer edges.
+    createDepthBuffer(this->width, this->height, numCascades, &this->depthBuffer);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
     float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
-    // Attach buffers to fbo
-    glGenFramebuffers(1, &this->fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->colorBuffer, 0);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, this->depthStencilBuffer, 0);
+    // Generate depth maps of the static casters, which are only ever copied
+    createDepthBuffer(this->width, this->height, numCascades, &this->staticDepthBuffer);
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        throw Error("Failed to build complete FBO for shadow map.");
-    }
+    createDepthFramebuffers(this->depthBuffer, this->fbos);
+    createDepthFramebuffers(this->staticDepthBuffer, this->staticFbos);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
 
 ShadowMap::~ShadowMap() {
-    glDeleteFramebuffers(1, &this->fbo);
-    glDeleteTextures(1, &this->depthStencilBuffer);
-    glDeleteTextures(1, &this->colorBuffer);
+    GLState::deleteFramebuffers(this->staticFbos.size(), this->staticFbos.data());
+    GLState::deleteFramebuffers(this->fbos.size(), this->fbos.data());
+    GLState::deleteTextures(1, &this->staticDepthBuffer);
+    GLState::deleteTextures(1, &this->depthBuffer);
+}
+
+void ShadowMap::bindStaticFramebuffer(unsigned int cascade) {
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, this->staticFbos[cascade]);
 }
 
-void ShadowMap::bindFramebuffer() {glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);}
-void ShadowMap::bindDepthMap() {glBindTexture(GL_TEXTURE_2D, this->depthStencilBuffer);}
+void ShadowMap::bindFramebuffer(unsigned int cascade, bool copyStaticLayer) {
+    if (!copyStaticLayer) {
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, this->fbos[cascade]);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        return;
+    }
+
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, this->staticFbos[cascade]);
+    GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, this->fbos[cascade]);
+    glBlitFramebuffer(0, 0, this->width, this->height, 0, 0, this->width, this->height,
+                      GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
-}
\ No newline at end of file
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, this->fbos[cascade]);
+}
+
+void ShadowMap::bindDepthMap() {GLState::bindTexture(GL_TEXTURE_2D_ARRAY, this->depthBuffer);}
+
+}
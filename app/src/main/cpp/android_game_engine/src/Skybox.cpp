@@ -1,71 +1,154 @@
 #include <android_game_engine/Skybox.h>
 
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <vector>
 
 #include <GLES3/gl32.h>
-#include <stb_image.h>
 
-#include <android_game_engine/Asset.h>
+#include <android_game_engine/AssetLoader.h>
 #include <android_game_engine/Exception.h>
-#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Log.h>
 #include <android_game_engine/ShaderProgram.h>
+#include <android_game_engine/TextureLoader.h>
 
 namespace {
 
-unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths) {
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+using Clock = std::chrono::steady_clock;
+
+///
+/// \brief uploadKtxCubemap Uploads a KTX cube map to the bound cube map.
+/// \param imageFilepath Filepath to the +X face image the KTX file was transcoded next to.
+/// \param ktx KTX cube map.
+/// \return True if the KTX cube map was uploaded.
+///
+bool uploadKtxCubemap(const std::string &imageFilepath, const age::KtxTexture &ktx) {
+    if (!age::TextureLoader::uploadKtx(GL_TEXTURE_CUBE_MAP, ktx)) {
+        age::Log::warn("Failed to upload " + age::TextureLoader::getKtxFilepath(imageFilepath) +
+                       ", falling back to decoding the skybox images.");
+        return false;
+    }
+    return true;
+}
+
+///
+/// \brief loadCubemapImages Decodes the images of each face of a cube map.
+/// \exception age::LoadError Failed to load texture data from image file.
+///
+std::vector<age::TextureLoader::Image> loadCubemapImages(const std::array<std::string, 6> &imageFilepaths) {
+    std::vector<age::TextureLoader::Image> images;
+    for (const auto &imageFilepath : imageFilepaths) {
+        try {
+            images.push_back(age::TextureLoader::loadImage(imageFilepath, false));
+        } catch (const age::LoadError &) {
+            throw age::LoadError("Failed to load skybox texture: " + imageFilepath);
+        }
+    }
+    return images;
+}
+
+///
+/// \brief uploadCubemapImages Uploads the decoded images of each face to the bound cube map.
+///
+void uploadCubemapImages(const std::vector<age::TextureLoader::Image> &images) {
+    for (auto i = 0u; i < images.size(); ++i) {
+        age::TextureLoader::uploadImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, images[i]);
+    }
+}
+
+///
+/// \brief setCubemapParameters Sets the sampling parameters of the bound cube map and unbinds it.
+///
+void setCubemapParameters() {
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     
-    int width, height, numChannels;
-    for (auto i = 0u; i < imageFilepaths.size(); ++i) {
-        auto asset = age::ManagerAssets::openAsset(imageFilepaths[i]);
-        auto length = asset.getLength();
-        std::unique_ptr<stbi_uc[]> buffer(new stbi_uc[length]);
-        asset.read(buffer.get(), length);
-        
-        auto img = stbi_load_from_memory(buffer.get(), length, &width, &height, &numChannels, 0);
+    age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+///
+/// \brief loadCubemapAsync Loads the KTX cube map, or else decodes the face images, on a
+///                         worker thread and queues the upload to a cube map.
+/// \param imageFilepaths Filepaths to the face images.
+/// \param texture Cube map to upload to. Nothing is uploaded if it was deleted in the meantime.
+///
+void loadCubemapAsync(const std::array<std::string, 6> &imageFilepaths, std::weak_ptr<unsigned int> texture) {
+    const auto requestTime = Clock::now();
     
-        GLenum format;
-        switch (numChannels) {
-            case 1:
-                format = GL_ALPHA;
-                break;
-        
-            case 3:
-                format = GL_RGB;
-                break;
-        
-            case 4:
-                format = GL_RGBA;
-                break;
+    age::AssetLoader::enqueueLoad([imageFilepaths, texture, requestTime](){
+        std::shared_ptr<age::KtxTexture> ktx = age::TextureLoader::loadKtx(imageFilepaths[0]);
+        std::shared_ptr<std::vector<age::TextureLoader::Image>> images;
+        size_t numBytes;
         
-            default:
-                format = GL_RGB;
-                break;
+        if (ktx) {
+            numBytes = age::TextureLoader::getSize(*ktx);
+        } else {
+            images = std::make_shared<std::vector<age::TextureLoader::Image>>(loadCubemapImages(imageFilepaths));
+            numBytes = 0;
+            for (const auto &image : *images) {
+                numBytes += image.pixels.size();
+            }
         }
         
-        if (img) {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                         0, GL_RGB, width, height,
-                         0, format, GL_UNSIGNED_BYTE, img);
-            stbi_image_free(img);
-        } else {
-            stbi_image_free(img);
-            glDeleteTextures(1, &texture);
-            throw age::LoadError("Failed to load skybox texture: " + imageFilepaths[i]);
+        age::AssetLoader::enqueueUpload([imageFilepaths, texture, requestTime, ktx, images](){
+            auto id = texture.lock();
+            if (!id) return;
+            
+            age::GLState::activeTexture(GL_TEXTURE0);
+            age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, *id);
+            
+            if (!ktx || !uploadKtxCubemap(imageFilepaths[0], *ktx)) {
+                if (!images) {
+                    // Decode the images on the GL thread rather than keep the placeholder
+                    uploadCubemapImages(loadCubemapImages(imageFilepaths));
+                } else {
+                    uploadCubemapImages(*images);
+                }
+            }
+            age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            
+            const std::chrono::duration<float, std::milli> loadTime = Clock::now() - requestTime;
+            age::Log::info("Loaded skybox " + imageFilepaths[0] + " in the background in " +
+                           std::to_string(loadTime.count()) + " ms");
+        }, numBytes);
+    });
+}
+
+std::shared_ptr<unsigned int> loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths,
+                                                 age::LoadMode mode) {
+    std::shared_ptr<unsigned int> texture(new unsigned int, [](auto texture){
+        age::GLState::deleteTextures(1, texture);
+        delete texture;
+    });
+    glGenTextures(1, texture.get());
+    
+    age::GLState::activeTexture(GL_TEXTURE0);
+    age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, *texture);
+    
+    if (mode == age::LoadMode::ASYNCHRONOUS) {
+        // Grey placeholder faces until the cube map is uploaded
+        const std::array<uint8_t, 3> grey {128, 128, 128};
+        for (auto i = 0u; i < imageFilepaths.size(); ++i) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, 1, 1, 0,
+                         GL_RGB, GL_UNSIGNED_BYTE, grey.data());
         }
+        setCubemapParameters();
+        
+        loadCubemapAsync(imageFilepaths, texture);
+        return texture;
     }
     
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // A cube map transcoded to KTX is stored next to its +X face image
+    std::unique_ptr<age::KtxTexture> ktx = age::TextureLoader::loadKtx(imageFilepaths[0]);
+    if (!ktx || !uploadKtxCubemap(imageFilepaths[0], *ktx)) {
+        uploadCubemapImages(loadCubemapImages(imageFilepaths));
+    }
     
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    setCubemapParameters();
     return texture;
 }
 
@@ -73,7 +156,7 @@ unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths
 
 namespace age {
 
-Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths) {
+Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths, LoadMode mode) {
     const std::vector<float> positions {
             -1.0f,  1.0f, -1.0f,
             -1.0f, -1.0f, -1.0f,
@@ -118,13 +201,13 @@ Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths) {
             1.0f, -1.0f,  1.0f
     };
 
-    this->texture = loadCubemapTexture(imageFilepaths);
+    this->texture = loadCubemapTexture(imageFilepaths, mode);
 
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
     
     glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(positions.size() * sizeof(float)),
                  positions.data(), GL_STATIC_DRAW);
@@ -132,22 +215,21 @@ Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths) {
                           reinterpret_cast<GLvoid*>(0));
     glEnableVertexAttribArray(0u);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 }
 
 Skybox::~Skybox() {
-    glDeleteTextures(1, &this->texture);
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
 }
 
 void Skybox::render(ShaderProgram *shader) {
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
     
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     shader->setUniform("skybox", 0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, this->texture);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, *this->texture);
     
     glDrawArrays(GL_TRIANGLES, 0, 36);
 }
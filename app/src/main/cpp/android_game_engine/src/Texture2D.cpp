@@ -1,137 +1,246 @@
 #include <android_game_engine/Texture2D.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <unordered_map>
 
 #include <GLES3/gl32.h>
+#include <glm/common.hpp>
 #include <glm/vec3.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-#include <android_game_engine/Asset.h>
-#include <android_game_engine/Exception.h>
-#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/AssetLoader.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ManagerResources.h>
+#include <android_game_engine/TextureLoader.h>
 
 namespace {
 
-std::unordered_map<std::string, std::weak_ptr<unsigned int>> textureIdCache;
+// Solid color textures keyed by their packed RGB8 color
+std::unordered_map<uint32_t, std::weak_ptr<unsigned int>> colorTextureIdCache;
+
+using Clock = std::chrono::steady_clock;
+
+// Default GL_TEXTURE_MAX_LEVEL, restored once a placeholder is replaced
+constexpr GLint defaultMaxLevel = 1000;
+
+///
+/// \brief uploadKtxTexture Uploads a KTX texture to the bound texture.
+/// \param imageFilepath Filepath to the source image.
+/// \param ktx KTX texture transcoded from the source image.
+/// \return True if the KTX texture was uploaded.
+///
+bool uploadKtxTexture(const std::string &imageFilepath, const age::KtxTexture &ktx) {
+    if (!age::TextureLoader::uploadKtx(GL_TEXTURE_2D, ktx)) {
+        age::Log::warn("Failed to upload " + age::TextureLoader::getKtxFilepath(imageFilepath) +
+                       ", falling back to decoding the source image.");
+        return false;
+    }
+    return true;
+}
+
+///
+/// \brief getImageTextureSize Returns the number of bytes of an image texture including its mipmaps.
+///
+size_t getImageTextureSize(const age::TextureLoader::Image &image) {
+    return image.pixels.size() * 4 / 3;
+}
+
+///
+/// \brief uploadImageTexture Uploads an image with generated mipmaps to the bound texture.
+///
+void uploadImageTexture(const age::TextureLoader::Image &image) {
+    age::TextureLoader::uploadImage(GL_TEXTURE_2D, image);
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
 
 ///
-/// \brief loadImageTexture Loads and caches texture data from image file.
+/// \brief uploadPlaceholderTexture Uploads a single white texel without mipmaps to the bound texture.
+///
+void uploadPlaceholderTexture() {
+    const std::array<uint8_t, 3> white {255, 255, 255};
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, white.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+}
+
+///
+/// \brief enqueueImageUpload Decodes an image and queues its upload to a texture.
+///
+/// This is called on a worker thread.
+///
 /// \param imageFilepath Filepath to the image.
-/// \return OpenGL's texture ID for the loaded texture.
+/// \param textureId Texture to upload to. Nothing is uploaded if it was deleted in the meantime.
+/// \param requestTime Time the texture was requested, to report the load time.
 /// \exception age::LoadError Failed to load image data from file.
 ///
-std::shared_ptr<unsigned int> loadImageTexture(const std::string &imageFilepath) {
-    const auto imageFilename = imageFilepath.substr(imageFilepath.find_last_of('/') + 1);
+void enqueueImageUpload(const std::string &imageFilepath, std::weak_ptr<unsigned int> textureId,
+                        Clock::time_point requestTime) {
+    auto image = std::make_shared<age::TextureLoader::Image>(age::TextureLoader::loadImage(imageFilepath, true));
     
-    // Check cache to avoid reloading
-    auto textureId = textureIdCache[imageFilename].lock();
-    if (textureId) return textureId;
-    
-    // Load image from file
-    int width, height, numChannels;
-    auto asset = age::ManagerAssets::openAsset(imageFilepath);
-    auto length = asset.getLength();
-    std::unique_ptr<stbi_uc[]> buffer(new stbi_uc[length]);
-    asset.read(buffer.get(), length);
-    
-    stbi_set_flip_vertically_on_load(true);
-    auto img = stbi_load_from_memory(buffer.get(), length, &width, &height, &numChannels, 0);
-    
-    if (!img) {
-        stbi_image_free(img);
-        throw age::LoadError("Failed to load texture at: " + imageFilepath);
-    }
-    
-    GLenum format;
-    switch (numChannels) {
-        case 1:
-            format = GL_ALPHA;
-            break;
+    age::AssetLoader::enqueueUpload([imageFilepath, textureId, requestTime, image](){
+        auto id = textureId.lock();
+        if (!id) return;
         
-        case 3:
-            format = GL_RGB;
-            break;
+        age::GLState::bindTexture(GL_TEXTURE_2D, *id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, defaultMaxLevel);
+        uploadImageTexture(*image);
+        age::GLState::bindTexture(GL_TEXTURE_2D, 0);
+        age::ManagerResources::setSize(age::ResourceType::TEXTURE, imageFilepath, getImageTextureSize(*image));
         
-        case 4:
-            format = GL_RGBA;
-            break;
+        const std::chrono::duration<float, std::milli> loadTime = Clock::now() - requestTime;
+        age::Log::info("Loaded " + imageFilepath + " in the background in " + std::to_string(loadTime.count()) + " ms");
+    }, getImageTextureSize(*image));
+}
+
+///
+/// \brief loadTextureAsync Loads the KTX file transcoded from an image, or else decodes the
+///                         image, on a worker thread and queues the upload to a texture.
+/// \param imageFilepath Filepath to the image.
+/// \param textureId Texture to upload to. Nothing is uploaded if it was deleted in the meantime.
+///
+void loadTextureAsync(const std::string &imageFilepath, std::weak_ptr<unsigned int> textureId) {
+    const auto requestTime = Clock::now();
+    
+    age::AssetLoader::enqueueLoad([imageFilepath, textureId, requestTime](){
+        std::shared_ptr<age::KtxTexture> ktx = age::TextureLoader::loadKtx(imageFilepath);
+        if (!ktx) {
+            enqueueImageUpload(imageFilepath, textureId, requestTime);
+            return;
+        }
         
-        default:
-            format = GL_RGB;
-            break;
-    }
+        age::AssetLoader::enqueueUpload([imageFilepath, textureId, requestTime, ktx](){
+            auto id = textureId.lock();
+            if (!id) return;
+            
+            age::GLState::bindTexture(GL_TEXTURE_2D, *id);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, defaultMaxLevel);
+            const auto uploaded = uploadKtxTexture(imageFilepath, *ktx);
+            age::GLState::bindTexture(GL_TEXTURE_2D, 0);
+            
+            if (uploaded) {
+                age::ManagerResources::setSize(age::ResourceType::TEXTURE, imageFilepath,
+                                               age::TextureLoader::getSize(*ktx));
+                
+                const std::chrono::duration<float, std::milli> loadTime = Clock::now() - requestTime;
+                age::Log::info("Loaded " + age::TextureLoader::getKtxFilepath(imageFilepath) +
+                               " in the background in " + std::to_string(loadTime.count()) + " ms");
+            } else {
+                age::AssetLoader::enqueueLoad([imageFilepath, textureId, requestTime](){
+                    enqueueImageUpload(imageFilepath, textureId, requestTime);
+                });
+            }
+        }, age::TextureLoader::getSize(*ktx));
+    });
+}
+
+///
+/// \brief loadImageTexture Loads texture data from image file and makes it resident.
+///
+/// The KTX file transcoded from the image is loaded instead when it exists.
+///
+/// \param imageFilepath Filepath to the image.
+/// \param mode Whether to load the image before returning or in the background.
+/// \return OpenGL's texture ID for the loaded texture.
+/// \exception age::LoadError Failed to load image data from file.
+///
+std::shared_ptr<unsigned int> loadImageTexture(const std::string &imageFilepath, age::LoadMode mode) {
+    // Check resident textures to avoid reloading
+    auto textureId = age::ManagerResources::find<unsigned int>(age::ResourceType::TEXTURE, imageFilepath);
+    if (textureId) return textureId;
     
-    // Clean up texture img on GPU and clear cache
-    auto textureIdDeleter = [imageFilename](auto textureId) {
-        glDeleteTextures(1, textureId);
-        
-        textureIdCache.erase(imageFilename);
+    // Clean up texture img on GPU once evicted
+    textureId = std::shared_ptr<unsigned int>(new unsigned int, [](auto textureId) {
+        age::GLState::deleteTextures(1, textureId);
         delete textureId;
-    };
-    textureId = std::shared_ptr<unsigned int>(new unsigned int, textureIdDeleter);
+    });
     
     // Load texture img onto GPU
     glGenTextures(1, textureId.get());
-    glBindTexture(GL_TEXTURE_2D, *textureId);
-    
-    glTexImage2D(GL_TEXTURE_2D,
-                 0, static_cast<GLint>(format), width, height, 0,
-                 format, GL_UNSIGNED_BYTE, img);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    age::GLState::bindTexture(GL_TEXTURE_2D, *textureId);
+    
+    size_t numBytes = 0;
+    if (mode == age::LoadMode::ASYNCHRONOUS) {
+        uploadPlaceholderTexture();
+        loadTextureAsync(imageFilepath, textureId);
+    } else {
+        std::unique_ptr<age::KtxTexture> ktx = age::TextureLoader::loadKtx(imageFilepath);
+        if (ktx && uploadKtxTexture(imageFilepath, *ktx)) {
+            numBytes = age::TextureLoader::getSize(*ktx);
+        } else {
+            const auto image = age::TextureLoader::loadImage(imageFilepath, true);
+            uploadImageTexture(image);
+            numBytes = getImageTextureSize(image);
+        }
+    }
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    textureIdCache[imageFilename] = textureId;
-    
-    glBindTexture(GL_TEXTURE_2D, 0);
-    stbi_image_free(img);
-    return textureId;
+    age::GLState::bindTexture(GL_TEXTURE_2D, 0);
+    return age::ManagerResources::insert(age::ResourceType::TEXTURE, imageFilepath, std::move(textureId), numBytes);
 }
 
 } // namespace
 
 namespace age {
 
-Texture2D::Texture2D(const std::string &imageFilepath)
-        : id(loadImageTexture(imageFilepath)) {}
+Texture2D::Texture2D(const std::string &imageFilepath, LoadMode mode)
+        : id(loadImageTexture(imageFilepath, mode)) {}
         
 Texture2D::Texture2D(const glm::vec3 &color) {
-    std::array<uint8_t, 3> rgb{static_cast<uint8_t>(color.r * 255),
-                               static_cast<uint8_t>(color.g * 255),
-                               static_cast<uint8_t>(color.b * 255)};
-    
-    auto textureIdDeleter = [](auto textureId) {
-        glDeleteTextures(1, textureId);
+    const auto clampedColor = glm::clamp(color, 0.0f, 1.0f);
+    const std::array<uint8_t, 3> rgb{static_cast<uint8_t>(clampedColor.r * 255),
+                                     static_cast<uint8_t>(clampedColor.g * 255),
+                                     static_cast<uint8_t>(clampedColor.b * 255)};
+    const auto key = (uint32_t(rgb[0]) << 16u) | (uint32_t(rgb[1]) << 8u) | uint32_t(rgb[2]);
+    
+    // Check palette to avoid creating another texture of the same color
+    this->id = colorTextureIdCache[key].lock();
+    if (this->id) return;
+    
+    auto textureIdDeleter = [key](auto textureId) {
+        GLState::deleteTextures(1, textureId);
+        
+        colorTextureIdCache.erase(key);
         delete textureId;
     };
     this->id = std::shared_ptr<unsigned int>(new unsigned int, textureIdDeleter);
     
-    // Load texture img onto GPU
+    // Load texture img onto GPU. A single texel needs no mipmaps.
     glGenTextures(1, this->id.get());
-    glBindTexture(GL_TEXTURE_2D, *this->id);
+    GLState::bindTexture(GL_TEXTURE_2D, *this->id);
     
     glTexImage2D(GL_TEXTURE_2D,
                  0, GL_RGB, 1, 1, 0,
                  GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
-    glGenerateMipmap(GL_TEXTURE_2D);
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
     
-    glBindTexture(GL_TEXTURE_2D, 0);
+    colorTextureIdCache[key] = this->id;
+    
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture2D::bind() const {
+    GLState::bindTexture(GL_TEXTURE_2D, *this->id);
 }
 
-void Texture2D::bind() {
-    glBindTexture(GL_TEXTURE_2D, *this->id);
+size_t Texture2D::getNumTextures() {
+    // Entries of textures that failed to load are left expired
+    auto isLoaded = [](const auto &entry){ return !entry.second.expired(); };
+    return ManagerResources::getStatistics(ResourceType::TEXTURE).numResident +
+           static_cast<size_t>(std::count_if(colorTextureIdCache.cbegin(), colorTextureIdCache.cend(), isLoaded));
 }
 
 } // namespace age
@@ -0,0 +1,147 @@
+#include <android_game_engine/TextureLoader.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <GLES3/gl32.h>
+#include <stb_image.h>
+
+#include <android_game_engine/Asset.h>
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/ManagerAssets.h>
+
+namespace age {
+namespace TextureLoader {
+
+std::string getKtxFilepath(const std::string &imageFilepath) {
+    const auto extension = imageFilepath.find_last_of('.');
+    const auto directory = imageFilepath.find_last_of('/');
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory)) {
+        return imageFilepath + ".ktx";
+    }
+    return imageFilepath.substr(0, extension) + ".ktx";
+}
+
+std::unique_ptr<KtxTexture> loadKtx(const std::string &imageFilepath) {
+    const auto ktxFilepath = getKtxFilepath(imageFilepath);
+
+    std::vector<uint8_t> buffer;
+    try {
+        auto asset = ManagerAssets::openAsset(ktxFilepath);
+        buffer.resize(asset.getLength());
+        asset.read(buffer.data(), buffer.size());
+    } catch (const LoadError &) {
+        // The source image was not transcoded
+        return nullptr;
+    }
+
+    try {
+        return std::make_unique<KtxTexture>(KtxTexture::read(buffer.data(), buffer.size()));
+    } catch (const LoadError &e) {
+        throw LoadError(ktxFilepath + ": " + e.what());
+    }
+}
+
+bool uploadKtx(unsigned int target, const KtxTexture &texture) {
+    if ((target == GL_TEXTURE_CUBE_MAP) != (texture.numFaces == 6)) return false;
+
+    // Clear previous errors so that only errors of the upload are checked
+    while (glGetError() != GL_NO_ERROR) {}
+
+    const auto numLevels = std::max(texture.numMipmapLevels, 1u);
+    for (auto level = 0u; level < numLevels; ++level) {
+        const auto width = static_cast<GLsizei>(std::max(texture.width >> level, 1u));
+        const auto height = static_cast<GLsizei>(std::max(texture.height >> level, 1u));
+
+        for (auto face = 0u; face < texture.numFaces; ++face) {
+            const auto faceTarget = texture.numFaces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target;
+            const auto &image = texture.getImage(level, face);
+
+            if (texture.isCompressed()) {
+                glCompressedTexImage2D(faceTarget, static_cast<GLint>(level), texture.glInternalFormat,
+                                       width, height, 0, static_cast<GLsizei>(image.size()), image.data());
+            } else {
+                glTexImage2D(faceTarget, static_cast<GLint>(level), static_cast<GLint>(texture.glInternalFormat),
+                             width, height, 0, texture.glFormat, texture.glType, image.data());
+            }
+        }
+    }
+
+    if (glGetError() != GL_NO_ERROR) return false;
+
+    if (texture.numMipmapLevels == 0) {
+        glGenerateMipmap(target);
+    } else {
+        // Levels past the transcoded ones would leave the texture incomplete
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.numMipmapLevels - 1));
+    }
+
+    return glGetError() == GL_NO_ERROR;
+}
+
+size_t getSize(const KtxTexture &texture) {
+    size_t size = 0;
+    for (const auto &image : texture.images) {
+        size += image.size();
+    }
+    return size;
+}
+
+Image loadImage(const std::string &imageFilepath, bool flipVertically) {
+    std::vector<stbi_uc> buffer;
+    {
+        auto asset = ManagerAssets::openAsset(imageFilepath);
+        buffer.resize(asset.getLength());
+        asset.read(buffer.data(), buffer.size());
+    }
+
+    // The flag is thread local so that images can be decoded on several threads at once
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+    Image image;
+    int numChannels;
+    auto pixels = stbi_load_from_memory(buffer.data(), static_cast<int>(buffer.size()),
+                                        &image.width, &image.height, &numChannels, 0);
+    if (!pixels) {
+        throw LoadError("Failed to load texture at: " + imageFilepath);
+    }
+
+    switch (numChannels) {
+        case 1:
+            image.format = GL_ALPHA;
+            break;
+
+        case 4:
+            image.format = GL_RGBA;
+            break;
+
+        default:
+            // Drop the alpha channel of grey and alpha images
+            if (numChannels != 3) {
+                stbi_image_free(pixels);
+                pixels = stbi_load_from_memory(buffer.data(), static_cast<int>(buffer.size()),
+                                               &image.width, &image.height, &numChannels, 3);
+                if (!pixels) {
+                    throw LoadError("Failed to load texture at: " + imageFilepath);
+                }
+                numChannels = 3;
+            }
+            image.format = GL_RGB;
+            break;
+    }
+
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(image.width) * image.height * numChannels);
+    stbi_image_free(pixels);
+    return image;
+}
+
+void uploadImage(unsigned int target, const Image &image) {
+    // Rows of 1 and 3 channel images aren't necessarily 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(target, 0, static_cast<GLint>(image.format), image.width, image.height, 0,
+                 image.format, GL_UNSIGNED_BYTE, image.pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+} // namespace TextureLoader
+} // namespace age
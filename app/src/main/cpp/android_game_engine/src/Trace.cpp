@@ -0,0 +1,277 @@
+#include <android_game_engine/Trace.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <network/Trace.h>
+
+#include <android_game_engine/Log.h>
+
+namespace {
+
+using Clock = age::Trace::Clock;
+using Ticks = age::Trace::Ticks;
+
+///
+/// \brief Maps timestamps to nanoseconds of the steady clock.
+///
+struct Calibration {
+    Ticks ticksOrigin = 0;
+    int64_t nanosecondsOrigin = 0;
+    double nanosecondsPerTick = 1.0;
+};
+
+int64_t toNanoseconds(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+const Calibration& getCalibration() {
+    static const Calibration calibration = [](){
+        Calibration calibration;
+#if defined(__aarch64__)
+        uint64_t frequency;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+        calibration.nanosecondsPerTick = 1.0e9 / static_cast<double>(frequency);
+        calibration.nanosecondsOrigin = toNanoseconds(Clock::now());
+        calibration.ticksOrigin = age::Trace::now();
+#endif
+        return calibration;
+    }();
+    return calibration;
+}
+
+Ticks toTicks(Clock::time_point time) {
+    const auto &calibration = getCalibration();
+    return calibration.ticksOrigin + static_cast<Ticks>(std::llround(
+            static_cast<double>(toNanoseconds(time) - calibration.nanosecondsOrigin) / calibration.nanosecondsPerTick));
+}
+
+int64_t toNanoseconds(Ticks ticks) {
+    const auto &calibration = getCalibration();
+    return calibration.nanosecondsOrigin + static_cast<int64_t>(std::llround(
+            static_cast<double>(static_cast<int64_t>(ticks - calibration.ticksOrigin)) * calibration.nanosecondsPerTick));
+}
+
+///
+/// \brief Slot of a ring. Its fields are atomic so that a slot the owning thread
+///        overwrites while it's exported is never read torn, only discarded.
+///
+struct Event {
+    std::atomic<const char*> name;
+    std::atomic<Ticks> begin;
+    std::atomic<Ticks> end;
+};
+
+struct ThreadRing {
+    std::array<Event, age::Trace::maxEventsPerThread> events;
+    std::atomic<uint64_t> numEvents {0}; ///< Events ever written, the next one goes to numEvents % size
+    std::atomic<bool> inUse {true};
+    uint64_t firstEvent = 0; ///< Events before it were cleared. Guarded by ringsMutex
+    unsigned int threadId;
+    std::string threadName; ///< Guarded by ringsMutex
+};
+
+///
+/// \brief Releases the ring of a thread when the thread exits so that a new thread reuses it.
+///
+struct ThreadRingHandle {
+    ThreadRing *ring = nullptr;
+
+    ~ThreadRingHandle() {
+        if (this->ring != nullptr) this->ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+std::atomic<bool> traceEnabled {false};
+
+std::mutex ringsMutex;
+std::vector<std::unique_ptr<ThreadRing>> rings;
+
+thread_local ThreadRingHandle threadRingHandle;
+
+ThreadRing& getThreadRing() {
+    if (threadRingHandle.ring != nullptr) return *threadRingHandle.ring;
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+
+    auto unused = std::find_if(rings.begin(), rings.end(), [](const std::unique_ptr<ThreadRing> &ring){
+        return !ring->inUse.load(std::memory_order_acquire);
+    });
+    if (unused != rings.end()) {
+        (*unused)->inUse.store(true, std::memory_order_relaxed);
+        threadRingHandle.ring = unused->get();
+    } else {
+        rings.push_back(std::make_unique<ThreadRing>());
+        rings.back()->threadId = static_cast<unsigned int>(rings.size());
+        threadRingHandle.ring = rings.back().get();
+    }
+
+    // A reused ring still holds the events of the thread that exited, which aren't this thread's
+    auto &ring = *threadRingHandle.ring;
+    ring.firstEvent = ring.numEvents.load(std::memory_order_relaxed);
+    ring.threadName = "Thread " + std::to_string(ring.threadId);
+    return ring;
+}
+
+void appendEscaped(std::ostringstream &json, const char *string) {
+    for (auto c = string; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') json << '\\';
+        json << *c;
+    }
+}
+
+} // namespace
+
+namespace age {
+namespace Trace {
+
+void setEnabled(bool enabled) {
+    getCalibration();
+    traceEnabled.store(enabled, std::memory_order_relaxed);
+    ntwk::Trace::setRecorder(enabled ? static_cast<ntwk::Trace::Recorder>(&record) : nullptr);
+}
+
+bool isEnabled() {
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const std::string &name) {
+    auto &ring = getThreadRing();
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    ring.threadName = name;
+}
+
+void record(const char *name, Clock::time_point begin, Clock::time_point end) {
+    record(name, toTicks(begin), toTicks(end));
+}
+
+void record(const char *name, Ticks begin, Ticks end) {
+    auto &ring = getThreadRing();
+
+    // Only this thread writes the ring, so the count is published after the slot is written
+    const auto index = ring.numEvents.load(std::memory_order_relaxed);
+    auto &event = ring.events[index % maxEventsPerThread];
+    event.name.store(name, std::memory_order_relaxed);
+    event.begin.store(begin, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    ring.numEvents.store(index + 1, std::memory_order_release);
+}
+
+void clear() {
+    // Rings are cleared by skipping their events rather than rewinding them under their writers
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (auto &ring : rings) {
+        ring->firstEvent = ring->numEvents.load(std::memory_order_relaxed);
+    }
+}
+
+std::string exportChromeJson() {
+    struct ExportedEvent {
+        const char *name;
+        int64_t begin;
+        int64_t end;
+        unsigned int threadId;
+    };
+
+    std::vector<ExportedEvent> events;
+    std::vector<std::pair<unsigned int, std::string>> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (const auto &ring : rings) {
+            threadNames.emplace_back(ring->threadId, ring->threadName);
+
+            const auto numEvents = ring->numEvents.load(std::memory_order_acquire);
+            const uint64_t oldest = numEvents > maxEventsPerThread ? numEvents - maxEventsPerThread : 0;
+            const auto first = std::max(ring->firstEvent, oldest);
+            const auto numCopied = events.size();
+            for (auto index = first; index < numEvents; ++index) {
+                const auto &event = ring->events[index % maxEventsPerThread];
+                events.push_back({event.name.load(std::memory_order_relaxed),
+                                  toNanoseconds(event.begin.load(std::memory_order_relaxed)),
+                                  toNanoseconds(event.end.load(std::memory_order_relaxed)),
+                                  ring->threadId});
+            }
+
+            // Discard the slots the thread overwrote or started overwriting while they were copied.
+            // Rings of exited threads and of the exporting thread aren't being written.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const auto writing = ring.get() != threadRingHandle.ring && ring->inUse.load(std::memory_order_acquire);
+            const auto numEventsAfter = ring->numEvents.load(std::memory_order_relaxed);
+            const auto numWritten = numEventsAfter + (writing ? 1 : 0);
+            const auto numOverwritten = numWritten > first + maxEventsPerThread ?
+                    std::min<uint64_t>(numWritten - first - maxEventsPerThread, numEvents - first) : 0;
+            events.erase(events.begin() + numCopied, events.begin() + numCopied + numOverwritten);
+        }
+    }
+
+    // Timestamps are relative to the first event so that microseconds keep their precision
+    int64_t origin = 0;
+    if (!events.empty()) {
+        origin = std::min_element(events.begin(), events.end(), [](const auto &a, const auto &b){
+            return a.begin < b.begin;
+        })->begin;
+    }
+
+    const auto processId = static_cast<int>(getpid());
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    auto separator = "\n";
+    for (const auto &threadName : threadNames) {
+        json << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << processId
+             << ",\"tid\":" << threadName.first << ",\"args\":{\"name\":\"";
+        appendEscaped(json, threadName.second.c_str());
+        json << "\"}}";
+        separator = ",\n";
+    }
+
+    for (const auto &event : events) {
+        json << separator << "{\"name\":\"";
+        appendEscaped(json, event.name);
+        json << "\",\"cat\":\"age\",\"ph\":\"X\",\"pid\":" << processId << ",\"tid\":" << event.threadId
+             << ",\"ts\":" << static_cast<double>(event.begin - origin) * 1.0e-3
+             << ",\"dur\":" << static_cast<double>(event.end - event.begin) * 1.0e-3 << "}";
+        separator = ",\n";
+    }
+
+    json << "\n]}\n";
+    return json.str();
+}
+
+bool writeChromeJson(const std::string &filepath) {
+    const auto json = exportChromeJson();
+
+    auto file = std::fopen(filepath.c_str(), "wb");
+    if (!file) {
+        Log::warn("Failed to write trace " + filepath + ": " + std::strerror(errno));
+        return false;
+    }
+
+    auto written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        Log::warn("Failed to write trace " + filepath);
+        return false;
+    }
+
+    Log::info("Wrote trace " + filepath);
+    return true;
+}
+
+} // namespace Trace
+} // namespace age
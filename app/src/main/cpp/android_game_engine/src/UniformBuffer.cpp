@@ -1,67 +1,194 @@
 #include <android_game_engine/UniformBuffer.h>
 
-#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <set>
 
 #include <GLES3/gl32.h>
 
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Log.h>
+
 namespace {
 
 ///
-/// The Pool class generates sequential elements.
-/// Elements can be recycled back into the pool.
+/// The BindingPointPool class hands out the lowest uniform buffer binding point that
+/// isn't in use. Binding points can be recycled back into the pool.
 ///
-template<typename T>
-class Pool {
+class BindingPointPool {
 public:
-    Pool(std::initializer_list<T> init) : pool(init) {}
-
-    T popFront() {
-        T element = this->pool.front();
-        this->pool.pop_front();
+    unsigned int acquire() {
+        if (!this->recycled.empty()) {
+            auto bindingPoint = *this->recycled.begin();
+            this->recycled.erase(this->recycled.begin());
+            return bindingPoint;
+        }
 
-        if (this->pool.empty()) {
-            this->pool.push_front(element + 1);
+        GLint maxBindingPoints = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindingPoints);
+        if (this->next >= static_cast<unsigned int>(maxBindingPoints)) {
+            throw age::Error("All " + std::to_string(maxBindingPoints) + " uniform buffer binding points are in use");
         }
 
-        return element;
+        return this->next++;
     }
 
-    void pushFront(const T &element) {
-        this->pool.push_front(element);
+    void release(unsigned int bindingPoint) {
+        this->recycled.insert(bindingPoint);
     }
 
 private:
-    std::deque<T> pool;
+    std::set<unsigned int> recycled;
+    unsigned int next = 0;
 };
 
-Pool<unsigned int> bindingPointPool {0, 1};
+BindingPointPool bindingPointPool;
+
+// A hung GPU or a lost context never signals fences, so waits for a region give up after a second
+constexpr GLuint64 fenceWaitTimeout_ns = 100000000;
+constexpr unsigned int maxFenceWaits = 10;
 
 } // namespace
 
 namespace age {
 
 UniformBuffer::UniformBuffer(const std::string &uniformBlockName, unsigned int size_bytes)
-        : uniformBlockName(uniformBlockName), bindingPoint(bindingPointPool.popFront()) {
+        : uniformBlockName(uniformBlockName), bindingPoint(bindingPointPool.acquire()) {
     glGenBuffers(1, &this->ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
     glBufferData(GL_UNIFORM_BUFFER, size_bytes, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, this->ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, this->ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 UniformBuffer::~UniformBuffer() {
-    glBindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, 0);
-    bindingPointPool.pushFront(this->bindingPoint);
-    glDeleteBuffers(1, &this->ubo);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, 0);
+    bindingPointPool.release(this->bindingPoint);
+    GLState::deleteBuffers(1, &this->ubo);
 }
 
 std::string UniformBuffer::getUniformBlockName() const {return this->uniformBlockName;}
 unsigned int UniformBuffer::getBindingPoint() const {return this->bindingPoint;}
 
 void UniformBuffer::bufferSubData(unsigned int offset_bytes, unsigned int size_bytes, const void *data) {
-    glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
     glBufferSubData(GL_UNIFORM_BUFFER, offset_bytes, size_bytes, data);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+UniformBufferRing::UniformBufferRing(const std::string &uniformBlockName, unsigned int frameSize_bytes,
+                                     unsigned int numFrames)
+        : uniformBlockName(uniformBlockName), bindingPoint(bindingPointPool.acquire()),
+          fences(numFrames, nullptr), frame(numFrames - 1) {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    this->offsetAlignment = static_cast<unsigned int>(alignment);
+
+    glGenBuffers(1, &this->ubo);
+    this->resize(frameSize_bytes);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+UniformBufferRing::~UniformBufferRing() {
+    this->flush();
+
+    for (auto fence : this->fences) {
+        if (fence) glDeleteSync(fence);
+    }
+
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, 0);
+    bindingPointPool.release(this->bindingPoint);
+    GLState::deleteBuffers(1, &this->ubo);
+}
+
+std::string UniformBufferRing::getUniformBlockName() const {return this->uniformBlockName;}
+unsigned int UniformBufferRing::getBindingPoint() const {return this->bindingPoint;}
+
+unsigned int UniformBufferRing::getAlignedSize(unsigned int size_bytes) const {
+    return (size_bytes + this->offsetAlignment - 1) / this->offsetAlignment * this->offsetAlignment;
+}
+
+void UniformBufferRing::beginFrame(unsigned int size_bytes) {
+    this->flush();
+
+    if (this->frameStarted) {
+        this->fences[this->frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    if (size_bytes > this->frameSize) {
+        // Doubled so that frames growing slowly don't reallocate every frame
+        this->resize(std::max(size_bytes, 2 * this->frameSize));
+    }
+
+    this->frame = (this->frame + 1) % this->fences.size();
+    this->frameOffset = 0;
+    this->frameStarted = true;
+
+    auto &fence = this->fences[this->frame];
+    if (fence) {
+        auto result = static_cast<GLenum>(GL_TIMEOUT_EXPIRED);
+        for (auto wait = 0u; wait < maxFenceWaits && result == GL_TIMEOUT_EXPIRED; ++wait) {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceWaitTimeout_ns);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+
+        if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+            Log::warn("Gave up waiting for the GPU to release a region of uniform buffer ring " +
+                      this->uniformBlockName + ", orphaning its storage");
+
+            // New storage instead of overwriting data the GPU may still read
+            this->resize(this->frameSize);
+        }
+    }
+
+    // Mapping a range of 0 bytes is an error
+    this->mappedSize = size_bytes;
+    if (size_bytes == 0) return;
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    this->mappedFrame = static_cast<unsigned char*>(glMapBufferRange(
+            GL_UNIFORM_BUFFER, this->frame * this->frameSize, size_bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+}
+
+unsigned int UniformBufferRing::push(const void *data, unsigned int size_bytes) {
+    const auto offset = this->getAlignedSize(this->frameOffset);
+    if (this->mappedFrame == nullptr || offset + size_bytes > this->mappedSize) {
+        throw Error("Failed to push " + std::to_string(size_bytes) + " bytes into uniform buffer ring " +
+                    this->uniformBlockName);
+    }
+
+    std::memcpy(this->mappedFrame + offset, data, size_bytes);
+    this->frameOffset = offset + size_bytes;
+
+    return this->frame * this->frameSize + offset;
+}
+
+void UniformBufferRing::flush() {
+    if (this->mappedFrame == nullptr) return;
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    this->mappedFrame = nullptr;
+}
+
+void UniformBufferRing::bind(unsigned int offset_bytes, unsigned int size_bytes) const {
+    GLState::bindBufferRange(GL_UNIFORM_BUFFER, this->bindingPoint, this->ubo, offset_bytes, size_bytes);
+}
+
+void UniformBufferRing::resize(unsigned int frameSize_bytes) {
+    // Frame regions must start at aligned offsets
+    this->frameSize = this->getAlignedSize(frameSize_bytes);
+
+    // The new storage isn't used by the GPU yet, so the fences of the old storage are dropped
+    for (auto &fence : this->fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    glBufferData(GL_UNIFORM_BUFFER, this->frameSize * this->fences.size(), nullptr, GL_DYNAMIC_DRAW);
 }
 
 } // namespace age
\ No newline at end of file
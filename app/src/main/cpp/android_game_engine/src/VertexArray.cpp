@@ -1,14 +1,26 @@
 #include <android_game_engine/VertexArray.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
 #include <GLES3/gl32.h>
 #include <glm/vec2.hpp>
-#include <glm/vec3.hpp>
+
+#include <android_game_engine/GLState.h>
 
 namespace {
 
-constexpr auto positionStride = sizeof(glm::vec3);
-constexpr auto normalStride = sizeof(glm::vec3);
-constexpr auto textureCoordinatesStride = sizeof(glm::vec2);
+constexpr auto instanceStride = sizeof(age::VertexArray::Instance);
+
+constexpr GLuint positionLocation = 0u;
+constexpr GLuint normalLocation = 1u;
+constexpr GLuint textureCoordinateLocation = 2u;
+
+constexpr GLuint instanceModelLocation = 3u;
+constexpr GLuint instanceNormalLocation = 7u;
+constexpr GLuint instanceColorLocation = 10u;
 
 } // namespace
 
@@ -17,67 +29,143 @@ namespace age {
 VertexArray::VertexArray(const std::vector<glm::vec3> &positions,
                          const std::vector<glm::vec3> &normals,
                          const std::vector<glm::vec2> &textureCoordinates,
-                         const std::vector<glm::uvec3> &indices) {
-    const auto positionsSize_bytes = positions.size() * positionStride;
-    const auto normalsSize_bytes = normals.size() * normalStride;
-    const auto textureCoordinatesSize_bytes = textureCoordinates.size() * textureCoordinatesStride;
-
-    const auto normalsOffset = positionsSize_bytes;
-    const auto textureCoordinatesOffset = normalsOffset + normalsSize_bytes;
-
+                         const std::vector<glm::uvec3> &indices,
+                         const VertexLayout &layout) : instanceCapacity(0) {
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
-    // Store vertex data
-    glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-    glBufferData(GL_ARRAY_BUFFER,
-                 positionsSize_bytes + normalsSize_bytes + textureCoordinatesSize_bytes,
-                 nullptr, GL_STATIC_DRAW);
+    // Store interleaved vertex data
+    const auto vertices = layout.interleave(positions, normals, textureCoordinates);
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, positionsSize_bytes, positions.data());
-    glBufferSubData(GL_ARRAY_BUFFER, normalsOffset, normalsSize_bytes, normals.data());
-    glBufferSubData(GL_ARRAY_BUFFER, textureCoordinatesOffset,
-                    textureCoordinatesSize_bytes, textureCoordinates.data());
+    glGenBuffers(1, &this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
     // Assign vertex attributes
-    glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, positionStride,
-                          reinterpret_cast<GLvoid*>(0));
-    glEnableVertexAttribArray(0u);
-
-    glVertexAttribPointer(1u, 3, GL_FLOAT, GL_FALSE, normalStride,
-                          reinterpret_cast<GLvoid*>(normalsOffset));
-    glEnableVertexAttribArray(1u);
-
-    glVertexAttribPointer(2u, 2, GL_FLOAT, GL_FALSE, textureCoordinatesStride,
-                          reinterpret_cast<GLvoid*>(textureCoordinatesOffset));
-    glEnableVertexAttribArray(2u);
+    const auto stride = static_cast<GLsizei>(layout.getStride());
+
+    if (layout.position == VertexLayout::PositionFormat::FLOAT3) {
+        glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<GLvoid*>(0));
+    } else {
+        glVertexAttribPointer(positionLocation, 4, GL_HALF_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<GLvoid*>(0));
+    }
+    glEnableVertexAttribArray(positionLocation);
+
+    if (layout.normal == VertexLayout::NormalFormat::FLOAT3) {
+        glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<GLvoid*>(layout.getNormalOffset()));
+    } else {
+        glVertexAttribPointer(normalLocation, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+                              reinterpret_cast<GLvoid*>(layout.getNormalOffset()));
+    }
+    glEnableVertexAttribArray(normalLocation);
+
+    if (layout.textureCoordinate == VertexLayout::TextureCoordinateFormat::FLOAT2) {
+        glVertexAttribPointer(textureCoordinateLocation, 2, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<GLvoid*>(layout.getTextureCoordinateOffset()));
+    } else {
+        glVertexAttribPointer(textureCoordinateLocation, 2, GL_HALF_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<GLvoid*>(layout.getTextureCoordinateOffset()));
+    }
+    glEnableVertexAttribArray(textureCoordinateLocation);
+
+    // Assign per-instance attributes. Matrices occupy one attribute location per column.
+    glGenBuffers(1, &this->instanceVbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->instanceVbo);
+
+    for (GLuint i = 0u; i < 4u; ++i) {
+        glVertexAttribPointer(instanceModelLocation + i, 4, GL_FLOAT, GL_FALSE, instanceStride,
+                              reinterpret_cast<GLvoid*>(offsetof(Instance, model) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(instanceModelLocation + i, 1u);
+        glEnableVertexAttribArray(instanceModelLocation + i);
+    }
+
+    for (GLuint i = 0u; i < 3u; ++i) {
+        glVertexAttribPointer(instanceNormalLocation + i, 3, GL_FLOAT, GL_FALSE, instanceStride,
+                              reinterpret_cast<GLvoid*>(offsetof(Instance, normal) + i * sizeof(glm::vec3)));
+        glVertexAttribDivisor(instanceNormalLocation + i, 1u);
+        glEnableVertexAttribArray(instanceNormalLocation + i);
+    }
+
+    glVertexAttribPointer(instanceColorLocation, 3, GL_FLOAT, GL_FALSE, instanceStride,
+                          reinterpret_cast<GLvoid*>(offsetof(Instance, color)));
+    glVertexAttribDivisor(instanceColorLocation, 1u);
+    glEnableVertexAttribArray(instanceColorLocation);
 
     // Store indices data
     this->numIndices = indices.size() * 3;
 
     glGenBuffers(1, &this->ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
-
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(glm::uvec3),
-                 indices.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+
+    if (positions.size() <= std::numeric_limits<uint16_t>::max()) {
+        std::vector<uint16_t> shortIndices;
+        shortIndices.reserve(this->numIndices);
+        for (const auto &triangle : indices) {
+            shortIndices.push_back(static_cast<uint16_t>(triangle.x));
+            shortIndices.push_back(static_cast<uint16_t>(triangle.y));
+            shortIndices.push_back(static_cast<uint16_t>(triangle.z));
+        }
+
+        this->indexType = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t),
+                     shortIndices.data(), GL_STATIC_DRAW);
+    } else {
+        this->indexType = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(glm::uvec3),
+                     indices.data(), GL_STATIC_DRAW);
+    }
 
     // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+VertexArray::VertexArray(VertexArray &&other) noexcept :
+    vao(std::exchange(other.vao, 0u)), vbo(std::exchange(other.vbo, 0u)), ebo(std::exchange(other.ebo, 0u)),
+    instanceVbo(std::exchange(other.instanceVbo, 0u)), numIndices(std::exchange(other.numIndices, 0u)),
+    indexType(other.indexType), instanceCapacity(std::exchange(other.instanceCapacity, 0u)) { }
+
+VertexArray& VertexArray::operator=(VertexArray &&other) noexcept {
+    std::swap(this->vao, other.vao);
+    std::swap(this->vbo, other.vbo);
+    std::swap(this->ebo, other.ebo);
+    std::swap(this->instanceVbo, other.instanceVbo);
+    std::swap(this->numIndices, other.numIndices);
+    std::swap(this->indexType, other.indexType);
+    std::swap(this->instanceCapacity, other.instanceCapacity);
+    return *this;
 }
 
 VertexArray::~VertexArray() {
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
-    glDeleteBuffers(1, &this->ebo);
+    // Moved from vertex arrays have no GL objects
+    if (this->vao == 0) return;
+
+
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
+    GLState::deleteBuffers(1, &this->ebo);
+    GLState::deleteBuffers(1, &this->instanceVbo);
 }
 
-void VertexArray::render() {
-    glBindVertexArray(this->vao);
-    glDrawElements(GL_TRIANGLES, this->numIndices,
-                   GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(0));
+void VertexArray::render(const Instance *instances, size_t numInstances) {
+    if (numInstances == 0) return;
+
+    GLState::bindVertexArray(this->vao);
+
+    // Orphan the previous instance data so the driver doesn't stall on draws still in flight
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->instanceVbo);
+    if (numInstances > this->instanceCapacity) {
+        this->instanceCapacity = numInstances;
+    }
+    glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * instanceStride, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, numInstances * instanceStride, instances);
+
+    glDrawElementsInstanced(GL_TRIANGLES, this->numIndices, this->indexType,
+                            reinterpret_cast<const GLvoid*>(0), numInstances);
 }
 
 } // namespace age
@@ -0,0 +1,91 @@
+#include <android_game_engine/VertexLayout.h>
+
+#include <cassert>
+#include <cstring>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+
+namespace {
+
+size_t getSize(age::VertexLayout::PositionFormat format) {
+    return format == age::VertexLayout::PositionFormat::FLOAT3 ? 3 * sizeof(float) : 4 * sizeof(uint16_t);
+}
+
+size_t getSize(age::VertexLayout::NormalFormat format) {
+    return format == age::VertexLayout::NormalFormat::FLOAT3 ? 3 * sizeof(float) : sizeof(uint32_t);
+}
+
+size_t getSize(age::VertexLayout::TextureCoordinateFormat format) {
+    return format == age::VertexLayout::TextureCoordinateFormat::FLOAT2 ? 2 * sizeof(float) : 2 * sizeof(uint16_t);
+}
+
+template<typename T>
+void write(uint8_t *destination, const T &value) {
+    std::memcpy(destination, &value, sizeof(value));
+}
+
+} // namespace
+
+namespace age {
+
+size_t VertexLayout::getNormalOffset() const {
+    return getSize(this->position);
+}
+
+size_t VertexLayout::getTextureCoordinateOffset() const {
+    return this->getNormalOffset() + getSize(this->normal);
+}
+
+size_t VertexLayout::getStride() const {
+    return this->getTextureCoordinateOffset() + getSize(this->textureCoordinate);
+}
+
+std::vector<uint8_t> VertexLayout::interleave(const std::vector<glm::vec3> &positions,
+                                              const std::vector<glm::vec3> &normals,
+                                              const std::vector<glm::vec2> &textureCoordinates) const {
+    assert(normals.size() == positions.size() && textureCoordinates.size() == positions.size() &&
+           "Vertex attributes must have the same number of elements");
+
+    const auto stride = this->getStride();
+    const auto normalOffset = this->getNormalOffset();
+    const auto textureCoordinateOffset = this->getTextureCoordinateOffset();
+
+    std::vector<uint8_t> vertices(positions.size() * stride);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        auto vertex = &vertices[i * stride];
+
+        if (this->position == PositionFormat::FLOAT3) {
+            write(vertex, positions[i]);
+        } else {
+            write(vertex, glm::packHalf4x16(glm::vec4(positions[i], 1.0f)));
+        }
+
+        if (this->normal == NormalFormat::FLOAT3) {
+            write(vertex + normalOffset, normals[i]);
+        } else {
+            write(vertex + normalOffset, packNormal(normals[i]));
+        }
+
+        if (this->textureCoordinate == TextureCoordinateFormat::FLOAT2) {
+            write(vertex + textureCoordinateOffset, textureCoordinates[i]);
+        } else {
+            write(vertex + textureCoordinateOffset, glm::packHalf2x16(textureCoordinates[i]));
+        }
+    }
+
+    return vertices;
+}
+
+uint32_t packNormal(const glm::vec3 &normal) {
+    const auto length = glm::length(normal);
+    const auto unitNormal = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    return glm::packSnorm3x10_1x2(glm::vec4(unitNormal, 0.0f));
+}
+
+glm::vec3 unpackNormal(uint32_t packedNormal) {
+    return glm::vec3(glm::unpackSnorm3x10_1x2(packedNormal));
+}
+
+} // namespace age
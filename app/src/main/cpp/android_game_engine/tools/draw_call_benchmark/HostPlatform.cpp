@@ -0,0 +1,136 @@
+#include "HostPlatform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <android/asset_manager.h>
+#include <android/asset_manager_jni.h>
+#include <android/log.h>
+
+struct AAssetManager {
+    std::string directory;
+};
+
+struct AAsset {
+    std::vector<char> data;
+    size_t position = 0;
+};
+
+namespace {
+
+JavaVM javaVM;
+JNIEnv jniEnv;
+
+std::atomic<int> minLogPriority {ANDROID_LOG_DEFAULT};
+
+} // namespace
+
+namespace HostPlatform {
+
+JNIEnv* getJNIEnv() {
+    return &jniEnv;
+}
+
+void setMinLogPriority(int priority) {
+    minLogPriority = priority;
+}
+
+} // namespace HostPlatform
+
+jint JavaVM::GetEnv(void **env, jint) {
+    *env = &jniEnv;
+    return JNI_OK;
+}
+
+jint JNIEnv::GetJavaVM(JavaVM **vm) {
+    *vm = &javaVM;
+    return JNI_OK;
+}
+
+jobject JNIEnv::NewGlobalRef(jobject object) {return object;}
+void JNIEnv::DeleteGlobalRef(jobject) {}
+void JNIEnv::DeleteLocalRef(jobject) {}
+
+jclass JNIEnv::GetObjectClass(jobject object) {return object;}
+jmethodID JNIEnv::GetMethodID(jclass, const char*, const char*) {return nullptr;}
+
+jobject JNIEnv::CallObjectMethod(jobject object, jmethodID, ...) {
+    // getCacheDir and getAbsolutePath both resolve to the directory the object names
+    return object;
+}
+
+void JNIEnv::CallVoidMethod(jobject, jmethodID, ...) {}
+
+const char* JNIEnv::GetStringUTFChars(jstring string, jboolean *isCopy) {
+    if (isCopy != nullptr) *isCopy = 0;
+    return static_cast<const char*>(string);
+}
+
+void JNIEnv::ReleaseStringUTFChars(jstring, const char*) {}
+
+extern "C" {
+
+int __android_log_print(int priority, const char *tag, const char *format, ...) {
+    if (priority < minLogPriority) return 0;
+
+    static const char priorityLetters[] = "??VDIWEFS";
+    const auto letter = priorityLetters[std::min<int>(std::max(priority, 0), sizeof(priorityLetters) - 2)];
+
+    va_list args;
+    va_start(args, format);
+    std::fprintf(stderr, "%c/%s: ", letter, tag);
+    const auto length = std::vfprintf(stderr, format, args);
+    va_end(args);
+    return length;
+}
+
+AAssetManager* AAssetManager_fromJava(JNIEnv*, jobject assetManager) {
+    // Never freed, like the asset manager of the application
+    return new AAssetManager{static_cast<const char*>(assetManager)};
+}
+
+AAsset* AAssetManager_open(AAssetManager *manager, const char *filename, int) {
+    std::ifstream file(manager->directory + "/" + filename, std::ios::binary);
+    if (!file) return nullptr;
+
+    auto asset = new AAsset;
+    asset->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return asset;
+}
+
+int AAsset_read(AAsset *asset, void *buffer, size_t count) {
+    count = std::min(count, asset->data.size() - asset->position);
+    std::copy_n(asset->data.data() + asset->position, count, static_cast<char*>(buffer));
+    asset->position += count;
+    return static_cast<int>(count);
+}
+
+off_t AAsset_seek(AAsset *asset, off_t offset, int whence) {
+    off_t position = offset;
+    if (whence == SEEK_CUR) position += static_cast<off_t>(asset->position);
+    else if (whence == SEEK_END) position += static_cast<off_t>(asset->data.size());
+
+    if (position < 0 || position > static_cast<off_t>(asset->data.size())) return -1;
+    asset->position = static_cast<size_t>(position);
+    return position;
+}
+
+off_t AAsset_getLength(AAsset *asset) {
+    return static_cast<off_t>(asset->data.size());
+}
+
+off_t AAsset_getRemainingLength(AAsset *asset) {
+    return static_cast<off_t>(asset->data.size() - asset->position);
+}
+
+void AAsset_close(AAsset *asset) {
+    delete asset;
+}
+
+} // extern "C"
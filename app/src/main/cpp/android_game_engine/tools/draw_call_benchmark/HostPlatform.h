@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Host implementations of the Android and JNI functions the engine calls, see the headers
+ * in platform/. JNI objects are strings, e.g. the path of a directory.
+ */
+
+#include <jni.h>
+
+namespace HostPlatform {
+
+///
+/// \brief getJNIEnv Returns the environment games are created with.
+///
+JNIEnv* getJNIEnv();
+
+///
+/// \brief setMinLogPriority Drops log messages below a priority, e.g. ANDROID_LOG_WARN.
+///
+void setMinLogPriority(int priority);
+
+} // namespace HostPlatform
@@ -0,0 +1,667 @@
+#include "RecordingGL.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+
+namespace {
+
+struct Uniform {
+    std::string name; ///< Arrays are named by their first element, e.g. "lights[0]"
+    GLint size;
+    GLenum type;
+};
+
+struct Program {
+    std::vector<GLuint> shaders;
+    bool linked = false;
+
+    std::vector<Uniform> uniforms;
+    std::unordered_map<std::string, GLint> uniformLocations;
+    GLint numUniformLocations = 0;
+    std::vector<std::string> uniformBlocks;
+};
+
+struct Buffer {
+    GLsizeiptr size = 0;
+    std::vector<unsigned char> mappedStorage; ///< Only allocated once the buffer is mapped
+};
+
+struct Context {
+    GLuint nextName = 1; ///< Names are unique across object types
+    std::unordered_map<GLuint, std::string> shaderSources;
+    std::unordered_map<GLuint, Program> programs;
+    std::unordered_map<GLuint, Buffer> buffers;
+    std::unordered_map<GLenum, GLuint> boundBuffers;
+    GLint unpackAlignment = 4;
+    bool fencesSignaled = true;
+
+    RecordingGL::Statistics statistics;
+};
+
+Context context;
+
+void countCall() {
+    ++context.statistics.numCalls;
+}
+
+void countStateChange() {
+    ++context.statistics.numCalls;
+    ++context.statistics.numStateChanges;
+}
+
+void countUniformUpdate() {
+    ++context.statistics.numCalls;
+    ++context.statistics.numUniformUpdates;
+}
+
+void countDraw(GLsizei numInstances) {
+    ++context.statistics.numCalls;
+    ++context.statistics.numDrawCalls;
+    context.statistics.numInstances += static_cast<unsigned int>(std::max(numInstances, 0));
+}
+
+void generateNames(GLsizei n, GLuint *names) {
+    for (GLsizei i = 0; i < n; ++i) {
+        names[i] = context.nextName++;
+    }
+}
+
+///
+/// \brief copyString Copies a string into a buffer of the caller the way GL returns names and logs.
+///
+void copyString(const std::string &string, GLsizei bufSize, GLsizei *length, GLchar *buffer) {
+    const auto numCopied = bufSize > 0 ? std::min(string.size(), static_cast<size_t>(bufSize - 1)) : 0;
+    if (bufSize > 0) {
+        std::memcpy(buffer, string.data(), numCopied);
+        buffer[numCopied] = '\0';
+    }
+    if (length != nullptr) *length = static_cast<GLsizei>(numCopied);
+}
+
+size_t getImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    size_t numComponents = 4;
+    switch (format) {
+        case GL_RED: case GL_RED_INTEGER: case GL_ALPHA: case GL_LUMINANCE:
+        case GL_DEPTH_COMPONENT: case GL_DEPTH_STENCIL:
+            numComponents = 1; break;
+        case GL_RG: case GL_RG_INTEGER: case GL_LUMINANCE_ALPHA:
+            numComponents = 2; break;
+        case GL_RGB: case GL_RGB_INTEGER:
+            numComponents = 3; break;
+        default:
+            break;
+    }
+
+    size_t pixelSize = numComponents;
+    switch (type) {
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+            pixelSize = 2 * numComponents; break;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+            pixelSize = 4 * numComponents; break;
+        case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+            pixelSize = 2; break;
+        case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_5_9_9_9_REV:
+            pixelSize = 4; break;
+        default:
+            break;
+    }
+
+    // Rows are padded to the unpack alignment
+    const auto alignment = static_cast<size_t>(context.unpackAlignment);
+    const auto rowSize = (static_cast<size_t>(width) * pixelSize + alignment - 1) / alignment * alignment;
+    return rowSize * static_cast<size_t>(height);
+}
+
+// Reflection of the uniforms declared in shader sources
+
+struct Declaration {
+    std::string type;
+    std::string name;
+    GLint arraySize; ///< 0 if the declaration isn't an array
+};
+
+using Structs = std::unordered_map<std::string, std::vector<Declaration>>;
+
+///
+/// \brief tokenize Splits GLSL into identifiers, numbers and punctuation, dropping
+///                 comments and preprocessor directives.
+///
+std::vector<std::string> tokenize(const std::string &source) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    bool lineStart = true;
+    while (i < source.size()) {
+        const auto c = source[i];
+        if (c == '\n') {
+            lineStart = true;
+            ++i;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (c == '#' && lineStart) {
+            i = std::min(source.find('\n', i), source.size());
+        } else if (source.compare(i, 2, "//") == 0) {
+            i = std::min(source.find('\n', i), source.size());
+        } else if (source.compare(i, 2, "/*") == 0) {
+            i = std::min(source.find("*/", i + 2), source.size() - 2) + 2;
+        } else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+            const auto begin = i;
+            while (i < source.size() && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_' || source[i] == '.')) ++i;
+            tokens.emplace_back(source, begin, i - begin);
+            lineStart = false;
+        } else {
+            tokens.emplace_back(1, c);
+            lineStart = false;
+            ++i;
+        }
+    }
+    return tokens;
+}
+
+bool isQualifier(const std::string &token) {
+    return token == "lowp" || token == "mediump" || token == "highp" || token == "const";
+}
+
+///
+/// \brief parseDeclarations Parses a declaration of one or more variables of a type up to its ';'.
+/// \return Index of the token after the ';'.
+///
+size_t parseDeclarations(const std::vector<std::string> &tokens, size_t i, std::vector<Declaration> &declarations) {
+    while (i < tokens.size() && isQualifier(tokens[i])) ++i;
+    if (i >= tokens.size()) return i;
+
+    const auto type = tokens[i++];
+    while (i < tokens.size() && tokens[i] != ";" && tokens[i] != "}") {
+        if (tokens[i] == ",") {
+            ++i;
+            continue;
+        }
+
+        Declaration declaration {type, tokens[i++], 0};
+        if (i < tokens.size() && tokens[i] == "[") {
+            // Sizes given by constants aren't resolved
+            declaration.arraySize = i + 1 < tokens.size() ? std::max(std::atoi(tokens[i + 1].c_str()), 1) : 1;
+            while (i < tokens.size() && tokens[i] != "]") ++i;
+            ++i;
+        }
+        declarations.push_back(declaration);
+    }
+    return tokens[std::min(i, tokens.size() - 1)] == ";" ? i + 1 : i;
+}
+
+GLenum getUniformType(const std::string &type) {
+    static const std::unordered_map<std::string, GLenum> types {
+        {"bool", GL_BOOL}, {"int", GL_INT}, {"float", GL_FLOAT},
+        {"vec2", GL_FLOAT_VEC2}, {"vec3", GL_FLOAT_VEC3}, {"vec4", GL_FLOAT_VEC4},
+        {"mat3", GL_FLOAT_MAT3}, {"mat4", GL_FLOAT_MAT4},
+        {"sampler2D", GL_SAMPLER_2D}, {"samplerCube", GL_SAMPLER_CUBE},
+        {"sampler2DArray", GL_SAMPLER_2D_ARRAY}, {"sampler2DArrayShadow", GL_SAMPLER_2D_ARRAY_SHADOW},
+        {"sampler2DShadow", GL_SAMPLER_2D_SHADOW}
+    };
+    auto t = types.find(type);
+    return t == types.end() ? GL_FLOAT : t->second;
+}
+
+///
+/// \brief addUniform Adds the active uniforms of a declaration, expanding the members of structs.
+///
+void addUniform(Program &program, const Structs &structs, const Declaration &declaration, const std::string &prefix) {
+    const auto name = prefix + declaration.name;
+
+    auto structMembers = structs.find(declaration.type);
+    if (structMembers != structs.end()) {
+        const auto numElements = std::max(declaration.arraySize, 1);
+        for (GLint element = 0; element < numElements; ++element) {
+            const auto elementName = declaration.arraySize > 0 ? name + "[" + std::to_string(element) + "]" : name;
+            for (const auto &member : structMembers->second) {
+                addUniform(program, structs, member, elementName + ".");
+            }
+        }
+        return;
+    }
+
+    // Uniforms declared by both stages are shared
+    if (program.uniformLocations.count(name) > 0) return;
+
+    const auto location = program.numUniformLocations;
+    const auto size = std::max(declaration.arraySize, 1);
+    program.numUniformLocations += size;
+
+    program.uniforms.push_back({declaration.arraySize > 0 ? name + "[0]" : name, size, getUniformType(declaration.type)});
+    program.uniformLocations[name] = location;
+    for (GLint element = 0; declaration.arraySize > 0 && element < size; ++element) {
+        program.uniformLocations[name + "[" + std::to_string(element) + "]"] = location + element;
+    }
+}
+
+///
+/// \brief reflect Collects the uniforms and uniform blocks declared by the shaders of a program.
+///
+void reflect(Program &program) {
+    std::string source;
+    for (auto shader : program.shaders) {
+        source += context.shaderSources[shader] + "\n";
+    }
+    const auto tokens = tokenize(source);
+
+    Structs structs;
+    std::vector<Declaration> declarations;
+    for (size_t i = 0; i < tokens.size();) {
+        if (tokens[i] == "struct" && i + 2 < tokens.size() && tokens[i + 2] == "{") {
+            auto &members = structs[tokens[i + 1]];
+            for (i += 3; i < tokens.size() && tokens[i] != "}";) {
+                i = parseDeclarations(tokens, i, members);
+            }
+            ++i;
+        } else if (tokens[i] == "uniform") {
+            auto j = i + 1;
+            while (j < tokens.size() && isQualifier(tokens[j])) ++j;
+
+            if (j + 1 < tokens.size() && tokens[j + 1] == "{") {
+                if (std::find(program.uniformBlocks.begin(), program.uniformBlocks.end(), tokens[j]) ==
+                    program.uniformBlocks.end()) {
+                    program.uniformBlocks.push_back(tokens[j]);
+                }
+                i = std::find(tokens.begin() + static_cast<std::ptrdiff_t>(j), tokens.end(), "}") - tokens.begin() + 1;
+            } else {
+                i = parseDeclarations(tokens, i + 1, declarations);
+            }
+        } else {
+            ++i;
+        }
+    }
+
+    program.uniforms.clear();
+    program.uniformLocations.clear();
+    program.numUniformLocations = 0;
+    for (const auto &declaration : declarations) {
+        addUniform(program, structs, declaration, "");
+    }
+}
+
+} // namespace
+
+namespace RecordingGL {
+
+void resetStatistics() {
+    context.statistics = Statistics();
+}
+
+Statistics getStatistics() {
+    return context.statistics;
+}
+
+void setFencesSignaled(bool signaled) {
+    context.fencesSignaled = signaled;
+}
+
+} // namespace RecordingGL
+
+// GLES3 entry points
+
+void glActiveTexture(GLenum) {countStateChange();}
+
+void glAttachShader(GLuint program, GLuint shader) {
+    countCall();
+    context.programs[program].shaders.push_back(shader);
+}
+
+void glBeginQuery(GLenum, GLuint) {countCall();}
+
+void glBindBuffer(GLenum target, GLuint buffer) {
+    countStateChange();
+    context.boundBuffers[target] = buffer;
+}
+
+void glBindBufferBase(GLenum target, GLuint, GLuint buffer) {
+    countStateChange();
+    context.boundBuffers[target] = buffer;
+}
+
+void glBindBufferRange(GLenum target, GLuint, GLuint buffer, GLintptr, GLsizeiptr) {
+    countStateChange();
+    context.boundBuffers[target] = buffer;
+}
+
+void glBindFramebuffer(GLenum, GLuint) {countStateChange();}
+void glBindTexture(GLenum, GLuint) {countStateChange();}
+void glBindVertexArray(GLuint) {countStateChange();}
+void glBlendFunc(GLenum, GLenum) {countStateChange();}
+
+void glBlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) {countCall();}
+
+void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum) {
+    countCall();
+    auto &buffer = context.buffers[context.boundBuffers[target]];
+    buffer.size = size;
+    buffer.mappedStorage.clear();
+    if (data != nullptr) context.statistics.numBufferBytesUploaded += static_cast<size_t>(size);
+}
+
+void glBufferSubData(GLenum, GLintptr, GLsizeiptr size, const void*) {
+    countCall();
+    context.statistics.numBufferBytesUploaded += static_cast<size_t>(size);
+}
+
+GLenum glCheckFramebufferStatus(GLenum) {
+    countCall();
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void glClear(GLbitfield) {countCall();}
+void glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {countStateChange();}
+
+GLenum glClientWaitSync(GLsync, GLbitfield, GLuint64) {
+    countCall();
+    return context.fencesSignaled ? GL_ALREADY_SIGNALED : GL_TIMEOUT_EXPIRED;
+}
+
+void glCompileShader(GLuint) {countCall();}
+
+void glCompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei imageSize, const void*) {
+    countCall();
+    context.statistics.numTextureBytesUploaded += static_cast<size_t>(std::max(imageSize, 0));
+}
+
+GLuint glCreateProgram() {
+    countCall();
+    const auto program = context.nextName++;
+    context.programs[program];
+    return program;
+}
+
+GLuint glCreateShader(GLenum) {
+    countCall();
+    const auto shader = context.nextName++;
+    context.shaderSources[shader];
+    return shader;
+}
+
+void glCullFace(GLenum) {countStateChange();}
+
+void glDeleteBuffers(GLsizei n, const GLuint *buffers) {
+    countCall();
+    for (GLsizei i = 0; i < n; ++i) {
+        context.buffers.erase(buffers[i]);
+        for (auto &binding : context.boundBuffers) {
+            if (binding.second == buffers[i]) binding.second = 0;
+        }
+    }
+}
+
+void glDeleteFramebuffers(GLsizei, const GLuint*) {countCall();}
+
+void glDeleteProgram(GLuint program) {
+    countCall();
+    context.programs.erase(program);
+}
+
+void glDeleteQueries(GLsizei, const GLuint*) {countCall();}
+
+void glDeleteShader(GLuint shader) {
+    countCall();
+    context.shaderSources.erase(shader);
+}
+
+void glDeleteSync(GLsync) {countCall();}
+void glDeleteTextures(GLsizei, const GLuint*) {countCall();}
+void glDeleteVertexArrays(GLsizei, const GLuint*) {countCall();}
+void glDepthFunc(GLenum) {countStateChange();}
+void glDepthMask(GLboolean) {countStateChange();}
+
+void glDetachShader(GLuint program, GLuint shader) {
+    countCall();
+    auto &shaders = context.programs[program].shaders;
+    shaders.erase(std::remove(shaders.begin(), shaders.end(), shader), shaders.end());
+}
+
+void glDisable(GLenum) {countStateChange();}
+void glDrawArrays(GLenum, GLint, GLsizei) {countDraw(1);}
+void glDrawBuffers(GLsizei, const GLenum*) {countStateChange();}
+void glDrawElements(GLenum, GLsizei, GLenum, const void*) {countDraw(1);}
+void glDrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei instancecount) {countDraw(instancecount);}
+void glEnable(GLenum) {countStateChange();}
+void glEnableVertexAttribArray(GLuint) {countStateChange();}
+void glEndQuery(GLenum) {countCall();}
+
+GLsync glFenceSync(GLenum, GLbitfield) {
+    countCall();
+    return reinterpret_cast<GLsync>(static_cast<uintptr_t>(context.nextName++));
+}
+
+void glFramebufferTextureLayer(GLenum, GLenum, GLuint, GLint, GLint) {countCall();}
+
+void glGenBuffers(GLsizei n, GLuint *buffers) {
+    countCall();
+    generateNames(n, buffers);
+}
+
+void glGenFramebuffers(GLsizei n, GLuint *framebuffers) {
+    countCall();
+    generateNames(n, framebuffers);
+}
+
+void glGenQueries(GLsizei n, GLuint *ids) {
+    countCall();
+    generateNames(n, ids);
+}
+
+void glGenTextures(GLsizei n, GLuint *textures) {
+    countCall();
+    generateNames(n, textures);
+}
+
+void glGenVertexArrays(GLsizei n, GLuint *arrays) {
+    countCall();
+    generateNames(n, arrays);
+}
+
+void glGenerateMipmap(GLenum) {countCall();}
+
+void glGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name) {
+    countCall();
+    const auto &uniforms = context.programs[program].uniforms;
+    if (index >= uniforms.size()) return;
+
+    const auto &uniform = uniforms[index];
+    copyString(uniform.name, bufSize, length, name);
+    *size = uniform.size;
+    *type = uniform.type;
+}
+
+void glGetActiveUniformBlockName(GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei *length, GLchar *uniformBlockName) {
+    countCall();
+    const auto &uniformBlocks = context.programs[program].uniformBlocks;
+    if (uniformBlockIndex >= uniformBlocks.size()) return;
+
+    copyString(uniformBlocks[uniformBlockIndex], bufSize, length, uniformBlockName);
+}
+
+GLenum glGetError() {
+    countCall();
+    return GL_NO_ERROR;
+}
+
+void glGetIntegerv(GLenum pname, GLint *data) {
+    countCall();
+    switch (pname) {
+        case GL_MAX_TEXTURE_IMAGE_UNITS: *data = 16; break;
+        case GL_MAX_TEXTURE_SIZE: *data = 4096; break;
+        case GL_MAX_UNIFORM_BUFFER_BINDINGS: *data = 72; break;
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *data = 64; break;
+        // Neither extensions such as timer queries nor program binaries are supported
+        default: *data = 0; break;
+    }
+}
+
+void glGetProgramBinary(GLuint, GLsizei, GLsizei *length, GLenum*, void*) {
+    countCall();
+    if (length != nullptr) *length = 0;
+}
+
+void glGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+    countCall();
+    copyString("", bufSize, length, infoLog);
+}
+
+void glGetProgramiv(GLuint program, GLenum pname, GLint *params) {
+    countCall();
+    const auto &p = context.programs[program];
+    switch (pname) {
+        case GL_LINK_STATUS: *params = p.linked ? GL_TRUE : GL_FALSE; break;
+        case GL_INFO_LOG_LENGTH: *params = 1; break;
+        case GL_ACTIVE_UNIFORMS: *params = static_cast<GLint>(p.uniforms.size()); break;
+        case GL_ACTIVE_UNIFORM_BLOCKS: *params = static_cast<GLint>(p.uniformBlocks.size()); break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+            *params = 0;
+            for (const auto &uniform : p.uniforms) {
+                *params = std::max(*params, static_cast<GLint>(uniform.name.size() + 1));
+            }
+            break;
+        case GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH:
+            *params = 0;
+            for (const auto &uniformBlock : p.uniformBlocks) {
+                *params = std::max(*params, static_cast<GLint>(uniformBlock.size() + 1));
+            }
+            break;
+        default: *params = 0; break;
+    }
+}
+
+void glGetQueryObjectuiv(GLuint, GLenum pname, GLuint *params) {
+    countCall();
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void glGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+    countCall();
+    copyString("", bufSize, length, infoLog);
+}
+
+void glGetShaderiv(GLuint, GLenum pname, GLint *params) {
+    countCall();
+    switch (pname) {
+        case GL_COMPILE_STATUS: *params = GL_TRUE; break;
+        case GL_INFO_LOG_LENGTH: *params = 1; break;
+        default: *params = 0; break;
+    }
+}
+
+const GLubyte* glGetString(GLenum name) {
+    countCall();
+    switch (name) {
+        case GL_VENDOR: return reinterpret_cast<const GLubyte*>("android_game_engine");
+        case GL_RENDERER: return reinterpret_cast<const GLubyte*>("RecordingGL");
+        case GL_VERSION: return reinterpret_cast<const GLubyte*>("OpenGL ES 3.2 RecordingGL");
+        case GL_SHADING_LANGUAGE_VERSION: return reinterpret_cast<const GLubyte*>("OpenGL ES GLSL ES 3.20");
+        default: return nullptr;
+    }
+}
+
+const GLubyte* glGetStringi(GLenum, GLuint) {
+    countCall();
+    return nullptr;
+}
+
+GLint glGetUniformLocation(GLuint program, const GLchar *name) {
+    countCall();
+    const auto &uniformLocations = context.programs[program].uniformLocations;
+    auto location = uniformLocations.find(name);
+    return location == uniformLocations.end() ? -1 : location->second;
+}
+
+void glLinkProgram(GLuint program) {
+    countCall();
+    auto &p = context.programs[program];
+    reflect(p);
+    p.linked = true;
+}
+
+void* glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    countCall();
+    auto &buffer = context.buffers[context.boundBuffers[target]];
+    if (offset < 0 || length < 0 || offset + length > buffer.size) return nullptr;
+
+    buffer.mappedStorage.resize(static_cast<size_t>(buffer.size));
+    if (access & GL_MAP_WRITE_BIT) context.statistics.numBufferBytesMapped += static_cast<size_t>(length);
+    return buffer.mappedStorage.data() + offset;
+}
+
+void glPixelStorei(GLenum pname, GLint param) {
+    countStateChange();
+    if (pname == GL_UNPACK_ALIGNMENT) context.unpackAlignment = param;
+}
+
+void glProgramBinary(GLuint program, GLenum, const void*, GLsizei) {
+    countCall();
+    context.programs[program].linked = false;
+}
+
+void glProgramParameteri(GLuint, GLenum, GLint) {countCall();}
+void glReadBuffer(GLenum) {countStateChange();}
+
+void glShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length) {
+    countCall();
+    auto &source = context.shaderSources[shader];
+    source.clear();
+    for (GLsizei i = 0; i < count; ++i) {
+        if (length != nullptr && length[i] >= 0) source.append(string[i], static_cast<size_t>(length[i]));
+        else source.append(string[i]);
+    }
+}
+
+void glTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void *pixels) {
+    countCall();
+    if (pixels != nullptr) context.statistics.numTextureBytesUploaded += getImageSize(width, height, format, type);
+}
+
+void glTexParameterfv(GLenum, GLenum, const GLfloat*) {countStateChange();}
+void glTexParameteri(GLenum, GLenum, GLint) {countStateChange();}
+void glTexStorage3D(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLsizei) {countCall();}
+void glUniform1f(GLint, GLfloat) {countUniformUpdate();}
+void glUniform1i(GLint, GLint) {countUniformUpdate();}
+void glUniform2f(GLint, GLfloat, GLfloat) {countUniformUpdate();}
+void glUniform3f(GLint, GLfloat, GLfloat, GLfloat) {countUniformUpdate();}
+void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) {countUniformUpdate();}
+void glUniformBlockBinding(GLuint, GLuint, GLuint) {countStateChange();}
+void glUniformMatrix3fv(GLint, GLsizei, GLboolean, const GLfloat*) {countUniformUpdate();}
+void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {countUniformUpdate();}
+
+GLboolean glUnmapBuffer(GLenum) {
+    countCall();
+    return GL_TRUE;
+}
+
+void glUseProgram(GLuint) {countStateChange();}
+void glVertexAttribDivisor(GLuint, GLuint) {countStateChange();}
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {countStateChange();}
+void glViewport(GLint, GLint, GLsizei, GLsizei) {countStateChange();}
+
+// EGL entry points. There is no display, the GL context is assumed to be current.
+
+EGLBoolean eglChooseConfig(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint *num_config) {
+    if (num_config != nullptr) *num_config = 0;
+    return EGL_FALSE;
+}
+
+EGLContext eglCreateContext(EGLDisplay, EGLConfig, EGLContext, const EGLint*) {return EGL_NO_CONTEXT;}
+EGLSurface eglCreateWindowSurface(EGLDisplay, EGLConfig, EGLNativeWindowType, const EGLint*) {return EGL_NO_SURFACE;}
+EGLBoolean eglDestroyContext(EGLDisplay, EGLContext) {return EGL_FALSE;}
+EGLBoolean eglDestroySurface(EGLDisplay, EGLSurface) {return EGL_FALSE;}
+EGLDisplay eglGetDisplay(EGLNativeDisplayType) {return EGL_NO_DISPLAY;}
+EGLint eglGetError() {return EGL_NOT_INITIALIZED;}
+__eglMustCastToProperFunctionPointerType eglGetProcAddress(const char*) {return nullptr;}
+EGLBoolean eglInitialize(EGLDisplay, EGLint*, EGLint*) {return EGL_FALSE;}
+EGLBoolean eglMakeCurrent(EGLDisplay, EGLSurface, EGLSurface, EGLContext) {return EGL_FALSE;}
+EGLBoolean eglQuerySurface(EGLDisplay, EGLSurface, EGLint, EGLint*) {return EGL_FALSE;}
+EGLBoolean eglSwapBuffers(EGLDisplay, EGLSurface) {return EGL_FALSE;}
+EGLBoolean eglTerminate(EGLDisplay) {return EGL_FALSE;}
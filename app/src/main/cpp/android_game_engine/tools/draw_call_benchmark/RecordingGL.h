@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+ * Recording null backend of OpenGL ES 3 and EGL for desktop hosts.
+ *
+ * The engine calls GLES directly, so the GLES3 and EGL entry points are the dispatch layer:
+ * Android builds link libGLESv3 and libEGL, and host builds link this backend instead,
+ * which defines the same entry points. Nothing is rendered. Every call is counted and
+ * enough state is emulated for the engine to run: objects are named, shaders always
+ * compile and link, mapped buffers are backed by memory, and the uniforms and uniform
+ * blocks of a program are reflected from the declarations in its shader sources.
+ *
+ * EGL displays can't be obtained, so ManagerWindowing must be initialized with dimensions.
+ * Like a GL context, the backend must only be used from one thread.
+ */
+
+#include <cstddef>
+
+namespace RecordingGL {
+
+struct Statistics {
+    unsigned int numCalls = 0;          ///< All GL calls, including queries
+    unsigned int numDrawCalls = 0;
+    unsigned int numInstances = 0;      ///< Instances drawn, 1 per call that isn't instanced
+    unsigned int numStateChanges = 0;   ///< Bindings, capabilities, fixed function state and programs
+    unsigned int numUniformUpdates = 0; ///< glUniform* calls
+    size_t numBufferBytesUploaded = 0;  ///< Bytes passed to glBufferData and glBufferSubData
+    size_t numBufferBytesMapped = 0;    ///< Bytes of buffer ranges mapped for writing
+    size_t numTextureBytesUploaded = 0; ///< Bytes of the images passed to glTexImage2D and glCompressedTexImage2D
+};
+
+///
+/// \brief resetStatistics Resets the counters, e.g. at the start of a frame.
+///
+void resetStatistics();
+
+///
+/// \brief getStatistics Returns the calls counted since the last call to resetStatistics.
+///
+Statistics getStatistics();
+
+///
+/// \brief setFencesSignaled Sets whether waits for fences return at once as signaled, as they
+///                          do by default, or time out like on a hung GPU.
+///
+void setFencesSignaled(bool signaled);
+
+} // namespace RecordingGL
@@ -0,0 +1,305 @@
+/**
+ * Measures the CPU cost of submitting frames with Game::render over synthetic scenes of
+ * boxes and models, on a desktop host with the recording GL backend in RecordingGL.h.
+ *
+ * Every frame is updated with a fixed timestep and rendered. The time spent in
+ * Game::render and the GL calls it made are reported per frame, along with the draws
+ * counted by the engine. Nothing is drawn, so the times only include the engine's own
+ * work and the calls into the null backend, not the work of a GL driver.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <android/asset_manager_jni.h>
+#include <android/log.h>
+
+#include <android_game_engine/AssetLoader.h>
+#include <android_game_engine/Box.h>
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Game.h>
+#include <android_game_engine/GameObject.h>
+#include <android_game_engine/LightDirectional.h>
+#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/ManagerResources.h>
+#include <android_game_engine/ManagerWindowing.h>
+#include <android_game_engine/ProgramBinaryCache.h>
+#include <android_game_engine/Texture2D.h>
+#include <android_game_engine/Trace.h>
+
+#include "HostPlatform.h"
+#include "RecordingGL.h"
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+struct Options {
+    unsigned int numBoxes = 100;
+    unsigned int numModels = 4;
+    unsigned int numFrames = 600;
+    unsigned int numWarmupFrames = 60;
+    bool dynamic = false;
+    int width = 1920;
+    int height = 1080;
+    std::string assetsDirectory = ASSETS_DIRECTORY;
+    std::string tracePath;
+    bool verbose = false;
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+                 "Usage: draw_call_benchmark [options]\n"
+                 "Options:\n"
+                 "  --boxes <n>       Number of boxes (default 100)\n"
+                 "  --models <n>      Number of ATV models (default 4)\n"
+                 "  --frames <n>      Number of measured frames (default 600)\n"
+                 "  --warmup <n>      Number of frames rendered before measuring (default 60)\n"
+                 "  --dynamic         Give the boxes mass so that they fall onto the floor\n"
+                 "  --size <w> <h>    Window dimensions (default 1920 1080)\n"
+                 "  --assets <dir>    Assets directory (default %s)\n"
+                 "  --trace <file>    Write a Chrome trace of the measured frames\n"
+                 "  --verbose         Print the engine's info logs\n",
+                 ASSETS_DIRECTORY);
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; ++i) {
+        const auto hasValues = [&](int numValues){ return i + numValues < argc; };
+
+        if (std::strcmp(argv[i], "--boxes") == 0 && hasValues(1)) {
+            options.numBoxes = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--models") == 0 && hasValues(1)) {
+            options.numModels = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--frames") == 0 && hasValues(1)) {
+            options.numFrames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValues(1)) {
+            options.numWarmupFrames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--dynamic") == 0) {
+            options.dynamic = true;
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValues(2)) {
+            options.width = std::atoi(argv[++i]);
+            options.height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--assets") == 0 && hasValues(1)) {
+            options.assetsDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && hasValues(1)) {
+            options.tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            options.verbose = true;
+        } else {
+            return false;
+        }
+    }
+    return options.numFrames > 0 && options.width > 0 && options.height > 0;
+}
+
+///
+/// \brief Lays boxes and models out on a grid over a floor, in view of the camera.
+///
+class BenchmarkGame : public age::Game {
+public:
+    BenchmarkGame(JNIEnv *env, jobject javaApplicationContext, const Options &options)
+        : Game(env, javaApplicationContext, nullptr), options(options) {}
+
+    void onCreate() override {
+        Game::onCreate();
+
+        this->setFixedTimestep(std::chrono::duration<float>(1.0f / 60.0f));
+        this->getDirectionalLight()->setLookAtDirection({1.0f, 1.0f, -3.0f});
+
+        const auto numObjects = this->options.numBoxes + this->options.numModels;
+        const auto gridSize = std::max(static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(numObjects)))), 1u);
+        const auto spacing = 1.0f;
+        const auto extent = gridSize * spacing;
+
+        this->getCam()->setPosition({0.0f, -extent, extent});
+        this->getCam()->setLookAtPoint({0.0f, 0.0f, 0.0f});
+
+        std::shared_ptr<age::Box> floor(new age::Box({age::Texture2D(glm::vec3(0.6f))},
+                                                     {age::Texture2D(glm::vec3(1.0f))}));
+        floor->setScale(glm::vec3{extent + spacing, extent + spacing, 0.2f});
+        floor->setPosition({0.0f, 0.0f, -0.1f});
+        this->addToWorldList(floor);
+
+        const auto gridPosition = [&](unsigned int i){
+            return glm::vec3{(static_cast<float>(i % gridSize) + 0.5f) * spacing - 0.5f * extent,
+                             (static_cast<float>(i / gridSize) + 0.5f) * spacing - 0.5f * extent,
+                             0.0f};
+        };
+
+        // Boxes share their textures so that they can be instanced, like in TestGame
+        const age::Texture2D white(glm::vec3(1.0f));
+        for (auto i = 0u; i < this->options.numBoxes; ++i) {
+            std::shared_ptr<age::Box> box(new age::Box({white}, {white}));
+            box->setColor({static_cast<float>(i % 7) / 6.0f, static_cast<float>(i % 5) / 4.0f, 0.5f});
+            box->setScale(glm::vec3(0.4f * spacing));
+            box->setPosition(gridPosition(i) + glm::vec3{0.0f, 0.0f, this->options.dynamic ? 0.5f : 0.2f});
+            if (this->options.dynamic) box->setMass(1.0f);
+            this->addToWorldList(box);
+        }
+
+        // The model's meshes are loaded once and shared by all of its game objects
+        for (auto i = 0u; i < this->options.numModels; ++i) {
+            auto model = std::make_shared<age::GameObject>("models/atv/ATV.3DS");
+            const auto dimensions = model->getScaledDimensions();
+            const auto size = std::max({dimensions.x, dimensions.y, dimensions.z, 1.0e-3f});
+            model->setScale(glm::vec3(0.8f * spacing / size));
+            model->setPosition(gridPosition(this->options.numBoxes + i) + glm::vec3{0.0f, 0.0f, 0.4f * spacing});
+            this->addToWorldList(model);
+        }
+    }
+
+private:
+    Options options;
+};
+
+template<typename T>
+T percentile(const std::vector<T> &sortedSamples, double fraction) {
+    const auto rank = static_cast<size_t>(std::ceil(fraction * sortedSamples.size()));
+    return sortedSamples[std::min(std::max<size_t>(rank, 1), sortedSamples.size()) - 1];
+}
+
+double average(const std::vector<double> &samples) {
+    return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    HostPlatform::setMinLogPriority(options.verbose ? ANDROID_LOG_DEFAULT : ANDROID_LOG_WARN);
+
+    const char *tmpDirectory = std::getenv("TMPDIR");
+    const std::string cacheDirectory = tmpDirectory ? tmpDirectory : "/tmp";
+
+    // Same order as GameEngineJNI::init. Assets load on the calling thread so that
+    // every model is loaded before the first frame.
+    auto env = HostPlatform::getJNIEnv();
+    age::ManagerWindowing::init(options.width, options.height);
+    age::ManagerAssets::init(AAssetManager_fromJava(env, const_cast<char*>(options.assetsDirectory.c_str())));
+    age::AssetLoader::init(0);
+    age::ManagerResources::init();
+
+    std::vector<double> renderDurations, updateDurations; // ms
+    std::vector<RecordingGL::Statistics> glStatistics;
+    std::vector<age::GLState::Statistics> glStateStatistics;
+    age::RenderQueue::Statistics worldStatistics, shadowStatistics;
+    age::Game::ShadowStatistics shadowCacheStatistics;
+
+    try {
+        auto game = std::make_unique<BenchmarkGame>(env, const_cast<char*>(cacheDirectory.c_str()), options);
+        game->onCreate();
+        game->onStart();
+        game->onResume();
+
+        const std::chrono::duration<float> frameDuration(1.0f / 60.0f);
+        for (auto frame = 0u; frame < options.numWarmupFrames + options.numFrames; ++frame) {
+            const auto measured = frame >= options.numWarmupFrames;
+            if (frame == options.numWarmupFrames && !options.tracePath.empty()) {
+                age::Trace::setEnabled(true);
+            }
+
+            const auto updateBegin = std::chrono::steady_clock::now();
+            game->update(frameDuration);
+            const auto updateEnd = std::chrono::steady_clock::now();
+
+            // Same per frame work as GameEngineJNI's renderJNI
+            age::GLState::resetStatistics();
+            RecordingGL::resetStatistics();
+            age::ManagerResources::processTrimMemory();
+            const auto renderBegin = std::chrono::steady_clock::now();
+            game->render();
+            const auto renderEnd = std::chrono::steady_clock::now();
+
+            if (!measured) continue;
+            updateDurations.push_back(Milliseconds(updateEnd - updateBegin).count());
+            renderDurations.push_back(Milliseconds(renderEnd - renderBegin).count());
+            glStatistics.push_back(RecordingGL::getStatistics());
+            glStateStatistics.push_back(age::GLState::getStatistics());
+        }
+
+        worldStatistics = game->getRenderStatistics();
+        shadowStatistics = game->getShadowRenderStatistics();
+        shadowCacheStatistics = game->getShadowStatistics();
+
+        if (!options.tracePath.empty()) {
+            age::Trace::setEnabled(false);
+            age::Trace::writeChromeJson(options.tracePath);
+        }
+
+        game->onPause();
+        game->onStop();
+        game->onDestroy();
+    } catch (const age::Error &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    // Same order as GameEngineJNI's onDestroyJNI
+    age::AssetLoader::shutdown();
+    age::ProgramBinaryCache::shutdown();
+    age::ManagerResources::shutdown();
+    age::ManagerAssets::shutdown();
+    age::ManagerWindowing::shutdown();
+
+    const auto perFrame = [&](auto member){
+        std::vector<double> samples;
+        for (const auto &statistics : glStatistics) samples.push_back(static_cast<double>(statistics.*member));
+        return average(samples);
+    };
+
+    std::vector<double> glStateIssued, glStateSkipped;
+    for (const auto &statistics : glStateStatistics) {
+        glStateIssued.push_back(statistics.numCallsIssued);
+        glStateSkipped.push_back(statistics.numCallsSkipped);
+    }
+
+    auto sortedRenderDurations = renderDurations;
+    std::sort(sortedRenderDurations.begin(), sortedRenderDurations.end());
+
+    std::printf("Scene: %u boxes, %u models%s, %dx%d, %u frames after %u warmup frames\n",
+                options.numBoxes, options.numModels, options.dynamic ? " (dynamic boxes)" : "",
+                options.width, options.height, options.numFrames, options.numWarmupFrames);
+    std::printf("\nCPU time per frame (ms)\n");
+    std::printf("  render   average %.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+                average(renderDurations), percentile(sortedRenderDurations, 0.50),
+                percentile(sortedRenderDurations, 0.95), percentile(sortedRenderDurations, 0.99),
+                sortedRenderDurations.back());
+    std::printf("  update   average %.3f\n", average(updateDurations));
+
+    std::printf("\nGL calls per frame\n");
+    std::printf("  calls                  %10.1f\n", perFrame(&RecordingGL::Statistics::numCalls));
+    std::printf("  draw calls             %10.1f\n", perFrame(&RecordingGL::Statistics::numDrawCalls));
+    std::printf("  instances              %10.1f\n", perFrame(&RecordingGL::Statistics::numInstances));
+    std::printf("  state changes          %10.1f\n", perFrame(&RecordingGL::Statistics::numStateChanges));
+    std::printf("  uniform updates        %10.1f\n", perFrame(&RecordingGL::Statistics::numUniformUpdates));
+    std::printf("  buffer bytes uploaded  %10.1f\n", perFrame(&RecordingGL::Statistics::numBufferBytesUploaded));
+    std::printf("  buffer bytes mapped    %10.1f\n", perFrame(&RecordingGL::Statistics::numBufferBytesMapped));
+    std::printf("  texture bytes uploaded %10.1f\n", perFrame(&RecordingGL::Statistics::numTextureBytesUploaded));
+
+    std::printf("\nEngine per frame\n");
+    std::printf("  GLState issued %.1f, skipped %.1f\n", average(glStateIssued), average(glStateSkipped));
+    std::printf("  world pass: %u draw calls, %u instances, %u shader changes, %u material changes (last frame)\n",
+                worldStatistics.numDrawCalls, worldStatistics.numInstances,
+                worldStatistics.numShaderChanges, worldStatistics.numMaterialChanges);
+    std::printf("  shadow pass: %u draw calls, %u instances (last frame)\n",
+                shadowStatistics.numDrawCalls, shadowStatistics.numInstances);
+    std::printf("  shadow cache: %.2f static layer refresh rate, %u static casters, %u uncached cascades (last frame)\n",
+                shadowCacheStatistics.staticLayerRefreshRate, shadowCacheStatistics.numStaticCasters,
+                shadowCacheStatistics.numUncachedCascades);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * Android asset manager on a desktop host, reading assets from a directory.
+ * Implemented by HostPlatform.cpp.
+ */
+
+#include <cstddef>
+
+#include <sys/types.h>
+
+struct AAssetManager;
+struct AAsset;
+
+enum {
+    AASSET_MODE_UNKNOWN = 0,
+    AASSET_MODE_RANDOM = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER = 3
+};
+
+extern "C" {
+
+AAsset* AAssetManager_open(AAssetManager *manager, const char *filename, int mode);
+
+int AAsset_read(AAsset *asset, void *buffer, size_t count);
+off_t AAsset_seek(AAsset *asset, off_t offset, int whence);
+off_t AAsset_getLength(AAsset *asset);
+off_t AAsset_getRemainingLength(AAsset *asset);
+void AAsset_close(AAsset *asset);
+
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <jni.h>
+
+#include <android/asset_manager.h>
+
+extern "C" AAssetManager* AAssetManager_fromJava(JNIEnv *env, jobject assetManager);
@@ -0,0 +1,20 @@
+#pragma once
+
+/**
+ * Android logging on a desktop host, printed to stderr. Implemented by HostPlatform.cpp.
+ */
+
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+};
+
+extern "C" int __android_log_print(int priority, const char *tag, const char *format, ...)
+        __attribute__((format(printf, 3, 4)));
@@ -0,0 +1,7 @@
+#pragma once
+
+/**
+ * There are no native windows on the host, ManagerWindowing is initialized with dimensions.
+ */
+
+struct ANativeWindow;
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * Subset of the JNI the engine uses, so that games can be created on a desktop host.
+ * Objects are host strings: getCacheDir and getAbsolutePath return the object they're
+ * called on, so a game's application context is the path of its cache directory.
+ * Implemented by HostPlatform.cpp.
+ */
+
+#include <cstdint>
+
+using jint = int32_t;
+using jboolean = uint8_t;
+using jobject = void*;
+using jclass = jobject;
+using jstring = jobject;
+using jmethodID = void*;
+
+#define JNI_OK 0
+#define JNI_ERR (-1)
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+struct JNIEnv;
+
+struct JavaVM {
+    jint GetEnv(void **env, jint version);
+};
+
+struct JNIEnv {
+    jint GetJavaVM(JavaVM **vm);
+
+    jobject NewGlobalRef(jobject object);
+    void DeleteGlobalRef(jobject object);
+    void DeleteLocalRef(jobject object);
+
+    jclass GetObjectClass(jobject object);
+    jmethodID GetMethodID(jclass clazz, const char *name, const char *signature);
+    jobject CallObjectMethod(jobject object, jmethodID method, ...);
+    void CallVoidMethod(jobject object, jmethodID method, ...);
+
+    const char* GetStringUTFChars(jstring string, jboolean *isCopy);
+    void ReleaseStringUTFChars(jstring string, const char *chars);
+};
@@ -0,0 +1,213 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/AABBTree.h>
+#include <android_game_engine/FrustumCuller.h>
+
+namespace {
+
+std::vector<age::AABB> makeRandomBoxes(size_t numBoxes, float worldSize) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> extent(0.1f, 2.0f);
+
+    std::vector<age::AABB> boxes;
+    for (size_t i = 0; i < numBoxes; ++i) {
+        const glm::vec3 center {position(random), position(random), position(random)};
+        const glm::vec3 extents {extent(random), extent(random), extent(random)};
+        boxes.push_back({center - extents, center + extents});
+    }
+    return boxes;
+}
+
+std::vector<int> createProxies(age::AABBTree &tree, const std::vector<age::AABB> &boxes) {
+    std::vector<int> proxies;
+    for (const auto &box : boxes) {
+        proxies.push_back(tree.createProxy(box, nullptr));
+    }
+    return proxies;
+}
+
+///
+/// \brief collect Runs a query and returns the sorted IDs of the proxies it reported.
+///
+template<typename Query>
+std::vector<int> collect(const Query &query) {
+    std::vector<int> proxies;
+    query([&proxies](int proxyId){ proxies.push_back(proxyId); return true; });
+    std::sort(proxies.begin(), proxies.end());
+    return proxies;
+}
+
+///
+/// \brief bruteForce Returns the sorted IDs of the proxies whose enlarged boxes pass a test.
+///
+template<typename Test>
+std::vector<int> bruteForce(const age::AABBTree &tree, const std::vector<int> &proxies, const Test &test) {
+    std::vector<int> result;
+    for (auto proxy : proxies) {
+        if (test(tree.getFatAABB(proxy))) result.push_back(proxy);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+glm::mat4 getProjectionView() {
+    const auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 60.0f);
+    const auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.5f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+bool isInFrustum(const age::FrustumCuller::Planes &planes, const age::AABB &aabb) {
+    const auto center = (aabb.min + aabb.max) * 0.5f;
+    const auto extents = (aabb.max - aabb.min) * 0.5f;
+    for (const auto &plane : planes) {
+        const glm::vec3 normal(plane);
+        if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extents) < 0.0f) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+AGE_TEST(AABBTree, queriesMatchBruteForce) {
+    age::AABBTree tree;
+    const auto proxies = createProxies(tree, makeRandomBoxes(2000, 50.0f));
+    AGE_CHECK(tree.getNumProxies() == proxies.size());
+
+    const age::AABB box {glm::vec3(-10.0f), glm::vec3(15.0f, 5.0f, 20.0f)};
+    const auto boxResult = collect([&](const age::AABBTree::QueryCallback &callback){ tree.queryBox(box, callback); });
+    AGE_CHECK(!boxResult.empty());
+    AGE_CHECK(boxResult == bruteForce(tree, proxies, [&box](const age::AABB &aabb){ return box.overlaps(aabb); }));
+
+    const glm::vec3 center {5.0f, -3.0f, 8.0f};
+    const auto radius = 12.0f;
+    const auto sphereResult = collect([&](const age::AABBTree::QueryCallback &callback){
+        tree.querySphere(center, radius, callback);
+    });
+    AGE_CHECK(!sphereResult.empty());
+    AGE_CHECK(sphereResult == bruteForce(tree, proxies, [&](const age::AABB &aabb){
+        const auto offset = glm::clamp(center, aabb.min, aabb.max) - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }));
+
+    const auto projectionView = getProjectionView();
+    const auto planes = age::FrustumCuller::extractPlanes(projectionView);
+    const auto frustumResult = collect([&](const age::AABBTree::QueryCallback &callback){
+        tree.queryFrustum(projectionView, callback);
+    });
+    AGE_CHECK(!frustumResult.empty());
+    AGE_CHECK(frustumResult == bruteForce(tree, proxies, [&planes](const age::AABB &aabb){ return isInFrustum(planes, aabb); }));
+}
+
+AGE_TEST(AABBTree, raysParallelToAnAxisHitBoxesAlongIt) {
+    age::AABBTree tree(0.0f);
+
+    // The origin lies on the planes of the first box's y and z faces
+    const auto onFaces = tree.createProxy({{2.0f, 0.0f, -1.0f}, {3.0f, 1.0f, 0.0f}}, nullptr);
+    const auto inside = tree.createProxy({{5.0f, -1.0f, -1.0f}, {6.0f, 1.0f, 1.0f}}, nullptr);
+    tree.createProxy({{2.0f, 2.0f, -1.0f}, {3.0f, 3.0f, 1.0f}}, nullptr);    // Beside the ray
+    tree.createProxy({{-3.0f, -1.0f, -1.0f}, {-2.0f, 1.0f, 1.0f}}, nullptr);  // Behind the origin
+    tree.createProxy({{20.0f, -1.0f, -1.0f}, {21.0f, 1.0f, 1.0f}}, nullptr);  // Past the maximum distance
+
+    const auto hits = collect([&](const age::AABBTree::QueryCallback &callback){
+        tree.queryRay(glm::vec3(0.0f), {1.0f, 0.0f, 0.0f}, 10.0f, callback);
+    });
+    AGE_CHECK((hits == std::vector<int>{std::min(onFaces, inside), std::max(onFaces, inside)}));
+
+    // Denormal components have no finite inverse either
+    const auto denormalHits = collect([&](const age::AABBTree::QueryCallback &callback){
+        tree.queryRay(glm::vec3(0.0f), {1.0f, 1.0e-40f, 0.0f}, 10.0f, callback);
+    });
+    AGE_CHECK(denormalHits == hits);
+}
+
+AGE_TEST(AABBTree, proxiesAreOnlyReinsertedOnceTheyLeaveTheirEnlargedBoxes) {
+    age::AABBTree tree(0.5f);
+    const auto proxies = createProxies(tree, makeRandomBoxes(100, 20.0f));
+
+    auto box = tree.getFatAABB(proxies[0]);
+    box.min += glm::vec3(0.5f);
+    box.max -= glm::vec3(0.5f);
+
+    const glm::vec3 smallMove(0.25f, 0.0f, 0.0f);
+    AGE_CHECK(!tree.moveProxy(proxies[0], {box.min + smallMove, box.max + smallMove}));
+
+    const glm::vec3 largeMove(1.0f, 0.0f, 0.0f);
+    AGE_CHECK(tree.moveProxy(proxies[0], {box.min + largeMove, box.max + largeMove}));
+    AGE_CHECK(tree.getFatAABB(proxies[0]).contains({box.min + largeMove, box.max + largeMove}));
+    AGE_CHECK(tree.getNumProxies() == proxies.size());
+}
+
+AGE_TEST(AABBTree, treeStaysBalanced) {
+    // Boxes inserted in order along a line would degenerate into a list without rotations
+    age::AABBTree tree;
+    std::vector<int> proxies;
+    for (auto i = 0; i < 1024; ++i) {
+        const glm::vec3 center(static_cast<float>(i) * 2.0f, 0.0f, 0.0f);
+        proxies.push_back(tree.createProxy({center - glm::vec3(0.5f), center + glm::vec3(0.5f)}, nullptr));
+    }
+    AGE_CHECK(tree.getHeight() <= 20);
+
+    for (size_t i = 0; i < proxies.size(); i += 2) {
+        tree.destroyProxy(proxies[i]);
+    }
+    AGE_CHECK(tree.getNumProxies() == proxies.size() / 2);
+    AGE_CHECK(tree.getHeight() <= 20);
+
+    // Destroyed proxies are no longer reported
+    const auto all = collect([&](const age::AABBTree::QueryCallback &callback){ tree.queryBox(tree.getBounds(), callback); });
+    AGE_CHECK(all.size() == proxies.size() / 2);
+    for (auto proxy : all) {
+        const auto index = std::find(proxies.begin(), proxies.end(), proxy) - proxies.begin();
+        AGE_CHECK(index % 2 == 1);
+    }
+}
+
+AGE_BENCHMARK(AABBTree, queries) {
+    const auto boxes = makeRandomBoxes(10000, 200.0f);
+    const auto projectionView = getProjectionView();
+
+    age::AABBTree tree;
+    std::vector<int> proxies;
+    EngineTests::measure("create 10000 proxies", 20, [&](){ tree = age::AABBTree(); },
+                         [&](){ proxies = createProxies(tree, boxes); });
+
+    unsigned int numVisible = 0;
+    const auto count = [&numVisible](int){ ++numVisible; return true; };
+    EngineTests::measure("frustum query over 10000 proxies", 200, nullptr, [&](){ tree.queryFrustum(projectionView, count); });
+
+    age::FrustumCuller culler;
+    for (const auto &box : boxes) {
+        culler.add((box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f);
+    }
+    std::vector<uint8_t> visibility;
+    EngineTests::measure("frustum cull of 10000 boxes, linear", 200, nullptr, [&](){ culler.cull(projectionView, visibility); });
+
+    EngineTests::measure("sphere query over 10000 proxies", 200, nullptr, [&](){ tree.querySphere(glm::vec3(0.0f), 20.0f, count); });
+
+    // Moves within the margin don't change the tree
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> offset(-0.08f, 0.08f);
+    std::vector<age::AABB> moved(boxes.size());
+    EngineTests::measure("move 10000 proxies by less than the margin", 50,
+                         [&](){
+                             for (size_t i = 0; i < boxes.size(); ++i) {
+                                 const glm::vec3 move {offset(random), offset(random), offset(random)};
+                                 moved[i] = {boxes[i].min + move, boxes[i].max + move};
+                             }
+                         },
+                         [&](){
+                             for (size_t i = 0; i < proxies.size(); ++i) {
+                                 tree.moveProxy(proxies[i], moved[i]);
+                             }
+                         });
+}
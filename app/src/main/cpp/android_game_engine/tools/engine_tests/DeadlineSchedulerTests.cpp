@@ -0,0 +1,99 @@
+#include "Test.h"
+
+#include <chrono>
+#include <thread>
+
+#include <network/DeadlineScheduler.h>
+#include <network/Rate.h>
+
+namespace {
+
+using Clock = ntwk::DeadlineScheduler::Clock;
+using std::chrono::milliseconds;
+
+// Wakeup times are passed to the scheduler, so a fixed start stands in for the clock
+const Clock::time_point start {std::chrono::seconds(1000)};
+constexpr milliseconds period {10};
+
+} // namespace
+
+AGE_TEST(DeadlineScheduler, deadlinesDoNotDriftAfterOversleeping) {
+    ntwk::DeadlineScheduler scheduler(period, start);
+    AGE_CHECK(scheduler.getNextDeadline() == start + period);
+
+    // Waking up late doesn't move the following deadlines
+    AGE_CHECK(scheduler.advance(start + period + milliseconds(3)) == start + 2 * period);
+    AGE_CHECK(scheduler.advance(start + 2 * period + milliseconds(9)) == start + 3 * period);
+
+    // Nor does waking up early
+    AGE_CHECK(scheduler.advance(start + 3 * period - milliseconds(4)) == start + 4 * period);
+
+    for (int cycle = 4; cycle <= 100; ++cycle) {
+        scheduler.advance(scheduler.getNextDeadline() + milliseconds(cycle % 7));
+    }
+    AGE_CHECK(scheduler.getNextDeadline() == start + 101 * period);
+    AGE_CHECK(scheduler.getStatistics().numMissedDeadlines == 0u);
+}
+
+AGE_TEST(DeadlineScheduler, missedPeriodsAreCountedAndSkipped) {
+    ntwk::DeadlineScheduler scheduler(period, start);
+
+    // 2.5 periods late, the deadlines 2 and 3 periods after start have passed
+    AGE_CHECK(scheduler.advance(start + 3 * period + period / 2) == start + 4 * period);
+    AGE_CHECK(scheduler.getStatistics().numCycles == 1u);
+    AGE_CHECK(scheduler.getStatistics().numMissedDeadlines == 2u);
+
+    // Waking up exactly at the next deadline misses the current one
+    AGE_CHECK(scheduler.advance(start + 5 * period) == start + 6 * period);
+    AGE_CHECK(scheduler.getStatistics().numMissedDeadlines == 3u);
+
+    AGE_CHECK(scheduler.advance(start + 6 * period) == start + 7 * period);
+    AGE_CHECK(scheduler.getStatistics().numCycles == 3u);
+    AGE_CHECK(scheduler.getStatistics().numMissedDeadlines == 3u);
+}
+
+AGE_TEST(DeadlineScheduler, jitterIsTheLatenessPastTheDeadline) {
+    ntwk::DeadlineScheduler scheduler(period, start);
+
+    scheduler.advance(start + period);                                 // On time
+    scheduler.advance(start + 2 * period + milliseconds(2));
+    scheduler.advance(start + 3 * period - milliseconds(5));           // Early wakeups aren't late
+    scheduler.advance(start + 4 * period + milliseconds(6));
+
+    auto statistics = scheduler.getStatistics();
+    AGE_CHECK(statistics.numCycles == 4u);
+    AGE_CHECK(statistics.meanJitter == milliseconds(2));
+    AGE_CHECK(statistics.maxJitter == milliseconds(6));
+
+    // Skipped periods aren't jitter of the next deadline, the lateness is measured from the missed one
+    scheduler.advance(start + 7 * period + milliseconds(4));
+    statistics = scheduler.getStatistics();
+    AGE_CHECK(statistics.maxJitter == 2 * period + milliseconds(4));
+    AGE_CHECK(statistics.meanJitter == std::chrono::nanoseconds(milliseconds(8) + 2 * period + milliseconds(4)) / 5);
+
+    scheduler.reset(start + 100 * period);
+    statistics = scheduler.getStatistics();
+    AGE_CHECK(scheduler.getNextDeadline() == start + 101 * period);
+    AGE_CHECK(statistics.numCycles == 0u && statistics.numMissedDeadlines == 0u);
+    AGE_CHECK(statistics.meanJitter == milliseconds(0) && statistics.maxJitter == milliseconds(0));
+}
+
+AGE_TEST(DeadlineScheduler, rateSkipsThePeriodsItOverslept) {
+    // The real clock, so only bounds that hold on a loaded host are checked
+    ntwk::Rate rate(200); // 5 ms
+    rate.sleep();
+    std::this_thread::sleep_for(milliseconds(23));
+    rate.sleep();
+
+    const auto afterOversleep = Clock::now();
+    rate.sleep();
+    rate.sleep();
+
+    // The loop is back on its grid, so the following sleeps wait instead of running back to back
+    AGE_CHECK(Clock::now() - afterOversleep >= milliseconds(5));
+
+    const auto statistics = rate.getStatistics();
+    AGE_CHECK(statistics.numCycles == 4u);
+    AGE_CHECK(statistics.numMissedDeadlines >= 3u);
+    AGE_CHECK(statistics.maxJitter >= milliseconds(15));
+}
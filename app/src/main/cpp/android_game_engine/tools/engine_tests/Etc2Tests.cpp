@@ -0,0 +1,191 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <android_game_engine/Etc2.h>
+
+namespace {
+
+using Block = std::array<uint8_t, 16 * 4>;
+
+///
+/// \brief makeImage Returns an RGBA image of smooth gradients and waves, like a photograph,
+///                  with a few sharp edges.
+///
+std::vector<uint8_t> makeImage(int width, int height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            auto *pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+            const auto u = static_cast<float>(x) / width;
+            const auto v = static_cast<float>(y) / height;
+            const auto edge = (x / 16 + y / 16) % 2 == 0 ? 0.0f : 40.0f;
+            pixel[0] = static_cast<uint8_t>(std::min(255.0f, 200.0f * u + edge));
+            pixel[1] = static_cast<uint8_t>(127.5f + 100.0f * std::sin(6.0f * u + 4.0f * v));
+            pixel[2] = static_cast<uint8_t>(std::min(255.0f, 180.0f * v + edge));
+            pixel[3] = static_cast<uint8_t>(255.0f * (1.0f - u * v));
+        }
+    }
+    return pixels;
+}
+
+///
+/// \brief getPsnr Returns the peak signal to noise ratio in dB of the RGB channels, or of
+///                the alpha channel, of an image and its decompressed copy.
+///
+double getPsnr(const std::vector<uint8_t> &original, const std::vector<uint8_t> &decompressed, bool alpha) {
+    double squaredError = 0.0;
+    size_t numValues = 0;
+    for (size_t i = 0; i < original.size(); ++i) {
+        if ((i % 4 == 3) != alpha) continue;
+        const double difference = static_cast<int>(original[i]) - static_cast<int>(decompressed[i]);
+        squaredError += difference * difference;
+        ++numValues;
+    }
+    if (squaredError == 0.0) return 100.0; // Identical
+    return 10.0 * std::log10(255.0 * 255.0 * numValues / squaredError);
+}
+
+int getLargestRgbError(const Block &original, const Block &decoded) {
+    auto largestError = 0;
+    for (size_t i = 0; i < original.size(); ++i) {
+        if (i % 4 == 3) continue;
+        largestError = std::max(largestError, std::abs(static_cast<int>(original[i]) - static_cast<int>(decoded[i])));
+    }
+    return largestError;
+}
+
+Block roundTripRgb(const Block &pixels) {
+    uint8_t block[age::Etc2::rgbBlockSize];
+    age::Etc2::encodeRgbBlock(pixels.data(), block);
+    Block decoded;
+    age::Etc2::decodeRgbBlock(block, decoded.data());
+    return decoded;
+}
+
+Block roundTripAlpha(const Block &pixels) {
+    uint8_t block[age::Etc2::rgbBlockSize];
+    age::Etc2::encodeAlphaBlock(pixels.data(), block);
+    Block decoded {};
+    age::Etc2::decodeAlphaBlock(block, decoded.data());
+    return decoded;
+}
+
+} // namespace
+
+AGE_TEST(Etc2, solidBlocksRoundTrip) {
+    for (const auto &color : {std::array<uint8_t, 3>{0, 0, 0}, {255, 255, 255}, {255, 0, 0}, {12, 200, 97}, {128, 128, 128}}) {
+        Block pixels;
+        for (size_t i = 0; i < 16; ++i) {
+            pixels[i * 4] = color[0];
+            pixels[i * 4 + 1] = color[1];
+            pixels[i * 4 + 2] = color[2];
+            pixels[i * 4 + 3] = 255;
+        }
+
+        // Base colours of 5 bits plus the smallest modifier get within a few steps of any
+        // colour, and every pixel of the block decodes to the same colour
+        const auto decoded = roundTripRgb(pixels);
+        AGE_CHECK(getLargestRgbError(pixels, decoded) <= 4);
+        for (size_t i = 0; i < 16; ++i) {
+            AGE_CHECK(decoded[i * 4 + 3] == 255);
+            AGE_CHECK(std::equal(decoded.begin() + i * 4, decoded.begin() + i * 4 + 3, decoded.begin()));
+        }
+    }
+}
+
+AGE_TEST(Etc2, gradientBlocksRoundTrip) {
+    // The planar mode represents linear gradients closely
+    Block pixels;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            auto *pixel = &pixels[(y * 4 + x) * 4];
+            pixel[0] = static_cast<uint8_t>(40 + 30 * x);
+            pixel[1] = static_cast<uint8_t>(200 - 25 * y);
+            pixel[2] = static_cast<uint8_t>(60 + 10 * x + 12 * y);
+            pixel[3] = static_cast<uint8_t>(255 - 16 * (x + y));
+        }
+    }
+    AGE_CHECK(getLargestRgbError(pixels, roundTripRgb(pixels)) <= 6);
+
+    const auto decodedAlpha = roundTripAlpha(pixels);
+    for (size_t i = 0; i < 16; ++i) {
+        AGE_CHECK(std::abs(static_cast<int>(decodedAlpha[i * 4 + 3]) - static_cast<int>(pixels[i * 4 + 3])) <= 8);
+    }
+}
+
+AGE_TEST(Etc2, extremeAlphaValuesAreExact) {
+    // Fully transparent and opaque pixels must stay so, e.g. for alpha testing
+    Block pixels {};
+    for (size_t i = 0; i < 16; ++i) {
+        pixels[i * 4 + 3] = i % 3 == 0 ? 0 : 255;
+    }
+    const auto decoded = roundTripAlpha(pixels);
+    for (size_t i = 0; i < 16; ++i) {
+        AGE_CHECK(decoded[i * 4 + 3] == pixels[i * 4 + 3]);
+    }
+}
+
+AGE_TEST(Etc2, imagesRoundTrip) {
+    // Not a multiple of the block size so that edge blocks replicate pixels
+    for (const auto &size : {std::array<int, 2>{64, 64}, {37, 21}, {1, 1}}) {
+        const auto width = size[0], height = size[1];
+        const auto pixels = makeImage(width, height);
+
+        for (auto alpha : {false, true}) {
+            const auto data = age::Etc2::compress(pixels.data(), width, height, alpha);
+            const auto numBlocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+            AGE_CHECK(data.size() == numBlocks * (alpha ? age::Etc2::rgbaBlockSize : age::Etc2::rgbBlockSize));
+            AGE_CHECK(data.size() == age::Etc2::getCompressedSize(width, height, alpha));
+
+            const auto decompressed = age::Etc2::decompress(data.data(), width, height, alpha);
+            AGE_CHECK(decompressed.size() == pixels.size());
+            AGE_CHECK(getPsnr(pixels, decompressed, false) > 35.0);
+            if (alpha) {
+                AGE_CHECK(getPsnr(pixels, decompressed, true) > 40.0);
+            } else {
+                // Without alpha blocks, pixels are opaque
+                AGE_CHECK(getPsnr(std::vector<uint8_t>(pixels.size(), 255), decompressed, true) == 100.0);
+            }
+        }
+    }
+}
+
+AGE_TEST(Etc2, noiseIsEncodedWithBoundedError) {
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> value(0, 255);
+    std::vector<uint8_t> pixels(64 * 64 * 4);
+    for (auto &channel : pixels) channel = static_cast<uint8_t>(value(random));
+
+    // Noise is the worst case, every block still needs a sensible approximation
+    const auto decompressed = age::Etc2::decompress(age::Etc2::compress(pixels.data(), 64, 64, true).data(), 64, 64, true);
+    AGE_CHECK(getPsnr(pixels, decompressed, false) > 12.0);
+    AGE_CHECK(getPsnr(pixels, decompressed, true) > 12.0);
+}
+
+AGE_BENCHMARK(Etc2, compress) {
+    const auto width = 512, height = 512;
+    const auto pixels = makeImage(width, height);
+    const auto numMegapixels = width * height / 1.0e6;
+
+    for (auto alpha : {false, true}) {
+        std::vector<uint8_t> data;
+        EngineTests::measure(alpha ? "compress 512x512 RGBA" : "compress 512x512 RGB", 5, nullptr, [&](){
+            data = age::Etc2::compress(pixels.data(), width, height, alpha);
+        });
+
+        std::vector<uint8_t> decompressed;
+        EngineTests::measure(alpha ? "decompress 512x512 RGBA" : "decompress 512x512 RGB", 20, nullptr, [&](){
+            decompressed = age::Etc2::decompress(data.data(), width, height, alpha);
+        });
+        std::printf("  %.2f megapixels, PSNR RGB %.2f dB", numMegapixels, getPsnr(pixels, decompressed, false));
+        if (alpha) std::printf(", alpha %.2f dB", getPsnr(pixels, decompressed, true));
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,132 @@
+#include "Test.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/FrustumCuller.h>
+
+namespace {
+
+struct Box {
+    glm::vec3 center;
+    glm::vec3 extents;
+};
+
+glm::mat4 getProjectionView() {
+    const auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    const auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+std::vector<Box> makeRandomBoxes(size_t numBoxes) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 5.0f);
+
+    std::vector<Box> boxes;
+    for (size_t i = 0; i < numBoxes; ++i) {
+        boxes.push_back({{position(random), position(random), position(random)},
+                         {extent(random), extent(random), extent(random)}});
+    }
+    return boxes;
+}
+
+///
+/// \brief isVisible Scalar reference of the culler's test: a box is culled when its corner
+///                  furthest along a plane's normal is behind the plane. Terms are summed in
+///                  the culler's order so that the results match exactly.
+///
+bool isVisible(const age::FrustumCuller::Planes &planes, const Box &box) {
+    for (const auto &plane : planes) {
+        const auto distance = plane.w +
+                box.center.x * plane.x + box.center.y * plane.y + box.center.z * plane.z +
+                box.extents.x * std::abs(plane.x) + box.extents.y * std::abs(plane.y) +
+                box.extents.z * std::abs(plane.z);
+        if (distance < 0.0f) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+AGE_TEST(FrustumCuller, boxesOutsideOfAPlaneAreCulled) {
+    const std::vector<Box> visible {
+        {{0.0f, 0.0f, -10.0f}, glm::vec3(1.0f)},
+        {{0.0f, 0.0f, 0.0f}, glm::vec3(1.0f)},    // Intersects the near plane
+        {{0.0f, 0.0f, -100.0f}, glm::vec3(1.0f)}, // Intersects the far plane
+        {{-11.0f, 0.0f, -10.0f}, glm::vec3(2.0f)}, // Intersects the left plane
+    };
+    const std::vector<Box> culled {
+        {{0.0f, 0.0f, 10.0f}, glm::vec3(1.0f)},   // Behind the camera
+        {{0.0f, 0.0f, -200.0f}, glm::vec3(1.0f)}, // Past the far plane
+        {{-30.0f, 0.0f, -10.0f}, glm::vec3(1.0f)},
+        {{0.0f, 20.0f, -10.0f}, glm::vec3(1.0f)},
+    };
+
+    // Interleaved so that the visible and culled boxes share lanes of the vector tests
+    age::FrustumCuller culler;
+    for (size_t i = 0; i < visible.size(); ++i) {
+        culler.add(visible[i].center, visible[i].extents);
+        culler.add(culled[i].center, culled[i].extents);
+    }
+    AGE_CHECK(culler.size() == 8u);
+
+    std::vector<uint8_t> visibility;
+    const auto statistics = culler.cull(getProjectionView(), visibility);
+    AGE_CHECK(statistics.numVisible == 4u);
+    AGE_CHECK(statistics.numCulled == 4u);
+    AGE_CHECK((visibility == std::vector<uint8_t>{1, 0, 1, 0, 1, 0, 1, 0}));
+
+    culler.clear();
+    AGE_CHECK(culler.size() == 0u);
+    AGE_CHECK(culler.cull(getProjectionView(), visibility).numVisible == 0u);
+    AGE_CHECK(visibility.empty());
+}
+
+AGE_TEST(FrustumCuller, matchesTheScalarReference) {
+    // Not a multiple of the vector width so that the remainder is tested as well
+    const auto boxes = makeRandomBoxes(1003);
+    const auto projectionView = getProjectionView();
+    const auto planes = age::FrustumCuller::extractPlanes(projectionView);
+
+    age::FrustumCuller culler;
+    for (const auto &box : boxes) {
+        culler.add(box.center, box.extents);
+    }
+
+    std::vector<uint8_t> visibility;
+    const auto statistics = culler.cull(projectionView, visibility);
+    AGE_CHECK(visibility.size() == boxes.size());
+    AGE_CHECK(statistics.numVisible + statistics.numCulled == boxes.size());
+    AGE_CHECK(statistics.numVisible > 0u && statistics.numCulled > 0u);
+
+    unsigned int numMismatches = 0;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        numMismatches += (visibility[i] != 0) != isVisible(planes, boxes[i]);
+    }
+    AGE_CHECK(numMismatches == 0u);
+}
+
+AGE_BENCHMARK(FrustumCuller, cull) {
+    const auto boxes = makeRandomBoxes(10000);
+    const auto projectionView = getProjectionView();
+    const auto planes = age::FrustumCuller::extractPlanes(projectionView);
+
+    age::FrustumCuller culler;
+    for (const auto &box : boxes) {
+        culler.add(box.center, box.extents);
+    }
+
+    std::vector<uint8_t> visibility;
+    EngineTests::measure("cull 10000 boxes", 200, nullptr, [&](){ culler.cull(projectionView, visibility); });
+    EngineTests::measure("cull 10000 boxes, scalar reference", 200, nullptr, [&](){
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            visibility[i] = isVisible(planes, boxes[i]);
+        }
+    });
+}
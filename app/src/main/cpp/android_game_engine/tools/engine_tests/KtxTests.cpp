@@ -0,0 +1,93 @@
+#include "Test.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/Ktx.h>
+
+namespace {
+
+// Byte offsets of header fields after the 12 byte identifier and the endianness word
+constexpr size_t widthOffset = 16 + 5 * 4;
+constexpr size_t numMipmapLevelsOffset = 16 + 10 * 4;
+
+age::KtxTexture makeTexture(uint32_t width, uint32_t height, uint32_t numFaces, uint32_t numMipmapLevels) {
+    age::KtxTexture texture;
+    texture.glType = 0x1401; // GL_UNSIGNED_BYTE
+    texture.glFormat = 0x1908; // GL_RGBA
+    texture.glInternalFormat = 0x8058; // GL_RGBA8
+    texture.glBaseInternalFormat = 0x1908;
+    texture.width = width;
+    texture.height = height;
+    texture.numFaces = numFaces;
+    texture.numMipmapLevels = numMipmapLevels;
+    for (auto level = 0u; level < numMipmapLevels; ++level) {
+        const auto levelWidth = std::max(width >> level, 1u), levelHeight = std::max(height >> level, 1u);
+        for (auto face = 0u; face < numFaces; ++face) {
+            texture.images.emplace_back(levelWidth * levelHeight * 4, static_cast<uint8_t>(level * numFaces + face));
+        }
+    }
+    return texture;
+}
+
+void setWord(std::vector<uint8_t> &data, size_t offset, uint32_t word) {
+    std::memcpy(&data[offset], &word, sizeof(word));
+}
+
+///
+/// \brief readFails Returns whether reading the data throws a LoadError.
+///
+bool readFails(const std::vector<uint8_t> &data) {
+    try {
+        age::KtxTexture::read(data.data(), data.size());
+    } catch (const age::LoadError&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+AGE_TEST(Ktx, texturesRoundTrip) {
+    for (auto numFaces : {1u, 6u}) {
+        const auto texture = makeTexture(16, 8, numFaces, 5);
+        const auto data = texture.write();
+        const auto read = age::KtxTexture::read(data.data(), data.size());
+
+        AGE_CHECK(read.width == 16u && read.height == 8u);
+        AGE_CHECK(read.numFaces == numFaces);
+        AGE_CHECK(read.numMipmapLevels == 5u);
+        AGE_CHECK(read.images == texture.images);
+    }
+}
+
+AGE_TEST(Ktx, fullMipmapChainsAreAccepted) {
+    // floor(log2(max(width, height))) + 1 levels, down to 1x1
+    for (const auto &size : {std::vector<uint32_t>{1, 1, 1}, {2, 1, 2}, {3, 5, 3}, {1024, 4, 11}}) {
+        const auto data = makeTexture(size[0], size[1], 1, size[2]).write();
+        AGE_CHECK(age::KtxTexture::read(data.data(), data.size()).images.size() == size[2]);
+        AGE_CHECK(readFails(makeTexture(size[0], size[1], 1, size[2] + 1).write()));
+    }
+}
+
+AGE_TEST(Ktx, corruptHeadersAreRejected) {
+    const auto data = makeTexture(16, 16, 6, 5).write();
+
+    // A huge level count fails before any memory is reserved for the images
+    for (auto numMipmapLevels : {6u, 1000u, 0x2AAAAAABu, 0xFFFFFFFFu}) {
+        auto corrupt = data;
+        setWord(corrupt, numMipmapLevelsOffset, numMipmapLevels);
+        AGE_CHECK(readFails(corrupt));
+    }
+
+    for (auto dimension : {0u, 1u}) {
+        auto corrupt = data;
+        setWord(corrupt, widthOffset + dimension * 4, 0);
+        AGE_CHECK(readFails(corrupt));
+    }
+
+    AGE_CHECK(readFails(std::vector<uint8_t>(data.begin(), data.end() - 1)));
+    AGE_CHECK(readFails(std::vector<uint8_t>(data.begin(), data.begin() + 40)));
+}
@@ -0,0 +1,260 @@
+#include "Test.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <android_game_engine/ManagerResources.h>
+
+namespace {
+
+using age::ResourceType;
+namespace ManagerResources = age::ManagerResources;
+
+// Levels of Android's ComponentCallbacks2.onTrimMemory
+constexpr int trimMemoryRunningModerate = 5;
+constexpr int trimMemoryRunningLow = 10;
+constexpr int trimMemoryRunningCritical = 15;
+constexpr int trimMemoryUiHidden = 20;
+
+///
+/// \brief Restarts the resource manager with a budget, and with the default one when the test ends.
+///
+struct ScopedBudget {
+    explicit ScopedBudget(size_t budget) {
+        ManagerResources::shutdown();
+        ManagerResources::init(budget);
+    }
+
+    ~ScopedBudget() {
+        ManagerResources::shutdown();
+        ManagerResources::init();
+    }
+};
+
+///
+/// \brief makeResource Returns a resource that counts how many times it was released.
+///
+std::shared_ptr<int> makeResource(unsigned int &numReleased) {
+    return std::shared_ptr<int>(new int(0), [&numReleased](int *resource){
+        ++numReleased;
+        delete resource;
+    });
+}
+
+std::shared_ptr<int> insertTexture(const std::string &filepath, size_t numBytes, unsigned int &numReleased) {
+    return ManagerResources::insert(ResourceType::TEXTURE, filepath, makeResource(numReleased), numBytes);
+}
+
+void insertUnreferencedTexture(const std::string &filepath, size_t numBytes, unsigned int &numReleased) {
+    insertTexture(filepath, numBytes, numReleased);
+}
+
+bool isTextureResident(const std::string &filepath) {
+    return ManagerResources::isResident(ResourceType::TEXTURE, filepath);
+}
+
+} // namespace
+
+AGE_TEST(ManagerResources, lookupsCountHitsAndMisses) {
+    ScopedBudget budget(1000);
+    unsigned int numReleased = 0;
+
+    AGE_CHECK(ManagerResources::find<int>(ResourceType::TEXTURE, "a.png") == nullptr);
+    auto texture = insertTexture("a.png", 100, numReleased);
+    AGE_CHECK(ManagerResources::find<int>(ResourceType::TEXTURE, "a.png") == texture);
+
+    // Inserting a resident filepath returns the resident resource and counts as a hit
+    unsigned int numDuplicatesReleased = 0;
+    AGE_CHECK(insertTexture("a.png", 100, numDuplicatesReleased) == texture);
+    AGE_CHECK(numDuplicatesReleased == 1u);
+
+    // Types don't share filepaths
+    AGE_CHECK(ManagerResources::find<int>(ResourceType::MESH, "a.png") == nullptr);
+
+    auto statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.numHits == 2u && statistics.numMisses == 1u);
+    AGE_CHECK(statistics.numResident == 1u && statistics.residentBytes == 100u);
+    AGE_CHECK(statistics.numUnreferenced == 0u && statistics.unreferencedBytes == 0u);
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::MESH).numMisses == 1u);
+
+    // Unreferenced resources stay cached, finding them takes them out of the cache
+    texture.reset();
+    statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.numUnreferenced == 1u && statistics.unreferencedBytes == 100u);
+    AGE_CHECK(numReleased == 0u);
+
+    texture = ManagerResources::find<int>(ResourceType::TEXTURE, "a.png");
+    AGE_CHECK(texture != nullptr);
+    statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.numHits == 3u && statistics.numUnreferenced == 0u && statistics.unreferencedBytes == 0u);
+
+    // isResident doesn't count as a lookup
+    AGE_CHECK(isTextureResident("a.png") && !isTextureResident("b.png"));
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numHits == 3u);
+}
+
+AGE_TEST(ManagerResources, leastRecentlyUsedResourcesAreEvictedFirst) {
+    ScopedBudget budget(300);
+    unsigned int numReleased = 0;
+
+    insertUnreferencedTexture("a.png", 100, numReleased);
+    insertUnreferencedTexture("b.png", 100, numReleased);
+    insertUnreferencedTexture("c.png", 100, numReleased);
+
+    // Using a moves it to the front of the cache, so b is the least recently used
+    ManagerResources::find<int>(ResourceType::TEXTURE, "a.png");
+
+    insertUnreferencedTexture("d.png", 100, numReleased);
+    AGE_CHECK(!isTextureResident("b.png"));
+    AGE_CHECK(isTextureResident("a.png") && isTextureResident("c.png") && isTextureResident("d.png"));
+
+    insertUnreferencedTexture("e.png", 100, numReleased);
+    AGE_CHECK(!isTextureResident("c.png"));
+    AGE_CHECK(isTextureResident("a.png") && isTextureResident("d.png") && isTextureResident("e.png"));
+
+    AGE_CHECK(numReleased == 2u);
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numEvictions == 2u);
+}
+
+AGE_TEST(ManagerResources, usedResourcesAreNeverEvicted) {
+    ScopedBudget budget(250);
+    unsigned int numReleased = 0;
+
+    auto a = insertTexture("a.png", 100, numReleased);
+    auto b = insertTexture("b.png", 100, numReleased);
+    auto c = insertTexture("c.png", 100, numReleased);
+
+    // Over budget, but nothing can be evicted
+    auto statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.numResident == 3u && statistics.residentBytes == 300u);
+    AGE_CHECK(numReleased == 0u);
+
+    // Until a resource is released, which is then evicted to meet the budget
+    b.reset();
+    AGE_CHECK(!isTextureResident("b.png"));
+    AGE_CHECK(numReleased == 1u);
+
+    // A copy keeps the resource in use
+    auto copy = a;
+    a.reset();
+    AGE_CHECK(isTextureResident("a.png"));
+    copy.reset();
+    AGE_CHECK(isTextureResident("a.png"));
+
+    // Lowering the budget evicts the unused resources down to it
+    ManagerResources::setBudget(100);
+    AGE_CHECK(ManagerResources::getBudget() == 100u);
+    AGE_CHECK(!isTextureResident("a.png") && isTextureResident("c.png"));
+
+    statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.numResident == 1u && statistics.residentBytes == 100u);
+    AGE_CHECK(statistics.numEvictions == 2u);
+}
+
+AGE_TEST(ManagerResources, evictingAMeshReleasesItsTextures) {
+    ScopedBudget budget(1000);
+    unsigned int numTexturesReleased = 0, numMeshesReleased = 0;
+
+    {
+        // The mesh keeps the texture it uses, like Mesh keeps its Texture2Ds
+        auto texture = insertTexture("mesh.png", 100, numTexturesReleased);
+        auto mesh = std::shared_ptr<int>(new int(0), [&numMeshesReleased, texture](int *resource){
+            ++numMeshesReleased;
+            delete resource;
+        });
+        ManagerResources::insert(ResourceType::MESH, "mesh.obj", mesh, 50);
+    }
+
+    // Only the mesh is unreferenced, the texture is still used by it
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::MESH).numUnreferenced == 1u);
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numUnreferenced == 0u);
+
+    // Evicting the mesh releases the texture, which is evicted by the same call
+    ManagerResources::setBudget(0);
+    AGE_CHECK(numMeshesReleased == 1u && numTexturesReleased == 1u);
+    AGE_CHECK(!ManagerResources::isResident(ResourceType::MESH, "mesh.obj"));
+    AGE_CHECK(!isTextureResident("mesh.png"));
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::MESH).numEvictions == 1u);
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numEvictions == 1u);
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).residentBytes == 0u);
+}
+
+AGE_TEST(ManagerResources, trimMemoryLevelsAreCoalesced) {
+    ScopedBudget budget(400);
+    unsigned int numReleased = 0;
+
+    const auto insertFour = [&numReleased](){
+        for (auto name : {"a.png", "b.png", "c.png", "d.png"}) {
+            insertUnreferencedTexture(name, 100, numReleased);
+        }
+    };
+    insertFour();
+
+    // Nothing is evicted until the GL thread processes the request
+    ManagerResources::onTrimMemory(trimMemoryRunningLow);
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numResident == 4u);
+
+    // Running low evicts down to half the budget, the least recently used first
+    ManagerResources::processTrimMemory();
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).residentBytes == 200u);
+    AGE_CHECK(!isTextureResident("a.png") && !isTextureResident("b.png"));
+
+    // The request was consumed
+    insertFour();
+    ManagerResources::processTrimMemory();
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numResident == 4u);
+
+    // The highest level since the last frame wins, whatever the order of the callbacks
+    std::thread callbacks([](){
+        ManagerResources::onTrimMemory(trimMemoryRunningModerate);
+        ManagerResources::onTrimMemory(trimMemoryRunningCritical);
+        ManagerResources::onTrimMemory(trimMemoryRunningLow);
+    });
+    callbacks.join();
+    ManagerResources::processTrimMemory();
+    AGE_CHECK(ManagerResources::getStatistics(ResourceType::TEXTURE).numResident == 0u);
+
+    // Hiding the UI evicts everything unused, but not what's used
+    insertFour();
+    auto used = ManagerResources::find<int>(ResourceType::TEXTURE, "c.png");
+    ManagerResources::onTrimMemory(trimMemoryUiHidden);
+    ManagerResources::processTrimMemory();
+    auto statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.numResident == 1u && isTextureResident("c.png"));
+
+    // The budget itself is unchanged
+    AGE_CHECK(ManagerResources::getBudget() == 400u);
+}
+
+AGE_TEST(ManagerResources, setSizeUpdatesTheBytesAndEvicts) {
+    ScopedBudget budget(300);
+    unsigned int numReleased = 0;
+
+    // A texture loading in the background is inserted before its size is known
+    auto loading = insertTexture("loading.png", 0, numReleased);
+    insertUnreferencedTexture("a.png", 100, numReleased);
+    insertUnreferencedTexture("b.png", 100, numReleased);
+
+    ManagerResources::setSize(ResourceType::TEXTURE, "loading.png", 100);
+    auto statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.residentBytes == 300u && statistics.numResident == 3u);
+
+    // Growing past the budget evicts the least recently used
+    ManagerResources::setSize(ResourceType::TEXTURE, "loading.png", 150);
+    statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(!isTextureResident("a.png") && isTextureResident("b.png"));
+    AGE_CHECK(statistics.residentBytes == 250u && statistics.unreferencedBytes == 100u);
+
+    // Resizing an unreferenced resource updates the unreferenced bytes too
+    ManagerResources::setSize(ResourceType::TEXTURE, "b.png", 40);
+    statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.residentBytes == 190u && statistics.unreferencedBytes == 40u);
+
+    // Shrinking doesn't evict, resizing a resource that isn't resident is ignored
+    ManagerResources::setSize(ResourceType::TEXTURE, "loading.png", 10);
+    ManagerResources::setSize(ResourceType::TEXTURE, "missing.png", 1000);
+    statistics = ManagerResources::getStatistics(ResourceType::TEXTURE);
+    AGE_CHECK(statistics.residentBytes == 50u && statistics.numResident == 2u);
+    AGE_CHECK(numReleased == 1u);
+}
@@ -0,0 +1,329 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/MeshOptimizer.h>
+
+namespace {
+
+struct Mesh {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::uvec3> indices;
+};
+
+///
+/// \brief makeSphere Returns a closed unit sphere of rings of vertices between two poles,
+///                   with counter-clockwise triangles seen from outside.
+///
+Mesh makeSphere(unsigned int numRings, unsigned int numSegments) {
+    Mesh mesh;
+    mesh.positions.emplace_back(0.0f, 1.0f, 0.0f);
+    for (auto ring = 1u; ring < numRings; ++ring) {
+        const auto polar = glm::pi<float>() * static_cast<float>(ring) / static_cast<float>(numRings);
+        for (auto segment = 0u; segment < numSegments; ++segment) {
+            const auto azimuth = glm::two_pi<float>() * static_cast<float>(segment) / static_cast<float>(numSegments);
+            mesh.positions.emplace_back(std::sin(polar) * std::cos(azimuth), std::cos(polar),
+                                        -std::sin(polar) * std::sin(azimuth));
+        }
+    }
+    mesh.positions.emplace_back(0.0f, -1.0f, 0.0f);
+
+    const auto southPole = static_cast<unsigned int>(mesh.positions.size() - 1);
+    const auto ringVertex = [numSegments](unsigned int ring, unsigned int segment){
+        return 1u + (ring - 1u) * numSegments + segment % numSegments;
+    };
+    for (auto segment = 0u; segment < numSegments; ++segment) {
+        mesh.indices.emplace_back(0u, ringVertex(1, segment), ringVertex(1, segment + 1));
+        for (auto ring = 1u; ring + 1 < numRings; ++ring) {
+            mesh.indices.emplace_back(ringVertex(ring, segment), ringVertex(ring + 1, segment), ringVertex(ring + 1, segment + 1));
+            mesh.indices.emplace_back(ringVertex(ring, segment), ringVertex(ring + 1, segment + 1), ringVertex(ring, segment + 1));
+        }
+        mesh.indices.emplace_back(ringVertex(numRings - 1, segment), southPole, ringVertex(numRings - 1, segment + 1));
+    }
+    return mesh;
+}
+
+///
+/// \brief makeShuffledSphere Returns a sphere with its triangles in random order, like
+///                           the triangles of a poorly ordered imported mesh.
+///
+Mesh makeShuffledSphere(unsigned int numRings, unsigned int numSegments) {
+    auto mesh = makeSphere(numRings, numSegments);
+    std::mt19937 random(1);
+    std::shuffle(mesh.indices.begin(), mesh.indices.end(), random);
+    return mesh;
+}
+
+///
+/// \brief getSortedTriangles Returns triangles rotated to start at their smallest index,
+///                           which keeps their winding, in sorted order.
+///
+std::vector<glm::uvec3> getSortedTriangles(std::vector<glm::uvec3> indices) {
+    for (auto &triangle : indices) {
+        while (triangle.x > triangle.y || triangle.x > triangle.z) {
+            triangle = {triangle.y, triangle.z, triangle.x};
+        }
+    }
+    std::sort(indices.begin(), indices.end(), [](const glm::uvec3 &lhs, const glm::uvec3 &rhs){
+        return std::tie(lhs.x, lhs.y, lhs.z) < std::tie(rhs.x, rhs.y, rhs.z);
+    });
+    return indices;
+}
+
+///
+/// \brief makeGrid Returns a flat, open square grid of quads in the xz plane.
+///
+Mesh makeGrid(unsigned int numQuads) {
+    Mesh mesh;
+    for (auto z = 0u; z <= numQuads; ++z) {
+        for (auto x = 0u; x <= numQuads; ++x) {
+            mesh.positions.emplace_back(static_cast<float>(x), 0.0f, static_cast<float>(z));
+        }
+    }
+
+    const auto vertex = [numQuads](unsigned int x, unsigned int z){ return z * (numQuads + 1u) + x; };
+    for (auto z = 0u; z < numQuads; ++z) {
+        for (auto x = 0u; x < numQuads; ++x) {
+            mesh.indices.emplace_back(vertex(x, z), vertex(x, z + 1), vertex(x + 1, z + 1));
+            mesh.indices.emplace_back(vertex(x, z), vertex(x + 1, z + 1), vertex(x + 1, z));
+        }
+    }
+    return mesh;
+}
+
+///
+/// \brief getSphereDeviation Returns the largest distance between the unit sphere and the
+///                           centroids and edge midpoints of a simplified sphere's triangles.
+///
+float getSphereDeviation(const Mesh &sphere, const std::vector<glm::uvec3> &indices) {
+    auto deviation = 0.0f;
+    for (const auto &triangle : indices) {
+        const auto &a = sphere.positions[triangle[0]];
+        const auto &b = sphere.positions[triangle[1]];
+        const auto &c = sphere.positions[triangle[2]];
+        for (const auto &point : {(a + b + c) / 3.0f, (a + b) * 0.5f, (b + c) * 0.5f, (c + a) * 0.5f}) {
+            deviation = std::max(deviation, 1.0f - glm::length(point));
+        }
+    }
+    return deviation;
+}
+
+bool isUsed(const std::vector<glm::uvec3> &indices, unsigned int vertex) {
+    return std::any_of(indices.begin(), indices.end(), [vertex](const glm::uvec3 &triangle){
+        return triangle.x == vertex || triangle.y == vertex || triangle.z == vertex;
+    });
+}
+
+float getAcmr(const Mesh &mesh) {
+    return age::MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.positions.size()).acmr;
+}
+
+} // namespace
+
+AGE_TEST(MeshOptimizer, vertexCacheIsSimulated) {
+    // Each vertex of a lone triangle is transformed once
+    auto statistics = age::MeshOptimizer::analyzeVertexCache({{0, 1, 2}}, 3);
+    AGE_CHECK(statistics.numTransformedVertices == 3u);
+    AGE_CHECK(statistics.acmr == 3.0f);
+    AGE_CHECK(statistics.atvr == 1.0f);
+
+    // The second triangle of a quad only misses for its last vertex
+    statistics = age::MeshOptimizer::analyzeVertexCache({{0, 1, 2}, {0, 2, 3}}, 4);
+    AGE_CHECK(statistics.numTransformedVertices == 4u);
+    AGE_CHECK(statistics.acmr == 2.0f);
+
+    // A cache of 3 entries has evicted vertex 0 by the time it's referenced again
+    statistics = age::MeshOptimizer::analyzeVertexCache({{0, 1, 2}, {3, 4, 5}, {0, 1, 2}}, 6, 3);
+    AGE_CHECK(statistics.numTransformedVertices == 9u);
+    AGE_CHECK(statistics.atvr == 1.5f);
+}
+
+AGE_TEST(MeshOptimizer, vertexCacheOptimizationLowersAcmr) {
+    auto mesh = makeShuffledSphere(64, 64);
+    const auto triangles = getSortedTriangles(mesh.indices);
+    const auto acmrBefore = getAcmr(mesh);
+
+    age::MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.positions.size());
+    const auto acmrAfter = getAcmr(mesh);
+
+    // Randomly ordered triangles miss for almost every vertex, while a well ordered closed
+    // mesh approaches 0.5 misses per triangle
+    AGE_CHECK(acmrBefore > 2.5f);
+    AGE_CHECK(acmrAfter < 0.8f);
+    AGE_CHECK(getSortedTriangles(mesh.indices) == triangles);
+}
+
+AGE_TEST(MeshOptimizer, overdrawOptimizationStaysWithinItsAcmrThreshold) {
+    auto mesh = makeShuffledSphere(64, 64);
+    const auto triangles = getSortedTriangles(mesh.indices);
+    age::MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.positions.size());
+    const auto acmrBefore = getAcmr(mesh);
+
+    const auto threshold = 1.05f;
+    age::MeshOptimizer::optimizeOverdraw(mesh.indices, mesh.positions, threshold);
+
+    // Clusters are only split where the misses this adds stay within the threshold
+    AGE_CHECK(getAcmr(mesh) <= acmrBefore * threshold);
+    AGE_CHECK(getSortedTriangles(mesh.indices) == triangles);
+}
+
+AGE_TEST(MeshOptimizer, vertexFetchOptimizationOrdersVerticesByFirstReference) {
+    // Vertex 1 isn't referenced and is dropped
+    std::vector<glm::uvec3> indices {{4, 2, 0}, {0, 2, 3}};
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> textureCoordinates;
+    for (auto v = 0; v < 5; ++v) {
+        positions.emplace_back(static_cast<float>(v));
+        normals.emplace_back(static_cast<float>(v) + 10.0f);
+        textureCoordinates.emplace_back(static_cast<float>(v) + 20.0f);
+    }
+    const auto originalIndices = indices;
+    const auto originalPositions = positions;
+
+    age::MeshOptimizer::optimizeVertexFetch(indices, positions, normals, textureCoordinates);
+
+    AGE_CHECK((indices == std::vector<glm::uvec3>{{0, 1, 2}, {2, 1, 3}}));
+    AGE_CHECK(positions.size() == 4u && normals.size() == 4u && textureCoordinates.size() == 4u);
+    for (size_t t = 0; t < indices.size(); ++t) {
+        for (auto i = 0; i < 3; ++i) {
+            const auto v = indices[t][i];
+            AGE_CHECK(positions[v] == originalPositions[originalIndices[t][i]]);
+            AGE_CHECK(normals[v] == positions[v] + 10.0f);
+            AGE_CHECK(textureCoordinates[v] == glm::vec2(positions[v]) + 20.0f);
+        }
+    }
+}
+
+AGE_TEST(MeshOptimizer, simplificationReachesItsTargetNumberOfTriangles) {
+    const auto sphere = makeSphere(64, 64);
+    const auto targetNumTriangles = sphere.indices.size() / 4;
+
+    auto error = -1.0f;
+    const auto indices = age::MeshOptimizer::simplify(sphere.indices, sphere.positions, targetNumTriangles, 1.0f, &error);
+    AGE_CHECK(indices.size() <= targetNumTriangles);
+    AGE_CHECK(indices.size() >= targetNumTriangles * 9 / 10);
+    AGE_CHECK(error > 0.0f && error <= 1.0f);
+
+    // Collapses keep the original vertices and drop the triangles they degenerate
+    AGE_CHECK(std::all_of(indices.begin(), indices.end(), [&sphere](const glm::uvec3 &triangle){
+        return triangle.x != triangle.y && triangle.y != triangle.z && triangle.z != triangle.x &&
+               std::max({triangle.x, triangle.y, triangle.z}) < sphere.positions.size();
+    }));
+
+    // The coarser sphere is still closed: every edge is shared by 2 triangles in opposite directions
+    std::vector<std::pair<unsigned int, unsigned int>> edges, reversedEdges;
+    for (const auto &triangle : indices) {
+        for (auto i = 0; i < 3; ++i) {
+            edges.emplace_back(triangle[i], triangle[(i + 1) % 3]);
+            reversedEdges.emplace_back(triangle[(i + 1) % 3], triangle[i]);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::sort(reversedEdges.begin(), reversedEdges.end());
+    AGE_CHECK(edges == reversedEdges);
+}
+
+AGE_TEST(MeshOptimizer, simplificationStaysWithinItsErrorBound) {
+    const auto sphere = makeSphere(64, 64);
+
+    const auto diameter = 2.0f;
+    const auto originalDeviation = getSphereDeviation(sphere, sphere.indices);
+
+    auto previousNumTriangles = sphere.indices.size() + 1;
+    for (auto targetError : {0.0f, 1.0e-3f, 1.0e-2f, 5.0e-2f}) {
+        auto error = -1.0f;
+        const auto indices = age::MeshOptimizer::simplify(sphere.indices, sphere.positions, 0, targetError, &error);
+        AGE_CHECK(error >= 0.0f && error <= targetError);
+
+        // Errors are root mean square distances relative to the diameter, so the largest
+        // distance to the surface may exceed them somewhat
+        AGE_CHECK(getSphereDeviation(sphere, indices) <= originalDeviation + 2.0f * targetError * diameter);
+
+        // Larger errors allow more collapses
+        AGE_CHECK(indices.size() < previousNumTriangles);
+        previousNumTriangles = indices.size();
+    }
+}
+
+AGE_TEST(MeshOptimizer, simplificationKeepsBordersAndSeams) {
+    // Interior vertices of a flat grid collapse at no error, its border vertices are locked
+    auto grid = makeGrid(8);
+    auto error = -1.0f;
+    auto indices = age::MeshOptimizer::simplify(grid.indices, grid.positions, 0, 0.0f, &error);
+    AGE_CHECK(error == 0.0f);
+    AGE_CHECK(indices.size() < grid.indices.size() / 2);
+    for (auto i = 0u; i <= 8u; ++i) {
+        AGE_CHECK(isUsed(indices, i));                // First row
+        AGE_CHECK(isUsed(indices, 8u * 9u + i));      // Last row
+        AGE_CHECK(isUsed(indices, i * 9u));           // First column
+        AGE_CHECK(isUsed(indices, i * 9u + 8u));      // Last column
+    }
+
+    // A vertex sharing its position with another one, like on a texture seam, is locked too
+    const auto seamVertex = 4u * 9u + 4u;
+    grid.positions.push_back(grid.positions[seamVertex]);
+    for (auto &triangle : grid.indices) {
+        if (triangle.z == seamVertex) triangle.z = static_cast<unsigned int>(grid.positions.size() - 1);
+    }
+    indices = age::MeshOptimizer::simplify(grid.indices, grid.positions, 0, 0.0f);
+    AGE_CHECK(isUsed(indices, seamVertex));
+    AGE_CHECK(isUsed(indices, static_cast<unsigned int>(grid.positions.size() - 1)));
+
+    // Degenerate triangles are dropped even when no collapse is needed
+    const std::vector<glm::uvec3> degenerate {{0, 1, 2}, {3, 3, 4}};
+    AGE_CHECK(age::MeshOptimizer::simplify(degenerate, grid.positions, 2, 0.0f).size() == 1u);
+}
+
+AGE_BENCHMARK(MeshOptimizer, optimize) {
+    // About 130000 triangles
+    const auto shuffled = makeShuffledSphere(256, 256);
+    auto mesh = shuffled;
+    const auto resetMesh = [&](){ mesh = shuffled; };
+
+    EngineTests::measure("optimizeVertexCache, 130000 triangles", 10, resetMesh, [&](){
+        age::MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.positions.size());
+    });
+    const auto optimized = mesh;
+    std::printf("  ACMR %.3f before, %.3f after\n", getAcmr(shuffled), getAcmr(optimized));
+
+    EngineTests::measure("optimizeOverdraw, 130000 triangles", 10, [&](){ mesh = optimized; }, [&](){
+        age::MeshOptimizer::optimizeOverdraw(mesh.indices, mesh.positions);
+    });
+    std::printf("  ACMR %.3f after overdraw optimization\n", getAcmr(mesh));
+
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> textureCoordinates;
+    EngineTests::measure("optimizeVertexFetch, 130000 triangles", 10,
+                         [&](){
+                             mesh = optimized;
+                             normals = mesh.positions;
+                             textureCoordinates.assign(mesh.positions.size(), glm::vec2(0.0f));
+                         },
+                         [&](){
+                             age::MeshOptimizer::optimizeVertexFetch(mesh.indices, mesh.positions,
+                                                                     normals, textureCoordinates);
+                         });
+}
+
+AGE_BENCHMARK(MeshOptimizer, simplify) {
+    // About 130000 triangles
+    const auto sphere = makeSphere(256, 256);
+    for (auto divisor : {2u, 4u, 16u}) {
+        std::vector<glm::uvec3> indices;
+        EngineTests::measure("simplify 130000 triangles to 1/" + std::to_string(divisor), 5, nullptr, [&](){
+            indices = age::MeshOptimizer::simplify(sphere.indices, sphere.positions, sphere.indices.size() / divisor, 1.0f);
+        });
+    }
+}
@@ -0,0 +1,159 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/OcclusionCuller.h>
+
+namespace {
+
+glm::mat4 getProjectionView() {
+    const auto projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+    const auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+///
+/// \brief makeWall Returns a square facing the camera at a distance, centered on the view direction.
+///
+age::OccluderMesh makeWall(float distance, float halfSize) {
+    return {{{-halfSize, -halfSize, -distance}, {halfSize, -halfSize, -distance},
+             {halfSize, halfSize, -distance}, {-halfSize, halfSize, -distance}},
+            {0, 1, 2, 0, 2, 3}};
+}
+
+age::OccluderMesh makeRandomTriangles(size_t numTriangles, unsigned int seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> depth(-60.0f, -1.0f);
+    std::uniform_real_distribution<float> offset(-3.0f, 3.0f);
+
+    age::OccluderMesh mesh;
+    for (size_t i = 0; i < numTriangles; ++i) {
+        const glm::vec3 center {position(random), position(random), depth(random)};
+        for (int vertex = 0; vertex < 3; ++vertex) {
+            mesh.indices.push_back(static_cast<unsigned int>(mesh.positions.size()));
+            mesh.positions.push_back(center + glm::vec3{offset(random), offset(random), offset(random)});
+        }
+    }
+    return mesh;
+}
+
+age::AABB makeBox(const glm::vec3 &center, float extent) {
+    return {center - glm::vec3(extent), center + glm::vec3(extent)};
+}
+
+} // namespace
+
+AGE_TEST(OcclusionCuller, boxesBehindAnOccluderAreHidden) {
+    age::OcclusionCuller culler(256, 128, 1);
+    culler.addOccluder(makeWall(10.0f, 5.0f), glm::mat4(1.0f));
+    AGE_CHECK(culler.getNumOccluderTriangles() == 2u);
+    culler.rasterize(getProjectionView());
+
+    AGE_CHECK(!culler.isVisible(makeBox({0.0f, 0.0f, -20.0f}, 1.0f)));
+    AGE_CHECK(!culler.isVisible(makeBox({2.0f, -2.0f, -50.0f}, 2.0f)));
+    AGE_CHECK(culler.isVisible(makeBox({0.0f, 0.0f, -5.0f}, 1.0f)));   // In front of the wall
+    AGE_CHECK(culler.isVisible(makeBox({0.0f, 0.0f, -10.0f}, 1.0f)));  // Intersects the wall
+    AGE_CHECK(culler.isVisible(makeBox({10.0f, 0.0f, -20.0f}, 1.5f))); // Sticks out past its side
+    AGE_CHECK(culler.isVisible(makeBox({0.0f, 0.0f, 0.0f}, 1.0f)));    // Crosses the near plane
+
+    // Occluders are transformed by their model matrix
+    culler.clearOccluders();
+    culler.addOccluder(makeWall(10.0f, 5.0f), glm::translate(glm::mat4(1.0f), {20.0f, 0.0f, 0.0f}));
+    culler.rasterize(getProjectionView());
+    AGE_CHECK(culler.isVisible(makeBox({0.0f, 0.0f, -20.0f}, 1.0f)));
+}
+
+AGE_TEST(OcclusionCuller, depthBufferDoesNotDependOnThreadsOrTriangleOrder) {
+    const auto projectionView = getProjectionView();
+    auto mesh = makeRandomTriangles(2000, 1);
+
+    age::OcclusionCuller singleThreaded(256, 128, 1);
+    singleThreaded.startWorkers();
+    singleThreaded.addOccluder(mesh, glm::mat4(1.0f));
+    singleThreaded.rasterize(projectionView);
+    AGE_CHECK(singleThreaded.getNumRasterizingThreads() == 1u);
+
+    const auto &depthBuffer = singleThreaded.getDepthBuffer();
+    AGE_CHECK(std::any_of(depthBuffer.begin(), depthBuffer.end(), [](float depth){ return depth < 1.0f; }));
+
+    // Without workers, the calling thread rasterizes all tiles
+    age::OcclusionCuller multiThreaded(256, 128, 4);
+    multiThreaded.addOccluder(mesh, glm::mat4(1.0f));
+    multiThreaded.rasterize(projectionView);
+    AGE_CHECK(multiThreaded.getNumRasterizingThreads() == 1u);
+    AGE_CHECK(multiThreaded.getDepthBuffer() == depthBuffer);
+
+    // Every rasterization reuses the culler's threads
+    multiThreaded.startWorkers();
+    for (int i = 0; i < 3; ++i) {
+        multiThreaded.rasterize(projectionView);
+        AGE_CHECK(multiThreaded.getNumRasterizingThreads() == 4u);
+        AGE_CHECK(multiThreaded.getDepthBuffer() == depthBuffer);
+    }
+
+    // Triangles in reverse order with their vertices in the same order
+    std::vector<unsigned int> reversedIndices;
+    for (auto triangle = mesh.indices.size(); triangle >= 3; triangle -= 3) {
+        reversedIndices.insert(reversedIndices.end(), mesh.indices.begin() + (triangle - 3), mesh.indices.begin() + triangle);
+    }
+    mesh.indices = std::move(reversedIndices);
+    multiThreaded.clearOccluders();
+    multiThreaded.addOccluder(mesh, glm::mat4(1.0f));
+    multiThreaded.rasterize(projectionView);
+    AGE_CHECK(multiThreaded.getDepthBuffer() == depthBuffer);
+}
+
+AGE_TEST(OcclusionCuller, fewTrianglesAreRasterizedByTheCallingThread) {
+    age::OcclusionCuller culler(256, 128, 4);
+    culler.startWorkers();
+    culler.addOccluder(makeWall(10.0f, 5.0f), glm::mat4(1.0f));
+    culler.rasterize(getProjectionView());
+    AGE_CHECK(culler.getNumRasterizingThreads() == 1u);
+    AGE_CHECK(!culler.isVisible(makeBox({0.0f, 0.0f, -20.0f}, 1.0f)));
+}
+
+AGE_BENCHMARK(OcclusionCuller, rasterize) {
+    const auto projectionView = getProjectionView();
+    const auto mesh = makeRandomTriangles(2000, 1);
+
+    for (auto numTriangles : {200u, 2000u}) {
+        const auto triangles = makeRandomTriangles(numTriangles, 1);
+        for (auto numThreads : {1u, 2u, 4u}) {
+            age::OcclusionCuller culler(256, 128, numThreads);
+            culler.startWorkers();
+            culler.addOccluder(triangles, glm::mat4(1.0f));
+            culler.rasterize(projectionView);
+            EngineTests::measure("rasterize " + std::to_string(numTriangles) + " triangles, " +
+                                 std::to_string(culler.getNumRasterizingThreads()) + " of " +
+                                 std::to_string(numThreads) + " threads", 100,
+                                 nullptr, [&](){ culler.rasterize(projectionView); });
+        }
+    }
+
+    age::OcclusionCuller culler;
+    culler.addOccluder(mesh, glm::mat4(1.0f));
+    culler.rasterize(projectionView);
+
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> depth(-90.0f, -1.0f);
+    std::vector<age::AABB> boxes;
+    for (auto i = 0; i < 10000; ++i) {
+        boxes.push_back(makeBox({position(random), position(random), depth(random)}, 0.5f));
+    }
+
+    unsigned int numVisible = 0;
+    EngineTests::measure("test 10000 boxes", 100, [&numVisible](){ numVisible = 0; }, [&](){
+        for (const auto &box : boxes) {
+            numVisible += culler.isVisible(box);
+        }
+    });
+}
@@ -0,0 +1,71 @@
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <asio/io_context.hpp>
+
+#include <network/PeriodicTimer.h>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+///
+/// \brief waitFor Polls a condition for up to a second and returns whether it became true.
+///
+template<typename Condition>
+bool waitFor(Condition condition) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+AGE_TEST(PeriodicTimer, callbacksRunOnTheIoThread) {
+    asio::io_context context;
+    std::atomic<unsigned int> numCallbacks {0};
+    std::thread::id callbackThread;
+
+    std::shared_ptr<ntwk::PeriodicTimer> timer;
+    timer = ntwk::PeriodicTimer::create(context, milliseconds(2), [&](){
+        callbackThread = std::this_thread::get_id();
+        if (++numCallbacks == 3) timer->cancel();
+    });
+
+    // run returns once the cancelled timer has no more waits pending
+    context.run();
+    AGE_CHECK(numCallbacks == 3u);
+    AGE_CHECK(callbackThread == std::this_thread::get_id());
+    AGE_CHECK(timer->getStatistics().numCycles == 3u);
+}
+
+AGE_TEST(PeriodicTimer, cancelIsSafeOffTheIoThread) {
+    asio::io_context context;
+    std::atomic<unsigned int> numCallbacks {0};
+    auto timer = ntwk::PeriodicTimer::create(context, milliseconds(1), [&numCallbacks](){ ++numCallbacks; });
+
+    std::thread ioThread([&context](){ context.run(); });
+    AGE_CHECK(waitFor([&numCallbacks](){ return numCallbacks >= 3u; }));
+
+    // Cancelling aborts the pending wait, which lets run return
+    timer->cancel();
+    const auto numCallbacksWhenCancelled = numCallbacks.load();
+    const auto stopped = waitFor([&context](){ return context.stopped(); });
+    AGE_CHECK(stopped);
+    if (!stopped) context.stop();
+    ioThread.join();
+
+    // A callback already running when cancel was called may finish, no later one starts
+    AGE_CHECK(numCallbacks <= numCallbacksWhenCancelled + 1u);
+    AGE_CHECK(timer->getStatistics().numCycles == numCallbacks);
+
+    // Cancelling again after the io_context stopped is harmless
+    timer->cancel();
+    AGE_CHECK(numCallbacks <= numCallbacksWhenCancelled + 1u);
+}
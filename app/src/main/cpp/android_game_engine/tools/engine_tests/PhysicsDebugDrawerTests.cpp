@@ -0,0 +1,138 @@
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/PhysicsDebugDrawer.h>
+#include <android_game_engine/PhysicsEngine.h>
+#include <android_game_engine/PhysicsRigidBody.h>
+#include <android_game_engine/ShaderProgram.h>
+
+#include "RecordingGL.h"
+
+namespace {
+
+using LineVertex = age::PhysicsDebugDrawer::LineVertex;
+
+// Bullet draws the 12 edges of each box's wireframe and of its AABB
+constexpr size_t numVerticesPerBox = 2 * (12 + 12);
+
+///
+/// \brief Physics world of boxes spaced apart so that none of them touch.
+///
+struct BoxWorld {
+    explicit BoxWorld(unsigned int numBoxes) : physics(&this->shader) {
+        for (auto i = 0u; i < numBoxes; ++i) {
+            this->boxes.emplace_back(new age::PhysicsRigidBody(nullptr, std::unique_ptr<btCollisionShape>(
+                    new btBoxShape({0.5f, 0.5f, 0.5f}))));
+            this->boxes.back()->setPosition({static_cast<float>(i % 32) * 2.0f, static_cast<float>(i / 32) * 2.0f, 0.0f});
+            this->physics.addRigidBody(this->boxes.back().get());
+        }
+    }
+
+    ~BoxWorld() {
+        for (auto &box : this->boxes) {
+            this->physics.removeRigidBody(box.get());
+        }
+    }
+
+    age::ShaderProgram shader {"shaders/PhysicsDebug.vert", "shaders/PhysicsDebug.frag"};
+    age::PhysicsEngine physics;
+    std::vector<std::unique_ptr<age::PhysicsRigidBody>> boxes;
+};
+
+} // namespace
+
+AGE_TEST(PhysicsDebugDrawer, boxesAreDrawnWithOneDrawCallPerFrame) {
+    const auto numBoxes = 100u;
+    BoxWorld world(numBoxes);
+
+    for (auto frame = 0; frame < 3; ++frame) {
+        RecordingGL::resetStatistics();
+        world.physics.renderDebug();
+
+        // One draw of all the lines, uploaded once into the orphaned VBO
+        const auto statistics = RecordingGL::getStatistics();
+        AGE_CHECK(statistics.numDrawCalls == 1u);
+        AGE_CHECK(statistics.numBufferBytesUploaded == numBoxes * numVerticesPerBox * sizeof(LineVertex));
+    }
+}
+
+AGE_TEST(PhysicsDebugDrawer, capturedLinesAreDrawnWithOneDrawCall) {
+    const auto numBoxes = 100u;
+    BoxWorld world(numBoxes);
+
+    // Capturing doesn't call OpenGL
+    std::vector<LineVertex> lines;
+    RecordingGL::resetStatistics();
+    world.physics.captureDebug(lines);
+    AGE_CHECK(lines.size() == numBoxes * numVerticesPerBox);
+    AGE_CHECK(RecordingGL::getStatistics().numCalls == 0u);
+
+    // Capturing again replaces the lines
+    world.physics.captureDebug(lines);
+    AGE_CHECK(lines.size() == numBoxes * numVerticesPerBox);
+
+    for (auto frame = 0; frame < 3; ++frame) {
+        RecordingGL::resetStatistics();
+        world.physics.renderDebug(lines);
+
+        const auto statistics = RecordingGL::getStatistics();
+        AGE_CHECK(statistics.numDrawCalls == 1u);
+        AGE_CHECK(statistics.numBufferBytesUploaded == lines.size() * sizeof(LineVertex));
+    }
+
+    // Nothing to draw, no draw call
+    RecordingGL::resetStatistics();
+    world.physics.renderDebug(std::vector<LineVertex>());
+    AGE_CHECK(RecordingGL::getStatistics().numCalls == 0u);
+}
+
+AGE_TEST(PhysicsDebugDrawer, contactPointsDrawTheNormalAndPenetration) {
+    age::ShaderProgram shader {"shaders/PhysicsDebug.vert", "shaders/PhysicsDebug.frag"};
+    age::PhysicsDebugDrawer drawer(&shader);
+    std::vector<LineVertex> lines;
+    drawer.setCaptureTarget(&lines);
+
+    // Separated contacts only draw their normal
+    drawer.drawContactPoint({1.0f, 2.0f, 3.0f}, {0.0f, 0.0f, 1.0f}, 0.1f, 0, {1.0f, 0.0f, 0.0f});
+    drawer.flushLines();
+    AGE_CHECK(lines.size() == 2u);
+    AGE_CHECK(lines[0].position == glm::vec3(1.0f, 2.0f, 3.0f));
+    AGE_CHECK(lines[1].position.z > 3.0f);
+    AGE_CHECK(lines[0].color == glm::vec3(1.0f, 0.0f, 0.0f) && lines[1].color == lines[0].color);
+
+    // Penetrating contacts also draw the depth along the normal
+    drawer.drawContactPoint({1.0f, 2.0f, 3.0f}, {0.0f, 0.0f, 1.0f}, -0.1f, 0, {1.0f, 0.0f, 0.0f});
+    drawer.drawContactPoint({0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, -0.2f, 0, {0.0f, 1.0f, 0.0f});
+    drawer.flushLines();
+    AGE_CHECK(lines.size() == 8u);
+    AGE_CHECK(lines[3].position == glm::vec3(1.0f, 2.0f, 3.0f - 0.1f));
+    AGE_CHECK(lines[7].position == glm::vec3(-0.2f, 0.0f, 0.0f));
+
+    // Drawn with one draw call
+    drawer.setCaptureTarget(nullptr);
+    RecordingGL::resetStatistics();
+    drawer.drawLines(lines);
+    const auto statistics = RecordingGL::getStatistics();
+    AGE_CHECK(statistics.numDrawCalls == 1u);
+    AGE_CHECK(statistics.numBufferBytesUploaded == 8u * sizeof(LineVertex));
+}
+
+AGE_BENCHMARK(PhysicsDebugDrawer, drawBoxes) {
+    BoxWorld world(1000);
+
+    std::vector<LineVertex> lines;
+    EngineTests::measure("capture 1000 boxes", 50, nullptr, [&](){
+        world.physics.captureDebug(lines);
+    });
+    EngineTests::measure("draw 1000 captured boxes", 50, nullptr, [&](){
+        world.physics.renderDebug(lines);
+    });
+    EngineTests::measure("draw 1000 boxes", 50, nullptr, [&](){
+        world.physics.renderDebug();
+    });
+}
@@ -0,0 +1,199 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <android_game_engine/ProgramBinaryCache.h>
+
+namespace {
+
+namespace Cache = age::ProgramBinaryCache;
+
+///
+/// \brief TemporaryCache Enables the cache in a new temporary directory, and disables it
+///                       and removes the directory when destroyed.
+///
+class TemporaryCache {
+public:
+    explicit TemporaryCache(size_t maxBytes=4u * 1024u * 1024u) {
+        char directory[] = "/tmp/age_program_binaries_XXXXXX";
+        if (mkdtemp(directory) != nullptr) this->directory = directory;
+        Cache::init(this->directory, maxBytes);
+    }
+
+    ~TemporaryCache() {
+        Cache::shutdown();
+        for (const auto &filename : this->getFilenames()) {
+            std::remove((this->directory + '/' + filename).c_str());
+        }
+        rmdir(this->directory.c_str());
+    }
+
+    std::vector<std::string> getFilenames() const {
+        std::vector<std::string> filenames;
+        if (auto dir = opendir(this->directory.c_str())) {
+            while (auto entry = readdir(dir)) {
+                const std::string filename = entry->d_name;
+                if (filename != "." && filename != "..") filenames.push_back(filename);
+            }
+            closedir(dir);
+        }
+        return filenames;
+    }
+
+    std::string directory;
+};
+
+Cache::ProgramBinary makeBinary(uint32_t format, size_t numBytes) {
+    Cache::ProgramBinary binary;
+    binary.format = format;
+    for (size_t i = 0; i < numBytes; ++i) {
+        binary.data.push_back(static_cast<uint8_t>(i * 31u + format));
+    }
+    return binary;
+}
+
+bool exists(const std::string &filepath) {
+    struct stat fileStat;
+    return stat(filepath.c_str(), &fileStat) == 0;
+}
+
+///
+/// \brief setLastUsedTime Sets the modification time pruning orders binaries by, since
+///                        binaries stored within a second otherwise can't be told apart.
+///
+void setLastUsedTime(const std::string &filepath, time_t time) {
+    const utimbuf times {time, time};
+    utime(filepath.c_str(), &times);
+}
+
+} // namespace
+
+AGE_TEST(ProgramBinaryCache, keysAreStable) {
+    const std::vector<std::string> parts {"#version 320 es\nvoid main() {}", "void main() {}", "Vendor", "Renderer", "OpenGL ES 3.2"};
+    const auto key = Cache::computeKey(parts);
+    AGE_CHECK(key == Cache::computeKey(parts));
+
+    // Keys name files that outlive the app, they must not change between builds or devices
+    AGE_CHECK(Cache::computeKey({}) == 0xad2aca7747985764ull);
+    AGE_CHECK(Cache::computeKey({"abc"}) == 0x825e049f5721b329ull);
+
+    // Every part, its position and its boundaries are hashed
+    AGE_CHECK(Cache::computeKey({"ab", "c"}) != Cache::computeKey({"a", "bc"}));
+    AGE_CHECK(Cache::computeKey({"a", "b"}) != Cache::computeKey({"b", "a"}));
+    AGE_CHECK(Cache::computeKey({}) != Cache::computeKey({""}));
+    auto changedParts = parts;
+    changedParts.back() = "OpenGL ES 3.1";
+    AGE_CHECK(Cache::computeKey(changedParts) != key);
+}
+
+AGE_TEST(ProgramBinaryCache, binariesRoundTrip) {
+    const auto binary = makeBinary(7, 1000);
+    const auto key = Cache::computeKey({"binariesRoundTrip"});
+
+    // Disabled until initialized
+    AGE_CHECK(!Cache::isEnabled());
+    Cache::store(key, binary);
+    AGE_CHECK(Cache::load(key) == nullptr);
+
+    TemporaryCache cache;
+    AGE_CHECK(Cache::isEnabled());
+    AGE_CHECK(Cache::getFilepath(0x1234abcdull) == cache.directory + "/000000001234abcd.bin");
+    AGE_CHECK(Cache::load(key) == nullptr);
+
+    Cache::store(key, binary);
+    const auto loaded = Cache::load(key);
+    AGE_CHECK(loaded != nullptr && loaded->format == binary.format && loaded->data == binary.data);
+
+    // Only the binary remains, no temporary file
+    AGE_CHECK(cache.getFilenames().size() == 1u);
+
+    Cache::remove(key);
+    AGE_CHECK(Cache::load(key) == nullptr);
+    AGE_CHECK(cache.getFilenames().empty());
+}
+
+AGE_TEST(ProgramBinaryCache, corruptBinariesAreRemoved) {
+    TemporaryCache cache;
+    const auto binary = makeBinary(3, 200);
+    const auto key = Cache::computeKey({"corruptBinariesAreRemoved"});
+    const auto filepath = Cache::getFilepath(key);
+
+    const auto corrupt = [&](long offset, const std::string &bytes){
+        Cache::store(key, binary);
+        auto file = std::fopen(filepath.c_str(), "r+b");
+        std::fseek(file, offset, offset < 0 ? SEEK_END : SEEK_SET);
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+    };
+
+    // Flipped data, failing the checksum
+    corrupt(-1, "\xff");
+    AGE_CHECK(Cache::load(key) == nullptr);
+    AGE_CHECK(!exists(filepath));
+
+    // Wrong magic
+    corrupt(0, "XXXX");
+    AGE_CHECK(Cache::load(key) == nullptr);
+    AGE_CHECK(!exists(filepath));
+
+    // Appended bytes
+    Cache::store(key, binary);
+    auto file = std::fopen(filepath.c_str(), "ab");
+    std::fputc(0, file);
+    std::fclose(file);
+    AGE_CHECK(Cache::load(key) == nullptr);
+    AGE_CHECK(!exists(filepath));
+
+    // Truncated, e.g. by a full disk
+    Cache::store(key, binary);
+    AGE_CHECK(truncate(filepath.c_str(), 100) == 0);
+    AGE_CHECK(Cache::load(key) == nullptr);
+    AGE_CHECK(!exists(filepath));
+
+    // Stored under another key
+    const auto otherKey = Cache::computeKey({"another key"});
+    Cache::store(otherKey, binary);
+    AGE_CHECK(std::rename(Cache::getFilepath(otherKey).c_str(), filepath.c_str()) == 0);
+    AGE_CHECK(Cache::load(key) == nullptr);
+    AGE_CHECK(!exists(filepath));
+
+    AGE_CHECK(cache.getFilenames().empty());
+}
+
+AGE_TEST(ProgramBinaryCache, leastRecentlyUsedBinariesArePruned) {
+    // Room for 2 binaries of 1000 bytes and their headers
+    TemporaryCache cache(2500);
+    const auto binary = makeBinary(1, 1000);
+    const auto first = Cache::computeKey({"first"});
+    const auto second = Cache::computeKey({"second"});
+    const auto third = Cache::computeKey({"third"});
+    const auto now = std::time(nullptr);
+
+    Cache::store(first, binary);
+    setLastUsedTime(Cache::getFilepath(first), now - 100);
+    Cache::store(second, binary);
+    setLastUsedTime(Cache::getFilepath(second), now - 50);
+    AGE_CHECK(cache.getFilenames().size() == 2u);
+
+    // Loading the first binary makes the second one the least recently used
+    AGE_CHECK(Cache::load(first) != nullptr);
+    Cache::store(third, binary);
+    AGE_CHECK(exists(Cache::getFilepath(first)));
+    AGE_CHECK(!exists(Cache::getFilepath(second)));
+    AGE_CHECK(exists(Cache::getFilepath(third)));
+
+    // A binary larger than the limit evicts all others but is kept itself
+    const auto large = Cache::computeKey({"large"});
+    Cache::store(large, makeBinary(2, 4000));
+    AGE_CHECK(cache.getFilenames().size() == 1u);
+    AGE_CHECK(Cache::load(large) != nullptr);
+}
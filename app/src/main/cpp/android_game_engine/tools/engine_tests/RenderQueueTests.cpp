@@ -0,0 +1,205 @@
+#include "Test.h"
+
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/Box.h>
+#include <android_game_engine/Mesh.h>
+#include <android_game_engine/RenderQueue.h>
+#include <android_game_engine/ShaderProgram.h>
+#include <android_game_engine/Texture2D.h>
+#include <android_game_engine/UniformBuffer.h>
+
+#include "RecordingGL.h"
+
+namespace {
+
+using Pass = age::RenderQueue::Pass;
+
+struct Shaders {
+    age::ShaderProgram first {"shaders/Default.vert", "shaders/Default.frag"};
+    age::ShaderProgram second {"shaders/ShadowMap.vert", "shaders/ShadowMap.frag"};
+};
+
+std::unique_ptr<age::Box> makeBox(const age::Texture2D &texture) {
+    return std::unique_ptr<age::Box>(new age::Box(std::vector<age::Texture2D>{texture},
+                                                  std::vector<age::Texture2D>{texture}));
+}
+
+///
+/// \brief renderShaders Renders a layer of a pass and returns the shaders in the order they were used.
+///
+std::vector<age::ShaderProgram*> renderShaders(age::RenderQueue &queue, Pass pass, unsigned int layer=0) {
+    std::vector<age::ShaderProgram*> shaders;
+    queue.render(pass, [&shaders](age::ShaderProgram *shader){ shaders.push_back(shader); }, layer);
+    return shaders;
+}
+
+} // namespace
+
+AGE_TEST(RenderQueue, opaqueItemsAreGroupedByShaderAndMerged) {
+    Shaders shaders;
+    const age::Texture2D white(glm::vec3(1.0f));
+    const auto box = makeBox(white);
+
+    age::RenderQueue queue;
+    for (auto i = 0u; i < 20u; ++i) {
+        auto *shader = i % 2 == 0 ? &shaders.first : &shaders.second;
+        queue.add(Pass::WORLD, box.get(), shader, nullptr, static_cast<float>((i * 7u) % 11u));
+    }
+    queue.sort();
+
+    AGE_CHECK(renderShaders(queue, Pass::WORLD).size() == 2u);
+
+    const auto statistics = queue.getStatistics(Pass::WORLD);
+    AGE_CHECK(statistics.numShaderChanges == 2u);
+    AGE_CHECK(statistics.numDrawCalls == 2u);
+    AGE_CHECK(statistics.numInstances == 20u);
+}
+
+AGE_TEST(RenderQueue, translucentItemsAreDrawnBackToFrontAfterOpaqueItems) {
+    Shaders shaders;
+    const age::Texture2D white(glm::vec3(1.0f));
+    const auto box = makeBox(white);
+
+    age::RenderQueue queue;
+
+    // Alternating shaders show the order of the translucent items, which are added out of order
+    const std::array<float, 5> depths {3.0f, 1.0f, 5.0f, 2.0f, 4.0f};
+    const auto translucentShader = [&shaders](float depth){
+        return static_cast<int>(depth) % 2 == 0 ? &shaders.first : &shaders.second;
+    };
+    for (auto depth : depths) {
+        queue.add(Pass::WORLD, box.get(), translucentShader(depth), nullptr, depth, true);
+    }
+    queue.add(Pass::WORLD, box.get(), &shaders.first, nullptr, 10.0f);
+    queue.sort();
+
+    const std::vector<age::ShaderProgram*> expected {
+        &shaders.first, // Opaque
+        translucentShader(5.0f), translucentShader(4.0f), translucentShader(3.0f),
+        translucentShader(2.0f), translucentShader(1.0f)
+    };
+    AGE_CHECK(renderShaders(queue, Pass::WORLD) == expected);
+    AGE_CHECK(queue.getStatistics(Pass::WORLD).numDrawCalls == 6u);
+}
+
+AGE_TEST(RenderQueue, opaqueItemsOfAShaderAreSortedByMaterial) {
+    Shaders shaders;
+    const age::MaterialUniforms uniforms(shaders.first);
+    const age::Texture2D white(glm::vec3(1.0f));
+    const age::Texture2D grey(glm::vec3(0.5f));
+    const auto whiteBox = makeBox(white);
+    const auto greyBox = makeBox(grey);
+
+    age::RenderQueue queue;
+    for (auto i = 0u; i < 10u; ++i) {
+        queue.add(Pass::WORLD, i % 2 == 0 ? whiteBox.get() : greyBox.get(), &shaders.first, &uniforms,
+                  static_cast<float>(i));
+    }
+    queue.sort();
+    renderShaders(queue, Pass::WORLD);
+
+    const auto statistics = queue.getStatistics(Pass::WORLD);
+    AGE_CHECK(statistics.numShaderChanges == 1u);
+    AGE_CHECK(statistics.numMaterialChanges == 2u);
+    AGE_CHECK(statistics.numDrawCalls == 2u);
+    AGE_CHECK(statistics.numInstances == 10u);
+}
+
+AGE_TEST(RenderQueue, passesAndLayersAreRenderedSeparately) {
+    Shaders shaders;
+    const age::Texture2D white(glm::vec3(1.0f));
+    const auto box = makeBox(white);
+
+    age::RenderQueue queue;
+    for (auto i = 0u; i < 3u; ++i) {
+        queue.add(Pass::SHADOW, box.get(), &shaders.second, nullptr, static_cast<float>(i), false, 0, 1);
+    }
+    for (auto i = 0u; i < 2u; ++i) {
+        queue.add(Pass::WORLD, box.get(), &shaders.first, nullptr, static_cast<float>(i));
+    }
+    queue.sort();
+
+    AGE_CHECK(renderShaders(queue, Pass::SHADOW, 0).empty());
+    AGE_CHECK(renderShaders(queue, Pass::SHADOW, 1) == std::vector<age::ShaderProgram*>{&shaders.second});
+    AGE_CHECK(queue.getStatistics(Pass::SHADOW, 1).numInstances == 3u);
+    AGE_CHECK(renderShaders(queue, Pass::WORLD) == std::vector<age::ShaderProgram*>{&shaders.first});
+    AGE_CHECK(queue.getStatistics(Pass::WORLD).numInstances == 2u);
+
+    queue.clear();
+    AGE_CHECK(renderShaders(queue, Pass::WORLD).empty());
+}
+
+AGE_TEST(RenderQueue, drawUniformsGrowTheRing) {
+    Shaders shaders;
+    const age::MaterialUniforms uniforms(shaders.first);
+    const age::Texture2D white(glm::vec3(1.0f));
+    const auto box = makeBox(white);
+
+    // Far more distinct specular exponents than fit in the ring's initial regions
+    age::UniformBufferRing ring("DrawUB", sizeof(age::RenderQueue::DrawUniforms));
+    age::RenderQueue queue;
+    for (auto frame = 0u; frame < 4u; ++frame) {
+        queue.clear();
+        for (auto i = 0u; i < 100u * (frame + 1u); ++i) {
+            queue.add(Pass::WORLD, box->getMeshes(), box->getInstance(), static_cast<float>(i),
+                      &shaders.first, &uniforms, static_cast<float>(i));
+        }
+        queue.sort();
+        queue.writeDrawUniforms(ring);
+        renderShaders(queue, Pass::WORLD);
+        AGE_CHECK(queue.getStatistics(Pass::WORLD).numInstances == 100u * (frame + 1u));
+    }
+}
+
+AGE_TEST(RenderQueue, drawUniformsDontWaitForeverOnAHungGpu) {
+    // Regions are reused after 3 frames, once their fences never signal
+    age::UniformBufferRing ring("DrawUB", 256);
+    age::RenderQueue::DrawUniforms uniforms;
+    RecordingGL::setFencesSignaled(false);
+
+    for (auto frame = 0u; frame < 6u; ++frame) {
+        ring.beginFrame(ring.getAlignedSize(sizeof(uniforms)));
+        const auto offset = ring.push(&uniforms, sizeof(uniforms));
+        ring.flush();
+        AGE_CHECK(offset % ring.getAlignedSize(1) == 0u);
+    }
+
+    RecordingGL::setFencesSignaled(true);
+}
+
+AGE_BENCHMARK(RenderQueue, sort) {
+    Shaders shaders;
+    const age::MaterialUniforms uniforms(shaders.first);
+
+    // Items spread over 2 shaders and 8 materials, at random depths, a fifth of them translucent
+    std::vector<age::Texture2D> textures;
+    std::vector<std::unique_ptr<age::Box>> boxes;
+    for (auto i = 0u; i < 8u; ++i) {
+        textures.emplace_back(glm::vec3(static_cast<float>(i) / 8.0f));
+        boxes.push_back(makeBox(textures.back()));
+    }
+
+    constexpr unsigned int numItems = 10000;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> depth(0.0f, 100.0f);
+
+    age::RenderQueue queue;
+    const auto fill = [&](){
+        queue.clear();
+        for (auto i = 0u; i < numItems; ++i) {
+            const auto &box = *boxes[random() % boxes.size()];
+            auto *shader = random() % 2 == 0 ? &shaders.first : &shaders.second;
+            queue.add(Pass::WORLD, box.getMeshes(), box.getInstance(), box.getSpecularExponent(),
+                      shader, &uniforms, depth(random), random() % 5 == 0);
+        }
+    };
+
+    EngineTests::measure("add 10000 items", 50, nullptr, fill);
+    EngineTests::measure("sort 10000 items", 50, fill, [&queue](){ queue.sort(); });
+}
@@ -0,0 +1,180 @@
+#include "Test.h"
+
+#include <array>
+#include <cmath>
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/ShadowCascades.h>
+
+namespace {
+
+constexpr float fieldOfView = glm::radians(45.0f);
+constexpr float aspectRatio = 16.0f / 9.0f;
+constexpr float nearPlane = 0.1f;
+constexpr float farPlane = 500.0f;
+
+const age::AABB casterBounds {{-100.0f, -100.0f, 0.0f}, {100.0f, 100.0f, 20.0f}};
+
+struct Camera {
+    glm::vec3 position;
+    glm::vec3 lookAtPoint;
+
+    glm::mat4 getView() const {
+        return glm::lookAt(this->position, this->lookAtPoint, glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    glm::mat4 getProjectionView() const {
+        return glm::perspective(fieldOfView, aspectRatio, nearPlane, farPlane) * this->getView();
+    }
+};
+
+void update(age::ShadowCascades &cascades, const Camera &camera, const glm::vec3 &lightDirection) {
+    cascades.update(camera.getProjectionView(), nearPlane, farPlane, lightDirection, casterBounds);
+}
+
+///
+/// \brief getSliceCorners Returns the corners of the view frustum between two view depths.
+///
+std::array<glm::vec3, 8> getSliceCorners(const Camera &camera, float nearDepth, float farDepth) {
+    const auto inverseView = glm::inverse(camera.getView());
+    const auto tanHalfFov = std::tan(fieldOfView / 2.0f);
+
+    std::array<glm::vec3, 8> corners;
+    for (int i = 0; i < 8; ++i) {
+        const auto depth = (i & 4) ? farDepth : nearDepth;
+        const glm::vec3 viewCorner((i & 1 ? 1.0f : -1.0f) * depth * tanHalfFov * aspectRatio,
+                                   (i & 2 ? 1.0f : -1.0f) * depth * tanHalfFov,
+                                   -depth);
+        corners[i] = glm::vec3(inverseView * glm::vec4(viewCorner, 1.0f));
+    }
+    return corners;
+}
+
+bool isInside(const glm::mat4 &lightSpace, const glm::vec3 &point) {
+    const auto clip = lightSpace * glm::vec4(point, 1.0f);
+    const auto tolerance = 1.0e-4f;
+    return std::abs(clip.x) <= 1.0f + tolerance && std::abs(clip.y) <= 1.0f + tolerance &&
+           std::abs(clip.z) <= 1.0f + tolerance;
+}
+
+} // namespace
+
+AGE_TEST(ShadowCascades, splitsIncreaseUpToTheShadowDistance) {
+    const Camera camera {{0.0f, -20.0f, 10.0f}, {0.0f, 0.0f, 0.0f}};
+
+    for (auto numCascades = 1u; numCascades <= age::ShadowCascades::maxCascades; ++numCascades) {
+        for (auto splitWeight : {0.0f, 0.5f, 0.75f, 1.0f}) {
+            age::ShadowCascades cascades(numCascades, 1024, 50.0f, splitWeight);
+            update(cascades, camera, {1.0f, 1.0f, -1.0f});
+
+            auto previousSplit = nearPlane;
+            for (auto cascade = 0u; cascade < numCascades; ++cascade) {
+                AGE_CHECK(cascades.getSplitDistance(cascade) > previousSplit);
+                previousSplit = cascades.getSplitDistance(cascade);
+            }
+            AGE_CHECK(std::abs(cascades.getSplitDistance(numCascades - 1) - 50.0f) < 1.0e-3f);
+
+            // Logarithmic splits give the near cascades more of the shadow map than uniform ones
+            if (numCascades > 1 && splitWeight == 1.0f) {
+                AGE_CHECK(cascades.getSplitDistance(0) < 50.0f / numCascades);
+            }
+        }
+    }
+
+    // Shadows stop at the far plane when it's closer than the shadow distance
+    age::ShadowCascades cascades(3, 1024, 1000.0f);
+    update(cascades, camera, {1.0f, 1.0f, -1.0f});
+    AGE_CHECK(std::abs(cascades.getSplitDistance(2) - farPlane) < 1.0e-2f);
+}
+
+AGE_TEST(ShadowCascades, cascadesCoverTheirSlices) {
+    for (const auto &camera : {Camera{{0.0f, -20.0f, 10.0f}, {0.0f, 0.0f, 0.0f}},
+                               Camera{{35.0f, 12.0f, 3.0f}, {-10.0f, 40.0f, 2.0f}},
+                               Camera{{0.0f, 0.0f, 60.0f}, {1.0f, 1.0f, 0.0f}}}) {
+        for (const auto &lightDirection : {glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                                           glm::vec3(-0.3f, 0.8f, -0.2f)}) {
+            age::ShadowCascades cascades(age::ShadowCascades::maxCascades, 1024, 80.0f);
+            update(cascades, camera, lightDirection);
+
+            auto sliceNear = nearPlane;
+            for (auto cascade = 0u; cascade < cascades.getNumCascades(); ++cascade) {
+                const auto &lightSpace = cascades.getLightSpaceMatrix(cascade);
+                const auto sliceFar = cascades.getSplitDistance(cascade);
+                for (const auto &corner : getSliceCorners(camera, sliceNear, sliceFar)) {
+                    AGE_CHECK(isInside(lightSpace, corner));
+                }
+
+                // Casters between the light and the slice aren't clipped by the near plane
+                for (int i = 0; i < 8; ++i) {
+                    const glm::vec3 corner((i & 1) ? casterBounds.max.x : casterBounds.min.x,
+                                           (i & 2) ? casterBounds.max.y : casterBounds.min.y,
+                                           (i & 4) ? casterBounds.max.z : casterBounds.min.z);
+                    AGE_CHECK((lightSpace * glm::vec4(corner, 1.0f)).z >= -1.0f - 1.0e-4f);
+                }
+
+                sliceNear = sliceFar;
+            }
+        }
+    }
+}
+
+AGE_TEST(ShadowCascades, subTexelMovesKeepTheProjection) {
+    // Straight down, so moving the camera along x only moves the cascades along the light's x
+    const glm::vec3 lightDirection(0.0f, 0.0f, -1.0f);
+    const auto resolution = 1024u;
+    age::ShadowCascades cascades(3, resolution, 50.0f);
+
+    Camera camera {{0.0f, -20.0f, 10.0f}, {0.0f, 0.0f, 0.0f}};
+    update(cascades, camera, lightDirection);
+
+    for (auto cascade = 0u; cascade < cascades.getNumCascades(); ++cascade) {
+        // Width of a texel in world units, from the scale of the light projection
+        const auto texelSize = 2.0f / (cascades.getLightSpaceMatrix(cascade)[0][0] * resolution);
+
+        // Moving by less than a texel crosses at most one texel edge
+        age::ShadowCascades moved(3, resolution, 50.0f);
+        auto lightSpace = cascades.getLightSpaceMatrix(cascade);
+        auto numChanges = 0u;
+        for (auto step = 1; step <= 8; ++step) {
+            const auto offset = glm::vec3(step * 0.1f * texelSize, 0.0f, 0.0f);
+            update(moved, {camera.position + offset, camera.lookAtPoint + offset}, lightDirection);
+
+            const auto &movedLightSpace = moved.getLightSpaceMatrix(cascade);
+            if (movedLightSpace != lightSpace) {
+                ++numChanges;
+
+                // By exactly one texel, the size and depth range stay the same
+                AGE_CHECK(movedLightSpace[0] == lightSpace[0] && movedLightSpace[1] == lightSpace[1]);
+                AGE_CHECK(movedLightSpace[2] == lightSpace[2]);
+                const auto texelOffset = (movedLightSpace[3].x - lightSpace[3].x) * resolution / 2.0f;
+                AGE_CHECK(std::abs(std::abs(texelOffset) - 1.0f) < 1.0e-2f);
+                AGE_CHECK(movedLightSpace[3].y == lightSpace[3].y);
+                lightSpace = movedLightSpace;
+            }
+        }
+        AGE_CHECK(numChanges <= 1u);
+
+        // Going back returns to the same projection
+        update(moved, camera, lightDirection);
+        AGE_CHECK(moved.getLightSpaceMatrix(cascade) == cascades.getLightSpaceMatrix(cascade));
+    }
+}
+
+AGE_TEST(ShadowCascades, turningTheCameraKeepsTheCascadeSizes) {
+    const glm::vec3 lightDirection(1.0f, 1.0f, -1.0f);
+    age::ShadowCascades cascades(3, 1024, 50.0f);
+    update(cascades, {{0.0f, -20.0f, 10.0f}, {0.0f, 0.0f, 0.0f}}, lightDirection);
+
+    for (auto angle : {0.3f, 1.2f, 2.5f}) {
+        age::ShadowCascades turned(3, 1024, 50.0f);
+        update(turned, {{0.0f, -20.0f, 10.0f}, {20.0f * std::sin(angle), -20.0f + 20.0f * std::cos(angle), 5.0f}},
+               lightDirection);
+
+        for (auto cascade = 0u; cascade < cascades.getNumCascades(); ++cascade) {
+            AGE_CHECK(turned.getLightSpaceMatrix(cascade)[0][0] == cascades.getLightSpaceMatrix(cascade)[0][0]);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * Minimal harness of the engine tests.
+ *
+ * Tests and benchmarks register themselves under a suite with AGE_TEST and AGE_BENCHMARK.
+ * main runs the tests of the suites named on its command line, or of all suites, and runs
+ * the benchmarks instead with --benchmark. AGE_CHECK doesn't depend on NDEBUG so that the
+ * tests also check release builds, which the benchmarks are measured in.
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace EngineTests {
+
+struct Case {
+    std::string suite;
+    std::string name;
+    std::function<void()> function;
+    bool benchmark;
+};
+
+///
+/// \brief getCases Returns the registered tests and benchmarks.
+///
+std::vector<Case>& getCases();
+
+struct Registration {
+    Registration(const char *suite, const char *name, std::function<void()> function, bool benchmark);
+};
+
+///
+/// \brief fail Reports a failed check of the running test.
+///
+void fail(const char *file, int line, const char *expression);
+
+///
+/// \brief measure Times a benchmark body and prints the median and fastest iteration.
+/// \param label Printed in front of the times.
+/// \param numIterations Number of times body is timed.
+/// \param setup Called untimed before every iteration, e.g. to refill the data body consumes.
+/// \param body Work to time.
+///
+void measure(const std::string &label, unsigned int numIterations,
+             const std::function<void()> &setup, const std::function<void()> &body);
+
+} // namespace EngineTests
+
+#define AGE_TEST_CASE(suite, name, benchmark) \
+    static void suite##_##name(); \
+    static const EngineTests::Registration suite##_##name##_registration(#suite, #name, suite##_##name, benchmark); \
+    static void suite##_##name()
+
+#define AGE_TEST(suite, name) AGE_TEST_CASE(suite, name, false)
+#define AGE_BENCHMARK(suite, name) AGE_TEST_CASE(suite, name, true)
+
+#define AGE_CHECK(condition) \
+    do { if (!(condition)) EngineTests::fail(__FILE__, __LINE__, #condition); } while (false)
@@ -0,0 +1,145 @@
+#include "Test.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android_game_engine/Trace.h>
+
+namespace {
+
+namespace Trace = age::Trace;
+using Ticks = Trace::Ticks;
+
+size_t countOccurrences(const std::string &string, const std::string &substring) {
+    size_t count = 0;
+    for (auto position = string.find(substring); position != std::string::npos;
+         position = string.find(substring, position + substring.size())) {
+        ++count;
+    }
+    return count;
+}
+
+///
+/// \brief countEvents Returns the number of exported events, or thread names, called name.
+///
+size_t countEvents(const std::string &json, const std::string &name) {
+    return countOccurrences(json, "\"name\":\"" + name + "\"");
+}
+
+///
+/// \brief Thread that records an event and keeps its ring until it's stopped.
+///
+class RingHolder {
+public:
+    RingHolder() : thread([this](){
+        Trace::record("Trace.newOwner", Trace::now(), Trace::now());
+        this->recorded = true;
+        while (!this->stopping) std::this_thread::yield();
+    }) {
+        while (!this->recorded) std::this_thread::yield();
+    }
+
+    ~RingHolder() {
+        this->stopping = true;
+        this->thread.join();
+    }
+
+private:
+    std::atomic<bool> recorded {false};
+    std::atomic<bool> stopping {false};
+    std::thread thread;
+};
+
+} // namespace
+
+AGE_TEST(Trace, fullRingsKeepTheLastEvents) {
+    const auto overfill = [](){
+        for (auto i = 0u; i < 100u; ++i) {
+            Trace::record("Trace.overwritten", Trace::now(), Trace::now());
+        }
+        for (auto i = 0u; i < Trace::maxEventsPerThread; ++i) {
+            Trace::record("Trace.kept", Trace::now(), Trace::now());
+        }
+    };
+
+    // The ring of the exporting thread
+    Trace::clear();
+    overfill();
+    auto json = Trace::exportChromeJson();
+    AGE_CHECK(countEvents(json, "Trace.overwritten") == 0u);
+    AGE_CHECK(countEvents(json, "Trace.kept") == Trace::maxEventsPerThread);
+
+    // Cleared events aren't exported either
+    Trace::clear();
+    AGE_CHECK(countEvents(Trace::exportChromeJson(), "Trace.kept") == 0u);
+
+    // The ring of a thread that exited
+    std::thread thread(overfill);
+    thread.join();
+    json = Trace::exportChromeJson();
+    AGE_CHECK(countEvents(json, "Trace.overwritten") == 0u);
+    AGE_CHECK(countEvents(json, "Trace.kept") == Trace::maxEventsPerThread);
+    Trace::clear();
+}
+
+AGE_TEST(Trace, reusedRingsDontExportTheirPreviousOwner) {
+    Trace::clear();
+
+    std::thread previousOwner([](){
+        Trace::setThreadName("Trace.exitedThread");
+        for (int i = 0; i < 10; ++i) {
+            Trace::record("Trace.previousOwner", Trace::now(), Trace::now());
+        }
+    });
+    previousOwner.join();
+    AGE_CHECK(countEvents(Trace::exportChromeJson(), "Trace.previousOwner") == 10u);
+
+    // New threads reuse the rings of exited threads, so holding rings until the exited
+    // thread's name is replaced claims its ring whichever other rings were unused
+    std::vector<std::unique_ptr<RingHolder>> holders;
+    auto json = Trace::exportChromeJson();
+    while (countEvents(json, "Trace.exitedThread") > 0 && holders.size() < 64) {
+        holders.push_back(std::make_unique<RingHolder>());
+        json = Trace::exportChromeJson();
+    }
+
+    AGE_CHECK(countEvents(json, "Trace.exitedThread") == 0u);
+    AGE_CHECK(countEvents(json, "Trace.previousOwner") == 0u);
+    AGE_CHECK(countEvents(json, "Trace.newOwner") == holders.size());
+    holders.clear();
+    Trace::clear();
+}
+
+AGE_BENCHMARK(Trace, scope) {
+    // 1000000 scopes, so milliseconds read as nanoseconds per scope. The budget is 50 ns.
+    const auto numScopes = 1000000;
+    const auto runScopes = [numScopes](){
+        for (int i = 0; i < numScopes; ++i) {
+            AGE_TRACE_SCOPE("Trace.scope");
+        }
+    };
+
+    // A scope takes two timestamps, whose cost depends on the clock of the host
+    volatile Ticks timestamp = 0;
+    EngineTests::measure("1000000 timestamps", 10, nullptr, [&timestamp, numScopes](){
+        for (int i = 0; i < numScopes; ++i) {
+            timestamp = Trace::now();
+        }
+    });
+
+    Trace::setEnabled(false);
+    EngineTests::measure("1000000 scopes, tracing disabled", 10, nullptr, runScopes);
+
+    Trace::setEnabled(true);
+    EngineTests::measure("1000000 scopes, tracing enabled", 10, nullptr, runScopes);
+    Trace::setEnabled(false);
+    Trace::clear();
+
+#ifndef AGE_TRACE
+    std::printf("  AGE_TRACE is off, the scopes are compiled out\n");
+#endif
+}
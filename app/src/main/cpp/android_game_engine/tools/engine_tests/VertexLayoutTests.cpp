@@ -0,0 +1,122 @@
+#include "Test.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/VertexArray.h>
+#include <android_game_engine/VertexLayout.h>
+
+#include "RecordingGL.h"
+
+namespace {
+
+/// Largest error of a component of a signed normalized 10-bit value
+constexpr float normalTolerance = 0.5f / 511.0f + 1.0e-6f;
+
+std::vector<glm::vec3> makeRandomNormals(size_t numNormals) {
+    std::mt19937 random(1);
+    std::normal_distribution<float> component;
+
+    std::vector<glm::vec3> normals;
+    while (normals.size() < numNormals) {
+        const glm::vec3 normal {component(random), component(random), component(random)};
+        if (glm::length(normal) > 1.0e-3f) normals.push_back(glm::normalize(normal));
+    }
+    return normals;
+}
+
+template<typename T>
+T read(const uint8_t *source) {
+    T value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+///
+/// \brief getIndexBufferSize Returns the bytes uploaded for the indices of a vertex array of
+///                           one triangle, without the bytes of its vertices.
+///
+size_t getIndexBufferSize(size_t numVertices) {
+    const std::vector<glm::vec3> positions(numVertices, glm::vec3(0.0f));
+    const std::vector<glm::vec3> normals(numVertices, glm::vec3(0.0f, 1.0f, 0.0f));
+    const std::vector<glm::vec2> textureCoordinates(numVertices, glm::vec2(0.0f));
+    const std::vector<glm::uvec3> indices {{0, 1, static_cast<unsigned int>(numVertices - 1)}};
+
+    RecordingGL::resetStatistics();
+    age::VertexArray vertexArray(positions, normals, textureCoordinates, indices);
+    return RecordingGL::getStatistics().numBufferBytesUploaded - numVertices * age::VertexLayout().getStride();
+}
+
+} // namespace
+
+AGE_TEST(VertexLayout, packedNormalsRoundTrip) {
+    // Axes are represented exactly, with x in the least significant bits
+    AGE_CHECK(age::packNormal({1.0f, 0.0f, 0.0f}) == 511u);
+    AGE_CHECK(age::packNormal({0.0f, 1.0f, 0.0f}) == 511u << 10u);
+    AGE_CHECK(age::packNormal({0.0f, 0.0f, 1.0f}) == 511u << 20u);
+    AGE_CHECK(age::unpackNormal(age::packNormal({0.0f, -1.0f, 0.0f})) == glm::vec3(0.0f, -1.0f, 0.0f));
+
+    unsigned int numOutOfTolerance = 0;
+    for (const auto &normal : makeRandomNormals(10000)) {
+        const auto unpacked = age::unpackNormal(age::packNormal(normal));
+        const auto error = glm::abs(unpacked - normal);
+        numOutOfTolerance += error.x > normalTolerance || error.y > normalTolerance || error.z > normalTolerance;
+    }
+    AGE_CHECK(numOutOfTolerance == 0u);
+}
+
+AGE_TEST(VertexLayout, normalsAreNormalizedWhenPacked) {
+    const auto unpacked = age::unpackNormal(age::packNormal({0.0f, 3.0f, 4.0f}));
+    AGE_CHECK(std::abs(unpacked.x) <= normalTolerance);
+    AGE_CHECK(std::abs(unpacked.y - 0.6f) <= normalTolerance);
+    AGE_CHECK(std::abs(unpacked.z - 0.8f) <= normalTolerance);
+
+    // Degenerate normals don't produce NaNs
+    AGE_CHECK(age::packNormal(glm::vec3(0.0f)) == 0u);
+}
+
+AGE_TEST(VertexLayout, interleavedVerticesMatchTheirLayout) {
+    const std::vector<glm::vec3> positions {{1.0f, 2.0f, 3.0f}, {-0.5f, 0.25f, 100.0f}};
+    const std::vector<glm::vec3> normals {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}};
+    const std::vector<glm::vec2> textureCoordinates {{0.0f, 1.0f}, {0.5f, 0.75f}};
+
+    const age::VertexLayout packed;
+    AGE_CHECK(packed.getNormalOffset() == 12u);
+    AGE_CHECK(packed.getTextureCoordinateOffset() == 16u);
+    AGE_CHECK(packed.getStride() == 20u);
+
+    auto vertices = packed.interleave(positions, normals, textureCoordinates);
+    AGE_CHECK(vertices.size() == 2u * packed.getStride());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto *vertex = &vertices[i * packed.getStride()];
+        AGE_CHECK(read<glm::vec3>(vertex) == positions[i]);
+        AGE_CHECK(age::unpackNormal(read<uint32_t>(vertex + packed.getNormalOffset())) == normals[i]);
+        AGE_CHECK(glm::unpackHalf2x16(read<uint32_t>(vertex + packed.getTextureCoordinateOffset())) == textureCoordinates[i]);
+    }
+
+    // These values are exactly representable as half floats
+    age::VertexLayout halfPositions;
+    halfPositions.position = age::VertexLayout::PositionFormat::HALF4;
+    halfPositions.normal = age::VertexLayout::NormalFormat::FLOAT3;
+    AGE_CHECK(halfPositions.getStride() == 24u);
+
+    vertices = halfPositions.interleave(positions, normals, textureCoordinates);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto *vertex = &vertices[i * halfPositions.getStride()];
+        AGE_CHECK(glm::vec3(glm::unpackHalf4x16(read<uint64_t>(vertex))) == positions[i]);
+        AGE_CHECK(read<glm::vec3>(vertex + halfPositions.getNormalOffset()) == normals[i]);
+    }
+}
+
+AGE_TEST(VertexLayout, indicesAreShortWhenVerticesFit) {
+    AGE_CHECK(getIndexBufferSize(3) == getIndexBufferSize(65535));
+    AGE_CHECK(getIndexBufferSize(65536) - getIndexBufferSize(65535) == 3u * (sizeof(uint32_t) - sizeof(uint16_t)));
+}
@@ -0,0 +1,117 @@
+/**
+ * Runs the engine tests on a desktop host with the recording GL backend of the draw call
+ * benchmark, see Test.h.
+ *
+ * Usage: engine_tests [--benchmark] [suite...]
+ */
+
+#include "Test.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+#include <android/asset_manager_jni.h>
+#include <android/log.h>
+
+#include <android_game_engine/AssetLoader.h>
+#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/ManagerResources.h>
+#include <android_game_engine/ManagerWindowing.h>
+
+#include "HostPlatform.h"
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+unsigned int numFailedChecks = 0;
+
+} // namespace
+
+namespace EngineTests {
+
+std::vector<Case>& getCases() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+Registration::Registration(const char *suite, const char *name, std::function<void()> function, bool benchmark) {
+    getCases().push_back({suite, name, std::move(function), benchmark});
+}
+
+void fail(const char *file, int line, const char *expression) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++numFailedChecks;
+}
+
+void measure(const std::string &label, unsigned int numIterations,
+             const std::function<void()> &setup, const std::function<void()> &body) {
+    std::vector<double> durations; // ms
+    for (auto i = 0u; i < numIterations; ++i) {
+        if (setup) setup();
+
+        const auto begin = std::chrono::steady_clock::now();
+        body();
+        const auto end = std::chrono::steady_clock::now();
+        durations.push_back(Milliseconds(end - begin).count());
+    }
+
+    std::sort(durations.begin(), durations.end());
+    std::printf("  %-48s median %9.3f ms  min %9.3f ms\n",
+                label.c_str(), durations[durations.size() / 2], durations.front());
+}
+
+} // namespace EngineTests
+
+int main(int argc, char *argv[]) {
+    bool benchmark = false;
+    std::vector<std::string> suites;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        } else {
+            suites.emplace_back(argv[i]);
+        }
+    }
+
+    HostPlatform::setMinLogPriority(ANDROID_LOG_WARN);
+
+    // Same order as GameEngineJNI::init
+    auto env = HostPlatform::getJNIEnv();
+    age::ManagerWindowing::init(1920, 1080);
+    age::ManagerAssets::init(AAssetManager_fromJava(env, const_cast<char*>(ASSETS_DIRECTORY)));
+    age::AssetLoader::init(2);
+    age::ManagerResources::init();
+
+    unsigned int numRun = 0, numFailed = 0;
+    for (const auto &testCase : EngineTests::getCases()) {
+        if (testCase.benchmark != benchmark) continue;
+        if (!suites.empty() && std::find(suites.begin(), suites.end(), testCase.suite) == suites.end()) continue;
+
+        std::printf("%s.%s\n", testCase.suite.c_str(), testCase.name.c_str());
+        const auto numFailedBefore = numFailedChecks;
+        try {
+            testCase.function();
+        } catch (const std::exception &e) {
+            EngineTests::fail(testCase.suite.c_str(), 0, e.what());
+        }
+
+        ++numRun;
+        if (numFailedChecks != numFailedBefore) {
+            std::printf("  FAILED\n");
+            ++numFailed;
+        }
+    }
+
+    // Same order as GameEngineJNI's onDestroyJNI
+    age::AssetLoader::shutdown();
+    age::ManagerResources::shutdown();
+    age::ManagerAssets::shutdown();
+    age::ManagerWindowing::shutdown();
+
+    std::printf("%u of %u %s passed\n", numRun - numFailed, numRun, benchmark ? "benchmarks" : "tests");
+    return numRun > 0 && numFailed == 0 ? 0 : 1;
+}
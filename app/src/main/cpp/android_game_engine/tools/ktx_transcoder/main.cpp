@@ -0,0 +1,235 @@
+/**
+ * Transcodes images into ETC2 compressed KTX textures with precomputed mipmaps so that
+ * Texture2D and Skybox can upload them without decoding or generating mipmaps on the device.
+ *
+ * The output should be placed next to the source image with its extension replaced by .ktx.
+ * Cube maps are written next to the +X face image.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <android_game_engine/Etc2.h>
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/Ktx.h>
+
+namespace {
+
+constexpr uint32_t glRgb = 0x1907;
+constexpr uint32_t glRgba = 0x1908;
+
+struct Image {
+    int width;
+    int height;
+    std::vector<uint8_t> pixels; // RGBA
+};
+
+struct Options {
+    bool cubemap = false;
+    bool mipmaps = true;
+    bool flip = true;
+    bool verify = false;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+void printUsage() {
+    std::cerr << "Usage: ktx_transcoder [options] <output.ktx> <image>\n"
+                 "       ktx_transcoder --cubemap [options] <output.ktx> <+x> <-x> <+y> <-y> <+z> <-z>\n"
+                 "Options:\n"
+                 "  --no-mipmaps  Only store the full resolution level\n"
+                 "  --flip        Flip images vertically (default for 2D textures, as Texture2D does)\n"
+                 "  --no-flip     Don't flip images vertically (default for cube maps)\n"
+                 "  --verify      Decode the output and report its PSNR and the encoding throughput\n";
+}
+
+Image loadImage(const std::string &filepath, bool flip) {
+    stbi_set_flip_vertically_on_load(flip);
+
+    Image image;
+    int numChannels;
+    auto pixels = stbi_load(filepath.c_str(), &image.width, &image.height, &numChannels, 4);
+    if (!pixels) {
+        throw age::LoadError("Failed to load image: " + filepath);
+    }
+
+    image.pixels.assign(pixels, pixels + 4 * image.width * image.height);
+    stbi_image_free(pixels);
+    return image;
+}
+
+bool hasTranslucentPixels(const Image &image) {
+    for (size_t i = 3; i < image.pixels.size(); i += 4) {
+        if (image.pixels[i] != 255) return true;
+    }
+    return false;
+}
+
+///
+/// \brief downsample Halves an image with a box filter, clamping odd edges.
+///
+Image downsample(const Image &image) {
+    Image half;
+    half.width = std::max(image.width / 2, 1);
+    half.height = std::max(image.height / 2, 1);
+    half.pixels.resize(4 * half.width * half.height);
+
+    for (auto y = 0; y < half.height; ++y) {
+        for (auto x = 0; x < half.width; ++x) {
+            for (auto c = 0; c < 4; ++c) {
+                auto sum = 0;
+                for (auto dy = 0; dy < 2; ++dy) {
+                    for (auto dx = 0; dx < 2; ++dx) {
+                        auto sourceX = std::min(2 * x + dx, image.width - 1);
+                        auto sourceY = std::min(2 * y + dy, image.height - 1);
+                        sum += image.pixels[4 * (sourceY * image.width + sourceX) + c];
+                    }
+                }
+                half.pixels[4 * (y * half.width + x) + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return half;
+}
+
+double getPsnr(const Image &image, const std::vector<uint8_t> &decoded, bool alpha) {
+    double squaredError = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        if (!alpha && i % 4 == 3) continue;
+        const double difference = static_cast<double>(image.pixels[i]) - decoded[i];
+        squaredError += difference * difference;
+        ++count;
+    }
+
+    if (squaredError == 0.0) return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10(255.0 * 255.0 * count / squaredError);
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    std::vector<std::string> positional;
+    auto flipSet = false;
+
+    for (auto i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--cubemap") {
+            options.cubemap = true;
+        } else if (arg == "--no-mipmaps") {
+            options.mipmaps = false;
+        } else if (arg == "--flip" || arg == "--no-flip") {
+            options.flip = arg == "--flip";
+            flipSet = true;
+        } else if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (options.cubemap && !flipSet) options.flip = false;
+
+    if (positional.size() != (options.cubemap ? 7u : 2u)) return false;
+    options.output = positional.front();
+    options.inputs.assign(positional.cbegin() + 1, positional.cend());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        std::vector<Image> faces;
+        for (const auto &input : options.inputs) {
+            faces.push_back(loadImage(input, options.flip));
+            if (faces.back().width != faces.front().width || faces.back().height != faces.front().height) {
+                throw age::LoadError("Cube map faces must have the same dimensions: " + input);
+            }
+        }
+
+        const auto alpha = std::any_of(faces.cbegin(), faces.cend(), hasTranslucentPixels);
+
+        age::KtxTexture texture;
+        texture.glInternalFormat = alpha ? age::Etc2::rgba8InternalFormat : age::Etc2::rgb8InternalFormat;
+        texture.glBaseInternalFormat = alpha ? glRgba : glRgb;
+        texture.width = static_cast<uint32_t>(faces.front().width);
+        texture.height = static_cast<uint32_t>(faces.front().height);
+        texture.numFaces = static_cast<uint32_t>(faces.size());
+
+        texture.numMipmapLevels = 1;
+        if (options.mipmaps) {
+            while ((std::max(texture.width, texture.height) >> texture.numMipmapLevels) > 0) {
+                ++texture.numMipmapLevels;
+            }
+        }
+
+        std::vector<std::vector<Image>> levels(texture.numMipmapLevels);
+        levels[0] = faces;
+        for (auto level = 1u; level < texture.numMipmapLevels; ++level) {
+            for (const auto &face : levels[level - 1]) {
+                levels[level].push_back(downsample(face));
+            }
+        }
+
+        size_t numPixels = 0;
+        std::chrono::duration<double> encodeDuration(0.0);
+        for (const auto &level : levels) {
+            for (const auto &image : level) {
+                const auto start = std::chrono::steady_clock::now();
+                texture.images.push_back(age::Etc2::compress(image.pixels.data(), image.width, image.height, alpha));
+                encodeDuration += std::chrono::steady_clock::now() - start;
+                numPixels += image.pixels.size() / 4;
+            }
+        }
+
+        const auto data = texture.write();
+        std::ofstream file(options.output, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+            throw age::LoadError("Failed to write: " + options.output);
+        }
+
+        std::printf("%s: %ux%u, %u face(s), %u level(s), %s, %zu bytes (%.1f%% of RGBA8)\n",
+                    options.output.c_str(), texture.width, texture.height, texture.numFaces,
+                    texture.numMipmapLevels, alpha ? "ETC2 RGBA8 EAC" : "ETC2 RGB8", data.size(),
+                    100.0 * data.size() / (4.0 * numPixels));
+
+        if (options.verify) {
+            // Read the written file back to also check the container
+            const auto readTexture = age::KtxTexture::read(data.data(), data.size());
+            for (auto face = 0u; face < readTexture.numFaces; ++face) {
+                const auto &image = levels[0][face];
+                const auto &compressed = readTexture.getImage(0, face);
+                const auto decoded = age::Etc2::decompress(compressed.data(), image.width, image.height, alpha);
+                std::printf("  face %u: PSNR %.2f dB\n", face, getPsnr(image, decoded, alpha));
+            }
+            std::printf("  encoded %zu pixels in %.3f s (%.2f Mpixels/s)\n", numPixels, encodeDuration.count(),
+                        numPixels / encodeDuration.count() / 1.0e6);
+        }
+    } catch (const age::Error &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -46,6 +46,7 @@ public class GameActivity extends AppCompatActivity implements GLSurfaceView.Ren
     private native void onPauseJNI();
     private native void onStopJNI();
     private native void onDestroyJNI();
+    private native void onTrimMemoryJNI(int level);
 
     private native void onSurfaceChangedJNI(int width, int height, int displayRotation);
 
@@ -141,6 +142,14 @@ public class GameActivity extends AppCompatActivity implements GLSurfaceView.Ren
         }
     }
 
+    @Override
+    public void onTrimMemory(int level) {
+        super.onTrimMemory(level);
+
+        // Thread safe, resources are released on the next frame.
+        this.onTrimMemoryJNI(level);
+    }
+
     @Override
     public void onSurfaceCreated(GL10 gl, EGLConfig config) {
         this.onSurfaceCreatedJNI(this.getApplicationContext(),
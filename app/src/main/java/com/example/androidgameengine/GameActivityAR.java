@@ -48,6 +48,7 @@ public class GameActivityAR extends AppCompatActivity implements GLSurfaceView.R
     private native void onPauseJNI();
     private native void onStopJNI();
     private native void onDestroyJNI();
+    private native void onTrimMemoryJNI(int level);
 
     private native void onSurfaceChangedJNI(int width, int height, int displayRotation);
 
@@ -177,6 +178,14 @@ public class GameActivityAR extends AppCompatActivity implements GLSurfaceView.R
         }
     }
 
+    @Override
+    public void onTrimMemory(int level) {
+        super.onTrimMemory(level);
+
+        // Thread safe, resources are released on the next frame.
+        this.onTrimMemoryJNI(level);
+    }
+
     @Override
     public void onRequestPermissionsResult(int requestCode, String[] permissions, int[] results) {
         if (!CameraPermissionHelper.hasCameraPermission(this)) {